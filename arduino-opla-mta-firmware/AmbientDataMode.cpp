@@ -1,12 +1,70 @@
 #include "AmbientDataMode.h"
+#include "Profiler.h"
 
-AmbientDataMode::AmbientDataMode(MKRIoTCarrier* carrierPtr) : BaseMode(carrierPtr) {
+static const uint32_t VALUE_FADE_MS = 300;
+
+AmbientDataMode::AmbientDataMode(MKRIoTCarrier* carrierPtr, SensorService* sensorPtr) : BaseMode(carrierPtr) {
+  sensors = sensorPtr;
   currentState = TEMP_CELSIUS;
   currentTheme = THEME_LIGHT;
+  historyChannel = HISTORY_PRESSURE;
+  buildScene();
+}
+
+void AmbientDataMode::buildScene() {
+  // Layout only; colors and values are filled in per draw
+  
+  // Center: Sun/Moon icon based on theme
+  centerElements[0] = radialDisplay->createCircleElement(0, "", 0, 20);
+  rings[3] = radialDisplay->createCenterRing(3, 0);
+  rings[3].elementCount = 1;
+  rings[3].elements = centerElements;
+  
+  // 1st Ring: Light intensity label and value, history trend and range
+  lightElements[0] = radialDisplay->createTextElement(270, "LIGHT", 0);
+  lightElements[1] = radialDisplay->createTextElement(90, "", 0);
+  lightElements[2] = radialDisplay->createTextElement(0, "", 0);
+  lightElements[3] = radialDisplay->createTextElement(180, "", 0);
+  rings[2] = radialDisplay->createTextRing(45, 1, 0);
+  rings[2].elementCount = 4;
+  rings[2].elements = lightElements;
+  rings[2].autoSpacing = false;
+  
+  // 2nd Ring: Temperature (top) and Humidity (bottom) values
+  valueElements[0] = radialDisplay->createCircleElement(0, "", 0, 18);
+  valueElements[1] = radialDisplay->createCircleElement(180, "", 0, 18);
+  rings[1] = radialDisplay->createCircleRing(70, 18, 0, 0);
+  rings[1].elementCount = 2;
+  rings[1].elements = valueElements;
+  rings[1].autoSpacing = false;
+  rings[1].textSize = 1;
+  
+  // 3rd Ring: Temperature and Humidity labels
+  labelElements[0] = radialDisplay->createTextElement(0, "TEMP", 0);
+  labelElements[1] = radialDisplay->createTextElement(180, "HUMID", 0);
+  rings[0] = radialDisplay->createTextRing(95, 1, 0);
+  rings[0].type = RadialRing::RING_TEXT_ARC;
+  rings[0].elementCount = 2;
+  rings[0].elements = labelElements;
+  rings[0].autoSpacing = false;
+  
+  // Outer ring: sparkline of hourly means over the last 24 hours
+  memset(historyBars, 0, sizeof(historyBars));
+  memset(drawnHistoryBars, 0, sizeof(drawnHistoryBars));
+  rings[4] = radialDisplay->createSparklineRing(111, 14, historyBars, drawnHistoryBars, HISTORY_HOURS);
+  
+  scene.centerX = 120;
+  scene.centerY = 120;
+  scene.backgroundColor = 0;
+  scene.ringCount = 5;
+  scene.rings = rings;
+  scene.lastSignature = 0;
+  animator->setScene(&scene);
 }
 
 void AmbientDataMode::enter() {
   Serial.println("Entering Ambient Data Mode");
+  radialDisplay->invalidate();
   displayWeather();
 }
 
@@ -27,9 +85,40 @@ void AmbientDataMode::handleButtonPress(int buttonIndex) {
   if (buttonIndex == 0) { // TOUCH0 - toggle temperature units
     updateWeatherState();
     displayWeather();
+  } else if (buttonIndex == 2) { // TOUCH2 - next history channel
+    nextHistoryChannel();
+    displayWeather();
   }
 }
 
+void AmbientDataMode::nextHistoryChannel() {
+  static const char* const NAMES[HISTORY_CHANNEL_COUNT] = {"temperature", "humidity", "pressure", "light"};
+  historyChannel = (HistoryChannel)((historyChannel + 1) % HISTORY_CHANNEL_COUNT);
+  Serial.print("History: ");
+  Serial.println(NAMES[historyChannel]);
+}
+
+void AmbientDataMode::updateHistoryText() {
+  // Channel letter, then values at the channel's resolution
+  static const char TAGS[HISTORY_CHANNEL_COUNT] = {'T', 'H', 'P', 'L'};
+  static const int DECIMALS[HISTORY_CHANNEL_COUNT] = {1, 1, 2, 0};
+  
+  const SensorHistory& history = sensors->getHistory();
+  if (history.getSampleCount() == 0) {
+    lightElements[2].content = "";
+    lightElements[3].content = "";
+    return;
+  }
+  
+  char tag = TAGS[historyChannel];
+  int decimals = DECIMALS[historyChannel];
+  float trend = SensorHistory::fromUnits(historyChannel, history.trend(historyChannel, 180));
+  lightElements[2].content.format("%c %s%.*f/3h", tag, trend < 0 ? "-" : "+", decimals, fabs(trend));
+  lightElements[3].content.format("%c %.*f-%.*f", tag,
+                                  decimals, SensorHistory::fromUnits(historyChannel, history.minimum(historyChannel)),
+                                  decimals, SensorHistory::fromUnits(historyChannel, history.maximum(historyChannel)));
+}
+
 void AmbientDataMode::updateWeatherState() {
   if (currentState == TEMP_CELSIUS) {
     currentState = TEMP_FAHRENHEIT;
@@ -41,7 +130,7 @@ void AmbientDataMode::updateWeatherState() {
 }
 
 void AmbientDataMode::updateTheme() {
-  DisplayTheme newTheme = getThemeFromLightSensor();
+  DisplayTheme newTheme = getThemeFromLightLevel(sensors->getSample().light);
   if (newTheme != currentTheme) {
     currentTheme = newTheme;
     Serial.print("Theme changed to: ");
@@ -49,15 +138,7 @@ void AmbientDataMode::updateTheme() {
   }
 }
 
-DisplayTheme AmbientDataMode::getThemeFromLightSensor() {
-  // Read light sensor
-  while (!carrier->Light.colorAvailable()) {
-    delay(5);
-  }
-  int none;
-  int lightLevel;
-  carrier->Light.readColor(none, none, none, lightLevel);
-  
+DisplayTheme AmbientDataMode::getThemeFromLightLevel(int lightLevel) {
   // Threshold for switching themes
   const int LIGHT_THRESHOLD = 300;
   
@@ -65,40 +146,36 @@ DisplayTheme AmbientDataMode::getThemeFromLightSensor() {
 }
 
 void AmbientDataMode::displayWeather() {
-  // Read all sensors
-  float temperature = carrier->Env.readTemperature();
-  float humidity = carrier->Env.readHumidity();
-  float pressure = carrier->Pressure.readPressure();
-  
-  // Read light sensor
-  while (!carrier->Light.colorAvailable()) {
-    delay(5);
-  }
-  int none;
-  int lightLevel;
-  carrier->Light.readColor(none, none, none, lightLevel);
+  PROFILE_SCOPE(PROBE_DISPLAY_WEATHER);
+
+  // Latest smoothed readings; the sensor service does the I2C work
+  const SensorSample& sample = sensors->getSample();
+  float temperature = sample.temperature;
+  float humidity = sample.humidity;
+  float pressure = sample.pressure;
+  int lightLevel = sample.light;
   
   // Convert temperature if needed
   float displayTemp = temperature;
-  String tempUnit = "C";
+  const char* tempUnit = "C";
   if (currentState == TEMP_FAHRENHEIT) {
     displayTemp = (temperature * 9.0 / 5.0) + 32.0;
     tempUnit = "F";
   }
   
-  // Only redraw if values changed significantly
+  // Scene diffing makes an unchanged redraw free, so always hand it over
+  drawRadialWeatherDisplay(displayTemp, tempUnit, humidity, lightLevel);
+  
+  // Only log if values changed significantly
   static float lastDisplayTemp = -999;
   static float lastHumidity = -999;
   static int lastLightLevel = -999;
-  static bool firstDraw = true;
   
   bool tempChanged = abs(displayTemp - lastDisplayTemp) > 0.1;
   bool humidityChanged = abs(humidity - lastHumidity) > 0.5;
   bool lightChanged = abs(lightLevel - lastLightLevel) > 50;
   
-  if (firstDraw || tempChanged || humidityChanged || lightChanged) {
-    drawRadialWeatherDisplay(displayTemp, tempUnit, humidity, lightLevel);
-    
+  if (tempChanged || humidityChanged || lightChanged) {
     Serial.print("Ambient - Temp: ");
     Serial.print(displayTemp);
     Serial.print(" ");
@@ -114,57 +191,53 @@ void AmbientDataMode::displayWeather() {
     lastDisplayTemp = displayTemp;
     lastHumidity = humidity;
     lastLightLevel = lightLevel;
-    firstDraw = false;
   }
 }
 
-void AmbientDataMode::drawRadialWeatherDisplay(float temperature, String tempUnit, float humidity, int lightLevel) {
-  const int centerX = 120;
-  const int centerY = 120;
-  
+void AmbientDataMode::drawRadialWeatherDisplay(float temperature, const char* tempUnit, float humidity, int lightLevel) {
   // Theme colors
   uint16_t bgColor = (currentTheme == THEME_LIGHT) ? ST77XX_WHITE : ST77XX_BLACK;
   uint16_t textColor = (currentTheme == THEME_LIGHT) ? ST77XX_BLACK : ST77XX_WHITE;
   uint16_t accentColor = (currentTheme == THEME_LIGHT) ? 0x7BEF : ST77XX_YELLOW;
   
-  // Clear screen
-  radialDisplay->clear(bgColor);
+  scene.backgroundColor = bgColor;
   
   // Center: Sun/Moon icon based on theme
-  String centerIcon = (currentTheme == THEME_LIGHT) ? "☀" : "☽";
-  radialDisplay->drawCenterElement(centerX, centerY, 20, centerIcon, accentColor, textColor, 3);
+  centerElements[0].content = (currentTheme == THEME_LIGHT) ? "☀" : "☽";
+  centerElements[0].color = accentColor;
+  rings[3].borderColor = textColor;
   
   // 1st Ring: Light intensity label and value
-  RadialElement lightElements[2];
-  lightElements[0] = radialDisplay->createTextElement(270, "LIGHT", textColor);
-  lightElements[1] = radialDisplay->createTextElement(90, String(lightLevel), accentColor);
+  lightElements[0].color = textColor;
+  lightElements[1].content.format("%d", lightLevel);
+  lightElements[1].color = accentColor;
   
-  RadialRing lightRing = radialDisplay->createTextRing(45, 1, textColor);
-  lightRing.elementCount = 2;
-  lightRing.elements = lightElements;
-  lightRing.autoSpacing = false;
-  radialDisplay->drawRing(centerX, centerY, lightRing);
+  // History trend over 3 hours and range over the whole 24 hours
+  updateHistoryText();
+  lightElements[2].color = textColor;
+  lightElements[3].color = textColor;
   
-  // 2nd Ring: Temperature (top) and Humidity (bottom) values
-  RadialElement valueElements[2];
-  valueElements[0] = radialDisplay->createCircleElement(0, String((int)temperature) + tempUnit, accentColor, 18);
-  valueElements[1] = radialDisplay->createCircleElement(180, String((int)humidity) + "%", accentColor, 18);
+  // Outer ring: hourly sparkline of the selected history channel
+  sensors->getHistory().sparkline(historyChannel, historyBars);
+  rings[4].bgColor = (currentTheme == THEME_LIGHT) ? 0xDEFB : 0x2104;
+  rings[4].borderColor = accentColor;
   
-  RadialRing valueRing = radialDisplay->createCircleRing(70, 18, accentColor, textColor);
-  valueRing.elementCount = 2;
-  valueRing.elements = valueElements;
-  valueRing.autoSpacing = false;
-  valueRing.textSize = 1;
-  radialDisplay->drawRing(centerX, centerY, valueRing);
+  // 2nd Ring: Temperature (top) and Humidity (bottom) values
+  // New readings fade through their circles
+  FixedString<7> value;
+  value.format("%d%s", (int)temperature, tempUnit);
+  animator->changeText(rings[1], 0, value.c_str(), TEXT_FADE, VALUE_FADE_MS);
+  valueElements[0].color = accentColor;
+  value.format("%d%%", (int)humidity);
+  animator->changeText(rings[1], 1, value.c_str(), TEXT_FADE, VALUE_FADE_MS);
+  valueElements[1].color = accentColor;
+  rings[1].bgColor = accentColor;
+  rings[1].borderColor = textColor;
   
   // 3rd Ring: Temperature and Humidity labels
-  RadialElement labelElements[2];
-  labelElements[0] = radialDisplay->createTextElement(0, "TEMP", textColor);
-  labelElements[1] = radialDisplay->createTextElement(180, "HUMID", textColor);
-  
-  RadialRing labelRing = radialDisplay->createTextRing(95, 1, textColor);
-  labelRing.elementCount = 2;
-  labelRing.elements = labelElements;
-  labelRing.autoSpacing = false;
-  radialDisplay->drawRing(centerX, centerY, labelRing);
-}
\ No newline at end of file
+  labelElements[0].color = textColor;
+  labelElements[1].color = textColor;
+  
+  // Only the elements that changed since the last draw are repainted
+  radialDisplay->drawRadialLayout(scene);
+}
@@ -2,6 +2,7 @@
 #define AMBIENT_DATA_MODE_H
 
 #include "BaseMode.h"
+#include "SensorService.h"
 
 enum AmbientState {
   TEMP_CELSIUS = 1,
@@ -15,24 +16,39 @@ enum DisplayTheme {
 
 class AmbientDataMode : public BaseMode {
 private:
+  SensorService* sensors;
   AmbientState currentState;
   DisplayTheme currentTheme;
+  HistoryChannel historyChannel;   // Shown in the sparkline ring
+  
+  // Retained radial scene; rings[0] is painted last so it stays on top
+  RadialDisplayConfig scene;
+  RadialRing rings[5];
+  RadialElement centerElements[1];
+  RadialElement lightElements[4];
+  RadialElement valueElements[2];
+  RadialElement labelElements[2];
+  uint8_t historyBars[HISTORY_HOURS];
+  uint8_t drawnHistoryBars[HISTORY_HOURS];
   
 public:
-  AmbientDataMode(MKRIoTCarrier* carrierPtr);
+  AmbientDataMode(MKRIoTCarrier* carrierPtr, SensorService* sensorPtr);
   
   void enter() override;
   void update() override;
   void exit() override;
   void handleButtonPress(int buttonIndex) override;
-  String getName() override { return "Ambient Data"; }
+  const char* getName() override { return "Ambient Data"; }
   
 private:
+  void buildScene();
   void displayWeather();
-  void drawRadialWeatherDisplay(float temperature, String tempUnit, float humidity, int lightLevel);
+  void drawRadialWeatherDisplay(float temperature, const char* tempUnit, float humidity, int lightLevel);
   void updateWeatherState();
   void updateTheme();
-  DisplayTheme getThemeFromLightSensor();
+  void nextHistoryChannel();
+  void updateHistoryText();
+  DisplayTheme getThemeFromLightLevel(int lightLevel);
 };
 
 #endif
\ No newline at end of file
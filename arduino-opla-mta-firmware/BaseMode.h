@@ -3,18 +3,22 @@
 
 #include <Arduino_MKRIoTCarrier.h>
 #include "RadialDisplay.h"
+#include "RadialAnimator.h"
 
 class BaseMode {
 protected:
   MKRIoTCarrier* carrier;
   RadialDisplay* radialDisplay;
+  RadialAnimator* animator;   // Modes hand it their scene
   
 public:
   BaseMode(MKRIoTCarrier* carrierPtr) : carrier(carrierPtr) {
     radialDisplay = new RadialDisplay(carrierPtr);
+    animator = new RadialAnimator(radialDisplay);
   }
   
   virtual ~BaseMode() {
+    delete animator;
     delete radialDisplay;
   }
   
@@ -22,7 +26,12 @@ public:
   virtual void update() = 0;
   virtual void exit() = 0;
   virtual void handleButtonPress(int buttonIndex) = 0;
-  virtual String getName() = 0;
+  virtual const char* getName() = 0;
+
+  // Animation frames; see RadialAnimator::renderFrame()
+  uint32_t renderFrame() { return animator->renderFrame(); }
+  bool isAnimating() { return animator->isAnimating(); }
+  void finishAnimations() { animator->finish(); }
 };
 
 #endif
\ No newline at end of file
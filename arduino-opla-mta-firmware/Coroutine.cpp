@@ -0,0 +1,105 @@
+#include "Coroutine.h"
+
+Coroutine* Coroutine::current = nullptr;
+
+#ifdef ARDUINO_ARCH_SAMD
+// Pushes r4-r11 and lr on the running stack, stores the stack pointer in
+// *save, then switches to the stack at load and pops the same from it.
+// Everything else is caller-saved, and the M0+ has no FPU registers.
+extern "C" void coroutineSwitch(void** save, void* load);
+
+asm(".pushsection .text.coroutineSwitch, \"ax\", %progbits\n"
+    ".syntax unified\n"
+    ".thumb\n"
+    ".thumb_func\n"
+    ".global coroutineSwitch\n"
+    ".type coroutineSwitch, %function\n"
+    "coroutineSwitch:\n"
+    "  push {r4-r7, lr}\n"
+    "  mov r4, r8\n"
+    "  mov r5, r9\n"
+    "  mov r6, r10\n"
+    "  mov r7, r11\n"
+    "  push {r4-r7}\n"
+    "  mov r2, sp\n"
+    "  str r2, [r0]\n"
+    "  mov sp, r1\n"
+    "  pop {r4-r7}\n"
+    "  mov r8, r4\n"
+    "  mov r9, r5\n"
+    "  mov r10, r6\n"
+    "  mov r11, r7\n"
+    "  pop {r4-r7, pc}\n"
+    ".size coroutineSwitch, . - coroutineSwitch\n"
+    ".popsection\n");
+
+// Words coroutineSwitch pops: r8-r11, r4-r7, then pc
+static const int SWITCH_FRAME_WORDS = 9;
+#endif
+
+Coroutine::Coroutine(uint32_t* stackBase, size_t stackBytes) {
+  stack = stackBase;
+  stackWords = stackBytes / sizeof(uint32_t);
+  function = nullptr;
+  context = nullptr;
+  running = false;
+  for (size_t i = 0; i < stackWords; i++) stack[i] = COROUTINE_PAINT;
+}
+
+void Coroutine::entry() {
+  Coroutine* self = current;
+  self->function(self->context);
+  self->running = false;
+  yield();   // Never resumed
+}
+
+void Coroutine::start(Function startFunction, void* startContext) {
+  if (running) return;
+  function = startFunction;
+  context = startContext;
+  running = true;
+
+#ifdef ARDUINO_ARCH_SAMD
+  // A frame for the first switch to pop, which lands in entry() with the
+  // stack empty and 8-byte aligned
+  uint32_t* frame = stack + stackWords - SWITCH_FRAME_WORDS;
+  for (int i = 0; i < SWITCH_FRAME_WORDS - 1; i++) frame[i] = 0;
+  frame[SWITCH_FRAME_WORDS - 1] = (uint32_t)(uintptr_t)&Coroutine::entry;
+  stackPointer = frame;
+#else
+  getcontext(&own);
+  own.uc_stack.ss_sp = stack;
+  own.uc_stack.ss_size = stackWords * sizeof(uint32_t);
+  own.uc_link = nullptr;
+  makecontext(&own, entry, 0);
+#endif
+}
+
+bool Coroutine::resume() {
+  if (!running) return false;
+  Coroutine* previous = current;
+  current = this;
+#ifdef ARDUINO_ARCH_SAMD
+  coroutineSwitch(&callerStackPointer, stackPointer);
+#else
+  swapcontext(&caller, &own);
+#endif
+  current = previous;
+  return running;
+}
+
+void Coroutine::yield() {
+  Coroutine* self = current;
+  if (!self) return;
+#ifdef ARDUINO_ARCH_SAMD
+  coroutineSwitch(&self->stackPointer, self->callerStackPointer);
+#else
+  swapcontext(&self->own, &self->caller);
+#endif
+}
+
+uint32_t Coroutine::getStackPeak() const {
+  size_t unused = 0;
+  while (unused < stackWords && stack[unused] == COROUTINE_PAINT) unused++;
+  return (stackWords - unused) * sizeof(uint32_t);
+}
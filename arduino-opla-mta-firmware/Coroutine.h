@@ -0,0 +1,62 @@
+/*
+ * Coroutine for Arduino Opla MTA Firmware
+ * Runs a function on a stack of its own, from which it can yield back to
+ * whoever resumed it and carry on where it stopped the next time. Code
+ * that pulls its input from a Stream, like the response parsers, can so
+ * wait for bytes still in flight without holding up loop(). On the board a
+ * switch saves the callee-saved registers and swaps the stack pointer; in
+ * the simulator it is ucontext.
+ *
+ * The stack is painted once, so getStackPeak() reports the deepest any
+ * run has reached.
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <Arduino.h>
+#ifndef ARDUINO_ARCH_SAMD
+#include <ucontext.h>
+#endif
+
+const uint32_t COROUTINE_PAINT = 0xC5C5C5C5;
+
+class Coroutine {
+public:
+  typedef void (*Function)(void* context);
+
+private:
+  uint32_t* stack;          // 8-byte aligned
+  size_t stackWords;
+  Function function;
+  void* context;
+  bool running;             // Started and not yet returned
+#ifdef ARDUINO_ARCH_SAMD
+  void* stackPointer;       // Saved by whichever side is not running
+  void* callerStackPointer;
+#else
+  ucontext_t own;
+  ucontext_t caller;
+#endif
+
+  static Coroutine* current;
+  static void entry();
+
+public:
+  Coroutine(uint32_t* stackBase, size_t stackBytes);
+
+  // Sets up function to run from the next resume(); only while not running
+  void start(Function startFunction, void* startContext);
+
+  // Runs it until it yields or returns; true if it yielded
+  bool resume();
+
+  // From inside a coroutine, returns to the caller of resume()
+  static void yield();
+  static bool inside() { return current != nullptr; }
+
+  bool isRunning() const { return running; }
+  uint32_t getStackPeak() const;
+};
+
+#endif
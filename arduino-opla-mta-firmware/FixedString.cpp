@@ -0,0 +1,156 @@
+#include "FixedString.h"
+
+// Bounded output; counts what would have been written past the end so
+// truncation can be detected, but never writes there
+struct TextWriter {
+  char* out;
+  size_t size;
+  size_t length;
+
+  void put(char c) {
+    if (length + 1 < size) out[length] = c;
+    length++;
+  }
+
+  void pad(char c, int count) {
+    while (count-- > 0) put(c);
+  }
+
+  // Writes digits (already formatted, most significant first) with sign and padding
+  void field(const char* sign, const char* digits, int width, bool leftAlign, bool zeroPad) {
+    int used = strlen(sign) + strlen(digits);
+    if (!leftAlign && !zeroPad) pad(' ', width - used);
+    while (*sign) put(*sign++);
+    if (!leftAlign && zeroPad) pad('0', width - used);
+    while (*digits) put(*digits++);
+    if (leftAlign) pad(' ', width - used);
+  }
+};
+
+static char* formatUnsigned(char* end, unsigned long value, unsigned base, bool upper) {
+  const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  *--end = '\0';
+  do {
+    *--end = digits[value % base];
+    value /= base;
+  } while (value);
+  return end;
+}
+
+size_t formatText(char* out, size_t size, const char* format, va_list args) {
+  TextWriter writer = {out, size, 0};
+  char digits[24];
+
+  while (*format) {
+    if (*format != '%') {
+      writer.put(*format++);
+      continue;
+    }
+    format++;
+
+    bool leftAlign = false, zeroPad = false;
+    for (;; format++) {
+      if (*format == '-') leftAlign = true;
+      else if (*format == '0') zeroPad = true;
+      else break;
+    }
+    int width = 0;
+    while (*format >= '0' && *format <= '9') width = width * 10 + (*format++ - '0');
+    int precision = -1;
+    if (*format == '.') {
+      format++;
+      precision = 0;
+      if (*format == '*') {
+        precision = va_arg(args, int);
+        format++;
+      }
+      while (*format >= '0' && *format <= '9') precision = precision * 10 + (*format++ - '0');
+    }
+    bool isLong = false;
+    if (*format == 'l') {
+      isLong = true;
+      format++;
+    }
+
+    char conversion = *format;
+    if (conversion) format++;
+    switch (conversion) {
+      case 'd':
+      case 'i': {
+        long value = isLong ? va_arg(args, long) : va_arg(args, int);
+        unsigned long magnitude = value < 0 ? -(unsigned long)value : value;
+        writer.field(value < 0 ? "-" : "", formatUnsigned(digits + sizeof(digits), magnitude, 10, false),
+                     width, leftAlign, zeroPad);
+        break;
+      }
+      case 'u':
+      case 'x':
+      case 'X': {
+        unsigned long value = isLong ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+        writer.field("", formatUnsigned(digits + sizeof(digits), value, conversion == 'u' ? 10 : 16,
+                                        conversion == 'X'), width, leftAlign, zeroPad);
+        break;
+      }
+      case 'f': {
+        // Fixed decimals from integer arithmetic; up to 6 places
+        double value = va_arg(args, double);
+        if (precision < 0) precision = 6;
+        if (precision > 6) precision = 6;
+        bool negative = value < 0;
+        if (negative) value = -value;
+
+        unsigned long scale = 1;
+        for (int i = 0; i < precision; i++) scale *= 10;
+        if (value * scale >= 4294967295.0) {
+          writer.field(negative ? "-" : "", "ovf", width, leftAlign, false);
+          break;
+        }
+        unsigned long scaled = (unsigned long)(value * scale + 0.5);
+
+        char* text = formatUnsigned(digits + sizeof(digits), scaled / scale, 10, false);
+        if (precision > 0) {
+          // Shift the integer part left to make room for the fraction
+          size_t intLength = strlen(text);
+          memmove(digits, text, intLength);
+          digits[intLength] = '.';
+          unsigned long fraction = scaled % scale;
+          for (int i = precision; i > 0; i--) {
+            digits[intLength + i] = '0' + fraction % 10;
+            fraction /= 10;
+          }
+          digits[intLength + precision + 1] = '\0';
+          text = digits;
+        }
+        writer.field(negative && scaled ? "-" : "", text, width, leftAlign, zeroPad);
+        break;
+      }
+      case 'c':
+        digits[0] = (char)va_arg(args, int);
+        digits[1] = '\0';
+        writer.field("", digits, width, leftAlign, false);
+        break;
+      case 's': {
+        const char* text = va_arg(args, const char*);
+        if (!text) text = "(null)";
+        int length = strlen(text);
+        if (precision >= 0 && precision < length) length = precision;
+        if (!leftAlign) writer.pad(' ', width - length);
+        for (int i = 0; i < length; i++) writer.put(text[i]);
+        if (leftAlign) writer.pad(' ', width - length);
+        break;
+      }
+      case '%':
+        writer.put('%');
+        break;
+      default:
+        // Unknown conversion: show it as written
+        writer.put('%');
+        if (conversion) writer.put(conversion);
+        break;
+    }
+  }
+
+  size_t written = writer.length < size ? writer.length : (size ? size - 1 : 0);
+  if (size) out[written] = '\0';
+  return written;
+}
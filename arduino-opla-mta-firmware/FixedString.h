@@ -0,0 +1,92 @@
+/*
+ * Fixed-capacity string for Arduino Opla MTA Firmware
+ * Holds up to N characters inline, so assigning, appending and formatting
+ * never touch the heap. Text that does not fit is truncated.
+ */
+
+#ifndef FIXEDSTRING_H
+#define FIXEDSTRING_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// printf-style formatting into a buffer of size bytes, always terminated.
+// Supports %d %i %u %x %X %c %s %% and %f, with '-' and '0' flags, width,
+// precision (.* included) and the l length modifier. %f does not need printf float
+// support and rounds halves away from zero. Returns the length written.
+size_t formatText(char* out, size_t size, const char* format, va_list args);
+
+template <size_t N> class FixedString {
+private:
+  static_assert(N > 0 && N < 256, "FixedString holds 1 to 255 characters");
+
+  char text[N + 1];
+  uint8_t textLength;
+
+public:
+  FixedString() { clear(); }
+  FixedString(const char* value) { assign(value); }
+
+  FixedString& operator=(const char* value) {
+    assign(value);
+    return *this;
+  }
+
+  void clear() {
+    text[0] = '\0';
+    textLength = 0;
+  }
+
+  void assign(const char* value) {
+    clear();
+    append(value);
+  }
+
+  FixedString& append(const char* value) {
+    if (!value) return *this;
+    while (*value && textLength < N) {
+      text[textLength++] = *value++;
+    }
+    text[textLength] = '\0';
+    return *this;
+  }
+
+  FixedString& append(char c) {
+    if (textLength < N) {
+      text[textLength++] = c;
+      text[textLength] = '\0';
+    }
+    return *this;
+  }
+
+  FixedString& operator+=(const char* value) { return append(value); }
+  FixedString& operator+=(char c) { return append(c); }
+
+  size_t format(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    textLength = formatText(text, N + 1, fmt, args);
+    va_end(args);
+    return textLength;
+  }
+
+  size_t appendFormat(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    textLength += formatText(text + textLength, N + 1 - textLength, fmt, args);
+    va_end(args);
+    return textLength;
+  }
+
+  const char* c_str() const { return text; }
+  size_t length() const { return textLength; }
+  bool isEmpty() const { return textLength == 0; }
+  static size_t capacity() { return N; }
+
+  bool operator==(const char* other) const { return strcmp(text, other ? other : "") == 0; }
+  bool operator!=(const char* other) const { return !(*this == other); }
+  template <size_t M> bool operator==(const FixedString<M>& other) const { return strcmp(text, other.c_str()) == 0; }
+  template <size_t M> bool operator!=(const FixedString<M>& other) const { return !(*this == other); }
+};
+
+#endif
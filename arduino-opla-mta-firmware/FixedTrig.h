@@ -0,0 +1,91 @@
+/*
+ * Fixed-point trigonometry for Arduino Opla MTA Firmware
+ * The SAMD21's Cortex-M0+ has no FPU, so sin()/cos() on floats are slow
+ * soft-float library calls. Angles here are binary angles (65536 = one turn,
+ * 0 = top, clockwise) and results are Q15, looked up in a quarter-wave sine
+ * table that the compiler generates and places in flash.
+ */
+
+#ifndef FIXEDTRIG_H
+#define FIXEDTRIG_H
+
+#include <stdint.h>
+
+typedef uint16_t BinaryAngle;
+
+const BinaryAngle ANGLE_QUARTER_TURN = 0x4000;
+const int32_t Q15_ONE = 32768;
+
+// Quarter-wave table resolution: 256 steps over 90 degrees, interpolated
+// across the remaining 6 bits of the angle
+const int SINE_TABLE_BITS = 8;
+const int SINE_TABLE_STEPS = 1 << SINE_TABLE_BITS;
+const int SINE_INTERP_BITS = 14 - SINE_TABLE_BITS;
+
+// Compile-time sine, for building the table only (C++11 constexpr: one
+// return statement per function, so loops become recursion)
+constexpr double trigTaylorSin(double x2, double term, int k) {
+  return k > 12 ? 0.0 : term + trigTaylorSin(x2, -term * x2 / ((2 * k) * (2 * k + 1)), k + 1);
+}
+
+constexpr int16_t trigQuarterSineQ15(int step) {
+  return step >= SINE_TABLE_STEPS ? (int16_t)32767
+    : (int16_t)(trigTaylorSin((step * 1.5707963267948966 / SINE_TABLE_STEPS) *
+                              (step * 1.5707963267948966 / SINE_TABLE_STEPS),
+                              step * 1.5707963267948966 / SINE_TABLE_STEPS, 1) * 32768.0 + 0.5);
+}
+
+template <int... Steps> struct TrigSteps {};
+template <int N, int... Steps> struct TrigMakeSteps : TrigMakeSteps<N - 1, N - 1, Steps...> {};
+template <int... Steps> struct TrigMakeSteps<0, Steps...> { typedef TrigSteps<Steps...> type; };
+
+template <typename S> struct TrigSineTable;
+template <int... Steps> struct TrigSineTable<TrigSteps<Steps...> > {
+  static constexpr int16_t values[sizeof...(Steps)] = { trigQuarterSineQ15(Steps)... };
+};
+template <int... Steps>
+constexpr int16_t TrigSineTable<TrigSteps<Steps...> >::values[sizeof...(Steps)];
+
+// sin(0..90 degrees) in Q15, with the 90 degree endpoint for interpolation
+typedef TrigSineTable<TrigMakeSteps<SINE_TABLE_STEPS + 1>::type> QuarterSineTable;
+
+// Sine of a binary angle in Q15 (-32767..32767)
+inline int32_t fixedSin(BinaryAngle angle) {
+  uint16_t quadrant = angle >> 14;
+  uint16_t offset = angle & (ANGLE_QUARTER_TURN - 1);
+  if (quadrant & 1) offset = ANGLE_QUARTER_TURN - offset;   // Mirror 90..180
+
+  int index = offset >> SINE_INTERP_BITS;
+  int32_t value = QuarterSineTable::values[index];
+  int32_t fraction = offset & ((1 << SINE_INTERP_BITS) - 1);
+  if (fraction) {
+    int32_t delta = QuarterSineTable::values[index + 1] - value;
+    value += (delta * fraction) >> SINE_INTERP_BITS;
+  }
+  return (quadrant & 2) ? -value : value;                   // 180..360 is negative
+}
+
+inline int32_t fixedCos(BinaryAngle angle) {
+  return fixedSin(angle + ANGLE_QUARTER_TURN);
+}
+
+// One float multiply, against the several soft-float calls of sin()/cos()
+inline BinaryAngle angleFromDegrees(float degrees) {
+  return (BinaryAngle)(int32_t)(degrees * (65536.0f / 360.0f) + (degrees < 0 ? -0.5f : 0.5f));
+}
+
+// Screen position at a distance from a center, angle 0 at the top running
+// clockwise, rounded to the nearest pixel
+inline void polarToCartesian(int centerX, int centerY, int radius, BinaryAngle angle, int& x, int& y) {
+  x = centerX + (int)(((int32_t)radius * fixedSin(angle) + (Q15_ONE >> 1)) >> 15);
+  y = centerY - (int)(((int32_t)radius * fixedCos(angle) + (Q15_ONE >> 1)) >> 15);
+}
+
+// Same, with radius and result in Q16 for subpixel positioning
+inline void polarToCartesianQ16(int32_t centerXQ16, int32_t centerYQ16, int32_t radiusQ16,
+                                BinaryAngle angle, int32_t& xQ16, int32_t& yQ16) {
+  xQ16 = centerXQ16 + (int32_t)(((int64_t)radiusQ16 * fixedSin(angle)) >> 15);
+  yQ16 = centerYQ16 - (int32_t)(((int64_t)radiusQ16 * fixedCos(angle)) >> 15);
+}
+
+#endif
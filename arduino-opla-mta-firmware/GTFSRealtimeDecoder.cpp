@@ -0,0 +1,368 @@
+#include "GTFSRealtimeDecoder.h"
+
+// Protobuf wire types
+const uint8_t WIRE_VARINT = 0;
+const uint8_t WIRE_FIXED64 = 1;
+const uint8_t WIRE_LENGTH = 2;
+const uint8_t WIRE_FIXED32 = 5;
+
+// gtfs-realtime.proto field numbers
+const uint32_t FEED_MESSAGE_HEADER = 1;
+const uint32_t FEED_MESSAGE_ENTITY = 2;
+const uint32_t FEED_HEADER_TIMESTAMP = 3;
+const uint32_t FEED_ENTITY_TRIP_UPDATE = 3;
+const uint32_t TRIP_UPDATE_TRIP = 1;
+const uint32_t TRIP_UPDATE_STOP_TIME_UPDATE = 2;
+const uint32_t TRIP_DESCRIPTOR_ROUTE_ID = 5;
+const uint32_t STOP_TIME_UPDATE_ARRIVAL = 2;
+const uint32_t STOP_TIME_UPDATE_DEPARTURE = 3;
+const uint32_t STOP_TIME_UPDATE_STOP_ID = 4;
+const uint32_t STOP_TIME_EVENT_TIME = 2;
+
+const uint32_t FEED_END = 0xFFFFFFFF;
+
+GTFSRealtimeDecoder::GTFSRealtimeDecoder() {
+  input = nullptr;
+  clearStops();
+  feedTimestamp = 0;
+  memset(&stats, 0, sizeof(stats));
+}
+
+void GTFSRealtimeDecoder::clearStops() {
+  stopCount = 0;
+}
+
+bool GTFSRealtimeDecoder::watchStop(const char* stopId) {
+  // Watch the parent station; the platform suffix only picks the direction
+  size_t length = strlen(stopId);
+  if (length > 1 && (stopId[length - 1] == 'N' || stopId[length - 1] == 'S')) {
+    length--;
+  }
+  if (length == 0 || length >= (size_t)GTFS_STOP_ID_LENGTH) return false;
+
+  for (int i = 0; i < stopCount; i++) {
+    if (strlen(stops[i].stopId) == length && strncmp(stops[i].stopId, stopId, length) == 0) {
+      return true;
+    }
+  }
+  if (stopCount >= GTFS_MAX_STOPS) return false;
+
+  GTFSStopArrivals& stop = stops[stopCount++];
+  memcpy(stop.stopId, stopId, length);
+  stop.stopId[length] = '\0';
+  stop.uptownCount = 0;
+  stop.downtownCount = 0;
+  return true;
+}
+
+const GTFSStopArrivals* GTFSRealtimeDecoder::findStop(const char* stopId) {
+  bool uptown;
+  int index = findWatchedStop(stopId, uptown);
+  if (index < 0) {
+    // Parent ID given
+    for (int i = 0; i < stopCount; i++) {
+      if (strcmp(stops[i].stopId, stopId) == 0) return &stops[i];
+    }
+    return nullptr;
+  }
+  return &stops[index];
+}
+
+int GTFSRealtimeDecoder::findWatchedStop(const char* stopId, bool& uptown) {
+  size_t length = strlen(stopId);
+  if (length < 2) return -1;
+
+  char suffix = stopId[length - 1];
+  if (suffix != 'N' && suffix != 'S') return -1;
+  uptown = suffix == 'N';
+
+  for (int i = 0; i < stopCount; i++) {
+    if (strlen(stops[i].stopId) == length - 1 && strncmp(stops[i].stopId, stopId, length - 1) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void GTFSRealtimeDecoder::addArrival(GTFSStopArrivals& stop, bool uptown, const char* route, uint32_t arrivalTime) {
+  GTFSArrival* arrivals = uptown ? stop.uptown : stop.downtown;
+  uint8_t& count = uptown ? stop.uptownCount : stop.downtownCount;
+
+  // Keep the table sorted by time, dropping the latest when it is full
+  int slot = count;
+  while (slot > 0 && arrivals[slot - 1].arrivalTime > arrivalTime) {
+    slot--;
+  }
+  if (slot >= TRAINS_PER_DIRECTION) return;
+
+  int last = count < TRAINS_PER_DIRECTION ? count : TRAINS_PER_DIRECTION - 1;
+  for (int i = last; i > slot; i--) {
+    arrivals[i] = arrivals[i - 1];
+  }
+  arrivals[slot].route = route;
+  arrivals[slot].arrivalTime = arrivalTime;
+  if (count < TRAINS_PER_DIRECTION) count++;
+}
+
+bool GTFSRealtimeDecoder::decode(Stream& feed, long length) {
+  input = &feed;
+  remaining = length;
+  position = 0;
+  bufferLength = 0;
+  bufferPos = 0;
+  feedTimestamp = 0;
+  memset(&stats, 0, sizeof(stats));
+  for (int i = 0; i < stopCount; i++) {
+    stops[i].uptownCount = 0;
+    stops[i].downtownCount = 0;
+  }
+
+  bool ok = true;
+  while (ok && (bufferPos < bufferLength || fillBuffer())) {
+    uint32_t field, messageEnd;
+    uint8_t wireType;
+    ok = readTag(field, wireType);
+    if (!ok) break;
+
+    if (field == FEED_MESSAGE_HEADER && wireType == WIRE_LENGTH) {
+      ok = readLength(FEED_END, messageEnd) && decodeHeader(messageEnd);
+    } else if (field == FEED_MESSAGE_ENTITY && wireType == WIRE_LENGTH) {
+      ok = readLength(FEED_END, messageEnd) && decodeEntity(messageEnd);
+    } else {
+      ok = skipField(wireType);
+    }
+  }
+
+  stats.bytes = position;
+  input = nullptr;
+  return ok && (length < 0 || position == (uint32_t)length);
+}
+
+bool GTFSRealtimeDecoder::fillBuffer() {
+  if (remaining == 0) return false;
+
+  size_t wanted = sizeof(buffer);
+  if (remaining > 0 && remaining < (long)wanted) wanted = remaining;
+  size_t received = input->readBytes(buffer, wanted);
+  if (received == 0) return false;
+
+  if (remaining > 0) remaining -= received;
+  bufferLength = received;
+  bufferPos = 0;
+  return true;
+}
+
+bool GTFSRealtimeDecoder::readByte(uint8_t& value) {
+  if (bufferPos >= bufferLength && !fillBuffer()) return false;
+  value = buffer[bufferPos++];
+  position++;
+  return true;
+}
+
+bool GTFSRealtimeDecoder::readVarint(uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    uint8_t b;
+    if (!readByte(b)) return false;
+    value |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+bool GTFSRealtimeDecoder::readTag(uint32_t& field, uint8_t& wireType) {
+  uint64_t tag;
+  if (!readVarint(tag)) return false;
+  field = (uint32_t)(tag >> 3);
+  wireType = tag & 0x07;
+  return field != 0;
+}
+
+bool GTFSRealtimeDecoder::readLength(uint32_t end, uint32_t& messageEnd) {
+  uint64_t length;
+  if (!readVarint(length)) return false;
+  if (length > end - position) return false;
+  messageEnd = position + (uint32_t)length;
+  return true;
+}
+
+bool GTFSRealtimeDecoder::skipBytes(uint32_t length) {
+  while (length > 0) {
+    if (bufferPos >= bufferLength && !fillBuffer()) return false;
+    uint32_t available = bufferLength - bufferPos;
+    uint32_t count = length < available ? length : available;
+    bufferPos += count;
+    position += count;
+    length -= count;
+  }
+  return true;
+}
+
+bool GTFSRealtimeDecoder::skipField(uint8_t wireType) {
+  uint64_t value;
+  switch (wireType) {
+    case WIRE_VARINT:
+      return readVarint(value);
+    case WIRE_FIXED64:
+      return skipBytes(8);
+    case WIRE_LENGTH: {
+      uint32_t end;
+      return readLength(FEED_END, end) && skipBytes(end - position);
+    }
+    case WIRE_FIXED32:
+      return skipBytes(4);
+    default:
+      // Groups are not used by gtfs-realtime
+      return false;
+  }
+}
+
+bool GTFSRealtimeDecoder::readString(char* out, size_t size, uint32_t length) {
+  // Strings too long for out are skipped and read back as empty
+  if (length >= size) {
+    out[0] = '\0';
+    return skipBytes(length);
+  }
+  for (uint32_t i = 0; i < length; i++) {
+    uint8_t b;
+    if (!readByte(b)) return false;
+    out[i] = (char)b;
+  }
+  out[length] = '\0';
+  return true;
+}
+
+bool GTFSRealtimeDecoder::decodeHeader(uint32_t end) {
+  while (position < end) {
+    uint32_t field;
+    uint8_t wireType;
+    if (!readTag(field, wireType)) return false;
+
+    if (field == FEED_HEADER_TIMESTAMP && wireType == WIRE_VARINT) {
+      uint64_t timestamp;
+      if (!readVarint(timestamp)) return false;
+      feedTimestamp = (uint32_t)timestamp;
+    } else if (!skipField(wireType)) {
+      return false;
+    }
+  }
+  return position == end;
+}
+
+bool GTFSRealtimeDecoder::decodeEntity(uint32_t end) {
+  stats.entities++;
+  while (position < end) {
+    uint32_t field, messageEnd;
+    uint8_t wireType;
+    if (!readTag(field, wireType)) return false;
+
+    if (field == FEED_ENTITY_TRIP_UPDATE && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) || !decodeTripUpdate(messageEnd)) return false;
+    } else if (!skipField(wireType)) {
+      return false;
+    }
+  }
+  return position == end;
+}
+
+bool GTFSRealtimeDecoder::decodeTripUpdate(uint32_t end) {
+  stats.tripUpdates++;
+  pendingCount = 0;
+  char route[GTFS_ROUTE_ID_LENGTH] = "";
+
+  while (position < end) {
+    uint32_t field, messageEnd;
+    uint8_t wireType;
+    if (!readTag(field, wireType)) return false;
+
+    if (field == TRIP_UPDATE_TRIP && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) || !decodeTrip(messageEnd, route)) return false;
+    } else if (field == TRIP_UPDATE_STOP_TIME_UPDATE && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) || !decodeStopTimeUpdate(messageEnd)) return false;
+    } else if (!skipField(wireType)) {
+      return false;
+    }
+  }
+  if (position != end) return false;
+
+  // The route may come after the stop times, so arrivals wait until here
+  for (int i = 0; i < pendingCount; i++) {
+    addArrival(stops[pending[i].stop], pending[i].uptown, route, pending[i].arrivalTime);
+  }
+  return true;
+}
+
+bool GTFSRealtimeDecoder::decodeTrip(uint32_t end, char* route) {
+  while (position < end) {
+    uint32_t field, messageEnd;
+    uint8_t wireType;
+    if (!readTag(field, wireType)) return false;
+
+    if (field == TRIP_DESCRIPTOR_ROUTE_ID && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) ||
+          !readString(route, GTFS_ROUTE_ID_LENGTH, messageEnd - position)) return false;
+    } else if (!skipField(wireType)) {
+      return false;
+    }
+  }
+  return position == end;
+}
+
+bool GTFSRealtimeDecoder::decodeStopTimeUpdate(uint32_t end) {
+  stats.stopTimeUpdates++;
+  char stopId[GTFS_STOP_ID_LENGTH + 1] = "";
+  uint32_t arrivalTime = 0;
+  uint32_t departureTime = 0;
+
+  while (position < end) {
+    uint32_t field, messageEnd;
+    uint8_t wireType;
+    if (!readTag(field, wireType)) return false;
+
+    if (field == STOP_TIME_UPDATE_STOP_ID && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) ||
+          !readString(stopId, sizeof(stopId), messageEnd - position)) return false;
+    } else if (field == STOP_TIME_UPDATE_ARRIVAL && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) || !decodeStopTimeEvent(messageEnd, arrivalTime)) return false;
+    } else if (field == STOP_TIME_UPDATE_DEPARTURE && wireType == WIRE_LENGTH) {
+      if (!readLength(end, messageEnd) || !decodeStopTimeEvent(messageEnd, departureTime)) return false;
+    } else if (!skipField(wireType)) {
+      return false;
+    }
+  }
+  if (position != end) return false;
+
+  bool uptown;
+  int stop = findWatchedStop(stopId, uptown);
+  uint32_t time = arrivalTime ? arrivalTime : departureTime;
+  if (stop < 0 || time == 0) return true;
+
+  // Trains that have already left are of no use
+  if (feedTimestamp && time < feedTimestamp) return true;
+
+  stats.matches++;
+  if (pendingCount < GTFS_MAX_STOPS) {
+    pending[pendingCount].stop = stop;
+    pending[pendingCount].uptown = uptown;
+    pending[pendingCount].arrivalTime = time;
+    pendingCount++;
+  }
+  return true;
+}
+
+bool GTFSRealtimeDecoder::decodeStopTimeEvent(uint32_t end, uint32_t& time) {
+  while (position < end) {
+    uint32_t field;
+    uint8_t wireType;
+    if (!readTag(field, wireType)) return false;
+
+    if (field == STOP_TIME_EVENT_TIME && wireType == WIRE_VARINT) {
+      uint64_t value;
+      if (!readVarint(value)) return false;
+      time = (uint32_t)value;
+    } else if (!skipField(wireType)) {
+      return false;
+    }
+  }
+  return position == end;
+}
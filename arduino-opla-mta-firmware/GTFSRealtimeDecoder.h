@@ -0,0 +1,102 @@
+/*
+ * GTFS-realtime decoder for Arduino Opla MTA Firmware
+ * Walks the protobuf wire format of an MTA feed straight from a Stream:
+ * FeedMessage -> FeedEntity -> TripUpdate -> StopTimeUpdate. Only stop time
+ * updates for watched stations are kept, as the soonest few arrivals per
+ * direction in fixed-size tables. Nothing is allocated and the feed is
+ * never buffered, so feeds of hundreds of KB decode in a few KB of RAM.
+ */
+
+#ifndef GTFSREALTIMEDECODER_H
+#define GTFSREALTIMEDECODER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "RouteId.h"
+
+const int GTFS_MAX_STOPS = 4;         // Stations watched in one pass
+const int GTFS_STOP_ID_LENGTH = 8;    // Parent stop ID, e.g. "401"
+const int GTFS_ROUTE_ID_LENGTH = 8;   // Route ID, e.g. "6X"
+
+struct GTFSArrival {
+  RouteId route;
+  uint32_t arrivalTime;   // POSIX seconds
+};
+
+// Soonest arrivals at one station. Stop IDs ending in N are uptown, S downtown.
+struct GTFSStopArrivals {
+  char stopId[GTFS_STOP_ID_LENGTH];
+  GTFSArrival uptown[TRAINS_PER_DIRECTION];
+  GTFSArrival downtown[TRAINS_PER_DIRECTION];
+  uint8_t uptownCount;
+  uint8_t downtownCount;
+};
+
+struct GTFSDecodeStats {
+  uint32_t bytes;
+  uint32_t entities;
+  uint32_t tripUpdates;
+  uint32_t stopTimeUpdates;
+  uint32_t matches;         // Stop time updates at a watched station
+};
+
+class GTFSRealtimeDecoder {
+private:
+  GTFSStopArrivals stops[GTFS_MAX_STOPS];
+  int stopCount;
+  uint32_t feedTimestamp;
+  GTFSDecodeStats stats;
+
+  // Input, read through a small buffer
+  Stream* input;
+  long remaining;           // Bytes left in the feed, or -1 if unknown
+  uint32_t position;        // Offset of the next byte in the feed
+  uint8_t buffer[64];
+  uint8_t bufferLength, bufferPos;
+
+  // Watched-station matches within the trip being decoded, kept until its
+  // route is known
+  struct PendingArrival {
+    int8_t stop;
+    bool uptown;
+    uint32_t arrivalTime;
+  };
+  PendingArrival pending[GTFS_MAX_STOPS];
+  int pendingCount;
+
+  bool fillBuffer();
+  bool readByte(uint8_t& value);
+  bool readVarint(uint64_t& value);
+  bool readTag(uint32_t& field, uint8_t& wireType);
+  bool skipBytes(uint32_t length);
+  bool skipField(uint8_t wireType);
+  bool readString(char* out, size_t size, uint32_t length);
+  bool readLength(uint32_t end, uint32_t& messageEnd);
+
+  bool decodeHeader(uint32_t end);
+  bool decodeEntity(uint32_t end);
+  bool decodeTripUpdate(uint32_t end);
+  bool decodeTrip(uint32_t end, char* route);
+  bool decodeStopTimeUpdate(uint32_t end);
+  bool decodeStopTimeEvent(uint32_t end, uint32_t& time);
+
+  int findWatchedStop(const char* stopId, bool& uptown);
+  void addArrival(GTFSStopArrivals& stop, bool uptown, const char* route, uint32_t arrivalTime);
+
+public:
+  GTFSRealtimeDecoder();
+
+  // Stations to keep, as parent IDs ("401") or either platform ("401N")
+  void clearStops();
+  bool watchStop(const char* stopId);
+
+  // Decodes one FeedMessage, replacing the arrivals from the last one.
+  // length is the body size, or -1 to read until the stream runs dry.
+  bool decode(Stream& feed, long length);
+
+  const GTFSStopArrivals* findStop(const char* stopId);
+  uint32_t getFeedTimestamp() { return feedTimestamp; }
+  const GTFSDecodeStats& getStats() { return stats; }
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "GlyphAtlas.h"
+
+static const uint16_t FIRST_ASCII = ' ';
+static const uint16_t LAST_ASCII = '~';
+
+uint16_t nextCodepoint(const char*& text) {
+  uint8_t lead = (uint8_t)*text++;
+  if (lead < 0x80) return lead;
+
+  // Continuation bytes expected after the lead, and its payload bits
+  int extra = (lead & 0xE0) == 0xC0 ? 1 : (lead & 0xF0) == 0xE0 ? 2 : 0;
+  if (extra == 0) return GLYPH_REPLACEMENT;
+  uint16_t codepoint = lead & (extra == 1 ? 0x1F : 0x0F);
+  for (int i = 0; i < extra; i++) {
+    if (((uint8_t)*text & 0xC0) != 0x80) return GLYPH_REPLACEMENT;   // Leave it for the next call
+    codepoint = (codepoint << 6) | ((uint8_t)*text++ & 0x3F);
+  }
+  return codepoint;
+}
+
+const GlyphEntry* findGlyph(uint16_t codepoint) {
+  if (codepoint >= FIRST_ASCII && codepoint <= LAST_ASCII) return &GLYPHS[codepoint - FIRST_ASCII];
+
+  // The symbols after ASCII are few and sorted
+  int low = LAST_ASCII - FIRST_ASCII + 1, high = GLYPH_COUNT - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    if (GLYPHS[middle].codepoint == codepoint) return &GLYPHS[middle];
+    if (GLYPHS[middle].codepoint < codepoint) {
+      low = middle + 1;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return &GLYPHS[GLYPH_REPLACEMENT - FIRST_ASCII];
+}
+
+int glyphTextWidth(const char* text, int size) {
+  int width = 0;
+  while (*text) {
+    width += findGlyph(nextCodepoint(text))->width + GLYPH_SPACING;
+  }
+  return width > 0 ? (width - GLYPH_SPACING) * size : 0;
+}
+
+// Runs of set bits down each column, one rectangle per run
+static void drawGlyphColumns(StripCompositor& target, int x, int y, const GlyphEntry* glyph,
+                             int size, uint16_t color) {
+  for (int column = 0; column < glyph->width; column++) {
+    uint8_t bits = GLYPH_COLUMNS[glyph->offset + column];
+    int row = 0;
+    while (bits) {
+      while (!(bits & 1)) {
+        bits >>= 1;
+        row++;
+      }
+      int start = row;
+      while (bits & 1) {
+        bits >>= 1;
+        row++;
+      }
+      target.writeFillRect(x + column * size, y + start * size, size, (row - start) * size, color);
+    }
+  }
+}
+
+void drawGlyphText(StripCompositor& target, int x, int y, const char* text, int size, uint16_t color) {
+  int height = GLYPH_HEIGHT * size;
+  target.startWrite();
+  while (*text) {
+    const GlyphEntry* glyph = findGlyph(nextCodepoint(text));
+    int width = glyph->width * size;
+    if (width > 0 && target.stripIntersects(x, y, width, height)) {
+      if (size == GLYPH_SPRITE_SIZE && glyph->sprite != GLYPH_NO_SPRITE) {
+        target.drawMask(x, y, GLYPH_SPRITES[glyph->sprite], width, height, GLYPH_SPRITE_STRIDE, color);
+      } else {
+        drawGlyphColumns(target, x, y, glyph, size, color);
+      }
+    }
+    x += width + GLYPH_SPACING * size;
+  }
+  target.endWrite();
+}
+
+void drawRotatedGlyph(StripCompositor& target, int32_t centerXQ16, int32_t centerYQ16,
+                      int32_t rightX, int32_t rightY, const GlyphEntry* glyph, int size, uint16_t color) {
+  int width = glyph->width * size;
+  int height = GLYPH_HEIGHT * size;
+  if (width == 0) return;
+
+  // Every screen pixel in a square that holds the glyph at any rotation is
+  // mapped back into the glyph (u along the baseline, v down the rows, Q15
+  // pixels from its top-left corner) and takes the bit it lands on; along a
+  // row u and v only step, so there is no multiply per pixel
+  int reach = (width + height) / 2 + 1;
+  int centerX = centerXQ16 >> 16;
+  int centerY = centerYQ16 >> 16;
+  int16_t top, bottom;
+  target.visibleRows(top, bottom);
+  top = max(top, (int16_t)(centerY - reach));
+  bottom = min(bottom, (int16_t)(centerY + reach));
+  int left = centerX - reach, right = centerX + reach;
+
+  target.startWrite();
+  for (int y = top; y <= bottom; y++) {
+    int64_t dx = ((int64_t)left << 16) - centerXQ16;
+    int64_t dy = ((int64_t)y << 16) - centerYQ16;
+    int32_t u = (int32_t)((dx * rightX + dy * rightY) >> 16) + (width << 14);
+    int32_t v = (int32_t)((dy * rightX - dx * rightY) >> 16) + (height << 14);
+
+    int runStart = -1;
+    for (int x = left; x <= right + 1; x++, u += rightX, v -= rightY) {
+      bool set = false;
+      if (x <= right && u >= 0 && v >= 0) {
+        int column = u >> 15, row = v >> 15;
+        set = column < width && row < height &&
+              ((GLYPH_COLUMNS[glyph->offset + column / size] >> (row / size)) & 1);
+      }
+      if (set && runStart < 0) {
+        runStart = x;
+      } else if (!set && runStart >= 0) {
+        target.writeFastHLine(runStart, y, x - runStart, color);
+        runStart = -1;
+      }
+    }
+  }
+  target.endWrite();
+}
@@ -0,0 +1,70 @@
+/*
+ * Glyph atlas for Arduino Opla MTA Firmware
+ * Proportional text from tables generated out of the classic 5x7 GFX font
+ * (GlyphTables.cpp, written by sim/tools/glyph_tables.cpp): each glyph is
+ * trimmed to its ink and keeps its own advance width, so text measures
+ * what it draws. The tables are const, so they stay in flash.
+ *
+ * Text is UTF-8. Besides printable ASCII the atlas has the few symbols the
+ * modes use; anything else draws as GLYPH_REPLACEMENT. Glyphs can be drawn
+ * upright or rotated about their center, which is how RadialDisplay lays
+ * text along a ring. Digits and "m", the countdown characters, also come
+ * pre-rasterized at GLYPH_SPRITE_SIZE and are blitted as 1-bit masks.
+ */
+
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <Arduino.h>
+#include "StripCompositor.h"
+
+const int GLYPH_HEIGHT = 8;             // Rows per glyph; row 7 is for descenders
+const int GLYPH_SPACING = 1;            // Blank columns after each glyph
+
+// Symbols beyond ASCII
+const uint16_t GLYPH_SUN = 0x2600;      // ☀
+const uint16_t GLYPH_MOON = 0x263D;     // ☽
+const uint16_t GLYPH_REPLACEMENT = '?';
+
+// Countdown sprites: "0".."9" and "m" at the text size arrivals are drawn with
+const char GLYPH_SPRITE_CHARACTERS[] = "0123456789m";
+const int GLYPH_SPRITE_COUNT = sizeof(GLYPH_SPRITE_CHARACTERS) - 1;
+const int GLYPH_SPRITE_SIZE = 2;
+const int GLYPH_SPRITE_ROWS = GLYPH_HEIGHT * GLYPH_SPRITE_SIZE;
+const int GLYPH_SPRITE_STRIDE = 2;      // Bytes per row, most significant bit leftmost
+const int GLYPH_SPRITE_BYTES = GLYPH_SPRITE_ROWS * GLYPH_SPRITE_STRIDE;
+const uint8_t GLYPH_NO_SPRITE = 0xFF;
+
+// Generated table rows, sorted by codepoint; printable ASCII comes first
+// and in order, so it is indexed directly
+struct GlyphEntry {
+  uint16_t codepoint;
+  uint16_t offset;                      // First column in GLYPH_COLUMNS
+  uint8_t width;                        // Columns of ink, the advance less GLYPH_SPACING
+  uint8_t sprite;                       // Index in GLYPH_SPRITES, or GLYPH_NO_SPRITE
+};
+
+extern const uint8_t GLYPH_COLUMNS[];   // One byte per column, bit 0 the top row
+extern const GlyphEntry GLYPHS[];
+extern const uint16_t GLYPH_COUNT;
+extern const uint8_t GLYPH_SPRITES[][GLYPH_SPRITE_BYTES];
+
+// Decodes the character at text and steps past it; malformed or 4-byte
+// sequences come back as GLYPH_REPLACEMENT
+uint16_t nextCodepoint(const char*& text);
+
+// The glyph for a character, the replacement glyph if there is none
+const GlyphEntry* findGlyph(uint16_t codepoint);
+
+// Pixels from the first glyph's left edge to the last one's right edge
+int glyphTextWidth(const char* text, int size);
+
+// Upright text with its top-left corner at x, y
+void drawGlyphText(StripCompositor& target, int x, int y, const char* text, int size, uint16_t color);
+
+// One glyph centered on a Q16 point, its baseline along the Q15 unit
+// vector (rightX, rightY); rows of the glyph run 90 degrees clockwise of it
+void drawRotatedGlyph(StripCompositor& target, int32_t centerXQ16, int32_t centerYQ16,
+                      int32_t rightX, int32_t rightY, const GlyphEntry* glyph, int size, uint16_t color);
+
+#endif
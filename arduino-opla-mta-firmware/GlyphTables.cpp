@@ -0,0 +1,277 @@
+/*
+ * Glyph atlas tables for Arduino Opla MTA Firmware
+ * Generated by sim/tools/glyph_tables.cpp; do not edit.
+ * 97 glyphs, 438 columns, 11 sprites at size 2.
+ */
+
+#include "GlyphAtlas.h"
+
+const uint8_t GLYPH_COLUMNS[] = {
+  0x00, 0x00,  // ' '
+  0x5F,  // '!'
+  0x07, 0x00, 0x07,  // '"'
+  0x14, 0x7F, 0x14, 0x7F, 0x14,  // '#'
+  0x24, 0x2A, 0x7F, 0x2A, 0x12,  // '$'
+  0x23, 0x13, 0x08, 0x64, 0x62,  // '%'
+  0x36, 0x49, 0x56, 0x20, 0x50,  // '&'
+  0x08, 0x07, 0x03,  // '\''
+  0x1C, 0x22, 0x41,  // '('
+  0x41, 0x22, 0x1C,  // ')'
+  0x2A, 0x1C, 0x7F, 0x1C, 0x2A,  // '*'
+  0x08, 0x08, 0x3E, 0x08, 0x08,  // '+'
+  0x80, 0x70, 0x30,  // ','
+  0x08, 0x08, 0x08, 0x08, 0x08,  // '-'
+  0x60, 0x60,  // '.'
+  0x20, 0x10, 0x08, 0x04, 0x02,  // '/'
+  0x3E, 0x51, 0x49, 0x45, 0x3E,  // '0'
+  0x00, 0x42, 0x7F, 0x40, 0x00,  // '1'
+  0x72, 0x49, 0x49, 0x49, 0x46,  // '2'
+  0x21, 0x41, 0x49, 0x4D, 0x33,  // '3'
+  0x18, 0x14, 0x12, 0x7F, 0x10,  // '4'
+  0x27, 0x45, 0x45, 0x45, 0x39,  // '5'
+  0x3C, 0x4A, 0x49, 0x49, 0x31,  // '6'
+  0x41, 0x21, 0x11, 0x09, 0x07,  // '7'
+  0x36, 0x49, 0x49, 0x49, 0x36,  // '8'
+  0x46, 0x49, 0x49, 0x29, 0x1E,  // '9'
+  0x14,  // ':'
+  0x40, 0x34,  // ';'
+  0x08, 0x14, 0x22, 0x41,  // '<'
+  0x14, 0x14, 0x14, 0x14, 0x14,  // '='
+  0x41, 0x22, 0x14, 0x08,  // '>'
+  0x02, 0x01, 0x59, 0x09, 0x06,  // '?'
+  0x3E, 0x41, 0x5D, 0x59, 0x4E,  // '@'
+  0x7C, 0x12, 0x11, 0x12, 0x7C,  // 'A'
+  0x7F, 0x49, 0x49, 0x49, 0x36,  // 'B'
+  0x3E, 0x41, 0x41, 0x41, 0x22,  // 'C'
+  0x7F, 0x41, 0x41, 0x41, 0x3E,  // 'D'
+  0x7F, 0x49, 0x49, 0x49, 0x41,  // 'E'
+  0x7F, 0x09, 0x09, 0x09, 0x01,  // 'F'
+  0x3E, 0x41, 0x41, 0x51, 0x73,  // 'G'
+  0x7F, 0x08, 0x08, 0x08, 0x7F,  // 'H'
+  0x41, 0x7F, 0x41,  // 'I'
+  0x20, 0x40, 0x41, 0x3F, 0x01,  // 'J'
+  0x7F, 0x08, 0x14, 0x22, 0x41,  // 'K'
+  0x7F, 0x40, 0x40, 0x40, 0x40,  // 'L'
+  0x7F, 0x02, 0x1C, 0x02, 0x7F,  // 'M'
+  0x7F, 0x04, 0x08, 0x10, 0x7F,  // 'N'
+  0x3E, 0x41, 0x41, 0x41, 0x3E,  // 'O'
+  0x7F, 0x09, 0x09, 0x09, 0x06,  // 'P'
+  0x3E, 0x41, 0x51, 0x21, 0x5E,  // 'Q'
+  0x7F, 0x09, 0x19, 0x29, 0x46,  // 'R'
+  0x26, 0x49, 0x49, 0x49, 0x32,  // 'S'
+  0x03, 0x01, 0x7F, 0x01, 0x03,  // 'T'
+  0x3F, 0x40, 0x40, 0x40, 0x3F,  // 'U'
+  0x1F, 0x20, 0x40, 0x20, 0x1F,  // 'V'
+  0x3F, 0x40, 0x38, 0x40, 0x3F,  // 'W'
+  0x63, 0x14, 0x08, 0x14, 0x63,  // 'X'
+  0x03, 0x04, 0x78, 0x04, 0x03,  // 'Y'
+  0x61, 0x59, 0x49, 0x4D, 0x43,  // 'Z'
+  0x7F, 0x41, 0x41, 0x41,  // '['
+  0x02, 0x04, 0x08, 0x10, 0x20,  // '\\'
+  0x41, 0x41, 0x41, 0x7F,  // ']'
+  0x04, 0x02, 0x01, 0x02, 0x04,  // '^'
+  0x40, 0x40, 0x40, 0x40, 0x40,  // '_'
+  0x03, 0x07, 0x08,  // '`'
+  0x20, 0x54, 0x54, 0x78, 0x40,  // 'a'
+  0x7F, 0x28, 0x44, 0x44, 0x38,  // 'b'
+  0x38, 0x44, 0x44, 0x44, 0x28,  // 'c'
+  0x38, 0x44, 0x44, 0x28, 0x7F,  // 'd'
+  0x38, 0x54, 0x54, 0x54, 0x18,  // 'e'
+  0x08, 0x7E, 0x09, 0x02,  // 'f'
+  0x18, 0xA4, 0xA4, 0x9C, 0x78,  // 'g'
+  0x7F, 0x08, 0x04, 0x04, 0x78,  // 'h'
+  0x44, 0x7D, 0x40,  // 'i'
+  0x20, 0x40, 0x40, 0x3D,  // 'j'
+  0x7F, 0x10, 0x28, 0x44,  // 'k'
+  0x41, 0x7F, 0x40,  // 'l'
+  0x7C, 0x04, 0x78, 0x04, 0x78,  // 'm'
+  0x7C, 0x08, 0x04, 0x04, 0x78,  // 'n'
+  0x38, 0x44, 0x44, 0x44, 0x38,  // 'o'
+  0xFC, 0x18, 0x24, 0x24, 0x18,  // 'p'
+  0x18, 0x24, 0x24, 0x18, 0xFC,  // 'q'
+  0x7C, 0x08, 0x04, 0x04, 0x08,  // 'r'
+  0x48, 0x54, 0x54, 0x54, 0x24,  // 's'
+  0x04, 0x04, 0x3F, 0x44, 0x24,  // 't'
+  0x3C, 0x40, 0x40, 0x20, 0x7C,  // 'u'
+  0x1C, 0x20, 0x40, 0x20, 0x1C,  // 'v'
+  0x3C, 0x40, 0x30, 0x40, 0x3C,  // 'w'
+  0x44, 0x28, 0x10, 0x28, 0x44,  // 'x'
+  0x4C, 0x90, 0x90, 0x90, 0x7C,  // 'y'
+  0x44, 0x64, 0x54, 0x4C, 0x44,  // 'z'
+  0x08, 0x36, 0x41,  // '{'
+  0x77,  // '|'
+  0x41, 0x36, 0x08,  // '}'
+  0x02, 0x01, 0x02, 0x04, 0x02,  // '~'
+  0x08, 0x22, 0x1C, 0x5D, 0x1C, 0x22, 0x08,  // sun
+  0x41, 0x41, 0x63, 0x7F, 0x3E, 0x1C,  // moon
+};
+
+const uint16_t GLYPH_COUNT = 97;
+const GlyphEntry GLYPHS[] = {
+  {0x0020, 0, 2, 255},  // ' '
+  {0x0021, 2, 1, 255},  // '!'
+  {0x0022, 3, 3, 255},  // '"'
+  {0x0023, 6, 5, 255},  // '#'
+  {0x0024, 11, 5, 255},  // '$'
+  {0x0025, 16, 5, 255},  // '%'
+  {0x0026, 21, 5, 255},  // '&'
+  {0x0027, 26, 3, 255},  // '\''
+  {0x0028, 29, 3, 255},  // '('
+  {0x0029, 32, 3, 255},  // ')'
+  {0x002A, 35, 5, 255},  // '*'
+  {0x002B, 40, 5, 255},  // '+'
+  {0x002C, 45, 3, 255},  // ','
+  {0x002D, 48, 5, 255},  // '-'
+  {0x002E, 53, 2, 255},  // '.'
+  {0x002F, 55, 5, 255},  // '/'
+  {0x0030, 60, 5, 0},  // '0'
+  {0x0031, 65, 5, 1},  // '1'
+  {0x0032, 70, 5, 2},  // '2'
+  {0x0033, 75, 5, 3},  // '3'
+  {0x0034, 80, 5, 4},  // '4'
+  {0x0035, 85, 5, 5},  // '5'
+  {0x0036, 90, 5, 6},  // '6'
+  {0x0037, 95, 5, 7},  // '7'
+  {0x0038, 100, 5, 8},  // '8'
+  {0x0039, 105, 5, 9},  // '9'
+  {0x003A, 110, 1, 255},  // ':'
+  {0x003B, 111, 2, 255},  // ';'
+  {0x003C, 113, 4, 255},  // '<'
+  {0x003D, 117, 5, 255},  // '='
+  {0x003E, 122, 4, 255},  // '>'
+  {0x003F, 126, 5, 255},  // '?'
+  {0x0040, 131, 5, 255},  // '@'
+  {0x0041, 136, 5, 255},  // 'A'
+  {0x0042, 141, 5, 255},  // 'B'
+  {0x0043, 146, 5, 255},  // 'C'
+  {0x0044, 151, 5, 255},  // 'D'
+  {0x0045, 156, 5, 255},  // 'E'
+  {0x0046, 161, 5, 255},  // 'F'
+  {0x0047, 166, 5, 255},  // 'G'
+  {0x0048, 171, 5, 255},  // 'H'
+  {0x0049, 176, 3, 255},  // 'I'
+  {0x004A, 179, 5, 255},  // 'J'
+  {0x004B, 184, 5, 255},  // 'K'
+  {0x004C, 189, 5, 255},  // 'L'
+  {0x004D, 194, 5, 255},  // 'M'
+  {0x004E, 199, 5, 255},  // 'N'
+  {0x004F, 204, 5, 255},  // 'O'
+  {0x0050, 209, 5, 255},  // 'P'
+  {0x0051, 214, 5, 255},  // 'Q'
+  {0x0052, 219, 5, 255},  // 'R'
+  {0x0053, 224, 5, 255},  // 'S'
+  {0x0054, 229, 5, 255},  // 'T'
+  {0x0055, 234, 5, 255},  // 'U'
+  {0x0056, 239, 5, 255},  // 'V'
+  {0x0057, 244, 5, 255},  // 'W'
+  {0x0058, 249, 5, 255},  // 'X'
+  {0x0059, 254, 5, 255},  // 'Y'
+  {0x005A, 259, 5, 255},  // 'Z'
+  {0x005B, 264, 4, 255},  // '['
+  {0x005C, 268, 5, 255},  // '\\'
+  {0x005D, 273, 4, 255},  // ']'
+  {0x005E, 277, 5, 255},  // '^'
+  {0x005F, 282, 5, 255},  // '_'
+  {0x0060, 287, 3, 255},  // '`'
+  {0x0061, 290, 5, 255},  // 'a'
+  {0x0062, 295, 5, 255},  // 'b'
+  {0x0063, 300, 5, 255},  // 'c'
+  {0x0064, 305, 5, 255},  // 'd'
+  {0x0065, 310, 5, 255},  // 'e'
+  {0x0066, 315, 4, 255},  // 'f'
+  {0x0067, 319, 5, 255},  // 'g'
+  {0x0068, 324, 5, 255},  // 'h'
+  {0x0069, 329, 3, 255},  // 'i'
+  {0x006A, 332, 4, 255},  // 'j'
+  {0x006B, 336, 4, 255},  // 'k'
+  {0x006C, 340, 3, 255},  // 'l'
+  {0x006D, 343, 5, 10},  // 'm'
+  {0x006E, 348, 5, 255},  // 'n'
+  {0x006F, 353, 5, 255},  // 'o'
+  {0x0070, 358, 5, 255},  // 'p'
+  {0x0071, 363, 5, 255},  // 'q'
+  {0x0072, 368, 5, 255},  // 'r'
+  {0x0073, 373, 5, 255},  // 's'
+  {0x0074, 378, 5, 255},  // 't'
+  {0x0075, 383, 5, 255},  // 'u'
+  {0x0076, 388, 5, 255},  // 'v'
+  {0x0077, 393, 5, 255},  // 'w'
+  {0x0078, 398, 5, 255},  // 'x'
+  {0x0079, 403, 5, 255},  // 'y'
+  {0x007A, 408, 5, 255},  // 'z'
+  {0x007B, 413, 3, 255},  // '{'
+  {0x007C, 416, 1, 255},  // '|'
+  {0x007D, 417, 3, 255},  // '}'
+  {0x007E, 420, 5, 255},  // '~'
+  {0x2600, 425, 7, 255},  // sun
+  {0x263D, 432, 6, 255},  // moon
+};
+
+const uint8_t GLYPH_SPRITES[][GLYPH_SPRITE_BYTES] = {
+  {  // '0'
+    0x3F, 0x00,  0x3F, 0x00,  0xC0, 0xC0,  0xC0, 0xC0,
+    0xC3, 0xC0,  0xC3, 0xC0,  0xCC, 0xC0,  0xCC, 0xC0,
+    0xF0, 0xC0,  0xF0, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,
+    0x3F, 0x00,  0x3F, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '1'
+    0x0C, 0x00,  0x0C, 0x00,  0x3C, 0x00,  0x3C, 0x00,
+    0x0C, 0x00,  0x0C, 0x00,  0x0C, 0x00,  0x0C, 0x00,
+    0x0C, 0x00,  0x0C, 0x00,  0x0C, 0x00,  0x0C, 0x00,
+    0x3F, 0x00,  0x3F, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '2'
+    0x3F, 0x00,  0x3F, 0x00,  0xC0, 0xC0,  0xC0, 0xC0,
+    0x00, 0xC0,  0x00, 0xC0,  0x3F, 0x00,  0x3F, 0x00,
+    0xC0, 0x00,  0xC0, 0x00,  0xC0, 0x00,  0xC0, 0x00,
+    0xFF, 0xC0,  0xFF, 0xC0,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '3'
+    0xFF, 0xC0,  0xFF, 0xC0,  0x00, 0xC0,  0x00, 0xC0,
+    0x03, 0x00,  0x03, 0x00,  0x0F, 0x00,  0x0F, 0x00,
+    0x00, 0xC0,  0x00, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,
+    0x3F, 0x00,  0x3F, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '4'
+    0x03, 0x00,  0x03, 0x00,  0x0F, 0x00,  0x0F, 0x00,
+    0x33, 0x00,  0x33, 0x00,  0xC3, 0x00,  0xC3, 0x00,
+    0xFF, 0xC0,  0xFF, 0xC0,  0x03, 0x00,  0x03, 0x00,
+    0x03, 0x00,  0x03, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '5'
+    0xFF, 0xC0,  0xFF, 0xC0,  0xC0, 0x00,  0xC0, 0x00,
+    0xFF, 0x00,  0xFF, 0x00,  0x00, 0xC0,  0x00, 0xC0,
+    0x00, 0xC0,  0x00, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,
+    0x3F, 0x00,  0x3F, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '6'
+    0x0F, 0xC0,  0x0F, 0xC0,  0x30, 0x00,  0x30, 0x00,
+    0xC0, 0x00,  0xC0, 0x00,  0xFF, 0x00,  0xFF, 0x00,
+    0xC0, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,
+    0x3F, 0x00,  0x3F, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '7'
+    0xFF, 0xC0,  0xFF, 0xC0,  0x00, 0xC0,  0x00, 0xC0,
+    0x00, 0xC0,  0x00, 0xC0,  0x03, 0x00,  0x03, 0x00,
+    0x0C, 0x00,  0x0C, 0x00,  0x30, 0x00,  0x30, 0x00,
+    0xC0, 0x00,  0xC0, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '8'
+    0x3F, 0x00,  0x3F, 0x00,  0xC0, 0xC0,  0xC0, 0xC0,
+    0xC0, 0xC0,  0xC0, 0xC0,  0x3F, 0x00,  0x3F, 0x00,
+    0xC0, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,  0xC0, 0xC0,
+    0x3F, 0x00,  0x3F, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // '9'
+    0x3F, 0x00,  0x3F, 0x00,  0xC0, 0xC0,  0xC0, 0xC0,
+    0xC0, 0xC0,  0xC0, 0xC0,  0x3F, 0xC0,  0x3F, 0xC0,
+    0x00, 0xC0,  0x00, 0xC0,  0x03, 0x00,  0x03, 0x00,
+    0xFC, 0x00,  0xFC, 0x00,  0x00, 0x00,  0x00, 0x00,
+  },
+  {  // 'm'
+    0x00, 0x00,  0x00, 0x00,  0x00, 0x00,  0x00, 0x00,
+    0xF3, 0x00,  0xF3, 0x00,  0xCC, 0xC0,  0xCC, 0xC0,
+    0xCC, 0xC0,  0xCC, 0xC0,  0xCC, 0xC0,  0xCC, 0xC0,
+    0xCC, 0xC0,  0xCC, 0xC0,  0x00, 0x00,  0x00, 0x00,
+  },
+};
@@ -0,0 +1,517 @@
+#include "HttpFetch.h"
+#include "Coroutine.h"
+#include <WiFiNINA.h>
+
+// One inflater and one handler stack serve every fetch; a fetch whose body
+// is ready while another's handler still runs waits its turn
+static InflateStream inflater;
+alignas(8) static uint32_t bodyStack[HTTP_FETCH_BODY_STACK / sizeof(uint32_t)];
+static Coroutine bodyTask(bodyStack, sizeof(bodyStack));
+static HttpFetch* bodyReader = nullptr;
+
+void HttpFetch::BodyStream::start(long length, bool chunkedBody) {
+  remaining = chunkedBody ? 0 : length;
+  chunked = chunkedBody;
+  inChunk = false;
+  ended = false;
+  broken = false;
+  abandoned = false;
+  consumed = 0;
+}
+
+int HttpFetch::BodyStream::available() {
+  if (chunked && remaining == 0) return 0;   // Framing comes first
+  int ready = client->available();
+  if (remaining >= 0 && ready > remaining) ready = (int)remaining;
+  return ready;
+}
+
+// Yields to poll() until a byte has arrived and the poll has budget left
+// to read it. False at the end of the connection or once the fetch gives up.
+bool HttpFetch::BodyStream::waitForWire() {
+  while (!abandoned) {
+    bool arrived = client->available() > 0;
+    if (!arrived && !client->connected()) return false;
+    bool budgetLeft = pollBytes < HTTP_FETCH_BODY_BYTES_PER_POLL && millis() - pollStart < HTTP_FETCH_BODY_MS_PER_POLL;
+    if (arrived && budgetLeft) return true;
+    Coroutine::yield();
+  }
+  return false;
+}
+
+bool HttpFetch::BodyStream::waitForData() {
+  if (chunked && remaining == 0 && !nextChunk()) return false;
+  return remaining != 0 && waitForWire();
+}
+
+// A byte of chunk framing, which is not counted as body
+int HttpFetch::BodyStream::readWire() {
+  if (!waitForWire()) return -1;
+  pollBytes++;
+  return client->read();
+}
+
+// Reads a line of chunk framing. size is the hex number it starts with, or
+// -1 if it has none or it is too large; chunk extensions after it are
+// ignored.
+bool HttpFetch::BodyStream::readChunkLine(long& size, bool& blank) {
+  size = -1;
+  blank = true;
+  bool digits = true;
+  int c;
+  while ((c = readWire()) >= 0 && c != '\n') {
+    if (c == '\r') continue;
+    blank = false;
+    int lower = c | 0x20;
+    int digit = c >= '0' && c <= '9' ? c - '0' : lower >= 'a' && lower <= 'f' ? lower - 'a' + 10 : -1;
+    if (!digits || digit < 0) {
+      digits = false;
+      continue;
+    }
+    size = max(size, 0L) * 16 + digit;
+    if (size > HTTP_FETCH_MAX_CHUNK) {
+      size = -1;
+      digits = false;
+    }
+  }
+  return c == '\n';
+}
+
+// Reads up to the next chunk's data: the line ending the last chunk's data,
+// then the size line. The last chunk, of size 0, is followed by trailer
+// fields up to a blank line, which end the body.
+bool HttpFetch::BodyStream::nextChunk() {
+  if (ended || broken) return false;
+  long size;
+  bool blank;
+  if (inChunk && (!readChunkLine(size, blank) || !blank)) {
+    broken = true;
+    return false;
+  }
+  if (!readChunkLine(size, blank) || size < 0) {
+    broken = true;
+    return false;
+  }
+  inChunk = true;
+  if (size > 0) {
+    remaining = size;
+    return true;
+  }
+  while (readChunkLine(size, blank)) {
+    if (blank) {
+      ended = true;
+      return false;
+    }
+  }
+  broken = true;
+  return false;
+}
+
+int HttpFetch::BodyStream::read() {
+  if (!waitForData()) return -1;
+  int c = client->read();
+  if (c >= 0) {
+    consumed++;
+    pollBytes++;
+    if (remaining > 0) remaining--;
+  }
+  return c;
+}
+
+int HttpFetch::BodyStream::peek() {
+  if (!waitForData()) return -1;
+  return client->peek();
+}
+
+HttpFetch::HttpFetch() {
+  client = nullptr;
+  host = nullptr;
+  port = 80;
+  secure = false;
+  addressKnown = false;
+  addressSince = 0;
+  quietCheck = nullptr;
+  quietContext = nullptr;
+  headerName = nullptr;
+  headerValue = nullptr;
+  requestValidators = nullptr;
+  acceptCompressed = false;
+  keepConnection = false;
+  reusedConnection = false;
+  idleSince = 0;
+  keepAliveMs = HTTP_FETCH_DEFAULT_KEEP_ALIVE;
+  serverCloses = false;
+  chunked = false;
+  encoding = -1;
+  bodyAccepted = false;
+  memset(&stats, 0, sizeof(stats));
+  state = FETCH_IDLE;
+  stageStart = 0;
+  statusCode = 0;
+  contentLength = -1;
+  onBody = nullptr;
+  onDone = nullptr;
+  context = nullptr;
+}
+
+void HttpFetch::begin(Client& netClient, const char* serverHost, uint16_t serverPort, bool secureClient) {
+  client = &netClient;
+  host = serverHost;
+  port = serverPort;
+  secure = secureClient;
+  addressKnown = false;
+  body.client = client;
+}
+
+void HttpFetch::setQuietCheck(QuietCheck check, void* checkContext) {
+  quietCheck = check;
+  quietContext = checkContext;
+}
+
+void HttpFetch::setHeader(const char* name, const char* value) {
+  headerName = name;
+  headerValue = value;
+}
+
+bool HttpFetch::startFetch(const char* requestPath, BodyHandler bodyHandler, DoneHandler doneHandler,
+                           void* handlerContext, const HttpValidators* validators) {
+  if (!client || isBusy()) return false;
+
+  path = requestPath;
+  requestValidators = validators;
+  responseValidators.etag.clear();
+  responseValidators.lastModified.clear();
+  onBody = bodyHandler;
+  onDone = doneHandler;
+  context = handlerContext;
+  statusCode = 0;
+  contentLength = -1;
+  stats.requests++;
+  enterStage(FETCH_CONNECTING);
+  return true;
+}
+
+void HttpFetch::enterStage(HttpFetchState next) {
+  state = next;
+  stageStart = millis();
+  line.clear();
+}
+
+bool HttpFetch::stageExpired(unsigned long timeout) {
+  return millis() - stageStart >= timeout;
+}
+
+// Whether this poll may make the stage's blocking call: once the UI is
+// quiet, or once it has waited long enough for that
+bool HttpFetch::mayBlock() {
+  return !quietCheck || quietCheck(quietContext) || stageExpired(HTTP_FETCH_QUIET_WAIT);
+}
+
+// Opens a fresh connection, blocking until the module has it up or gives
+// up. A failure may mean the host has moved, so the next one looks it up
+// again.
+void HttpFetch::connect() {
+  client->stop();
+  bool connected = secure ? client->connect(host, port) : client->connect(address, port);
+  if (!connected) {
+    addressKnown = false;
+    finish(FETCH_CONNECT_FAILED);
+    return;
+  }
+  stats.connections++;
+  enterStage(FETCH_SENDING);
+}
+
+void HttpFetch::finish(HttpFetchResult result) {
+  // Keep the connection only after a response read to its end
+  keepConnection = keepConnection && !serverCloses && (result == FETCH_OK || result == FETCH_NOT_MODIFIED);
+  if (!keepConnection) client->stop();
+  idleSince = millis();
+  state = FETCH_DONE;
+  if (onDone) onDone(result, statusCode, context);
+}
+
+void HttpFetch::poll() {
+  switch (state) {
+    case FETCH_RESOLVING:
+      if (!mayBlock()) return;
+      stats.lookups++;
+      if (!WiFi.hostByName(host, address)) {
+        finish(FETCH_CONNECT_FAILED);
+        return;
+      }
+      addressKnown = true;
+      addressSince = millis();
+      enterStage(FETCH_CONNECTING);
+      break;
+
+    case FETCH_CONNECTING:
+      // Reuse the kept connection while the server should still hold it
+      reusedConnection = keepConnection && client->connected() && millis() - idleSince < keepAliveMs;
+      if (reusedConnection) {
+        keepConnection = false;
+        enterStage(FETCH_SENDING);
+        break;
+      }
+      keepConnection = false;
+      if (!secure && (!addressKnown || millis() - addressSince >= HTTP_FETCH_ADDRESS_MAX_AGE)) {
+        enterStage(FETCH_RESOLVING);
+        break;
+      }
+      if (!mayBlock()) return;
+      connect();
+      break;
+
+    case FETCH_SENDING:
+      sendRequest();
+      enterStage(FETCH_AWAITING_RESPONSE);
+      break;
+
+    case FETCH_AWAITING_RESPONSE:
+    case FETCH_READING_HEADERS: {
+      while (readLine()) {
+        if (state == FETCH_AWAITING_RESPONSE) {
+          if (line.isEmpty()) continue;   // End of an informational response
+          handleStatusLine();
+        } else {
+          handleHeaderLine();
+        }
+        if (state == FETCH_DONE || state == FETCH_READING_BODY) return;
+      }
+      unsigned long timeout = state == FETCH_AWAITING_RESPONSE ? HTTP_FETCH_RESPONSE_TIMEOUT
+                                                                : HTTP_FETCH_HEADER_TIMEOUT;
+      if (!client->connected() && reusedConnection && state == FETCH_AWAITING_RESPONSE && line.isEmpty()) {
+        // The server dropped the kept connection before the request got
+        // there; send it again on a new one
+        stats.retries++;
+        client->stop();
+        enterStage(FETCH_CONNECTING);
+      } else if (!client->connected()) {
+        finish(FETCH_INVALID_RESPONSE);   // Closed before the headers ended
+      } else if (stageExpired(timeout)) {
+        finish(FETCH_TIMED_OUT);
+      }
+      break;
+    }
+
+    case FETCH_READING_BODY:
+      readBody();
+      break;
+
+    default:
+      break;
+  }
+}
+
+void HttpFetch::sendRequest() {
+  client->print("GET ");
+  client->print(path.c_str());
+  client->print(" HTTP/1.1\r\nHost: ");
+  client->print(host);
+  if (port != 80 && port != 443) {
+    client->print(":");
+    client->print(port);
+  }
+  client->print("\r\nUser-Agent: Arduino/2.2.0\r\n");
+  if (acceptCompressed) client->print("Accept-Encoding: deflate, gzip\r\n");
+  if (headerName) {
+    client->print(headerName);
+    client->print(": ");
+    client->print(headerValue);
+    client->print("\r\n");
+  }
+  if (requestValidators && !requestValidators->etag.isEmpty()) {
+    client->print("If-None-Match: ");
+    client->print(requestValidators->etag.c_str());
+    client->print("\r\n");
+  }
+  if (requestValidators && !requestValidators->lastModified.isEmpty()) {
+    client->print("If-Modified-Since: ");
+    client->print(requestValidators->lastModified.c_str());
+    client->print("\r\n");
+  }
+  client->print("\r\n");
+}
+
+// Header value with leading spaces skipped; name includes the colon
+static const char* headerValueOf(const char* line, const char* name) {
+  size_t length = strlen(name);
+  if (strncasecmp(line, name, length) != 0) return nullptr;
+  line += length;
+  while (*line == ' ' || *line == '\t') line++;
+  return line;
+}
+
+// Reads whatever part of a line has arrived, up to the per-poll budget.
+// Returns true once a whole line (without its CRLF) is in line.
+bool HttpFetch::readLine() {
+  for (int i = 0; i < HTTP_FETCH_HEADER_BYTES_PER_POLL; i++) {
+    if (client->available() <= 0) return false;
+    int c = client->read();
+    if (c == '\n') return true;
+    if (c >= 0 && c != '\r') line.append((char)c);
+  }
+  return false;
+}
+
+void HttpFetch::handleStatusLine() {
+  // "HTTP/1.1 200 OK"
+  const char* text = line.c_str();
+  if (strncmp(text, "HTTP/", 5) != 0 || line.length() < 12) {
+    finish(FETCH_INVALID_RESPONSE);
+    return;
+  }
+  statusCode = atoi(text + 9);
+  serverCloses = strncmp(text, "HTTP/1.0", 8) == 0;
+  keepAliveMs = HTTP_FETCH_DEFAULT_KEEP_ALIVE;
+  chunked = false;
+  encoding = -1;
+  if (statusCode >= 100 && statusCode < 200) {
+    // Informational; the real status line follows its headers
+    enterStage(FETCH_AWAITING_RESPONSE);
+    return;
+  }
+  enterStage(FETCH_READING_HEADERS);
+}
+
+void HttpFetch::handleHeaderLine() {
+  if (line.isEmpty()) {
+    if (statusCode == 304) {
+      keepConnection = true;   // Never has a body
+      finish(FETCH_NOT_MODIFIED);
+      return;
+    }
+    if (statusCode != 200) {
+      finish(FETCH_HTTP_ERROR);
+      return;
+    }
+    if (encoding == -2) {
+      finish(FETCH_INVALID_RESPONSE);   // Encoded in a way we cannot read
+      return;
+    }
+    // A chunked body's own framing says where it ends (RFC 9112)
+    if (chunked) contentLength = -1;
+    body.start(contentLength, chunked);
+    body.setTimeout(0);   // Reads wait by themselves
+    enterStage(FETCH_READING_BODY);
+    return;
+  }
+
+  // A validator cut short by the line or field size would never match, so
+  // it is only kept whole
+  bool whole = line.length() < line.capacity();
+  const char* value;
+  if ((value = headerValueOf(line.c_str(), "Content-Length:"))) {
+    contentLength = atol(value);
+  } else if ((value = headerValueOf(line.c_str(), "ETag:"))) {
+    if (whole && strlen(value) <= responseValidators.etag.capacity()) responseValidators.etag = value;
+  } else if ((value = headerValueOf(line.c_str(), "Last-Modified:"))) {
+    if (whole && strlen(value) <= responseValidators.lastModified.capacity()) {
+      responseValidators.lastModified = value;
+    }
+  } else if ((value = headerValueOf(line.c_str(), "Connection:"))) {
+    if (strncasecmp(value, "close", 5) == 0) serverCloses = true;
+  } else if ((value = headerValueOf(line.c_str(), "Keep-Alive:"))) {
+    // "timeout=5, max=100": stop trusting the connection a second early
+    const char* timeout = strstr(value, "timeout=");
+    if (timeout) keepAliveMs = max(atol(timeout + 8) - 1, 0L) * 1000UL;
+  } else if ((value = headerValueOf(line.c_str(), "Content-Encoding:"))) {
+    if (strncasecmp(value, "gzip", 4) == 0 || strncasecmp(value, "x-gzip", 6) == 0) {
+      encoding = INFLATE_GZIP;
+    } else if (strncasecmp(value, "deflate", 7) == 0) {
+      encoding = INFLATE_ZLIB;
+    } else if (strncasecmp(value, "identity", 8) != 0) {
+      encoding = -2;
+    }
+  } else if ((value = headerValueOf(line.c_str(), "Transfer-Encoding:"))) {
+    // Only chunking; a transfer coding layered under it cannot be read
+    if (strncasecmp(value, "chunked", 7) == 0) {
+      chunked = true;
+    } else if (strncasecmp(value, "identity", 8) != 0) {
+      encoding = -2;
+    }
+  }
+  line.clear();
+}
+
+void HttpFetch::readBody() {
+  if (bodyReader != this) {
+    if (bodyReader) {
+      if (stageExpired(HTTP_FETCH_BODY_TIMEOUT)) finish(FETCH_TIMED_OUT);
+      return;
+    }
+    bodyReader = this;
+    bodyTask.start(parseBody, this);
+  }
+
+  // The handler runs until it waits for bytes or has used this poll's budget
+  body.pollStart = millis();
+  body.pollBytes = 0;
+  if (bodyTask.resume()) {
+    if (body.pollBytes > 0) {
+      stageStart = millis();
+      return;
+    }
+    if (!stageExpired(HTTP_FETCH_BODY_TIMEOUT)) return;
+    // Nothing for too long: every read now ends, so the handler finishes
+    body.abandoned = true;
+    while (bodyTask.resume()) {
+    }
+  }
+  bodyReader = nullptr;
+
+  bool accepted = bodyAccepted;
+  if (encoding >= 0 && inflater.hasFailed() && !body.broken && !body.abandoned) {
+    // Most likely compressed for a larger window than ours; ask for
+    // plain bodies from now on
+    Serial.println("HTTP body could not be inflated, compression off");
+    acceptCompressed = false;
+    accepted = false;
+  }
+
+  stats.wireBytes += body.consumed;
+  stats.bodyBytes += encoding >= 0 ? inflater.getOutputBytes() : body.consumed;
+  stats.stackPeak = bodyTask.getStackPeak();
+  if (accepted) {
+    finish(FETCH_OK);
+  } else if (body.abandoned) {
+    finish(FETCH_TIMED_OUT);
+  } else {
+    finish(body.broken ? FETCH_INVALID_RESPONSE : FETCH_BODY_FAILED);
+  }
+}
+
+// Runs on the body coroutine
+void HttpFetch::parseBody(void* fetch) {
+  HttpFetch* self = (HttpFetch*)fetch;
+
+  // A compressed body reaches the handler inflated, of unknown length
+  Stream* stream = &self->body;
+  long length = self->contentLength;
+  if (self->encoding >= 0) {
+    inflater.begin(self->body, (InflateFormat)self->encoding);
+    inflater.setTimeout(0);
+    stream = &inflater;
+    length = -1;
+  }
+  self->bodyAccepted = !self->onBody || self->onBody(*stream, length, self->context);
+
+  // Read what the handler left, so the connection can carry the next
+  // request and a compressed body's checksum is read
+  self->keepConnection = self->bodyAccepted && self->drainBody(*stream);
+}
+
+bool HttpFetch::drainBody(Stream& stream) {
+  if (chunked) {
+    // Where it ends is only known on reaching the last chunk, which comes
+    // after a compressed body's checksum
+    long left = HTTP_FETCH_DRAIN_LIMIT;
+    while (left > 0 && stream.read() >= 0) left--;
+    while (left > 0 && body.read() >= 0) left--;
+    return body.ended && (encoding < 0 || inflater.isDone());
+  }
+  if (contentLength < 0 || body.remaining > HTTP_FETCH_DRAIN_LIMIT) return false;
+  while (stream.read() >= 0) {
+  }
+  return body.remaining == 0 && (encoding < 0 || inflater.isDone());
+}
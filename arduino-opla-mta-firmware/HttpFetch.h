@@ -0,0 +1,241 @@
+/*
+ * Loop-driven HTTP fetch for Arduino Opla MTA Firmware
+ * Runs one GET request as a state machine advanced by poll() from loop():
+ * look the host up, connect, send, wait for the response, read headers,
+ * hand the body to a parser, done. Two stages are a single call that
+ * blocks until WiFiNINA's co-processor answers, each in a poll() of its
+ * own: the host lookup (WiFi.hostByName(), bounded by the module's DNS
+ * timeout), made once and then only after a failed connect or after
+ * HTTP_FETCH_ADDRESS_MAX_AGE, and a fresh connection to the cached
+ * address, one TCP handshake and at most WiFiNINA's 10 s connect timeout.
+ * A TLS client connects by name so the module can check the certificate;
+ * its connect() also does the lookup and the TLS handshake, seconds on
+ * the board, within the same timeout. Both wait until the quiet check
+ * says the UI is idle, for up to HTTP_FETCH_QUIET_WAIT. Every other
+ * poll() only does the work whose bytes have already arrived. The body
+ * handler runs as a Coroutine: when the bytes it asks for have not
+ * arrived, or the poll has read its share of the body, it is suspended
+ * and poll() returns, to carry on where it stopped the next time.
+ * The connection is kept open between fetches (HTTP/1.1 keep-alive), so a
+ * refresh usually skips the socket setup through the WiFiNINA module; a
+ * kept connection the server has meanwhile dropped is replaced and the
+ * request sent again. Compressed bodies are inflated on the way to the
+ * parser when setAcceptCompressed() allows them, and chunked ones are
+ * joined back together.
+ */
+
+#ifndef HTTPFETCH_H
+#define HTTPFETCH_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "FixedString.h"
+#include "InflateStream.h"
+
+// Per-stage timeouts (milliseconds)
+const unsigned long HTTP_FETCH_RESPONSE_TIMEOUT = 10000;  // Request sent to status line
+const unsigned long HTTP_FETCH_HEADER_TIMEOUT = 5000;     // Status line to end of headers
+const unsigned long HTTP_FETCH_BODY_TIMEOUT = 10000;      // Longest wait for more of the body
+
+// Longest a lookup or a fresh connection waits for the quiet check, so
+// fresh data still arrives while someone keeps using the buttons
+const unsigned long HTTP_FETCH_QUIET_WAIT = 10000;
+
+// Age at which the host's cached address is looked up again
+const unsigned long HTTP_FETCH_ADDRESS_MAX_AGE = 3600000UL;
+
+// Header bytes consumed per poll()
+const int HTTP_FETCH_HEADER_BYTES_PER_POLL = 256;
+
+// Body bytes read, and time spent parsing them, per poll(); whichever runs
+// out first suspends the handler
+const uint16_t HTTP_FETCH_BODY_BYTES_PER_POLL = 1024;
+const unsigned long HTTP_FETCH_BODY_MS_PER_POLL = 5;
+
+// Stack the body handler runs on: the parsers and the inflater, with room
+// to spare. The simulator's is larger for host-sized frames.
+#ifdef ARDUINO_ARCH_SAMD
+const size_t HTTP_FETCH_BODY_STACK = 4096;
+#else
+const size_t HTTP_FETCH_BODY_STACK = 65536;
+#endif
+
+// Idle time a kept connection is trusted for when the server does not say
+// (Keep-Alive: timeout=N); Apache's default, the shortest in common use
+const unsigned long HTTP_FETCH_DEFAULT_KEEP_ALIVE = 5000;
+
+// Body bytes left unread by the parser that are read past to keep the
+// connection; with more, it is closed instead
+const long HTTP_FETCH_DRAIN_LIMIT = 512;
+
+// Chunk larger than this is taken for broken framing
+const long HTTP_FETCH_MAX_CHUNK = 0x100000;
+
+enum HttpFetchState {
+  FETCH_IDLE,
+  FETCH_RESOLVING,
+  FETCH_CONNECTING,
+  FETCH_SENDING,
+  FETCH_AWAITING_RESPONSE,
+  FETCH_READING_HEADERS,
+  FETCH_READING_BODY,
+  FETCH_DONE
+};
+
+enum HttpFetchResult {
+  FETCH_OK,
+  FETCH_CONNECT_FAILED,
+  FETCH_TIMED_OUT,
+  FETCH_INVALID_RESPONSE,
+  FETCH_HTTP_ERROR,       // Status other than 200 or 304; see getStatusCode()
+  FETCH_BODY_FAILED,      // The body handler rejected the body
+  FETCH_NOT_MODIFIED      // 304 to a conditional request; there is no body
+};
+
+// Cache validators from a response. Sent back with the next request for
+// the same resource, they let the server answer 304 instead of resending
+// a body that has not changed.
+struct HttpValidators {
+  FixedString<47> etag;
+  FixedString<31> lastModified;   // IMF-fixdate, 29 characters
+};
+
+struct HttpFetchStats {
+  uint32_t requests;
+  uint32_t lookups;         // Host lookups; connections reuse the address
+  uint32_t connections;     // Sockets opened; the rest reused one
+  uint32_t retries;         // Requests resent after a kept connection dropped
+  uint32_t wireBytes;       // Body bytes as received
+  uint32_t bodyBytes;       // Body bytes after inflating
+  uint32_t stackPeak;       // Deepest the body handler's stack has been, in bytes
+};
+
+class HttpFetch {
+public:
+  // Reads the body from the stream, which ends with the body. length is
+  // the Content-Length, or -1 if the server did not send one (a chunked
+  // body never has one). Runs on the body coroutine, so it must not start
+  // another fetch.
+  typedef bool (*BodyHandler)(Stream& body, long length, void* context);
+  typedef void (*DoneHandler)(HttpFetchResult result, int statusCode, void* context);
+
+  // True when a call that blocks the loop may be made now
+  typedef bool (*QuietCheck)(void* context);
+
+private:
+  // The response body as a Stream: stops at Content-Length or the last
+  // chunk and strips chunk framing. A read of bytes still in flight yields
+  // the body coroutine until they arrive.
+  class BodyStream : public Stream {
+  public:
+    Client* client;
+    long remaining;   // In the body, or the current chunk; -1 reads until the connection closes
+    bool chunked;
+    bool inChunk;     // A chunk has begun, so a line break ends its data
+    bool ended;       // The last chunk and its trailer have been read
+    bool broken;      // The chunk framing made no sense
+    bool abandoned;   // The fetch timed out; reads end the body
+    uint32_t consumed;
+    uint16_t pollBytes;        // Read since the last resume, framing included
+    unsigned long pollStart;
+
+    void start(long length, bool chunkedBody);
+    bool waitForWire();
+    bool waitForData();
+    int readWire();
+    bool readChunkLine(long& size, bool& blank);
+    bool nextChunk();
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return 0; }
+  };
+
+  Client* client;
+  const char* host;
+  uint16_t port;
+  bool secure;                // TLS client, which connects by name
+  IPAddress address;          // Of host, once looked up
+  bool addressKnown;
+  unsigned long addressSince;
+  QuietCheck quietCheck;
+  void* quietContext;
+  const char* headerName;
+  const char* headerValue;
+  const HttpValidators* requestValidators;
+  HttpValidators responseValidators;
+  bool acceptCompressed;
+
+  // Keep-alive: whether the open connection may carry the next request,
+  // and until when
+  bool keepConnection;
+  bool reusedConnection;
+  unsigned long idleSince;
+  unsigned long keepAliveMs;
+
+  HttpFetchState state;
+  unsigned long stageStart;
+  FixedString<95> path;
+  FixedString<63> line;     // Status or header line being read
+  int statusCode;
+  long contentLength;
+  bool serverCloses;
+  bool chunked;             // Transfer-Encoding: chunked
+  int8_t encoding;          // InflateFormat, -1 for an identity body, -2 unreadable
+  bool bodyAccepted;        // From the body handler
+  BodyStream body;
+  HttpFetchStats stats;
+
+  BodyHandler onBody;
+  DoneHandler onDone;
+  void* context;
+
+  void enterStage(HttpFetchState next);
+  bool mayBlock();
+  void connect();
+  void finish(HttpFetchResult result);
+  bool stageExpired(unsigned long timeout);
+  void sendRequest();
+  bool readLine();
+  void handleStatusLine();
+  void handleHeaderLine();
+  void readBody();
+  static void parseBody(void* fetch);
+  bool drainBody(Stream& stream);
+
+public:
+  HttpFetch();
+  // secure is for a TLS client such as WiFiSSLClient
+  void begin(Client& netClient, const char* serverHost, uint16_t serverPort, bool secure = false);
+
+  // Lookups and fresh connections wait until check returns true, for up
+  // to HTTP_FETCH_QUIET_WAIT; without a check they go ahead at once
+  void setQuietCheck(QuietCheck check, void* checkContext);
+
+  // Extra request header sent with every fetch, e.g. an API key
+  void setHeader(const char* name, const char* value);
+
+  // Asks for deflate or gzip bodies. Only for servers that compress with
+  // a window InflateStream can hold (INFLATE_WINDOW_BITS).
+  void setAcceptCompressed(bool accept) { acceptCompressed = accept; }
+
+  // Starts a GET; returns false if a fetch is already running. onDone is
+  // called from poll() exactly once per started fetch. With validators
+  // from an earlier response the request is conditional; they must stay
+  // valid until the fetch is done.
+  bool startFetch(const char* requestPath, BodyHandler bodyHandler, DoneHandler doneHandler, void* handlerContext,
+                  const HttpValidators* validators = nullptr);
+  void poll();
+
+  // Validators and Content-Length of the last response, valid from onDone
+  // until the next fetch starts
+  const HttpValidators& getResponseValidators() { return responseValidators; }
+  long getContentLength() { return contentLength; }
+
+  const HttpFetchStats& getStats() { return stats; }
+
+  bool isBusy() { return state != FETCH_IDLE && state != FETCH_DONE; }
+  HttpFetchState getState() { return state; }
+};
+
+#endif
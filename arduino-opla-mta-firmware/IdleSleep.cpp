@@ -0,0 +1,45 @@
+#include "IdleSleep.h"
+
+IdleSleep::IdleSleep() {
+  wakeCheck = nullptr;
+  wakeContext = nullptr;
+  resetStats();
+}
+
+void IdleSleep::setWakeCheck(WakeCheck check, void* context) {
+  wakeCheck = check;
+  wakeContext = context;
+}
+
+bool IdleSleep::sleep(uint32_t ms) {
+  uint32_t start = millis();
+  uint32_t nextCheck = start;
+
+  while (true) {
+    uint32_t now = millis();
+    if (wakeCheck && (int32_t)(now - nextCheck) >= 0) {
+      if (wakeCheck(wakeContext)) {
+        earlyWakes++;
+        return true;
+      }
+      nextCheck = now + IDLE_WAKE_CHECK_MS;
+    }
+    if ((uint32_t)(now - start) >= ms) return false;
+
+    uint32_t halted = micros();
+    __WFI();
+    idleMicros += micros() - halted;
+  }
+}
+
+uint16_t IdleSleep::getDutyCyclePermille() {
+  uint32_t window = micros() - windowStart;
+  if (window == 0 || idleMicros >= window) return 0;
+  return (uint16_t)((uint64_t)(window - idleMicros) * 1000 / window);
+}
+
+void IdleSleep::resetStats() {
+  windowStart = micros();
+  idleMicros = 0;
+  earlyWakes = 0;
+}
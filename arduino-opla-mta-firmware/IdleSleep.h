@@ -0,0 +1,44 @@
+/*
+ * Idle sleep for Arduino Opla MTA Firmware
+ * Halts the CPU with __WFI() until the next scheduled deadline. The core
+ * wakes on every interrupt, at least the 1 ms SysTick; each wake checks the
+ * deadline, and every few ticks runs a wake check (touch sensing), so a
+ * press is handled without waiting for a task. Busy and idle time are
+ * tallied into a CPU duty cycle.
+ */
+
+#ifndef IDLESLEEP_H
+#define IDLESLEEP_H
+
+#include <Arduino.h>
+
+// Milliseconds between wake checks while asleep
+const uint32_t IDLE_WAKE_CHECK_MS = 5;
+
+class IdleSleep {
+public:
+  // Returns true if there is new work, ending the sleep early
+  typedef bool (*WakeCheck)(void* context);
+
+private:
+  WakeCheck wakeCheck;
+  void* wakeContext;
+  uint32_t windowStart;     // micros() when the duty-cycle window began
+  uint32_t idleMicros;      // Time halted in __WFI() this window
+  uint32_t earlyWakes;
+
+public:
+  IdleSleep();
+  void setWakeCheck(WakeCheck check, void* context);
+
+  // Sleeps for up to ms; returns true if the wake check cut it short.
+  // The wake check runs once even when ms is 0.
+  bool sleep(uint32_t ms);
+
+  // Busy share of the time since resetStats(), in tenths of a percent
+  uint16_t getDutyCyclePermille();
+  uint32_t getEarlyWakes() { return earlyWakes; }
+  void resetStats();
+};
+
+#endif
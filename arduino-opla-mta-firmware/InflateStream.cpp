@@ -0,0 +1,338 @@
+#include "InflateStream.h"
+
+// RFC 1951 length and distance codes: base value and extra bits
+static const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,    65,    97,    129,
+                                           193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Order the code length code lengths are sent in
+static const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static const uint32_t ADLER_MODULUS = 65521;
+
+InflateStream::InflateStream() {
+  source = nullptr;
+  format = INFLATE_RAW;
+  state = INFLATE_FAILED;
+  peeked = -1;
+}
+
+void InflateStream::begin(Stream& sourceStream, InflateFormat streamFormat) {
+  source = &sourceStream;
+  format = streamFormat;
+  state = INFLATE_HEADER;
+  finalBlock = false;
+  bitBuffer = 0;
+  bitCount = 0;
+  outputBytes = 0;
+  copyLength = 0;
+  copyDistance = 0;
+  adler = 1;
+  peeked = -1;
+}
+
+bool InflateStream::needBits(uint8_t count) {
+  while (bitCount < count) {
+    int c = source->read();
+    if (c < 0) return false;
+    bitBuffer |= (uint32_t)c << bitCount;
+    bitCount += 8;
+  }
+  return true;
+}
+
+// At most 16 bits at a time
+uint32_t InflateStream::takeBits(uint8_t count) {
+  uint32_t value = bitBuffer & ((1UL << count) - 1);
+  bitBuffer >>= count;
+  bitCount -= count;
+  return value;
+}
+
+void InflateStream::buildTree(uint16_t* counts, uint16_t* symbols, const uint8_t* lengths, int count) {
+  memset(counts, 0, 16 * sizeof(uint16_t));
+  for (int i = 0; i < count; i++) counts[lengths[i]]++;
+  counts[0] = 0;
+
+  uint16_t offsets[16];
+  uint16_t sum = 0;
+  for (int length = 0; length < 16; length++) {
+    offsets[length] = sum;
+    sum += counts[length];
+  }
+  for (int i = 0; i < count; i++) {
+    if (lengths[i]) symbols[offsets[lengths[i]]++] = i;
+  }
+}
+
+// Walks the code a bit at a time; codes of each length are consecutive
+int InflateStream::decodeSymbol(const uint16_t* counts, const uint16_t* symbols) {
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  for (int length = 1; length < 16; length++) {
+    if (!needBits(1)) return -1;
+    code |= takeBits(1);
+    int count = counts[length];
+    if (code - first < count) return symbols[index + code - first];
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+bool InflateStream::readStreamHeader() {
+  if (format == INFLATE_ZLIB) {
+    if (!needBits(16)) return false;
+    uint8_t method = takeBits(8);
+    uint8_t flags = takeBits(8);
+    if ((method & 0x0F) != 8 || ((method << 8) | flags) % 31 != 0 || (flags & 0x20)) return false;
+    // The window the stream was compressed for
+    return (method >> 4) + 8 <= INFLATE_WINDOW_BITS;
+  }
+
+  if (format == INFLATE_GZIP) {
+    uint8_t header[10];
+    for (int i = 0; i < 10; i++) {
+      if (!needBits(8)) return false;
+      header[i] = takeBits(8);
+    }
+    if (header[0] != 0x1F || header[1] != 0x8B || header[2] != 8) return false;
+    uint8_t flags = header[3];
+    if (flags & 0x04) {   // FEXTRA
+      if (!needBits(16)) return false;
+      for (uint16_t skip = takeBits(16); skip > 0; skip--) {
+        if (!needBits(8)) return false;
+        takeBits(8);
+      }
+    }
+    for (uint8_t text = 0x08; text <= 0x10; text <<= 1) {   // FNAME, FCOMMENT
+      if (!(flags & text)) continue;
+      do {
+        if (!needBits(8)) return false;
+      } while (takeBits(8) != 0);
+    }
+    if (flags & 0x02) {   // FHCRC
+      if (!needBits(16)) return false;
+      takeBits(16);
+    }
+  }
+  return true;
+}
+
+bool InflateStream::readBlockHeader() {
+  if (!needBits(3)) return false;
+  finalBlock = takeBits(1);
+  uint8_t type = takeBits(2);
+
+  if (type == 0) {
+    // Stored: byte aligned length and its complement, then the bytes
+    takeBits(bitCount & 7);
+    if (!needBits(32)) return false;
+    uint16_t length = takeBits(16);
+    if ((uint16_t)~takeBits(16) != length) return false;
+    copyLength = length;
+    copyDistance = 0;
+    state = INFLATE_STORED;
+    return true;
+  }
+
+  if (type == 1) {
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    buildTree(literals.counts, literals.symbols, lengths, 288);
+    memset(lengths, 5, 30);
+    buildTree(distances.counts, distances.symbols, lengths, 30);
+  } else if (type != 2 || !readDynamicTrees()) {
+    return false;
+  }
+  copyLength = 0;
+  state = INFLATE_CODES;
+  return true;
+}
+
+bool InflateStream::readDynamicTrees() {
+  if (!needBits(14)) return false;
+  int literalCount = takeBits(5) + 257;
+  int distanceCount = takeBits(5) + 1;
+  int codeLengthCount = takeBits(4) + 4;
+  if (literalCount > 286 || distanceCount > 30) return false;
+
+  // The code length code is built in the distance tree, which is not
+  // needed until after it
+  uint8_t lengths[286 + 30];
+  memset(lengths, 0, 19);
+  for (int i = 0; i < codeLengthCount; i++) {
+    if (!needBits(3)) return false;
+    lengths[CODE_LENGTH_ORDER[i]] = takeBits(3);
+  }
+  buildTree(distances.counts, distances.symbols, lengths, 19);
+
+  int total = literalCount + distanceCount;
+  int n = 0;
+  while (n < total) {
+    int symbol = decodeSymbol(distances.counts, distances.symbols);
+    if (symbol < 0) return false;
+    if (symbol < 16) {
+      lengths[n++] = symbol;
+      continue;
+    }
+
+    uint8_t value = 0;
+    int repeat;
+    if (symbol == 16) {
+      if (n == 0 || !needBits(2)) return false;
+      value = lengths[n - 1];
+      repeat = 3 + takeBits(2);
+    } else if (symbol == 17) {
+      if (!needBits(3)) return false;
+      repeat = 3 + takeBits(3);
+    } else {
+      if (!needBits(7)) return false;
+      repeat = 11 + takeBits(7);
+    }
+    if (n + repeat > total) return false;
+    while (repeat-- > 0) lengths[n++] = value;
+  }
+  if (lengths[256] == 0) return false;   // No end-of-block code
+
+  buildTree(literals.counts, literals.symbols, lengths, literalCount);
+  buildTree(distances.counts, distances.symbols, lengths + literalCount, distanceCount);
+  return true;
+}
+
+bool InflateStream::readTrailer() {
+  takeBits(bitCount & 7);
+  if (format == INFLATE_ZLIB) {
+    uint32_t expected = 0;
+    for (int i = 0; i < 4; i++) {
+      if (!needBits(8)) return false;
+      expected = (expected << 8) | takeBits(8);
+    }
+    return expected == adler;
+  }
+  if (format == INFLATE_GZIP) {
+    // CRC-32 is skipped; the deflate data has its own checks and the
+    // length catches truncation
+    if (!needBits(32)) return false;
+    takeBits(16);
+    takeBits(16);
+    if (!needBits(32)) return false;
+    uint32_t length = takeBits(16);
+    return (length | takeBits(16) << 16) == outputBytes;
+  }
+  return true;
+}
+
+int InflateStream::emit(uint8_t value) {
+  window[outputBytes & (INFLATE_WINDOW_SIZE - 1)] = value;
+  outputBytes++;
+
+  // Adler-32 without a division per byte
+  uint32_t a = (adler & 0xFFFF) + value;
+  if (a >= ADLER_MODULUS) a -= ADLER_MODULUS;
+  uint32_t b = (adler >> 16) + a;
+  if (b >= ADLER_MODULUS) b -= ADLER_MODULUS;
+  adler = (b << 16) | a;
+  return value;
+}
+
+int InflateStream::fail() {
+  state = INFLATE_FAILED;
+  return -1;
+}
+
+int InflateStream::nextByte() {
+  while (true) {
+    switch (state) {
+      case INFLATE_HEADER:
+        if (!readStreamHeader()) return fail();
+        state = INFLATE_BLOCK_HEADER;
+        break;
+
+      case INFLATE_BLOCK_HEADER:
+        if (finalBlock) {
+          state = INFLATE_TRAILER;
+        } else if (!readBlockHeader()) {
+          return fail();
+        }
+        break;
+
+      case INFLATE_STORED:
+        if (copyLength == 0) {
+          state = INFLATE_BLOCK_HEADER;
+          break;
+        }
+        if (!needBits(8)) return fail();
+        copyLength--;
+        return emit(takeBits(8));
+
+      case INFLATE_CODES: {
+        if (copyLength > 0) {
+          copyLength--;
+          return emit(window[(outputBytes - copyDistance) & (INFLATE_WINDOW_SIZE - 1)]);
+        }
+
+        int symbol = decodeSymbol(literals.counts, literals.symbols);
+        if (symbol < 0) return fail();
+        if (symbol < 256) return emit(symbol);
+        if (symbol == 256) {
+          state = INFLATE_BLOCK_HEADER;
+          break;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29 || !needBits(LENGTH_EXTRA[symbol])) return fail();
+        uint16_t length = LENGTH_BASE[symbol] + takeBits(LENGTH_EXTRA[symbol]);
+
+        int code = decodeSymbol(distances.counts, distances.symbols);
+        if (code < 0 || code >= 30 || !needBits(DISTANCE_EXTRA[code])) return fail();
+        uint32_t distance = DISTANCE_BASE[code] + takeBits(DISTANCE_EXTRA[code]);
+
+        // Further back than the window, or than the stream itself
+        if (distance > INFLATE_WINDOW_SIZE || distance > outputBytes) return fail();
+        copyLength = length;
+        copyDistance = distance;
+        break;
+      }
+
+      case INFLATE_TRAILER:
+        if (!readTrailer()) return fail();
+        state = INFLATE_DONE;
+        return -1;
+
+      default:
+        return -1;
+    }
+  }
+}
+
+int InflateStream::available() {
+  if (peeked >= 0) return 1;
+  if (state == INFLATE_DONE || state == INFLATE_FAILED) return 0;
+  if (state == INFLATE_CODES && copyLength > 0) return 1;
+  return source->available() > 0 || bitCount >= 8 ? 1 : 0;
+}
+
+int InflateStream::read() {
+  if (peeked >= 0) {
+    int c = peeked;
+    peeked = -1;
+    return c;
+  }
+  return nextByte();
+}
+
+int InflateStream::peek() {
+  if (peeked < 0) peeked = nextByte();
+  return peeked;
+}
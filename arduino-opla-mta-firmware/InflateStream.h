@@ -0,0 +1,94 @@
+/*
+ * Streaming inflater for Arduino Opla MTA Firmware
+ * Decodes a zlib, gzip or raw deflate stream a byte at a time as it is
+ * read, behind a Stream, so a compressed HTTP body goes straight into the
+ * same parsers as a plain one. Deflate allows references up to 32 KB back,
+ * which is all of the SAMD21's RAM; this keeps a 2 KB window instead.
+ * zlib streams state their window and are refused up front if it is
+ * larger; gzip and raw streams fail if they reach further back. Servers
+ * should compress for it with windowBits 11 (zlib's deflateInit2).
+ */
+
+#ifndef INFLATESTREAM_H
+#define INFLATESTREAM_H
+
+#include <Arduino.h>
+
+const int INFLATE_WINDOW_BITS = 11;
+const uint16_t INFLATE_WINDOW_SIZE = 1 << INFLATE_WINDOW_BITS;
+
+enum InflateFormat {
+  INFLATE_ZLIB,         // Content-Encoding: deflate (RFC 1950)
+  INFLATE_GZIP,         // Content-Encoding: gzip (RFC 1952)
+  INFLATE_RAW           // Bare deflate blocks (RFC 1951)
+};
+
+class InflateStream : public Stream {
+private:
+  enum State {
+    INFLATE_HEADER,
+    INFLATE_BLOCK_HEADER,
+    INFLATE_STORED,
+    INFLATE_CODES,
+    INFLATE_TRAILER,
+    INFLATE_DONE,
+    INFLATE_FAILED
+  };
+
+  // Canonical Huffman code: symbol counts per code length, and symbols in
+  // code order
+  struct LiteralTree {
+    uint16_t counts[16];
+    uint16_t symbols[288];
+  };
+  struct DistanceTree {
+    uint16_t counts[16];
+    uint16_t symbols[30];
+  };
+
+  Stream* source;
+  InflateFormat format;
+  State state;
+  bool finalBlock;
+  uint32_t bitBuffer;
+  uint8_t bitCount;
+
+  LiteralTree literals;
+  DistanceTree distances;
+  uint8_t window[INFLATE_WINDOW_SIZE];
+  uint32_t outputBytes;     // Also the window write position
+  uint16_t copyLength;      // Bytes left in a match or stored block
+  uint16_t copyDistance;    // 0 while copying a stored block
+  uint32_t adler;           // zlib checksum, kept as bytes go out
+
+  int peeked;               // Next byte if already decoded, else -1
+
+  bool needBits(uint8_t count);
+  uint32_t takeBits(uint8_t count);
+  int decodeSymbol(const uint16_t* counts, const uint16_t* symbols);
+  static void buildTree(uint16_t* counts, uint16_t* symbols, const uint8_t* lengths, int count);
+  bool readStreamHeader();
+  bool readBlockHeader();
+  bool readDynamicTrees();
+  bool readTrailer();
+  int emit(uint8_t value);
+  int fail();
+  int nextByte();
+
+public:
+  InflateStream();
+
+  // Starts decoding a new stream read from source
+  void begin(Stream& sourceStream, InflateFormat streamFormat);
+
+  bool isDone() const { return state == INFLATE_DONE; }
+  bool hasFailed() const { return state == INFLATE_FAILED; }
+  uint32_t getOutputBytes() const { return outputBytes; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+};
+
+#endif
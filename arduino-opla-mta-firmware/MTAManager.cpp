@@ -1,119 +1,689 @@
 #include "MTAManager.h"
-#include <ArduinoJson.h>
+#include "Profiler.h"
+
+// Stream helpers for walking the response skeleton by hand, so only the
+// arrival entries ever reach ArduinoJson
+
+static bool isJsonSpace(int c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Next byte without consuming it, optionally past whitespace; -1 at the
+// end of the body. The body stream waits for bytes still in flight.
+static int peekByte(Stream& body, bool skipSpace) {
+  int c = body.peek();
+  while (skipSpace && isJsonSpace(c)) {
+    body.read();
+    c = body.peek();
+  }
+  return c;
+}
+
+static int readToken(Stream& body) {
+  int c = peekByte(body, true);
+  if (c >= 0) body.read();
+  return c;
+}
+
+// Reads the rest of a string whose opening quote was consumed, keeping as
+// much as fits in out (which may be null)
+static bool readString(Stream& body, char* out, size_t size) {
+  size_t length = 0;
+  char c;
+  while (body.readBytes(&c, 1) == 1) {
+    if (c == '"') {
+      if (out) out[length] = '\0';
+      return true;
+    }
+    if (c == '\\' && body.readBytes(&c, 1) != 1) break;
+    if (out && length + 1 < size) out[length++] = c;
+  }
+  return false;
+}
+
+// Reads past one value of any size without storing it
+static bool skipValue(Stream& body) {
+  int c = readToken(body);
+  if (c == '"') return readString(body, nullptr, 0);
+
+  if (c == '{' || c == '[') {
+    int depth = 1;
+    char ch;
+    while (depth > 0 && body.readBytes(&ch, 1) == 1) {
+      if (ch == '"') {
+        if (!readString(body, nullptr, 0)) return false;
+      } else if (ch == '{' || ch == '[') {
+        depth++;
+      } else if (ch == '}' || ch == ']') {
+        depth--;
+      }
+    }
+    return depth == 0;
+  }
+
+  // Number or literal: stop before whatever ends it
+  if (c < 0) return false;
+  while ((c = peekByte(body, false)) >= 0 && c != ',' && c != '}' && c != ']' && !isJsonSpace(c)) {
+    body.read();
+  }
+  return true;
+}
+
+// Reads a non-negative integer value; anything else reads as 0
+static bool readUnsigned(Stream& body, uint32_t& value) {
+  value = 0;
+  int c = peekByte(body, true);
+  if (c < '0' || c > '9') return skipValue(body);
+  while ((c = peekByte(body, false)) >= '0' && c <= '9') {
+    value = value * 10 + (c - '0');
+    body.read();
+  }
+  // Read past a fraction or exponent, if any
+  while ((c = peekByte(body, false)) >= 0 && c != ',' && c != '}' && c != ']' && !isJsonSpace(c)) {
+    body.read();
+  }
+  return c >= 0;
+}
+
+#if MTA_USE_GTFS_FEED
+// Feed path for the group of lines a route belongs to
+static const char* feedPathForLine(const char* line) {
+  switch (line[0]) {
+    case 'A': case 'C': case 'E': case 'H': return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs-ace";
+    case 'B': case 'D': case 'F': case 'M': return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs-bdfm";
+    case 'G': return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs-g";
+    case 'J': case 'Z': return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs-jz";
+    case 'N': case 'Q': case 'R': case 'W': return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs-nqrw";
+    case 'L': return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs-l";
+    default: return "/Dataservice/mtagtfsfeeds/nyct%2Fgtfs";  // 1-7 and S
+  }
+}
+#endif
 
 MTAManager::MTAManager() {
-  httpClient = nullptr;
-  clearStationData();
+  started = false;
+  for (int i = 0; i < MTA_STATION_COUNT; i++) {
+    stations[i].config = &MTA_CONFIGS[i];
+    stations[i].data = &stationBuffers[i];
+    stations[i].version = 0;
+    stations[i].lastAttempt = 0;
+    stations[i].attempted = false;
+    stations[i].lastFailed = false;
+    stations[i].bodyBytes = 0;
+    stations[i].volatility = 128;   // Unknown until refreshes compare
+    clearStationData(stationBuffers[i]);
+  }
+  spareBuffer = &stationBuffers[MTA_STATION_COUNT];
+  nextPrefetch = 0;
+  activeStation = -1;
+  fetchingStation = -1;
+  memset(&fetchStats, 0, sizeof(fetchStats));
+  startTime = 0;
+  responseTimed = false;
 }
 
 void MTAManager::begin() {
-  // Initialize HTTP client
-  httpClient = new HttpClient(wifiClient, MTA_PROXY_HOST, MTA_PROXY_PORT);
+  proxyFetch.begin(wifiClient, MTA_PROXY_HOST, MTA_PROXY_PORT);
+  proxyFetch.setAcceptCompressed(true);   // The proxy compresses for a small window
+  proxyFetch.setHeader("Accept", "application/x-mta-summary, application/json;q=0.5");
+#if MTA_USE_GTFS_FEED
+  feedFetch.begin(feedClient, MTA_FEED_HOST, MTA_FEED_PORT, true);
+  feedFetch.setHeader("x-api-key", MTA_API_KEY);
+
+  // One pass over a feed picks out every configured station it serves
+  for (int i = 0; i < MTA_STATION_COUNT; i++) {
+    feedDecoder.watchStop(MTA_CONFIGS[i].stationId);
+  }
+#endif
+  started = true;
+  startTime = millis();
   Serial.println("MTA Manager initialized");
 }
 
-void MTAManager::clearStationData() {
-  stationData.hasData = false;
-  stationData.lastUpdate = 0;
+void MTAManager::clearStationData(StationData& data) {
+  data.hasData = false;
+  data.lastUpdate = 0;
   
   // Clear all train data
-  for (int i = 0; i < 3; i++) {
-    stationData.uptown[i].isValid = false;
-    stationData.downtown[i].isValid = false;
+  for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+    data.uptown[i].isValid = false;
+    data.downtown[i].isValid = false;
   }
 }
 
-bool MTAManager::updateStationData(const char* stationId) {
-  if (!httpClient) {
-    Serial.println("HTTP client not initialized");
-    return false;
+bool MTAManager::isStale(int index, unsigned long now) {
+  const StationCacheEntry& entry = stations[index];
+  if (!entry.attempted) return true;
+  return (uint32_t)(now - entry.lastAttempt) >= refreshIntervalMs(index);
+}
+
+unsigned long MTAManager::refreshIntervalMs(int index) {
+  const StationCacheEntry& entry = stations[index];
+  if (entry.lastFailed) return MTA_RETRY_INTERVAL * 1000UL;
+
+  // Half the time to the nearest train, so a refresh lands before it has
+  // gone and while its prediction is still moving
+  int32_t nearest = secondsToNearestTrain(*entry.data);
+  long seconds = nearest >= 0 ? max(nearest / 2, (int32_t)MTA_REFRESH_MIN) : MTA_REFRESH_INTERVAL;
+
+  // Arrivals that held steady over the last few refreshes stretch it
+  seconds = seconds * (512 - entry.volatility) / 256;
+  seconds = constrain(seconds, (long)MTA_REFRESH_MIN, (long)MTA_REFRESH_MAX);
+
+  // Stations not on screen only need to be warm when switched to
+  if (index != activeStation) seconds *= MTA_BACKGROUND_REFRESH_FACTOR;
+  return seconds * 1000UL;
+}
+
+// Seconds to the first train still ahead: 0 if every listed train is due
+// or gone, -1 if none are listed
+int32_t MTAManager::secondsToNearestTrain(const StationData& data) const {
+  if (!data.hasData) return -1;
+  int32_t nearest = -1;
+  uint32_t now = clock.now();
+  const TrainArrival* directions[2] = {data.uptown, data.downtown};
+  for (int d = 0; d < 2; d++) {
+    for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+      const TrainArrival& arrival = directions[d][i];
+      if (!arrival.isValid) continue;
+      int32_t seconds = max((int32_t)(arrival.arrivalTime - now), (int32_t)0);
+      if (nearest < 0 || seconds < nearest) nearest = seconds;
+    }
   }
-  
+  return nearest;
+}
+
+// Whether a refresh changed the predictions rather than just moving past a
+// departed train: some train, listed before and still due inside the old
+// horizon, is missing or more than MTA_MOVED_SECONDS off
+bool MTAManager::arrivalsMoved(const StationData& before, const StationData& after) const {
+  if (before.hasData != after.hasData) return true;
+  uint32_t now = clock.now();
+  const TrainArrival* oldDirections[2] = {before.uptown, before.downtown};
+  const TrainArrival* newDirections[2] = {after.uptown, after.downtown};
+  for (int d = 0; d < 2; d++) {
+    // Trains listed only in one of the two are checked up to the earlier
+    // of the two horizons
+    uint32_t oldHorizon = 0, newHorizon = 0;
+    for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+      if (oldDirections[d][i].isValid) oldHorizon = oldDirections[d][i].arrivalTime;
+      if (newDirections[d][i].isValid) newHorizon = newDirections[d][i].arrivalTime;
+    }
+    uint32_t horizon = (int32_t)(oldHorizon - newHorizon) < 0 ? oldHorizon : newHorizon;
+
+    for (int pass = 0; pass < 2; pass++) {
+      const TrainArrival* from = pass ? oldDirections[d] : newDirections[d];
+      const TrainArrival* to = pass ? newDirections[d] : oldDirections[d];
+      for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+        const TrainArrival& arrival = from[i];
+        if (!arrival.isValid || (int32_t)(arrival.arrivalTime - horizon) > 0) continue;
+        if (pass && (int32_t)(arrival.arrivalTime - now) < MTA_DEPARTED_GRACE) continue;  // Due or gone
+
+        bool matched = false;
+        for (int j = 0; j < TRAINS_PER_DIRECTION && !matched; j++) {
+          int32_t offset = (int32_t)(to[j].arrivalTime - arrival.arrivalTime);
+          matched = to[j].isValid && to[j].route == arrival.route &&
+                    offset <= MTA_MOVED_SECONDS && offset >= -MTA_MOVED_SECONDS;
+        }
+        if (!matched) return true;
+      }
+    }
+  }
+  return false;
+}
+
+void MTAManager::update() {
+  PROFILE_SCOPE(PROBE_MTA_UPDATE);
+  if (!started) return;
+
+  if (fetchingStation >= 0) {
+#if MTA_USE_GTFS_FEED
+    feedFetch.poll();
+#else
+    proxyFetch.poll();
+#endif
+    return;
+  }
+
+  // Cached arrivals move with the clock, so countdowns stay put when it is set
+  int32_t moved = clock.sync();
+  if (moved != 0) shiftArrivals(moved);
+
+  if (WiFi.status() != WL_CONNECTED) return;
+
+  unsigned long now = millis();
+  if (activeStation >= 0 && isStale(activeStation, now)) {
+    startRefresh(activeStation);
+    return;
+  }
+
+  for (int i = 0; i < MTA_STATION_COUNT; i++) {
+    int index = (nextPrefetch + i) % MTA_STATION_COUNT;
+    if (isStale(index, now)) {
+      nextPrefetch = (index + 1) % MTA_STATION_COUNT;
+      startRefresh(index);
+      return;
+    }
+  }
+}
+
+void MTAManager::setActiveStation(int index) {
+  activeStation = index;
+}
+
+bool MTAManager::startRefresh(int index) {
+  if (!started || fetchingStation >= 0) return false;
+  const MTAConfig& config = *stations[index].config;
   Serial.print("Fetching MTA data for station: ");
-  Serial.println(stationId);
-  
-  // For now, simulate MTA data since we need a proxy service
-  // In production, this would call: /api/mta/station/{stationId}
-  
-  // Simulate Roosevelt Island F train data
-  clearStationData();
+  Serial.println(config.stationId);
+  fetchingStation = index;
+
+#if MTA_USE_SIMULATED_DATA
+  // Simulate MTA data until a proxy service is deployed
+  StationData& data = *spareBuffer;
+  clearStationData(data);
   
-  // Simulate uptown (Queens-bound) F trains
-  stationData.uptown[0] = {"F", "179 St", 2, true};
-  stationData.uptown[1] = {"F", "179 St", 8, true};
-  stationData.uptown[2] = {"F", "179 St", 15, true};
+  // Simulate uptown trains
+  data.uptown[0] = {config.trainLine, "179 St", 2, 0, true};
+  data.uptown[1] = {config.trainLine, "179 St", 8, 0, true};
+  data.uptown[2] = {config.trainLine, "179 St", 15, 0, true};
   
-  // Simulate downtown (Manhattan-bound) F trains
-  stationData.downtown[0] = {"F", "Coney Island", 4, true};
-  stationData.downtown[1] = {"F", "Coney Island", 11, true};
-  stationData.downtown[2] = {"F", "Coney Island", 18, true};
+  // Simulate downtown trains
+  data.downtown[0] = {config.trainLine, "Coney Island", 4, 0, true};
+  data.downtown[1] = {config.trainLine, "Coney Island", 11, 0, true};
+  data.downtown[2] = {config.trainLine, "Coney Island", 18, 0, true};
   
-  stationData.hasData = true;
-  stationData.lastUpdate = millis();
+  stampArrivals(data, 0);
+  data.hasData = true;
+  data.lastUpdate = millis();
   
   Serial.println("MTA data updated (simulated)");
+  finishRefresh(true, true);
   return true;
-  
-  /* 
-  // Real implementation would look like this:
-  String endpoint = "/api/mta/station/";
-  endpoint += stationId;
-  
-  httpClient->beginRequest();
-  httpClient->get(endpoint);
-  httpClient->endRequest();
-  
-  int statusCode = httpClient->responseStatusCode();
-  String response = httpClient->responseBody();
-  
-  if (statusCode == 200) {
-    parseTrainData(response);
-    stationData.lastUpdate = millis();
-    return true;
+#else
+  // Conditional on the last response, so an unchanged station costs a 304
+  const HttpValidators* validators = stations[index].data->hasData ? &stations[index].validators : nullptr;
+#if MTA_USE_GTFS_FEED
+  bool requested = feedFetch.startFetch(feedPathForLine(config.trainLine), handleFeedBody, handleFetchDone, this,
+                                        validators);
+#else
+  FixedString<48> endpoint;
+  endpoint.format("/api/mta/station/%s", config.stationId);
+  bool requested = proxyFetch.startFetch(endpoint.c_str(), handleProxyBody, handleFetchDone, this, validators);
+#endif
+  if (requested) fetchStats.fetches++;
+  if (!requested) finishRefresh(false, false);
+  return requested;
+#endif
+}
+
+void MTAManager::finishRefresh(bool fetched, bool published) {
+  StationCacheEntry& entry = stations[fetchingStation];
+  fetchingStation = -1;
+  entry.attempted = true;
+  entry.lastAttempt = millis();
+  entry.lastFailed = !fetched;
+
+  // A failed fetch leaves the last good data in place until it expires
+  if (!fetched) return;
+
+  // Volatility is a running average of refreshes that moved the arrivals
+  bool moved = published && arrivalsMoved(*entry.data, *spareBuffer);
+  entry.volatility += ((moved ? 256 : 0) - (int)entry.volatility) / 4;
+
+  // Not modified: the cached arrivals are current as they are
+  if (!published) {
+    entry.data->lastUpdate = millis();
+    return;
+  }
+
+  StationData* fresh = spareBuffer;
+  spareBuffer = entry.data;
+  entry.data = fresh;
+  entry.version++;
+}
+
+bool MTAManager::handleProxyBody(Stream& body, long length, void* context) {
+  (void)length;
+  MTAManager* self = (MTAManager*)context;
+  StationData& data = *self->spareBuffer;
+
+  // Parse straight off the socket instead of buffering the body. A binary
+  // summary is told from JSON by its first byte.
+  uint32_t serverTime;
+  bool parsed;
+  if (peekByte(body, false) == STATION_SUMMARY_MAGIC[0]) {
+    const char* stationId = self->stations[self->fetchingStation].config->stationId;
+    parsed = self->parseSummary(body, stationId, data, serverTime);
   } else {
+    parsed = self->parseTrainData(body, data, serverTime);
+  }
+  if (!parsed) {
+    Serial.println("MTA response could not be parsed");
+    return false;
+  }
+  self->responseTimed = self->stampArrivals(data, serverTime);
+  data.lastUpdate = millis();
+  return true;
+}
+
+HttpFetch& MTAManager::activeFetch() {
+#if MTA_USE_GTFS_FEED
+  return feedFetch;
+#else
+  return proxyFetch;
+#endif
+}
+
+void MTAManager::handleFetchDone(HttpFetchResult result, int statusCode, void* context) {
+  MTAManager* self = (MTAManager*)context;
+  HttpFetch& fetch = self->activeFetch();
+  StationCacheEntry& entry = self->stations[self->fetchingStation];
+
+  if (result == FETCH_OK) {
+    long length = fetch.getContentLength();
+    entry.bodyBytes = length > 0 && length < 65536 ? length : 0;
+    // The same minutes-only body later means later trains, so it is
+    // never revalidated
+    if (self->responseTimed) {
+      entry.validators = fetch.getResponseValidators();
+    } else {
+      entry.validators = HttpValidators();
+    }
+  } else if (result == FETCH_NOT_MODIFIED) {
+    // A 304 may carry updated validators
+    const HttpValidators& validators = fetch.getResponseValidators();
+    if (!validators.etag.isEmpty()) entry.validators.etag = validators.etag.c_str();
+    if (!validators.lastModified.isEmpty()) entry.validators.lastModified = validators.lastModified.c_str();
+    self->fetchStats.notModified++;
+    self->fetchStats.bytesSaved += entry.bodyBytes;
+  }
+
+  if (result == FETCH_HTTP_ERROR) {
     Serial.print("HTTP Error: ");
     Serial.println(statusCode);
+  } else if (result != FETCH_OK && result != FETCH_BODY_FAILED && result != FETCH_NOT_MODIFIED) {
+    Serial.print("MTA fetch failed: ");
+    Serial.println((int)result);
+  }
+  self->finishRefresh(result == FETCH_OK || result == FETCH_NOT_MODIFIED, result == FETCH_OK);
+}
+
+#if MTA_USE_GTFS_FEED
+bool MTAManager::handleFeedBody(Stream& body, long length, void* context) {
+  MTAManager* self = (MTAManager*)context;
+
+  // Decode straight off the socket; the feed is never held in memory
+  bool decoded = self->feedDecoder.decode(body, length);
+  if (!decoded || !self->fillFromFeed(*self->stations[self->fetchingStation].config, *self->spareBuffer)) {
+    Serial.println("MTA feed could not be decoded");
     return false;
   }
-  */
+  return true;
 }
 
-void MTAManager::parseTrainData(String jsonResponse) {
-  // Parse JSON response from MTA proxy service
-  DynamicJsonDocument doc(2048);
-  deserializeJson(doc, jsonResponse);
-  
-  clearStationData();
-  
-  // Parse uptown trains
-  JsonArray uptown = doc["uptown"];
-  for (int i = 0; i < 3 && i < uptown.size(); i++) {
-    stationData.uptown[i].route = uptown[i]["route"].as<String>();
-    stationData.uptown[i].destination = uptown[i]["destination"].as<String>();
-    stationData.uptown[i].minutesAway = uptown[i]["minutes"].as<int>();
-    stationData.uptown[i].isValid = true;
+bool MTAManager::fillFromFeed(const MTAConfig& config, StationData& data) {
+  const GTFSStopArrivals* stop = feedDecoder.findStop(config.stationId);
+  if (!stop) return false;
+
+  clearStationData(data);
+  for (int i = 0; i < stop->uptownCount; i++) {
+    data.uptown[i].route = stop->uptown[i].route;
+    data.uptown[i].destination = "";   // Not carried by the feed
+    data.uptown[i].arrivalTime = stop->uptown[i].arrivalTime;
+    data.uptown[i].isValid = true;
   }
-  
-  // Parse downtown trains
-  JsonArray downtown = doc["downtown"];
-  for (int i = 0; i < 3 && i < downtown.size(); i++) {
-    stationData.downtown[i].route = downtown[i]["route"].as<String>();
-    stationData.downtown[i].destination = downtown[i]["destination"].as<String>();
-    stationData.downtown[i].minutesAway = downtown[i]["minutes"].as<int>();
-    stationData.downtown[i].isValid = true;
+  for (int i = 0; i < stop->downtownCount; i++) {
+    data.downtown[i].route = stop->downtown[i].route;
+    data.downtown[i].destination = "";
+    data.downtown[i].arrivalTime = stop->downtown[i].arrivalTime;
+    data.downtown[i].isValid = true;
+  }
+  responseTimed = stampArrivals(data, feedDecoder.getFeedTimestamp());
+  data.hasData = true;
+  data.lastUpdate = millis();
+  return true;
+}
+#endif
+
+bool MTAManager::parseTrainData(Stream& body, StationData& data, uint32_t& serverTime) {
+  PROFILE_SCOPE(PROBE_PARSE_TRAIN_DATA);
+
+  // Parse JSON response from MTA proxy service, walking the top-level
+  // object by hand and handing each arrival entry to ArduinoJson alone
+  StaticJsonDocument<MTA_FILTER_JSON_SIZE> filter;
+  deserializeJson(filter, "{\"route\":true,\"destination\":true,\"minutes\":true,\"arrival\":true}");
+
+  clearStationData(data);
+  serverTime = 0;
+
+  if (readToken(body) != '{') return false;
+
+  char key[16];
+  while (true) {
+    int c = readToken(body);
+    if (c == ',') continue;
+    if (c == '}') break;
+    if (c != '"' || !readString(body, key, sizeof(key)) || readToken(body) != ':') return false;
+
+    bool ok;
+    if (strcmp(key, "uptown") == 0) {
+      ok = parseArrivals(body, filter, data.uptown);
+    } else if (strcmp(key, "downtown") == 0) {
+      ok = parseArrivals(body, filter, data.downtown);
+    } else if (strcmp(key, "timestamp") == 0) {
+      ok = readUnsigned(body, serverTime);
+    } else {
+      ok = skipValue(body);
+    }
+    if (!ok) return false;
+  }
+
+  data.hasData = true;
+  return true;
+}
+
+bool MTAManager::parseArrivals(Stream& body, JsonDocument& filter, TrainArrival* arrivals) {
+  if (readToken(body) != '[') return false;
+
+  StaticJsonDocument<MTA_ARRIVAL_JSON_SIZE> entry;
+  int count = 0;
+  while (true) {
+    int c = peekByte(body, true);
+    if (c < 0) return false;
+    if (c == ',' || c == ']') {
+      body.read();
+      if (c == ']') return true;
+      continue;
+    }
+
+    // Only the first few entries are kept; later ones are read past
+    if (count >= TRAINS_PER_DIRECTION) {
+      if (!skipValue(body)) return false;
+      continue;
+    }
+
+    DeserializationError error = deserializeJson(entry, body, DeserializationOption::Filter(filter));
+    if (error) {
+      Serial.print("MTA JSON error: ");
+      Serial.println(error.c_str());
+      return false;
+    }
+
+    arrivals[count].route = entry["route"].as<const char*>();
+    arrivals[count].destination = entry["destination"].as<const char*>();
+    arrivals[count].minutesAway = entry["minutes"].as<int>();
+    arrivals[count].arrivalTime = (uint32_t)entry["arrival"].as<unsigned long>();   // 0 if absent
+    arrivals[count].isValid = true;
+    count++;
+  }
+}
+
+bool MTAManager::parseSummary(Stream& body, const char* stationId, StationData& data, uint32_t& serverTime) {
+  PROFILE_SCOPE(PROBE_PARSE_SUMMARY);
+  clearStationData(data);
+  serverTime = 0;
+
+  uint8_t header[STATION_SUMMARY_HEADER_BYTES];
+  if (body.readBytes(header, sizeof(header)) != sizeof(header)) return false;
+  if (header[0] != STATION_SUMMARY_MAGIC[0] || header[1] != STATION_SUMMARY_MAGIC[1] ||
+      header[2] != STATION_SUMMARY_VERSION) {
+    return false;
+  }
+  // A summary for some other station, e.g. a misrouted cache entry
+  if (strncmp((const char*)header + STATION_SUMMARY_ID_OFFSET, stationId, STATION_SUMMARY_ID_BYTES) != 0) {
+    return false;
+  }
+
+  uint32_t timestamp = stationSummaryRead32(header + STATION_SUMMARY_TIMESTAMP_OFFSET);
+  const uint8_t* counts = header + STATION_SUMMARY_COUNTS_OFFSET;
+  int stringCount = counts[2];
+  uint32_t expectedCrc = stationSummaryRead32(header + STATION_SUMMARY_CRC_OFFSET);
+  uint32_t crc = stationSummaryCrc(0, header, STATION_SUMMARY_CRC_OFFSET);
+  if (timestamp == 0) return false;
+
+  // Records past the first few are only checksummed. The kept ones hold
+  // their string indices until the strings arrive.
+  uint8_t routeIndex[2][TRAINS_PER_DIRECTION];
+  uint8_t destinationIndex[2][TRAINS_PER_DIRECTION];
+  TrainArrival* directions[2] = {data.uptown, data.downtown};
+  for (int d = 0; d < 2; d++) {
+    for (int i = 0; i < counts[d]; i++) {
+      uint8_t record[STATION_SUMMARY_RECORD_BYTES];
+      if (body.readBytes(record, sizeof(record)) != sizeof(record)) return false;
+      crc = stationSummaryCrc(crc, record, sizeof(record));
+      if (i >= TRAINS_PER_DIRECTION) continue;
+      if (record[0] >= stringCount || record[1] >= stringCount) return false;
+
+      TrainArrival& arrival = directions[d][i];
+      routeIndex[d][i] = record[0];
+      destinationIndex[d][i] = record[1];
+      arrival.arrivalTime = stationSummaryRead32(record + 2);
+      int32_t seconds = (int32_t)(arrival.arrivalTime - timestamp);
+      arrival.minutesAway = seconds > 0 ? (seconds + 30) / 60 : 0;
+      arrival.isValid = true;
+    }
+  }
+
+  for (int s = 0; s < stringCount; s++) {
+    uint8_t length;
+    if (body.readBytes(&length, 1) != 1) return false;
+    crc = stationSummaryCrc(crc, &length, 1);
+
+    // Longer strings are cut to what the arrivals keep
+    char text[32];
+    for (int i = 0; i < length; i++) {
+      uint8_t c;
+      if (body.readBytes(&c, 1) != 1) return false;
+      crc = stationSummaryCrc(crc, &c, 1);
+      if (i < (int)sizeof(text) - 1) text[i] = c;
+    }
+    text[min((int)length, (int)sizeof(text) - 1)] = '\0';
+
+    for (int d = 0; d < 2; d++) {
+      for (int i = 0; i < TRAINS_PER_DIRECTION && directions[d][i].isValid; i++) {
+        if (routeIndex[d][i] == s) directions[d][i].route = text;
+        if (destinationIndex[d][i] == s) directions[d][i].destination = text;
+      }
+    }
+  }
+
+  // Nothing is published unless the whole summary arrived intact
+  if (crc != expectedCrc) return false;
+  serverTime = timestamp;
+  data.hasData = true;
+  return true;
+}
+
+bool MTAManager::hasValidData(int index) {
+  const StationData& data = getStationData(index);
+  return data.hasData && ((uint32_t)(millis() - data.lastUpdate) < 300000); // 5 minutes
+}
+
+bool MTAManager::stampArrivals(StationData& data, uint32_t serverTime) {
+  // Epoch arrival times are taken relative to the response's own timestamp
+  // when it has one, so the server and device clocks need not agree.
+  // Entries with only a minute count, or epoch times with nothing to
+  // relate them to yet, are counted from now.
+  uint32_t now = clock.now();
+  bool haveEpoch = serverTime != 0 || clock.isSynced();
+  bool timed = true;
+  TrainArrival* directions[2] = {data.uptown, data.downtown};
+  for (int d = 0; d < 2; d++) {
+    for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+      TrainArrival& arrival = directions[d][i];
+      if (!arrival.isValid) continue;
+      if (arrival.arrivalTime == 0 || !haveEpoch) {
+        if (serverTime == 0) timed = false;
+        arrival.arrivalTime = now + arrival.minutesAway * 60;
+      } else {
+        if (serverTime != 0) arrival.arrivalTime += now - serverTime;
+        arrival.minutesAway = minutesUntil(arrival);
+      }
+    }
+  }
+  return timed;
+}
+
+void MTAManager::shiftArrivals(int32_t seconds) {
+  for (int b = 0; b <= MTA_STATION_COUNT; b++) {
+    StationData& data = stationBuffers[b];
+    for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+      data.uptown[i].arrivalTime += seconds;
+      data.downtown[i].arrivalTime += seconds;
+    }
   }
-  
-  stationData.hasData = true;
 }
 
-StationData MTAManager::getStationData() {
-  return stationData;
+int MTAManager::minutesUntil(const TrainArrival& arrival) const {
+  int32_t seconds = (int32_t)(arrival.arrivalTime - clock.now());
+  return seconds > 0 ? (seconds + 30) / 60 : 0;
 }
 
-bool MTAManager::hasValidData() {
-  return stationData.hasData && (millis() - stationData.lastUpdate < 300000); // 5 minutes
+bool MTAManager::hasDeparted(const TrainArrival& arrival) const {
+  return (int32_t)(arrival.arrivalTime - clock.now()) < -MTA_DEPARTED_GRACE;
 }
 
-unsigned long MTAManager::getLastUpdateTime() {
-  return stationData.lastUpdate;
+uint32_t MTAManager::msUntilChange(const TrainArrival& arrival) const {
+  // Down a minute once the rounded seconds fall below the half minute;
+  // at 0 it stays until the train is gone
+  int minutes = minutesUntil(arrival);
+  uint32_t changesAt = minutes > 0 ? arrival.arrivalTime - (60 * minutes - 31)
+                                   : arrival.arrivalTime + MTA_DEPARTED_GRACE + 1;
+  return clock.msUntil(changesAt);
+}
+
+unsigned long MTAManager::getLastUpdateTime(int index) {
+  return getStationData(index).lastUpdate;
+}
+
+void MTAManager::setQuietCheck(HttpFetch::QuietCheck check, void* context) {
+  proxyFetch.setQuietCheck(check, context);
+#if MTA_USE_GTFS_FEED
+  feedFetch.setQuietCheck(check, context);
+#endif
+}
+
+void MTAManager::printStats(Print& out) {
+  // Scale to an hour of uptime; fixed-interval polling would have sent a
+  // request per station at startup and every MTA_REFRESH_INTERVAL after
+  uint32_t elapsed = millis() - startTime;
+  if (elapsed < 1000) return;
+  uint32_t fixedRequests = MTA_STATION_COUNT * (1 + elapsed / (MTA_REFRESH_INTERVAL * 1000UL));
+  int32_t avoided = (int32_t)fixedRequests - (int32_t)fetchStats.fetches;
+
+  const HttpFetchStats& http = activeFetch().getStats();
+  FixedString<127> line;
+  line.format("MTA: %lu fetches on %lu connections (%lu resent, %lu lookups), %lu not modified, %lu body bytes "
+              "(%lu inflated)",
+              (unsigned long)fetchStats.fetches, (unsigned long)http.connections, (unsigned long)http.retries,
+              (unsigned long)http.lookups,
+              (unsigned long)fetchStats.notModified, (unsigned long)http.wireBytes, (unsigned long)http.bodyBytes);
+  out.println(line.c_str());
+  line.format("  per hour: %ld requests avoided, %lu bytes saved by 304s", (long)((int64_t)avoided * 3600000 / elapsed),
+              (unsigned long)((uint64_t)fetchStats.bytesSaved * 3600000 / elapsed));
+  out.println(line.c_str());
+  line.format("  body parser stack peak %lu of %lu bytes", (unsigned long)http.stackPeak,
+              (unsigned long)HTTP_FETCH_BODY_STACK);
+  out.println(line.c_str());
 }
\ No newline at end of file
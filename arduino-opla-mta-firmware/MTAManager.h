@@ -8,44 +8,150 @@
 
 #include <Arduino.h>
 #include <WiFiNINA.h>
-#include <ArduinoHttpClient.h>
+#include <ArduinoJson.h>
 #include "config.h"
+#include "GTFSRealtimeDecoder.h"
+#include "FixedString.h"
+#include "RouteId.h"
+#include "HttpFetch.h"
+#include "WallClock.h"
+#include "StationSummary.h"
+
+// ArduinoJson memory for parsing a response: one arrival entry at a time,
+// plus the filter, so peak RAM does not depend on the response size
+const size_t MTA_ARRIVAL_JSON_SIZE = 192;
+const size_t MTA_FILTER_JSON_SIZE = 128;
 
 struct TrainArrival {
-  String route;
-  String destination;
-  int minutesAway;
+  RouteId route;
+  FixedString<31> destination;
+  int minutesAway;            // As reported when fetched
+  uint32_t arrivalTime;       // On the manager's wall clock
   bool isValid;
 };
 
 struct StationData {
-  TrainArrival uptown[3];    // Next 3 uptown trains
-  TrainArrival downtown[3];  // Next 3 downtown trains
+  TrainArrival uptown[TRAINS_PER_DIRECTION];    // Next uptown trains
+  TrainArrival downtown[TRAINS_PER_DIRECTION];  // Next downtown trains
   unsigned long lastUpdate;
   bool hasData;
 };
 
+// Cached arrivals for one MTA_CONFIGS station
+struct StationCacheEntry {
+  const MTAConfig* config;
+  StationData* data;          // Published data; swapped out whole on refresh
+  uint32_t version;           // Bumped each time new data is published
+  unsigned long lastAttempt;  // millis() of the last fetch, good or bad
+  bool attempted;
+  bool lastFailed;
+  HttpValidators validators;  // From the last response, for conditional requests
+  uint16_t bodyBytes;         // Size of the last full response
+  uint16_t volatility;        // 0-256: how often refreshes move the arrivals
+};
+
+// Refresh counters since begin(). Requests avoided are against polling
+// every station at the fixed MTA_REFRESH_INTERVAL.
+struct MTAFetchStats {
+  uint32_t fetches;           // Requests sent
+  uint32_t notModified;       // Answered 304, nothing to parse
+  uint32_t bytesSaved;        // Bodies the 304s stood in for
+};
+
 class MTAManager {
 private:
   WiFiClient wifiClient;
-  HttpClient* httpClient;
-  StationData stationData;
+  HttpFetch proxyFetch;
+  WallClock clock;
+  bool started;
+
+  // One entry per configured station. Fetches fill the spare buffer and
+  // publish it by swapping it with the entry's, so readers only ever see
+  // complete data.
+  StationCacheEntry stations[MTA_STATION_COUNT];
+  StationData stationBuffers[MTA_STATION_COUNT + 1];
+  StationData* spareBuffer;
+  int nextPrefetch;
+  int activeStation;          // Shown on screen; refreshed ahead of the rest
+  int fetchingStation;        // Refresh in flight, or -1
+  MTAFetchStats fetchStats;
+  unsigned long startTime;
+  bool responseTimed;         // Last body gave absolute times, so may be revalidated
   
   // MTA API endpoints (we'll use a simplified proxy service)
   const char* MTA_PROXY_HOST = "api.example.com"; // Replace with actual proxy
   const int MTA_PROXY_PORT = 80;
+
+#if MTA_USE_GTFS_FEED
+  // MTA GTFS-realtime feeds, one per group of lines
+  const char* MTA_FEED_HOST = "api-endpoint.mta.info";
+  const int MTA_FEED_PORT = 443;
+  WiFiSSLClient feedClient;
+  HttpFetch feedFetch;
+  GTFSRealtimeDecoder feedDecoder;
+
+  static bool handleFeedBody(Stream& body, long length, void* context);
+  bool fillFromFeed(const MTAConfig& config, StationData& data);
+#endif
   
-  bool fetchStationData(const char* stationId);
-  void parseTrainData(String jsonResponse);
-  void clearStationData();
+  static bool handleProxyBody(Stream& body, long length, void* context);
+  static void handleFetchDone(HttpFetchResult result, int statusCode, void* context);
+  HttpFetch& activeFetch();
+  void finishRefresh(bool fetched, bool published);
+  bool parseArrivals(Stream& body, JsonDocument& filter, TrainArrival* arrivals);
+  void clearStationData(StationData& data);
+  bool stampArrivals(StationData& data, uint32_t serverTime);
+  void shiftArrivals(int32_t seconds);
+  bool isStale(int index, unsigned long now);
+  unsigned long refreshIntervalMs(int index);
+  int32_t secondsToNearestTrain(const StationData& data) const;
+  bool arrivalsMoved(const StationData& before, const StationData& after) const;
 
 public:
   MTAManager();
   void begin();
-  bool updateStationData(const char* stationId);
-  StationData getStationData();
-  bool hasValidData();
-  unsigned long getLastUpdateTime();
+
+  // Advances the fetch in flight, or starts one for the next expired
+  // station, round-robin, so every station stays warm in the cache.
+  // Call from loop(); it never waits on the network.
+  void update();
+
+  // Starts fetching one station now, stale or not, for update() to carry
+  // on; false if another fetch is in flight or this one could not start
+  bool startRefresh(int index);
+  bool isFetching() { return fetchingStation >= 0; }
+  void setActiveStation(int index);
+
+  // Host lookups and fresh connections block the loop, so they wait for
+  // the check to say the UI is idle (HttpFetch::setQuietCheck())
+  void setQuietCheck(HttpFetch::QuietCheck check, void* context);
+
+  int getStationCount() { return MTA_STATION_COUNT; }
+  const MTAConfig& getStationConfig(int index) { return *stations[index].config; }
+
+  // Latest published data for a station, valid until its next refresh
+  const StationData& getStationData(int index) const { return *stations[index].data; }
+  uint32_t getDataVersion(int index) const { return stations[index].version; }
+  bool hasValidData(int index);
+
+  // Countdown from the wall clock, so it stays current between fetches:
+  // whole minutes to the arrival, rounded, and whether the train has left
+  int minutesUntil(const TrainArrival& arrival) const;
+  bool hasDeparted(const TrainArrival& arrival) const;
+
+  // Milliseconds until either of those next changes for the arrival
+  uint32_t msUntilChange(const TrainArrival& arrival) const;
+  unsigned long getLastUpdateTime(int index);
+
+  const MTAFetchStats& getFetchStats() const { return fetchStats; }
+  void printStats(Print& out);
+
+  // Proxy response decoders, JSON and binary summary (StationSummary.h).
+  // Both fill data from the body as it streams in and return the
+  // response's feed timestamp, 0 if it had none; arrival times are left
+  // on the feed's clock.
+  bool parseTrainData(Stream& body, StationData& data, uint32_t& serverTime);
+  bool parseSummary(Stream& body, const char* stationId, StationData& data, uint32_t& serverTime);
 };
 
-#endif
\ No newline at end of file
+#endif
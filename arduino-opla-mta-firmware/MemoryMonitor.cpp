@@ -0,0 +1,186 @@
+#include "MemoryMonitor.h"
+#include "FixedString.h"
+
+#ifdef ARDUINO_ARCH_SAMD
+#include <malloc.h>
+
+extern "C" char* sbrk(int increment);
+extern "C" char __StackTop;    // From the linker script: the top of RAM
+
+// newlib-nano's free list, in address order; size counts the header
+struct NanoChunk {
+  long size;
+  NanoChunk* next;
+};
+extern "C" NanoChunk* __malloc_free_list;
+#else
+#include <SimMemory.h>
+#endif
+
+static const char* const SUBSYSTEM_NAMES[MEMORY_SUBSYSTEM_COUNT] = {
+  "other", "wifi", "transit", "sensors", "modes", "display"
+};
+
+MemoryStats MemoryMonitor::stats = {0};
+AllocationStats MemoryMonitor::allocations[MEMORY_SUBSYSTEM_COUNT];
+MemorySubsystem MemoryMonitor::current = MEMORY_OTHER;
+static bool stackPainted = false;
+
+#ifdef ARDUINO_ARCH_SAMD
+// The heap grows up from the end of .bss and the stack down from the top
+// of RAM; the stack may reach as low as the heap's break
+static uint32_t* stackFloor() { return (uint32_t*)(((uintptr_t)sbrk(0) + 3) & ~(uintptr_t)3); }
+static char* stackTop() { return &__StackTop; }
+
+static void sampleHeap(MemoryStats& out) {
+  struct mallinfo info = mallinfo();
+  uint32_t gap = (char*)__get_MSP() - sbrk(0);
+  out.heapBytes = info.uordblks;
+  out.freeBytes = info.fordblks + gap;
+  out.largestFreeBlock = gap;
+  for (NanoChunk* chunk = __malloc_free_list; chunk; chunk = chunk->next) {
+    uint32_t usable = chunk->size - sizeof(long);
+    if (usable > out.largestFreeBlock) out.largestFreeBlock = usable;
+  }
+}
+#else
+// The simulator's sketch stack and arena stand in for the board's RAM
+static uint32_t* stackFloor() { return (uint32_t*)SimMemory::stackBottom(); }
+static char* stackTop() { return SimMemory::stackTop(); }
+
+static void sampleHeap(MemoryStats& out) {
+  SimHeapStats heap = SimMemory::heapStats();
+  out.heapBytes = heap.usedBytes;
+  out.freeBytes = heap.freeBytes;
+  out.largestFreeBlock = heap.largestFreeBlock;
+}
+
+static void onSimAllocation(SimMemory::AllocationEvent event, size_t bytes) {
+  if (event == SimMemory::FREED) {
+    MemoryMonitor::noteFree();
+  } else {
+    MemoryMonitor::noteAllocation(bytes, event == SimMemory::ALLOCATED);
+  }
+}
+#endif
+
+void MemoryMonitor::begin() {
+#ifndef ARDUINO_ARCH_SAMD
+  SimMemory::setAllocationHook(onSimAllocation);
+#endif
+  // Everything between the stack floor and a margin below this frame is unused
+  uint32_t* bottom = stackFloor();
+  char* frame = (char*)__builtin_frame_address(0);
+  if (!bottom || frame < (char*)bottom + MEMORY_PAINT_MARGIN || frame > stackTop()) return;
+  volatile uint32_t* end = (uint32_t*)((uintptr_t)(frame - MEMORY_PAINT_MARGIN) & ~(uintptr_t)3);
+  for (volatile uint32_t* word = bottom; word < end; word++) {
+    *word = MEMORY_PAINT;
+  }
+  stackPainted = true;
+}
+
+const MemoryStats& MemoryMonitor::sample() {
+  sampleHeap(stats);
+
+  // The lowest word the stack has written is the first unpainted one above
+  // the floor; the heap may have moved the floor up since begin()
+  uint32_t* bottom = stackFloor();
+  if (stackPainted) {
+    const volatile uint32_t* deepest = bottom;
+    const volatile uint32_t* top = (uint32_t*)stackTop();
+    while (deepest < top && *deepest == MEMORY_PAINT) deepest++;
+    stats.stackBytes = (const char*)top - (const char*)deepest;
+    stats.stackHeadroom = (const char*)deepest - (const char*)bottom;
+  }
+  return stats;
+}
+
+uint32_t MemoryMonitor::getTotalAllocations() {
+  uint32_t total = 0;
+  for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) total += allocations[i].allocations;
+  return total;
+}
+
+const char* MemoryMonitor::getName(MemorySubsystem subsystem) {
+  return SUBSYSTEM_NAMES[subsystem];
+}
+
+uint8_t MemoryMonitor::getFragmentationPercent() {
+  if (stats.freeBytes == 0 || stats.largestFreeBlock >= stats.freeBytes) return 0;
+  return (uint8_t)((uint64_t)(stats.freeBytes - stats.largestFreeBlock) * 100 / stats.freeBytes);
+}
+
+void MemoryMonitor::noteAllocation(size_t bytes, bool succeeded) {
+  if (!succeeded) {
+    stats.failures++;
+    return;
+  }
+  allocations[current].allocations++;
+  allocations[current].bytes += bytes;
+  stats.liveBlocks++;
+}
+
+void MemoryMonitor::noteFree() {
+  if (stats.liveBlocks > 0) stats.liveBlocks--;
+}
+
+void MemoryMonitor::printStats(Print& out) {
+  sample();
+  FixedString<127> line;
+  line.format("Memory: %lu bytes free, largest block %lu (%u%% fragmented), %lu used in %lu blocks, %lu failed",
+              (unsigned long)stats.freeBytes, (unsigned long)stats.largestFreeBlock, getFragmentationPercent(),
+              (unsigned long)stats.heapBytes, (unsigned long)stats.liveBlocks, (unsigned long)stats.failures);
+  out.println(line.c_str());
+  line.format("  stack peak %lu bytes, %lu never reached", (unsigned long)stats.stackBytes,
+              (unsigned long)stats.stackHeadroom);
+  out.println(line.c_str());
+  for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+    if (allocations[i].allocations == 0) continue;
+    line.format("  %-8s %6lu allocations, %7lu bytes", SUBSYSTEM_NAMES[i], (unsigned long)allocations[i].allocations,
+                (unsigned long)allocations[i].bytes);
+    out.println(line.c_str());
+  }
+}
+
+#if defined(ARDUINO_ARCH_SAMD) && MEMORY_WRAP_MALLOC
+// Linked in place of the C library's by -Wl,--wrap=malloc and friends.
+// Library Strings and operator new come through here; the C library's own
+// calls (printf's buffers) do not.
+extern "C" {
+void* __real_malloc(size_t bytes);
+void __real_free(void* p);
+void* __real_realloc(void* p, size_t bytes);
+void* __real_calloc(size_t count, size_t bytes);
+
+void* __wrap_malloc(size_t bytes) {
+  void* p = __real_malloc(bytes);
+  MemoryMonitor::noteAllocation(bytes, p != nullptr);
+  return p;
+}
+
+void __wrap_free(void* p) {
+  if (p) MemoryMonitor::noteFree();
+  __real_free(p);
+}
+
+void* __wrap_realloc(void* p, size_t bytes) {
+  void* moved = __real_realloc(p, bytes);
+  if (!p) {
+    MemoryMonitor::noteAllocation(bytes, moved != nullptr);
+  } else if (bytes == 0) {
+    MemoryMonitor::noteFree();
+  } else {
+    // A block that grew (String appends) counts again, but is still one block
+    MemoryMonitor::noteAllocation(bytes, moved != nullptr);
+    if (moved) MemoryMonitor::noteFree();
+  }
+  return moved;
+}
+
+void* __wrap_calloc(size_t count, size_t bytes) {
+  void* p = __real_calloc(count, bytes);
+  MemoryMonitor::noteAllocation(count * bytes, p != nullptr);
+  return p;
+}
+}
+#endif
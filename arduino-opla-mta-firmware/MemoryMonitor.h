@@ -0,0 +1,98 @@
+/*
+ * Memory monitor for Arduino Opla MTA Firmware
+ * Watches the heap and stack a long-running unit eventually dies of. The
+ * heap comes from sbrk() and mallinfo(): bytes in use, bytes free (the
+ * free list plus the gap up to the stack) and the largest block that could
+ * still be allocated. begin() paints the unused stack so sample() can find
+ * the deepest the stack has reached since.
+ *
+ * Allocations are counted per subsystem, by whatever MEMORY_SCOPE is
+ * innermost when they are made. On the board that takes malloc(), free(),
+ * realloc() and calloc() wrapped at link time (make compile passes
+ * -Wl,--wrap and MEMORY_WRAP_MALLOC=1); without it the counts stay 0. In
+ * the simulator, the sketch's heap and stack are SimMemory's.
+ */
+
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum MemorySubsystem {
+  MEMORY_OTHER,      // Outside every scope, setup included
+  MEMORY_WIFI,
+  MEMORY_TRANSIT,    // MTA fetches and parsing
+  MEMORY_SENSORS,
+  MEMORY_MODES,      // Modes, their text and touch handling
+  MEMORY_DISPLAY,    // Drawing scenes
+  MEMORY_SUBSYSTEM_COUNT
+};
+
+// Stack below this much under the caller of begin() is left unpainted
+const uint32_t MEMORY_PAINT_MARGIN = 256;
+const uint32_t MEMORY_PAINT = 0xA5A5A5A5;
+
+struct MemoryStats {
+  uint32_t heapBytes;          // In allocated blocks
+  uint32_t freeBytes;          // Free blocks plus the gap up to the stack
+  uint32_t largestFreeBlock;   // Largest allocation that would succeed
+  uint32_t stackBytes;         // Deepest the stack has been since begin()
+  uint32_t stackHeadroom;      // Between the stack floor (the heap's break) and that point
+  uint32_t liveBlocks;         // Allocations not yet freed
+  uint32_t failures;           // Allocations that found no room
+};
+
+struct AllocationStats {
+  uint32_t allocations;        // Including reallocs that grew a block
+  uint32_t bytes;              // Requested
+};
+
+class MemoryMonitor {
+private:
+  static MemoryStats stats;
+  static AllocationStats allocations[MEMORY_SUBSYSTEM_COUNT];
+  static MemorySubsystem current;
+
+public:
+  // Paints the stack; call first thing in setup()
+  static void begin();
+
+  // Refreshes the heap and stack figures; scanning the stack takes a few
+  // hundred microseconds, so this belongs in a report, not a hot path
+  static const MemoryStats& sample();
+  static const MemoryStats& getStats() { return stats; }
+  static const AllocationStats& getAllocations(MemorySubsystem subsystem) { return allocations[subsystem]; }
+  static uint32_t getTotalAllocations();
+  static const char* getName(MemorySubsystem subsystem);
+
+  // Percentage of the free bytes outside the largest free block
+  static uint8_t getFragmentationPercent();
+
+  static MemorySubsystem enter(MemorySubsystem subsystem) {
+    MemorySubsystem previous = current;
+    current = subsystem;
+    return previous;
+  }
+  static void leave(MemorySubsystem previous) { current = previous; }
+
+  // From the allocator wrappers
+  static void noteAllocation(size_t bytes, bool succeeded);
+  static void noteFree();
+
+  static void printStats(Print& out);
+};
+
+// Attributes allocations to a subsystem until the end of the enclosing block
+class MemoryScope {
+private:
+  MemorySubsystem previous;
+
+public:
+  MemoryScope(MemorySubsystem subsystem) : previous(MemoryMonitor::enter(subsystem)) {}
+  ~MemoryScope() { MemoryMonitor::leave(previous); }
+};
+
+#define MEMORY_SCOPE(subsystem) MemoryScope memoryScope(subsystem)
+
+#endif
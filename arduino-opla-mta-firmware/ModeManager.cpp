@@ -1,8 +1,9 @@
 #include "ModeManager.h"
 
-ModeManager::ModeManager(MKRIoTCarrier* carrierPtr, MTAManager* mtaPtr) {
+ModeManager::ModeManager(MKRIoTCarrier* carrierPtr, MTAManager* mtaPtr, SensorService* sensorPtr) {
   carrier = carrierPtr;
   mtaManager = mtaPtr;
+  sensorService = sensorPtr;
   currentMode = nullptr;
   currentModeType = MODE_NONE;
   
@@ -31,7 +32,7 @@ void ModeManager::begin() {
 
 void ModeManager::initializeModes() {
   // Create mode instances
-  modes[MODE_AMBIENT] = new AmbientDataMode(carrier);
+  modes[MODE_AMBIENT] = new AmbientDataMode(carrier, sensorService);
   modes[MODE_TRANSIT] = new NYCMTATransitMode(carrier, mtaManager);
   modes[MODE_WEATHER] = nullptr;  // Future implementation
   
@@ -67,8 +68,12 @@ void ModeManager::handleButtonPress(int buttonIndex) {
       }
       break;
       
-    case 2: // TOUCH2 - Future: Weather mode  
-      Serial.println("Weather mode not implemented yet");
+    case 2: // TOUCH2 - Next station in transit mode, next history in ambient; future: Weather mode
+      if (currentModeType == MODE_TRANSIT || currentModeType == MODE_AMBIENT) {
+        currentMode->handleButtonPress(buttonIndex);
+      } else {
+        Serial.println("Weather mode not implemented yet");
+      }
       break;
       
     case 3: // TOUCH3 - Future: Additional mode
@@ -88,8 +93,9 @@ void ModeManager::switchToMode(DisplayMode newMode) {
     return;
   }
   
-  // Exit current mode
+  // Exit current mode, leaving its animations finished for when it returns
   if (currentMode != nullptr) {
+    currentMode->finishAnimations();
     currentMode->exit();
   }
   
@@ -105,7 +111,15 @@ void ModeManager::switchToMode(DisplayMode newMode) {
   }
 }
 
-String ModeManager::getCurrentModeName() {
+uint32_t ModeManager::renderFrame() {
+  return currentMode != nullptr ? currentMode->renderFrame() : 0;
+}
+
+bool ModeManager::isAnimating() {
+  return currentMode != nullptr && currentMode->isAnimating();
+}
+
+const char* ModeManager::getCurrentModeName() {
   if (currentMode != nullptr) {
     return currentMode->getName();
   }
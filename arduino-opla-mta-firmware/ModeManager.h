@@ -10,6 +10,7 @@
 #include <Arduino_MKRIoTCarrier.h>
 #include "config.h"
 #include "MTAManager.h"
+#include "SensorService.h"
 #include "BaseMode.h"
 #include "AmbientDataMode.h"
 #include "NYCMTATransitMode.h"
@@ -25,6 +26,7 @@ class ModeManager {
 private:
   MKRIoTCarrier* carrier;
   MTAManager* mtaManager;
+  SensorService* sensorService;
   
   // Mode instances
   BaseMode* modes[3];  // Array to hold different modes
@@ -36,14 +38,19 @@ private:
   void switchToMode(DisplayMode newMode);
 
 public:
-  ModeManager(MKRIoTCarrier* carrierPtr, MTAManager* mtaPtr);
+  ModeManager(MKRIoTCarrier* carrierPtr, MTAManager* mtaPtr, SensorService* sensorPtr);
   ~ModeManager();
   
   void begin();
   void update();
   void handleButtonPress(int buttonIndex);
+
+  // Draws the current mode's next animation frame; returns milliseconds
+  // until the one after, 0 when nothing is animating
+  uint32_t renderFrame();
+  bool isAnimating();
   DisplayMode getCurrentModeType() { return currentModeType; }
-  String getCurrentModeName();
+  const char* getCurrentModeName();
 };
 
 #endif
\ No newline at end of file
@@ -1,39 +1,119 @@
 #include "NYCMTATransitMode.h"
+#include "TransitMetadata.h"
+#include "Profiler.h"
+
+// Countdown changes slide through their circles; a direction change
+// swings the countdown ring round by a slot
+static const uint32_t COUNTDOWN_SLIDE_MS = 400;
+static const uint32_t DIRECTION_SWING_MS = 450;
+static const float DIRECTION_SWING_DEGREES = 120;
 
 NYCMTATransitMode::NYCMTATransitMode(MKRIoTCarrier* carrierPtr, MTAManager* mtaPtr) 
   : BaseMode(carrierPtr), mtaManager(mtaPtr) {
   currentState = TRANSIT_UPTOWN;
-  stationId = "B06"; // Roosevelt Island - F Train
+  stationIndex = 0;
+  drawnVersion = 0;
+  drawnAt = 0;
+  redrawMs = 0;
+  buildScene();
+  applyStation();
+}
+
+void NYCMTATransitMode::buildScene() {
+  const int centerX = 120;
+  const int centerY = 120;
+  
+  // Center: Line letter in the line color, filled in by applyStation()
+  centerElements[0] = radialDisplay->createCircleElement(0, "", ST77XX_BLACK, 30);
+  rings[3] = radialDisplay->createCenterRing(4, ST77XX_WHITE);
+  rings[3].elementCount = 1;
+  rings[3].elements = centerElements;
+  
+  // 1st Ring: Station name, filled in by applyStation()
+  stationElements[0] = radialDisplay->createTextElement(0, "", ST77XX_BLACK);
+  rings[2] = radialDisplay->createTextRing(50, 1, ST77XX_BLACK);
+  rings[2].type = RadialRing::RING_TEXT_ARC;
+  rings[2].elementCount = 1;
+  rings[2].elements = stationElements;
+  
+  // 2nd Ring: Direction indicator, filled in per draw
+  directionElements[0] = radialDisplay->createTextElement(0, "", ST77XX_BLACK);
+  rings[1] = radialDisplay->createTextRing(70, 2, ST77XX_BLACK);
+  rings[1].type = RadialRing::RING_TEXT_ARC;
+  rings[1].elementCount = 1;
+  rings[1].elements = directionElements;
+  
+  // 3rd Ring: Train arrival times, filled in per draw
+  for (int i = 0; i < 3; i++) {
+    timeElements[i] = radialDisplay->createCircleElement(90 + (i * 120), "", ST77XX_WHITE, 20); // 90, 210, 330 degrees
+  }
+  rings[0] = radialDisplay->createCircleRing(95, 20, ST77XX_WHITE, ST77XX_BLACK);
+  rings[0].elementCount = 0;
+  rings[0].elements = timeElements;
+  rings[0].autoSpacing = false;
+  rings[0].textSize = 2;
+  
+  // Screen filled with the line color by applyStation()
+  scene.centerX = centerX;
+  scene.centerY = centerY;
+  scene.ringCount = 4;
+  scene.rings = rings;
+  scene.lastSignature = 0;
+  animator->setScene(&scene);
+}
+
+void NYCMTATransitMode::applyStation() {
+  const MTAConfig& config = mtaManager->getStationConfig(stationIndex);
+  TransitStation station;
+  bool known = findTransitStation(config.stationId, station);
+  centerElements[0].content = config.trainLine;
+  stationElements[0].content = known ? station.name : config.stationName;
+  uptownLabel = known ? station.northLabel : "UPTOWN";
+  downtownLabel = known ? station.southLabel : "DOWNTOWN";
+  scene.backgroundColor = transitRouteColor(config.trainLine);
+  rings[3].borderColor = scene.backgroundColor;
+}
+
+void NYCMTATransitMode::nextStation() {
+  stationIndex = (stationIndex + 1) % mtaManager->getStationCount();
+  applyStation();
+  mtaManager->setActiveStation(stationIndex);
+  Serial.print("Switching to station: ");
+  Serial.println(mtaManager->getStationConfig(stationIndex).stationName);
 }
 
 void NYCMTATransitMode::enter() {
   Serial.println("Entering NYC MTA Transit Mode");
-  // Fetch fresh MTA data
-  mtaManager->updateStationData(stationId.c_str());
+  radialDisplay->invalidate();
+  // Draw straight from the cache; the MTA manager keeps it fresh
+  mtaManager->setActiveStation(stationIndex);
   displayTransit();
 }
 
 void NYCMTATransitMode::update() {
-  // Update display if needed (could check for data changes)
-  static unsigned long lastUpdate = 0;
-  unsigned long now = millis();
-  
-  // Refresh display every 30 seconds
-  if (now - lastUpdate > 30000) {
+  // Countdowns run off the wall clock between fetches, so besides new data
+  // only the next minute change of one on screen needs a redraw
+  if (mtaManager->getDataVersion(stationIndex) != drawnVersion || millis() - drawnAt >= redrawMs) {
     displayTransit();
-    lastUpdate = now;
   }
 }
 
 void NYCMTATransitMode::exit() {
   Serial.println("Exiting NYC MTA Transit Mode");
-  // Clear display or perform cleanup
+  mtaManager->setActiveStation(-1);
 }
 
 void NYCMTATransitMode::handleButtonPress(int buttonIndex) {
   if (buttonIndex == 1) { // TOUCH1 - cycle between uptown/downtown
     updateTransitState();
-    displayTransit();
+    displayTransit(TEXT_CUT);
+    if (radialDisplay->isOnScreen()) {
+      rings[0].rotation = currentState == TRANSIT_UPTOWN ? -DIRECTION_SWING_DEGREES : DIRECTION_SWING_DEGREES;
+      animator->animate(rings[0].rotation, 0, DIRECTION_SWING_MS);
+    }
+  } else if (buttonIndex == 2) { // TOUCH2 - next configured station
+    nextStation();
+    displayTransit(TEXT_CUT);
   }
 }
 
@@ -47,8 +127,12 @@ void NYCMTATransitMode::updateTransitState() {
   }
 }
 
-void NYCMTATransitMode::displayTransit() {
-  StationData data = mtaManager->getStationData();
+void NYCMTATransitMode::displayTransit(TextTransition transition) {
+  PROFILE_SCOPE(PROBE_DISPLAY_TRANSIT);
+  const StationData& data = mtaManager->getStationData(stationIndex);
+  drawnVersion = mtaManager->getDataVersion(stationIndex);
+  drawnAt = millis();
+  redrawMs = UINT32_MAX;
   
   if (!data.hasData) {
     Serial.println("No transit data available");
@@ -58,63 +142,35 @@ void NYCMTATransitMode::displayTransit() {
     carrier->display.setTextSize(2);
     carrier->display.setCursor(50, 110);
     carrier->display.print("No Data");
+    radialDisplay->invalidate();
     return;
   }
   
   // Use radial display for transit info
-  drawRadialTransitDisplay();
+  drawRadialTransitDisplay(data, transition);
 }
 
-void NYCMTATransitMode::drawRadialTransitDisplay() {
-  StationData data = mtaManager->getStationData();
-  const int centerX = 120;
-  const int centerY = 120;
-  
-  // Clear screen with F train orange
-  radialDisplay->clear(0xFD20);
-  
-  // Center: Line letter
-  radialDisplay->drawCenterElement(centerX, centerY, 30, "F", ST77XX_BLACK, 0xFD20, 4);
-  
-  // 1st Ring: Station name
-  RadialElement stationElements[1];
-  stationElements[0] = radialDisplay->createTextElement(0, "Roosevelt Island", ST77XX_BLACK);
-  
-  RadialRing stationRing = radialDisplay->createTextRing(50, 1, ST77XX_BLACK);
-  stationRing.elementCount = 1;
-  stationRing.elements = stationElements;
-  radialDisplay->drawRing(centerX, centerY, stationRing);
-  
+void NYCMTATransitMode::drawRadialTransitDisplay(const StationData& data, TextTransition transition) {
   // 2nd Ring: Direction indicator
-  String direction = (currentState == TRANSIT_UPTOWN) ? "UPTOWN" : "DOWNTOWN";
-  RadialElement directionElements[1];
-  directionElements[0] = radialDisplay->createTextElement(0, direction, ST77XX_BLACK);
-  
-  RadialRing directionRing = radialDisplay->createTextRing(70, 2, ST77XX_BLACK);
-  directionRing.elementCount = 1;
-  directionRing.elements = directionElements;
-  radialDisplay->drawRing(centerX, centerY, directionRing);
+  directionElements[0].content = (currentState == TRANSIT_UPTOWN) ? uptownLabel : downtownLabel;
   
   // 3rd Ring: Train arrival times
-  TrainArrival* arrivals = (currentState == TRANSIT_UPTOWN) ? data.uptown : data.downtown;
+  const TrainArrival* arrivals = (currentState == TRANSIT_UPTOWN) ? data.uptown : data.downtown;
   int validCount = 0;
-  RadialElement timeElements[3];
   
-  for (int i = 0; i < 3 && validCount < 3; i++) {
-    if (arrivals[i].isValid) {
-      float angle = 90 + (validCount * 120); // 90, 210, 330 degrees
-      String timeText = String(arrivals[i].minutesAway) + "m";
-      timeElements[validCount] = radialDisplay->createCircleElement(angle, timeText, ST77XX_WHITE, 20);
+  for (int i = 0; i < TRAINS_PER_DIRECTION && validCount < 3; i++) {
+    if (arrivals[i].isValid && !mtaManager->hasDeparted(arrivals[i])) {
+      FixedString<7> countdown;
+      countdown.format("%dm", mtaManager->minutesUntil(arrivals[i]));
+      animator->changeText(rings[0], validCount, countdown.c_str(), transition, COUNTDOWN_SLIDE_MS);
+      redrawMs = min(redrawMs, mtaManager->msUntilChange(arrivals[i]));
       validCount++;
     }
   }
   
-  if (validCount > 0) {
-    RadialRing timeRing = radialDisplay->createCircleRing(95, 20, ST77XX_WHITE, ST77XX_BLACK);
-    timeRing.elementCount = validCount;
-    timeRing.elements = timeElements;
-    timeRing.autoSpacing = false;
-    timeRing.textSize = 2;
-    radialDisplay->drawRing(centerX, centerY, timeRing);
-  }
-}
\ No newline at end of file
+  rings[0].elementCount = validCount;
+  rings[0].isVisible = validCount > 0;
+  
+  // Only the elements that changed since the last draw are repainted
+  radialDisplay->drawRadialLayout(scene);
+}
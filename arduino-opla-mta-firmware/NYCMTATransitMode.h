@@ -13,7 +13,20 @@ class NYCMTATransitMode : public BaseMode {
 private:
   MTAManager* mtaManager;
   TransitState currentState;
-  String stationId;
+  int stationIndex;        // Into MTA_CONFIGS
+  uint32_t drawnVersion;   // Station data version on screen
+  unsigned long drawnAt;   // millis() of the last draw
+  uint32_t redrawMs;       // After drawnAt, when a countdown on screen changes
+  const char* uptownLabel; // Direction labels, from the transit tables
+  const char* downtownLabel;
+  
+  // Retained radial scene; rings[0] is painted last so it stays on top
+  RadialDisplayConfig scene;
+  RadialRing rings[4];
+  RadialElement centerElements[1];
+  RadialElement stationElements[1];
+  RadialElement directionElements[1];
+  RadialElement timeElements[3];
   
 public:
   NYCMTATransitMode(MKRIoTCarrier* carrierPtr, MTAManager* mtaPtr);
@@ -22,11 +35,14 @@ public:
   void update() override;
   void exit() override;
   void handleButtonPress(int buttonIndex) override;
-  String getName() override { return "NYC MTA Transit"; }
+  const char* getName() override { return "NYC MTA Transit"; }
   
 private:
-  void displayTransit();
-  void drawRadialTransitDisplay();
+  void buildScene();
+  void applyStation();
+  void nextStation();
+  void displayTransit(TextTransition transition = TEXT_SLIDE);
+  void drawRadialTransitDisplay(const StationData& data, TextTransition transition);
   void updateTransitState();
 };
 
@@ -0,0 +1,124 @@
+#include "Profiler.h"
+
+#if PROFILER_ENABLED
+#include "StationSummary.h"
+
+static const char* const PROBE_NAMES[PROBE_COUNT] = {
+  "loop", "drawRadialLayout", "drawRing", "displayWeather", "displayTransit",
+  "mtaUpdate", "parseTrainData", "parseSummary"
+};
+
+static const int CALIBRATION_ROUNDS = 16;
+
+ProbeStats Profiler::probes[PROBE_COUNT];
+uint32_t Profiler::resetMs = 0;
+uint32_t Profiler::overheadTicks = 0;
+
+void Profiler::begin() {
+  // A probe times one read of the clock on top of its code; the quickest of
+  // a few back-to-back reads is that cost without interrupts in the way
+  overheadTicks = 0xFFFFFFFF;
+  for (int i = 0; i < CALIBRATION_ROUNDS; i++) {
+    uint32_t start = profileTicks();
+    uint32_t ticks = profileTicks() - start;
+    if (ticks < overheadTicks) overheadTicks = ticks;
+  }
+  reset();
+}
+
+void Profiler::reset() {
+  memset(probes, 0, sizeof(probes));
+  resetMs = millis();
+}
+
+const char* Profiler::getName(ProfileProbe probe) {
+  return PROBE_NAMES[probe];
+}
+
+void Profiler::record(ProfileProbe probe, uint32_t ticks) {
+  ProbeStats& stats = probes[probe];
+  if (stats.count == 0 || ticks < stats.minTicks) stats.minTicks = ticks;
+  if (ticks > stats.maxTicks) stats.maxTicks = ticks;
+  stats.count++;
+  stats.totalTicks += ticks;
+
+  int bucket = ticks > 1 ? 31 - __builtin_clz(ticks) : 0;
+  if (stats.buckets[bucket] < 0xFFFF) stats.buckets[bucket]++;
+}
+
+// Writes little-endian fields, keeping the CRC of everything written
+class RecordWriter {
+private:
+  Print& out;
+  uint32_t crc;
+
+public:
+  RecordWriter(Print& target) : out(target), crc(0) {}
+
+  void bytes(const void* data, size_t length) {
+    out.write((const uint8_t*)data, length);
+    crc = stationSummaryCrc(crc, (const uint8_t*)data, length);
+  }
+
+  void u8(uint8_t value) { bytes(&value, 1); }
+  void u16(uint16_t value) {
+    uint8_t le[2] = {(uint8_t)value, (uint8_t)(value >> 8)};
+    bytes(le, sizeof(le));
+  }
+  void u32(uint32_t value) {
+    uint8_t le[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    bytes(le, sizeof(le));
+  }
+  void u64(uint64_t value) {
+    u32((uint32_t)value);
+    u32((uint32_t)(value >> 32));
+  }
+
+  uint32_t getCrc() { return crc; }
+};
+
+// Only the buckets from the first to the last in use are sent
+static void usedBuckets(const ProbeStats& stats, int& first, int& count) {
+  first = 0;
+  while (first < PROFILE_BUCKETS && stats.buckets[first] == 0) first++;
+  int last = PROFILE_BUCKETS - 1;
+  while (last >= first && stats.buckets[last] == 0) last--;
+  count = last - first + 1;
+}
+
+size_t Profiler::dump(Print& out) {
+  size_t length = PROFILE_HEADER_BYTES + 4;
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    int first, count;
+    usedBuckets(probes[i], first, count);
+    length += 1 + strlen(PROBE_NAMES[i]) + PROFILE_PROBE_BYTES + 2 * count;
+  }
+
+  RecordWriter writer(out);
+  writer.bytes(PROFILE_MAGIC, sizeof(PROFILE_MAGIC));
+  writer.u8(PROFILE_VERSION);
+  writer.u8(PROBE_COUNT);
+  writer.u16((uint16_t)length);
+  writer.u32(PROFILE_TICKS_PER_SECOND);
+  writer.u32(millis() - resetMs);
+  writer.u32(overheadTicks);
+
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    const ProbeStats& stats = probes[i];
+    int first, count;
+    usedBuckets(stats, first, count);
+    writer.u8(strlen(PROBE_NAMES[i]));
+    writer.bytes(PROBE_NAMES[i], strlen(PROBE_NAMES[i]));
+    writer.u32(stats.count);
+    writer.u32(stats.minTicks);
+    writer.u32(stats.maxTicks);
+    writer.u64(stats.totalTicks);
+    writer.u8(first);
+    writer.u8(count);
+    for (int b = first; b < first + count; b++) writer.u16(stats.buckets[b]);
+  }
+  writer.u32(writer.getCrc());
+  return length;
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Profiler for Arduino Opla MTA Firmware
+ * Scoped timing probes on the hot paths. PROFILE_SCOPE(probe) times the
+ * rest of the enclosing block and adds it to that probe's count, min, max,
+ * total and a histogram of powers of two. Probes compile to nothing unless
+ * PROFILER_ENABLED is 1 (config.h, or make compile PROFILE=1).
+ *
+ * Ticks are CPU cycles on the board, read from SysTick and millis(), and
+ * nanoseconds from clock_gettime() on the host. Probes nest; each reports
+ * the time inside it, nested probes included.
+ *
+ * Profiler::dump() writes every probe as one binary record, decoded on the
+ * host by sim/tools/profile_decode.cpp. All integers are little-endian.
+ *
+ *   Header, PROFILE_HEADER_BYTES:
+ *     0   4  magic "OPRF"
+ *     4   1  format version (PROFILE_VERSION)
+ *     5   1  probes
+ *     6   2  bytes in the record, CRC included
+ *     8   4  ticks per second
+ *     12  4  milliseconds the counters cover
+ *     16  4  ticks a probe adds around the code it times
+ *   Probes, each:
+ *     0   1  name length, then that many bytes of name
+ *     +0  4  count
+ *     +4  4  fewest ticks, 0 without samples
+ *     +8  4  most ticks
+ *     +12 8  total ticks
+ *     +20 1  first histogram bucket sent; bucket b counts 2^b to 2^(b+1)-1 ticks
+ *     +21 1  buckets sent, n
+ *     +22 2n bucket counts, stopping at 65535
+ *   CRC-32 of every byte before it, as in StationSummary.h, 4 bytes
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+#ifndef ARDUINO_ARCH_SAMD
+#include <time.h>
+#endif
+
+enum ProfileProbe {
+  PROBE_LOOP,               // Tasks run by a loop() iteration; touches are handled in its sleep
+  PROBE_DRAW_LAYOUT,        // RadialDisplay::drawRadialLayout()
+  PROBE_DRAW_RING,          // One ring into one strip
+  PROBE_DISPLAY_WEATHER,    // AmbientDataMode::displayWeather()
+  PROBE_DISPLAY_TRANSIT,    // NYCMTATransitMode::displayTransit()
+  PROBE_MTA_UPDATE,         // MTAManager::update(): a fetch poll or the staleness scan
+  PROBE_PARSE_TRAIN_DATA,   // JSON arrivals off the socket, over the polls they take
+  PROBE_PARSE_SUMMARY,      // Binary station summary off the socket, likewise
+  PROBE_COUNT
+};
+
+const uint8_t PROFILE_MAGIC[4] = {'O', 'P', 'R', 'F'};
+const uint8_t PROFILE_VERSION = 1;
+const int PROFILE_HEADER_BYTES = 20;
+const int PROFILE_PROBE_BYTES = 22;       // Before its name and buckets
+const int PROFILE_BUCKETS = 32;
+
+// Serial command bytes, read by the sketch
+const char PROFILE_DUMP_COMMAND = 'P';
+const char PROFILE_RESET_COMMAND = 'R';
+
+#ifdef ARDUINO_ARCH_SAMD
+const uint32_t PROFILE_TICKS_PER_SECOND = F_CPU;
+
+// SysTick counts down from LOAD to 0 every millisecond, and the core counts
+// its wraps in millis(); together they give cycles. A wrap between the two
+// reads changes millis(), so that read is retried. Wraps every 89 s at
+// 48 MHz, which only matters for probes longer than that.
+inline uint32_t profileTicks() {
+  uint32_t ms, remaining;
+  do {
+    ms = millis();
+    remaining = SysTick->VAL;
+  } while (ms != millis());
+  return ms * (SysTick->LOAD + 1) + (SysTick->LOAD - remaining);
+}
+#else
+const uint32_t PROFILE_TICKS_PER_SECOND = 1000000000;
+
+inline uint32_t profileTicks() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+}
+#endif
+
+struct ProbeStats {
+  uint32_t count;
+  uint32_t minTicks;
+  uint32_t maxTicks;
+  uint64_t totalTicks;
+  uint16_t buckets[PROFILE_BUCKETS];
+};
+
+class Profiler {
+private:
+  static ProbeStats probes[PROBE_COUNT];
+  static uint32_t resetMs;
+  static uint32_t overheadTicks;
+
+public:
+  // Measures the probes' own cost and clears the counters
+  static void begin();
+  static void reset();
+
+  static void record(ProfileProbe probe, uint32_t ticks);
+  static const ProbeStats& getStats(ProfileProbe probe) { return probes[probe]; }
+  static const char* getName(ProfileProbe probe);
+
+  // Writes the binary record; returns its length
+  static size_t dump(Print& out);
+};
+
+// Times from its construction to the end of the enclosing block
+class ProfileScope {
+private:
+  ProfileProbe probe;
+  uint32_t start;
+
+public:
+  ProfileScope(ProfileProbe timedProbe) : probe(timedProbe), start(profileTicks()) {}
+  ~ProfileScope() { Profiler::record(probe, profileTicks() - start); }
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE_NAME(line) profileScope##line
+#define PROFILE_SCOPE_AT(probe, line) ProfileScope PROFILE_SCOPE_NAME(line)(probe)
+#define PROFILE_SCOPE(probe) PROFILE_SCOPE_AT(probe, __LINE__)
+#else
+#define PROFILE_SCOPE(probe)
+#endif
+
+#endif
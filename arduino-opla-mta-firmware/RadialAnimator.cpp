@@ -0,0 +1,293 @@
+#include "RadialAnimator.h"
+#include "GlyphAtlas.h"
+
+AnimatorStats RadialAnimator::stats = {0};
+
+// Frames this far within budget count toward speeding back up
+static const uint32_t QUICK_FRAME_PERCENT = 25;
+
+RadialAnimator::RadialAnimator(RadialDisplay* displayPtr) {
+  display = displayPtr;
+  scene = nullptr;
+  for (int i = 0; i < ANIMATOR_MAX_TWEENS; i++) {
+    tweens[i].inUse = false;
+  }
+  frameMs = ANIMATION_FRAME_MS;
+  quickFrames = 0;
+  running = false;
+  lastFrameMs = 0;
+}
+
+void RadialAnimator::setScene(RadialDisplayConfig* scenePtr) {
+  scene = scenePtr;
+}
+
+RadialAnimator::Tween* RadialAnimator::findTween(void* target) {
+  for (int i = 0; i < ANIMATOR_MAX_TWEENS; i++) {
+    if (tweens[i].inUse && tweens[i].target == target) return &tweens[i];
+  }
+  return nullptr;
+}
+
+RadialAnimator::Tween* RadialAnimator::startTween(void* target, TweenKind kind, uint32_t durationMs,
+                                                  TweenEasing easing) {
+  Tween* tween = findTween(target);
+  for (int i = 0; !tween && i < ANIMATOR_MAX_TWEENS; i++) {
+    if (!tweens[i].inUse) tween = &tweens[i];
+  }
+  if (!tween) return nullptr;
+
+  tween->inUse = true;
+  tween->repeat = false;
+  tween->kind = kind;
+  tween->easing = easing;
+  tween->target = target;
+  tween->startMs = millis();
+  tween->durationMs = durationMs > 0 ? durationMs : 1;
+  return tween;
+}
+
+bool RadialAnimator::animate(float& value, float to, uint32_t durationMs, TweenEasing easing) {
+  Tween* tween = startTween(&value, TWEEN_FLOAT, durationMs, easing);
+  if (!tween) {
+    value = to;
+    return false;
+  }
+  tween->from = value;
+  tween->to = to;
+  return true;
+}
+
+bool RadialAnimator::animate(int& value, int to, uint32_t durationMs, TweenEasing easing) {
+  Tween* tween = startTween(&value, TWEEN_INT, durationMs, easing);
+  if (!tween) {
+    value = to;
+    return false;
+  }
+  tween->from = value;
+  tween->to = to;
+  return true;
+}
+
+bool RadialAnimator::animateColor(uint16_t& color, uint16_t to, uint32_t durationMs, TweenEasing easing) {
+  // Taking over a color tween starts again from the color on screen
+  Tween* tween = startTween(&color, TWEEN_COLOR, durationMs, easing);
+  if (!tween) {
+    color = to;
+    return false;
+  }
+  tween->from = color;
+  tween->to = to;
+  return true;
+}
+
+bool RadialAnimator::spin(float& angle, float degreesPerSecond) {
+  if (degreesPerSecond == 0) {
+    cancel(&angle);
+    return true;
+  }
+  Tween* tween = startTween(&angle, TWEEN_FLOAT, (uint32_t)(360000 / fabs(degreesPerSecond)), EASE_LINEAR);
+  if (!tween) return false;
+  tween->repeat = true;
+  tween->from = fmod(angle, 360);
+  tween->to = tween->from + (degreesPerSecond > 0 ? 360 : -360);
+  return true;
+}
+
+bool RadialAnimator::changeText(RadialRing& ring, int index, const char* text, TextTransition transition,
+                                uint32_t durationMs) {
+  RadialElement& element = ring.elements[index];
+  Tween* tween = findTween(&element);
+
+  if (tween) {
+    if (!tween->swapped) {
+      tween->text = text;       // The old text is still leaving; bring this one in instead
+      return true;
+    }
+    if (element.content == text) return true;
+  } else if (element.content == text) {
+    return true;
+  }
+
+  // Nothing to move away from: text that is not on screen, or no text yet
+  if (transition == TEXT_CUT || !display->isOnScreen() || element.content.isEmpty() ||
+      element.lastBounds.w == 0) {
+    if (tween) cancel(&element);
+    element.content = text;
+    element.textOffset = 0;
+    element.textFade = 0;
+    return true;
+  }
+
+  tween = startTween(&element, TWEEN_TEXT, durationMs, EASE_IN_OUT);
+  if (!tween) {
+    element.content = text;
+    return false;
+  }
+
+  // Far enough that the text clears the circle it is clipped to
+  int circleSize = element.size > 0 ? element.size : 15;
+  tween->transition = transition;
+  tween->distance = (int8_t)min(circleSize + GLYPH_HEIGHT * ring.textSize / 2 + 1, 127);
+  tween->swapped = false;
+  tween->text = text;
+  tween->from = 0;
+  tween->to = 1;
+  return true;
+}
+
+void RadialAnimator::cancel(void* target) {
+  Tween* tween = findTween(target);
+  if (!tween) return;
+  if (tween->kind == TWEEN_TEXT) {
+    RadialElement* element = (RadialElement*)tween->target;
+    if (!tween->swapped) element->content = tween->text;
+    element->textOffset = 0;
+    element->textFade = 0;
+  }
+  tween->inUse = false;
+}
+
+void RadialAnimator::complete(Tween& tween) {
+  switch (tween.kind) {
+    case TWEEN_FLOAT:
+      // A spin stops wherever it is
+      if (!tween.repeat) *(float*)tween.target = tween.to;
+      break;
+    case TWEEN_INT:
+      *(int*)tween.target = (int)tween.to;
+      break;
+    case TWEEN_COLOR:
+      *(uint16_t*)tween.target = (uint16_t)tween.to;
+      break;
+    case TWEEN_TEXT:
+      cancel(tween.target);
+      break;
+  }
+  tween.inUse = false;
+}
+
+void RadialAnimator::finish() {
+  for (int i = 0; i < ANIMATOR_MAX_TWEENS; i++) {
+    if (tweens[i].inUse) complete(tweens[i]);
+  }
+}
+
+bool RadialAnimator::isAnimating() {
+  for (int i = 0; i < ANIMATOR_MAX_TWEENS; i++) {
+    if (tweens[i].inUse) return true;
+  }
+  return false;
+}
+
+bool RadialAnimator::advance(Tween& tween, uint32_t nowMs) {
+  uint32_t elapsed = nowMs - tween.startMs;
+  if (elapsed >= tween.durationMs) {
+    if (!tween.repeat) {
+      complete(tween);
+      return false;
+    }
+    elapsed %= tween.durationMs;
+  }
+
+  float progress = (float)elapsed / tween.durationMs;
+  if (tween.easing == EASE_IN_OUT) {
+    progress = progress * progress * (3 - 2 * progress);
+  }
+
+  switch (tween.kind) {
+    case TWEEN_FLOAT:
+      *(float*)tween.target = tween.from + (tween.to - tween.from) * progress;
+      break;
+
+    case TWEEN_INT:
+      *(int*)tween.target = (int)lroundf(tween.from + (tween.to - tween.from) * progress);
+      break;
+
+    case TWEEN_COLOR:
+      *(uint16_t*)tween.target = blendColors((uint16_t)tween.from, (uint16_t)tween.to,
+                                             (uint8_t)(progress * 255));
+      break;
+
+    case TWEEN_TEXT: {
+      // Out over the first half, swap, back in over the second
+      RadialElement* element = (RadialElement*)tween.target;
+      float away;
+      if (progress < 0.5f) {
+        away = progress * 2;
+      } else {
+        if (!tween.swapped) {
+          element->content = tween.text;
+          tween.swapped = true;
+        }
+        away = 2 - progress * 2;
+      }
+      int offset = (int)(tween.distance * away);
+      element->textOffset = tween.transition != TEXT_SLIDE ? 0 : tween.swapped ? offset : -offset;
+      element->textFade = tween.transition == TEXT_FADE ? (uint8_t)(away * 255) : 0;
+      break;
+    }
+  }
+  return true;
+}
+
+uint32_t RadialAnimator::renderFrame() {
+  uint32_t nowMs = millis();
+  if (!scene || !isAnimating()) {
+    running = false;
+    return 0;
+  }
+
+  // Frames the target rate called for since the last one, and did not get;
+  // the first frame of a run takes a whole frame's time of its own
+  if (running) {
+    uint32_t sinceLast = nowMs - lastFrameMs;
+    stats.animatingMs += sinceLast;
+    if (sinceLast >= 2 * ANIMATION_FRAME_MS) {
+      stats.droppedFrames += sinceLast / ANIMATION_FRAME_MS - 1;
+    }
+  } else {
+    stats.animatingMs += frameMs;
+  }
+  running = true;
+  lastFrameMs = nowMs;
+
+  for (int i = 0; i < ANIMATOR_MAX_TWEENS; i++) {
+    if (tweens[i].inUse) advance(tweens[i], nowMs);
+  }
+
+  uint32_t start = micros();
+  display->drawRadialLayout(*scene);
+  uint32_t frameMicros = micros() - start;
+  stats.frames++;
+  if (frameMicros > stats.maxFrameMicros) stats.maxFrameMicros = frameMicros;
+
+  // Too slow for this rate: halve it, and past the slowest rate give up on
+  // the motion and show where it was going
+  if (frameMicros > (uint32_t)frameMs * 1000) {
+    stats.overruns++;
+    quickFrames = 0;
+    if (frameMs < ANIMATION_SLOWEST_FRAME_MS) {
+      frameMs = min(frameMs * 2, (int)ANIMATION_SLOWEST_FRAME_MS);
+    } else {
+      for (int i = 0; i < ANIMATOR_MAX_TWEENS; i++) {
+        if (tweens[i].inUse && !tweens[i].repeat) {
+          complete(tweens[i]);
+          stats.snapped++;
+        }
+      }
+      display->drawRadialLayout(*scene);
+    }
+  } else if (frameMs > ANIMATION_FRAME_MS && frameMicros < (uint32_t)frameMs * 10 * QUICK_FRAME_PERCENT &&
+             ++quickFrames >= ANIMATION_RECOVERY_FRAMES) {
+    frameMs = max(frameMs / 2, (int)ANIMATION_FRAME_MS);
+    quickFrames = 0;
+  }
+
+  if (!isAnimating()) {
+    running = false;
+    return 0;
+  }
+  uint32_t spentMs = millis() - nowMs;
+  return spentMs < frameMs ? frameMs - spentMs : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ * Radial animation for Arduino Opla MTA Firmware
+ * Tweens fields of a retained radial scene (element angles, ring rotation,
+ * colors, arc sweeps) and countdown text changes, and draws frames at a
+ * steady rate while any are running. Tweens follow the clock, not the
+ * frame count, so a late or dropped frame never slows the motion down.
+ * A frame that overruns its budget halves the frame rate; at the slowest
+ * rate the tweens jump to their ends rather than stutter on. Frames are
+ * drawn through drawRadialLayout(), so only what moved is repainted.
+ */
+
+#ifndef RADIALANIMATOR_H
+#define RADIALANIMATOR_H
+
+#include <Arduino.h>
+#include "RadialDisplay.h"
+
+const int ANIMATOR_MAX_TWEENS = 8;
+const uint16_t ANIMATION_FRAME_MS = 33;            // 30 fps
+const uint16_t ANIMATION_SLOWEST_FRAME_MS = 132;   // 7.5 fps, after two halvings
+const int ANIMATION_RECOVERY_FRAMES = 8;           // Quick frames before speeding up again
+
+enum TweenEasing {
+  EASE_LINEAR,
+  EASE_IN_OUT       // Smoothstep: starts and stops gently
+};
+
+// How RING_CIRCLES text changes: the old text leaves in the first half of
+// the transition and the new one arrives in the second
+enum TextTransition {
+  TEXT_CUT,         // At once
+  TEXT_SLIDE,       // Out through the top of the circle, in from the bottom
+  TEXT_FADE         // Into the circle's fill and back out
+};
+
+// Totals over every animator, since they all share the one screen
+struct AnimatorStats {
+  uint32_t frames;          // Frames drawn
+  uint32_t droppedFrames;   // Frames the 30 fps target called for that were not drawn
+  uint32_t overruns;        // Frames that took longer than their budget
+  uint32_t snapped;         // Tweens jumped to the end at the slowest frame rate
+  uint32_t animatingMs;     // Time with tweens running
+  uint32_t maxFrameMicros;
+};
+
+class RadialAnimator {
+private:
+  enum TweenKind { TWEEN_FLOAT, TWEEN_INT, TWEEN_COLOR, TWEEN_TEXT };
+
+  struct Tween {
+    bool inUse;
+    bool repeat;            // Restart from the beginning when done
+    TweenKind kind;
+    TweenEasing easing;
+    void* target;           // float, int, uint16_t color, or RadialElement
+    float from, to;
+    uint32_t startMs;
+    uint32_t durationMs;
+
+    // TWEEN_TEXT
+    TextTransition transition;
+    int8_t distance;        // Pixels a sliding text travels
+    bool swapped;           // The new text is showing
+    FixedString<23> text;
+  };
+
+  RadialDisplay* display;
+  RadialDisplayConfig* scene;
+  Tween tweens[ANIMATOR_MAX_TWEENS];
+  uint16_t frameMs;         // Current frame interval, longer after overruns
+  int quickFrames;          // Consecutive frames well within budget
+  bool running;
+  uint32_t lastFrameMs;
+
+  static AnimatorStats stats;
+
+  Tween* findTween(void* target);
+  Tween* startTween(void* target, TweenKind kind, uint32_t durationMs, TweenEasing easing);
+  bool advance(Tween& tween, uint32_t nowMs);   // False once it is done
+  void complete(Tween& tween);
+
+public:
+  RadialAnimator(RadialDisplay* displayPtr);
+
+  // The scene frames are drawn from
+  void setScene(RadialDisplayConfig* scenePtr);
+
+  // Tween a scene field from its current value. A field already tweening
+  // is taken over from where it is. With every slot busy the field jumps
+  // to its end value and false is returned.
+  bool animate(float& value, float to, uint32_t durationMs, TweenEasing easing = EASE_IN_OUT);
+  bool animate(int& value, int to, uint32_t durationMs, TweenEasing easing = EASE_IN_OUT);
+  bool animateColor(uint16_t& color, uint16_t to, uint32_t durationMs, TweenEasing easing = EASE_IN_OUT);
+
+  // Turns an angle, such as a ring's rotation, until cancelled
+  bool spin(float& angle, float degreesPerSecond);
+
+  // Changes a RING_CIRCLES element's text. Text that is not on screen yet
+  // changes at once; a change during a transition that has not reached
+  // its new text just retargets it.
+  bool changeText(RadialRing& ring, int index, const char* text, TextTransition transition,
+                  uint32_t durationMs);
+
+  void cancel(void* target);      // Stops a tween where it is
+  void finish();                  // Jumps every tween to its end
+
+  bool isAnimating();
+
+  // Advances every tween to now and draws the scene; returns milliseconds
+  // until the next frame is due, 0 once nothing is animating
+  uint32_t renderFrame();
+
+  uint16_t getFrameMs() { return frameMs; }
+  static const AnimatorStats& getStats() { return stats; }
+};
+
+#endif
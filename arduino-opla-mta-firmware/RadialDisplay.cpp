@@ -1,39 +1,479 @@
 #include "RadialDisplay.h"
+#include "Profiler.h"
+#include "MemoryMonitor.h"
 #include <math.h>
 
-RadialDisplay::RadialDisplay(MKRIoTCarrier* carrierPtr) {
+RadialDisplay* RadialDisplay::screenOwner = nullptr;
+
+// FNV-1a, used to fingerprint everything that affects how something is drawn
+static const uint32_t SIGNATURE_SEED = 2166136261UL;
+
+static uint32_t hashBytes(uint32_t hash, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+template <typename T> static uint32_t hashValue(uint32_t hash, T value) {
+  return hashBytes(hash, &value, sizeof(value));
+}
+
+static bool rectIsEmpty(const RadialRect& r) {
+  return r.w <= 0 || r.h <= 0;
+}
+
+static RadialRect rectUnion(const RadialRect& a, const RadialRect& b) {
+  if (rectIsEmpty(a)) return b;
+  if (rectIsEmpty(b)) return a;
+  int16_t x0 = min(a.x, b.x);
+  int16_t y0 = min(a.y, b.y);
+  int16_t x1 = max(a.x + a.w, b.x + b.w);
+  int16_t y1 = max(a.y + a.h, b.y + b.h);
+  RadialRect r = {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+  return r;
+}
+
+// True if the rectangles overlap or are within margin pixels of each other
+static bool rectsTouch(const RadialRect& a, const RadialRect& b, int margin) {
+  return a.x - margin < b.x + b.w && b.x - margin < a.x + a.w &&
+         a.y - margin < b.y + b.h && b.y - margin < a.y + a.h;
+}
+
+static RadialRect squareAround(int x, int y, int radius) {
+  RadialRect r = {(int16_t)(x - radius), (int16_t)(y - radius),
+                  (int16_t)(2 * radius + 1), (int16_t)(2 * radius + 1)};
+  return r;
+}
+
+// Text under the middle of a ring runs counter-clockwise, so it reads left
+// to right and never upside down
+static bool readsCounterClockwise(float angle) {
+  BinaryAngle position = angleFromDegrees(angle);
+  return position > ANGLE_QUARTER_TURN && position < 3 * ANGLE_QUARTER_TURN;
+}
+
+// Binary angle spanned by a distance along a circle, in half pixels
+static int32_t arcSweep(int32_t halfPixels, int radius) {
+  return halfPixels * 5215 / radius;   // 65536 / (2 * pi * 2)
+}
+
+// Largest x with x * x <= value
+static int32_t isqrt(int32_t value) {
+  uint32_t remainder = value;
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > remainder) bit >>= 2;
+  while (bit) {
+    if (remainder >= root + bit) {
+      remainder -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+static int32_t floorDiv(int32_t n, int32_t d) {
+  return n >= 0 ? n / d : -((-n + d - 1) / d);
+}
+
+// Integers x with a * x + b >= 0, as [lo, hi]; lo > hi when there are none
+static void halfPlaneRange(int32_t a, int32_t b, int& lo, int& hi) {
+  const int UNBOUNDED = RADIAL_SCREEN_WIDTH * 2;
+  lo = -UNBOUNDED;
+  hi = UNBOUNDED;
+  if (a > 0) {
+    lo = -floorDiv(b, a);
+  } else if (a < 0) {
+    hi = floorDiv(b, -a);
+  } else if (b < 0) {
+    lo = UNBOUNDED;
+  }
+}
+
+RadialDisplay::RadialDisplay(MKRIoTCarrier* carrierPtr)
+  : target(&carrierPtr->display, RADIAL_SCREEN_WIDTH, RADIAL_SCREEN_HEIGHT) {
   carrier = carrierPtr;
+  needsFullRedraw = true;
+  dirtyCount = 0;
+  memset(&stats, 0, sizeof(stats));
 }
 
 void RadialDisplay::clear(uint16_t backgroundColor) {
-  carrier->display.fillScreen(backgroundColor);
+  target.fillScreen(backgroundColor);
+  screenOwner = nullptr;
+}
+
+void RadialDisplay::invalidate() {
+  needsFullRedraw = true;
+}
+
+bool RadialDisplay::isOnScreen() {
+  return screenOwner == this && !needsFullRedraw;
+}
+
+uint16_t blendColors(uint16_t from, uint16_t to, uint8_t amount) {
+  // Each channel separately, so red never borrows from green
+  int32_t red = from >> 11, green = (from >> 5) & 0x3F, blue = from & 0x1F;
+  red += (((int32_t)(to >> 11) - red) * amount + 127) / 255;
+  green += (((int32_t)((to >> 5) & 0x3F) - green) * amount + 127) / 255;
+  blue += (((int32_t)(to & 0x1F) - blue) * amount + 127) / 255;
+  return (uint16_t)((red << 11) | (green << 5) | blue);
 }
 
 void RadialDisplay::calculatePosition(int centerX, int centerY, int radius, float angle, int& x, int& y) {
-  float radians = (angle - 90) * PI / 180.0; // -90 to start from top (0°)
-  x = centerX + (radius * cos(radians));
-  y = centerY + (radius * sin(radians));
+  polarToCartesian(centerX, centerY, radius, angleFromDegrees(angle), x, y);
+}
+
+float RadialDisplay::elementAngle(RadialRing& ring, int index) {
+  if (!ring.autoSpacing) {
+    return ring.elements[index].angle + ring.rotation;
+  }
+
+  // Auto-calculate angle based on position in array
+  float angleRange = ring.endAngle - ring.startAngle;
+  if (angleRange <= 0) angleRange = 360; // Full circle
+  return ring.startAngle + ring.rotation + (index * angleRange / ring.elementCount);
 }
 
 void RadialDisplay::drawRadialLayout(RadialDisplayConfig& config) {
-  // Clear screen
-  clear(config.backgroundColor);
-  
-  // Draw each ring from outermost to innermost
-  for (int i = config.ringCount - 1; i >= 0; i--) {
-    drawRing(config.centerX, config.centerY, config.rings[i]);
+  PROFILE_SCOPE(PROBE_DRAW_LAYOUT);
+  MEMORY_SCOPE(MEMORY_DISPLAY);
+  uint32_t signature = configSignature(config);
+  bool fullRedraw = needsFullRedraw || screenOwner != this || signature != config.lastSignature;
+
+  if (!fullRedraw) {
+    dirtyCount = 0;
+    collectDirtyRects(config);
+
+    if (dirtyCount == 0) {
+      stats.unchangedFrames++;
+      return;
+    }
+
+    // Past half the screen, one clear is cheaper than many region repaints
+    uint32_t dirtyArea = 0;
+    for (int i = 0; i < dirtyCount; i++) {
+      dirtyArea += (uint32_t)dirtyRects[i].w * dirtyRects[i].h;
+    }
+    fullRedraw = dirtyArea > (uint32_t)RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT / 2;
+  }
+
+  if (fullRedraw) {
+    RadialRect screen = {0, 0, RADIAL_SCREEN_WIDTH, RADIAL_SCREEN_HEIGHT};
+    repaintRegion(config, screen);
+    stats.fullRedraws++;
+    stats.repaintedPixels += (uint32_t)RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT;
+  } else {
+    for (int i = 0; i < dirtyCount; i++) {
+      repaintRegion(config, dirtyRects[i]);
+      stats.repaintedPixels += (uint32_t)dirtyRects[i].w * dirtyRects[i].h;
+    }
+    stats.partialRedraws++;
   }
+
+  config.lastSignature = signature;
+  commitFrame(config);
+  needsFullRedraw = false;
+  screenOwner = this;
+}
+
+void RadialDisplay::repaintRegion(RadialDisplayConfig& config, RadialRect region) {
+  // Composite the region off-screen one strip at a time; every pixel in it
+  // is sent exactly once, however many layers cover it
+  for (target.beginRegion(region.x, region.y, region.w, region.h); target.nextStrip(); ) {
+    target.fillRect(region.x, region.y, region.w, region.h, config.backgroundColor);
+
+    // Draw each ring that reaches into the strip, from outermost to innermost
+    for (int i = config.ringCount - 1; i >= 0; i--) {
+      RadialRing& ring = config.rings[i];
+      if (!ring.isVisible) continue;
+
+      RadialRect bounds = ringBounds(config.centerX, config.centerY, ring);
+      if (target.stripIntersects(bounds.x, bounds.y, bounds.w, bounds.h)) {
+        drawRingContent(config.centerX, config.centerY, ring);
+      }
+    }
+  }
+}
+
+void RadialDisplay::collectDirtyRects(RadialDisplayConfig& config) {
+  for (int i = 0; i < config.ringCount; i++) {
+    RadialRing& ring = config.rings[i];
+
+    // Ring-level change (geometry, colors, element count): repaint it whole
+    if (ringSignature(ring) != ring.lastSignature) {
+      addDirtyRect(ring.lastBounds);
+      if (ring.isVisible) {
+        addDirtyRect(ringBounds(config.centerX, config.centerY, ring));
+      }
+      continue;
+    }
+
+    if (!ring.isVisible) continue;
+
+    for (int j = 0; j < ring.elementCount; j++) {
+      RadialElement& element = ring.elements[j];
+      if (elementSignature(ring, j) != element.lastSignature) {
+        addDirtyRect(element.lastBounds);
+        if (element.isVisible) {
+          addDirtyRect(elementBounds(config.centerX, config.centerY, ring, j));
+        }
+      }
+    }
+
+    if (ring.type == RadialRing::RING_SPARKLINE && ring.drawnSamples) {
+      for (int j = 0; j < ring.sampleCount; j++) {
+        if (ring.samples[j] == ring.drawnSamples[j]) continue;
+        int inner, outer;
+        float startAngle, endAngle;
+        sparklineBar(ring, j, inner, outer, startAngle, endAngle);
+        addDirtyRect(sectorBounds(config.centerX, config.centerY, inner, outer, startAngle, endAngle));
+      }
+    }
+  }
+}
+
+void RadialDisplay::commitFrame(RadialDisplayConfig& config) {
+  RadialRect empty = {0, 0, 0, 0};
+
+  for (int i = 0; i < config.ringCount; i++) {
+    RadialRing& ring = config.rings[i];
+    ring.lastSignature = ringSignature(ring);
+    ring.lastBounds = ring.isVisible ? ringBounds(config.centerX, config.centerY, ring) : empty;
+
+    for (int j = 0; j < ring.elementCount; j++) {
+      RadialElement& element = ring.elements[j];
+      element.lastSignature = elementSignature(ring, j);
+      element.lastBounds = (ring.isVisible && element.isVisible)
+        ? elementBounds(config.centerX, config.centerY, ring, j) : empty;
+    }
+
+    if (ring.type == RadialRing::RING_SPARKLINE && ring.drawnSamples) {
+      memcpy(ring.drawnSamples, ring.samples, ring.sampleCount);
+    }
+  }
+}
+
+void RadialDisplay::addDirtyRect(RadialRect rect) {
+  // Clip to the screen
+  RadialRect screen = {0, 0, RADIAL_SCREEN_WIDTH, RADIAL_SCREEN_HEIGHT};
+  int16_t x0 = max(rect.x, screen.x);
+  int16_t y0 = max(rect.y, screen.y);
+  int16_t x1 = min(rect.x + rect.w, screen.x + screen.w);
+  int16_t y1 = min(rect.y + rect.h, screen.y + screen.h);
+  if (x1 <= x0 || y1 <= y0) return;
+  rect.x = x0;
+  rect.y = y0;
+  rect.w = x1 - x0;
+  rect.h = y1 - y0;
+
+  // Merge with anything it overlaps, repeating until the set is disjoint
+  for (int i = 0; i < dirtyCount; i++) {
+    if (rectsTouch(dirtyRects[i], rect, 2)) {
+      rect = rectUnion(rect, dirtyRects[i]);
+      dirtyRects[i] = dirtyRects[--dirtyCount];
+      i = -1;
+    }
+  }
+
+  if (dirtyCount < MAX_DIRTY_RECTS) {
+    dirtyRects[dirtyCount++] = rect;
+    return;
+  }
+
+  // Out of slots: fold into whichever region grows the least
+  int best = 0;
+  uint32_t bestGrowth = 0xFFFFFFFF;
+  for (int i = 0; i < dirtyCount; i++) {
+    RadialRect merged = rectUnion(dirtyRects[i], rect);
+    uint32_t growth = (uint32_t)merged.w * merged.h - (uint32_t)dirtyRects[i].w * dirtyRects[i].h;
+    if (growth < bestGrowth) {
+      bestGrowth = growth;
+      best = i;
+    }
+  }
+  dirtyRects[best] = rectUnion(dirtyRects[best], rect);
+}
+
+uint32_t RadialDisplay::configSignature(RadialDisplayConfig& config) {
+  uint32_t hash = SIGNATURE_SEED;
+  hash = hashValue(hash, config.centerX);
+  hash = hashValue(hash, config.centerY);
+  hash = hashValue(hash, config.backgroundColor);
+  hash = hashValue(hash, config.ringCount);
+  return hash;
+}
+
+uint32_t RadialDisplay::ringSignature(RadialRing& ring) {
+  uint32_t hash = SIGNATURE_SEED;
+  hash = hashValue(hash, ring.isVisible);
+  hash = hashValue(hash, (int)ring.type);
+  hash = hashValue(hash, ring.radius);
+  hash = hashValue(hash, ring.thickness);
+  hash = hashValue(hash, ring.bgColor);
+  hash = hashValue(hash, ring.borderColor);
+  hash = hashValue(hash, ring.borderWidth);
+  hash = hashValue(hash, ring.textSize);
+  hash = hashValue(hash, ring.elementCount);
+  hash = hashValue(hash, ring.startAngle);
+  hash = hashValue(hash, ring.endAngle);
+  hash = hashValue(hash, ring.autoSpacing);
+  hash = hashValue(hash, ring.sampleCount);
+
+  // Element signatures carry the rotation, so a turning ring repaints only
+  // where its elements were and are; sparkline bars have no elements
+  if (ring.type == RadialRing::RING_SPARKLINE) {
+    hash = hashValue(hash, ring.rotation);
+  }
+  return hash;
+}
+
+uint32_t RadialDisplay::elementSignature(RadialRing& ring, int index) {
+  RadialElement& element = ring.elements[index];
+  uint32_t hash = SIGNATURE_SEED;
+  hash = hashValue(hash, element.isVisible);
+  hash = hashValue(hash, elementAngle(ring, index));
+  hash = hashValue(hash, element.color);
+  hash = hashValue(hash, element.size);
+  hash = hashValue(hash, element.textOffset);
+  hash = hashValue(hash, element.textFade);
+  hash = hashBytes(hash, element.content.c_str(), element.content.length());
+  return hash;
+}
+
+RadialRect RadialDisplay::textBounds(int x, int y, const char* text, int textSize) {
+  // Text is drawn centered on the point
+  int textWidth = glyphTextWidth(text, textSize);
+  RadialRect r = {(int16_t)(x - textWidth/2), (int16_t)(y - GLYPH_HEIGHT * textSize/2),
+                  (int16_t)textWidth, (int16_t)(GLYPH_HEIGHT * textSize)};
+  return r;
+}
+
+RadialRect RadialDisplay::arcTextBounds(int centerX, int centerY, RadialRing& ring, int index) {
+  RadialElement& element = ring.elements[index];
+  if (element.content.length() == 0) {
+    RadialRect empty = {0, 0, 0, 0};
+    return empty;
+  }
+
+  // The band the glyphs are centered in; corners of the end glyphs reach a
+  // little further round at its inner edge, so measure the sweep there
+  int halfHeight = GLYPH_HEIGHT * ring.textSize / 2;
+  int halfWidth = glyphTextWidth(element.content.c_str(), ring.textSize) / 2 + ring.textSize + 1;
+  float halfSweep = halfWidth * 57.29578f / max(ring.radius - halfHeight, 1);
+  float angle = elementAngle(ring, index);
+  return sectorBounds(centerX, centerY, max(ring.radius - halfHeight - 1, 0), ring.radius + halfHeight + 1,
+                      angle - halfSweep, angle + halfSweep);
+}
+
+RadialRect RadialDisplay::sectorBounds(int centerX, int centerY, int innerRadius, int outerRadius,
+                                       float startAngle, float endAngle) {
+  // Sample the ends and any compass points swept through, at both the
+  // inner and outer edge
+  RadialRect bounds = {0, 0, 0, 0};
+  int x, y;
+  for (int edge = 0; edge < 2; edge++) {
+    int radius = edge == 0 ? innerRadius : outerRadius;
+    calculatePosition(centerX, centerY, radius, startAngle, x, y);
+    bounds = rectUnion(bounds, squareAround(x, y, 1));
+    calculatePosition(centerX, centerY, radius, endAngle, x, y);
+    bounds = rectUnion(bounds, squareAround(x, y, 1));
+  }
+  for (float a = ceil(startAngle / 90) * 90; a <= endAngle; a += 90) {
+    calculatePosition(centerX, centerY, outerRadius, a, x, y);
+    bounds = rectUnion(bounds, squareAround(x, y, 1));
+  }
+  return bounds;
+}
+
+RadialRect RadialDisplay::elementBounds(int centerX, int centerY, RadialRing& ring, int index) {
+  RadialElement& element = ring.elements[index];
+  RadialRect empty = {0, 0, 0, 0};
+  int x, y;
+
+  switch (ring.type) {
+    case RadialRing::RING_TEXT_CIRCULAR:
+      calculatePosition(centerX, centerY, ring.radius, elementAngle(ring, index), x, y);
+      return textBounds(x, y, element.content.c_str(), ring.textSize);
+
+    case RadialRing::RING_TEXT_ARC:
+      return arcTextBounds(centerX, centerY, ring, index);
+
+    case RadialRing::RING_CIRCLES: {
+      calculatePosition(centerX, centerY, ring.radius, elementAngle(ring, index), x, y);
+      int circleSize = element.size > 0 ? element.size : 15;
+      RadialRect bounds = squareAround(x, y, circleSize);
+      if (element.content.length() > 0) {
+        bounds = rectUnion(bounds, textBounds(x, y, element.content.c_str(), ring.textSize));
+      }
+      return bounds;
+    }
+
+    case RadialRing::RING_ARCS: {
+      int outer = ring.radius + max(ring.thickness, 1) - 1;
+      float angle = element.angle + ring.rotation;
+      return sectorBounds(centerX, centerY, ring.radius, outer,
+                          angle - element.size/2, angle + element.size/2);
+    }
+
+    case RadialRing::RING_DOTS: {
+      calculatePosition(centerX, centerY, ring.radius, elementAngle(ring, index), x, y);
+      int dotSize = element.size > 0 ? element.size : 3;
+      return squareAround(x, y, dotSize);
+    }
+
+    case RadialRing::RING_BACKGROUND:
+    case RadialRing::RING_SPARKLINE:
+      break;
+  }
+  return empty;
+}
+
+RadialRect RadialDisplay::ringBounds(int centerX, int centerY, RadialRing& ring) {
+  RadialRect bounds = {0, 0, 0, 0};
+
+  if (ring.thickness > 0) {
+    bounds = rectUnion(bounds, squareAround(centerX, centerY, ring.radius + ring.thickness/2));
+  }
+  if (ring.borderWidth > 0) {
+    bounds = rectUnion(bounds, squareAround(centerX, centerY, ring.radius + ring.borderWidth - 1));
+  }
+
+  for (int i = 0; i < ring.elementCount; i++) {
+    if (ring.elements[i].isVisible) {
+      bounds = rectUnion(bounds, elementBounds(centerX, centerY, ring, i));
+    }
+  }
+  return bounds;
 }
 
 void RadialDisplay::drawRing(int centerX, int centerY, RadialRing& ring) {
+  drawRingContent(centerX, centerY, ring);
+
+  // Immediate-mode drawing: the screen no longer matches any retained scene
+  screenOwner = nullptr;
+}
+
+void RadialDisplay::drawRingContent(int centerX, int centerY, RadialRing& ring) {
+  PROFILE_SCOPE(PROBE_DRAW_RING);
+
   // Draw ring background first
   drawRingBackground(centerX, centerY, ring);
-  
+
   // Draw ring content based on type
   switch (ring.type) {
     case RadialRing::RING_TEXT_CIRCULAR:
       drawTextRing(centerX, centerY, ring);
       break;
+    case RadialRing::RING_TEXT_ARC:
+      drawArcTextRing(centerX, centerY, ring);
+      break;
     case RadialRing::RING_CIRCLES:
       drawCircleRing(centerX, centerY, ring);
       break;
@@ -43,6 +483,9 @@ void RadialDisplay::drawRing(int centerX, int centerY, RadialRing& ring) {
     case RadialRing::RING_DOTS:
       drawDotRing(centerX, centerY, ring);
       break;
+    case RadialRing::RING_SPARKLINE:
+      drawSparklineRing(centerX, centerY, ring);
+      break;
     case RadialRing::RING_BACKGROUND:
       // Already drawn background, nothing more needed
       break;
@@ -51,152 +494,248 @@ void RadialDisplay::drawRing(int centerX, int centerY, RadialRing& ring) {
 
 void RadialDisplay::drawRingBackground(int centerX, int centerY, RadialRing& ring) {
   if (ring.thickness > 0) {
-    // Draw filled ring background
-    carrier->display.fillCircle(centerX, centerY, ring.radius + ring.thickness/2, ring.bgColor);
-    if (ring.radius > ring.thickness/2) {
-      carrier->display.fillCircle(centerX, centerY, ring.radius - ring.thickness/2, 0x0000); // Cut out center
-    }
+    // Fill only the band itself, leaving whatever is inside the ring
+    int inner = ring.radius > ring.thickness/2 ? ring.radius - ring.thickness/2 + 1 : 0;
+    fillAnnularSector(centerX, centerY, inner, ring.radius + ring.thickness/2,
+                      0, 65536, ring.bgColor);
   }
-  
+
   if (ring.borderWidth > 0) {
     // Draw border
     for (int i = 0; i < ring.borderWidth; i++) {
-      carrier->display.drawCircle(centerX, centerY, ring.radius + i, ring.borderColor);
+      target.drawCircle(centerX, centerY, ring.radius + i, ring.borderColor);
     }
   }
 }
 
+void RadialDisplay::fillAnnularSector(int centerX, int centerY, int innerRadius, int outerRadius,
+                                      BinaryAngle startAngle, uint32_t sweep, uint16_t color) {
+  if (outerRadius < 0 || sweep == 0) return;
+
+  // A pixel is inside when its center lies within half a pixel of the band
+  int32_t outerLimit = (int32_t)outerRadius * outerRadius + outerRadius;
+  int32_t innerLimit = innerRadius > 0 ? (int32_t)innerRadius * innerRadius - innerRadius : -1;
+
+  // Sector edges as half-planes: c * x + s * y >= 0 holds clockwise of an
+  // edge, for the edge's sine s and cosine c. Sweeps up to 180 degrees are
+  // the pixels clockwise of the start and not of the end; wider sweeps are
+  // everything outside the opposite (narrower) gap.
+  bool fullCircle = sweep >= 65536;
+  bool wide = sweep > 32768;
+  BinaryAngle endAngle = startAngle + sweep;
+  int32_t startSin = fixedSin(startAngle), startCos = fixedCos(startAngle);
+  int32_t endSin = fixedSin(endAngle), endCos = fixedCos(endAngle);
+
+  int16_t top, bottom;
+  target.visibleRows(top, bottom);
+  top = max(top, (int16_t)(centerY - outerRadius));
+  bottom = min(bottom, (int16_t)(centerY + outerRadius));
+
+  target.startWrite();
+  for (int y = top; y <= bottom; y++) {
+    int32_t dy = y - centerY;
+    int32_t outerSq = outerLimit - dy * dy;
+    if (outerSq < 0) continue;
+    int outerX = isqrt(outerSq);
+    int32_t innerSq = innerLimit - dy * dy;
+    int innerX = innerSq >= 0 ? isqrt(innerSq) : -1;
+
+    // Band spans on this row, left and right of any hole
+    int spans[2][2] = {{-outerX, -innerX - 1}, {innerX + 1, outerX}};
+    int spanCount = 2;
+    if (innerX < 0) {
+      spans[0][1] = outerX;
+      spanCount = 1;
+    }
+
+    // Sector columns: [keepLo, keepHi] for narrow sweeps, outside
+    // [gapLo, gapHi] for wide ones
+    int keepLo = -outerX, keepHi = outerX, gapLo = 1, gapHi = 0;
+    if (!fullCircle) {
+      int lo1, hi1, lo2, hi2;
+      if (wide) {
+        halfPlaneRange(-startCos, -startSin * dy - 1, lo1, hi1);
+        halfPlaneRange(endCos, endSin * dy - 1, lo2, hi2);
+        gapLo = max(lo1, lo2);
+        gapHi = min(hi1, hi2);
+      } else {
+        halfPlaneRange(startCos, startSin * dy, lo1, hi1);
+        halfPlaneRange(-endCos, -endSin * dy, lo2, hi2);
+        keepLo = max(lo1, lo2);
+        keepHi = min(hi1, hi2);
+      }
+    }
+
+    for (int i = 0; i < spanCount; i++) {
+      int x0 = max(spans[i][0], keepLo);
+      int x1 = min(spans[i][1], keepHi);
+      if (x0 > x1) continue;
+      if (gapLo <= gapHi) {
+        // Up to two pieces either side of the gap
+        if (x0 < gapLo) {
+          int right = min(x1, gapLo - 1);
+          target.writeFastHLine(centerX + x0, y, right - x0 + 1, color);
+        }
+        x0 = max(x0, gapHi + 1);
+      }
+      if (x0 <= x1) {
+        target.writeFastHLine(centerX + x0, y, x1 - x0 + 1, color);
+      }
+    }
+  }
+  target.endWrite();
+}
+
 void RadialDisplay::drawTextRing(int centerX, int centerY, RadialRing& ring) {
-  carrier->display.setTextSize(ring.textSize);
-  
-  float angleRange = ring.endAngle - ring.startAngle;
-  if (angleRange <= 0) angleRange = 360; // Full circle
-  
   for (int i = 0; i < ring.elementCount; i++) {
     if (!ring.elements[i].isVisible) continue;
-    
-    float angle;
-    if (ring.autoSpacing) {
-      // Auto-calculate angle based on position in array
-      angle = ring.startAngle + (i * angleRange / ring.elementCount);
-    } else {
-      // Use specified angle
-      angle = ring.elements[i].angle;
-    }
-    
+
     int x, y;
-    calculatePosition(centerX, centerY, ring.radius, angle, x, y);
-    
-    carrier->display.setTextColor(ring.elements[i].color);
-    
-    // Center text approximately
-    int textWidth = ring.elements[i].content.length() * 6 * ring.textSize;
-    carrier->display.setCursor(x - textWidth/2, y - 4 * ring.textSize);
-    carrier->display.print(ring.elements[i].content);
+    calculatePosition(centerX, centerY, ring.radius, elementAngle(ring, i), x, y);
+
+    // Center text on its position
+    const char* text = ring.elements[i].content.c_str();
+    drawGlyphText(target, x - glyphTextWidth(text, ring.textSize)/2, y - GLYPH_HEIGHT * ring.textSize/2,
+                  text, ring.textSize, ring.elements[i].color);
   }
 }
 
-void RadialDisplay::drawCircleRing(int centerX, int centerY, RadialRing& ring) {
+void RadialDisplay::drawArcTextRing(int centerX, int centerY, RadialRing& ring) {
+  int radius = max(ring.radius, 1);
+
   for (int i = 0; i < ring.elementCount; i++) {
     if (!ring.elements[i].isVisible) continue;
-    
-    float angle;
-    if (ring.autoSpacing) {
-      float angleRange = ring.endAngle - ring.startAngle;
-      if (angleRange <= 0) angleRange = 360;
-      angle = ring.startAngle + (i * angleRange / ring.elementCount);
-    } else {
-      angle = ring.elements[i].angle;
+
+    RadialRect bounds = arcTextBounds(centerX, centerY, ring, i);
+    if (!target.stripIntersects(bounds.x, bounds.y, bounds.w, bounds.h)) continue;
+
+    // Each glyph is centered on the ring at its own angle and turned to
+    // follow it; offsets are in half pixels from the middle of the text
+    float angle = elementAngle(ring, i);
+    bool reversed = readsCounterClockwise(angle);
+    BinaryAngle middle = angleFromDegrees(angle);
+    const char* text = ring.elements[i].content.c_str();
+    int32_t offset = -glyphTextWidth(text, ring.textSize);
+
+    while (*text) {
+      const GlyphEntry* glyph = findGlyph(nextCodepoint(text));
+      int width = glyph->width * ring.textSize;
+      int32_t sweep = arcSweep(offset + width, radius);
+      BinaryAngle position = reversed ? middle - sweep : middle + sweep;
+
+      int32_t x, y;
+      polarToCartesianQ16((int32_t)centerX << 16, (int32_t)centerY << 16, (int32_t)radius << 16,
+                          position, x, y);
+      int32_t rightX = reversed ? -fixedCos(position) : fixedCos(position);
+      int32_t rightY = reversed ? -fixedSin(position) : fixedSin(position);
+      drawRotatedGlyph(target, x, y, rightX, rightY, glyph, ring.textSize, ring.elements[i].color);
+
+      offset += 2 * (width + GLYPH_SPACING * ring.textSize);
     }
-    
+  }
+}
+
+void RadialDisplay::drawCircleRing(int centerX, int centerY, RadialRing& ring) {
+  for (int i = 0; i < ring.elementCount; i++) {
+    if (!ring.elements[i].isVisible) continue;
+
     int x, y;
-    calculatePosition(centerX, centerY, ring.radius, angle, x, y);
-    
+    calculatePosition(centerX, centerY, ring.radius, elementAngle(ring, i), x, y);
+
     int circleSize = ring.elements[i].size > 0 ? ring.elements[i].size : 15;
-    
+
     // Draw circle
-    carrier->display.fillCircle(x, y, circleSize, ring.elements[i].color);
+    target.fillCircle(x, y, circleSize, ring.elements[i].color);
     if (ring.borderWidth > 0) {
-      carrier->display.drawCircle(x, y, circleSize, ring.borderColor);
+      target.drawCircle(x, y, circleSize, ring.borderColor);
     }
-    
-    // Draw content if any
-    if (ring.elements[i].content.length() > 0) {
-      carrier->display.setTextColor(ring.borderColor);
-      carrier->display.setTextSize(ring.textSize);
-      
-      int textWidth = ring.elements[i].content.length() * 6 * ring.textSize;
-      carrier->display.setCursor(x - textWidth/2, y - 4 * ring.textSize);
-      carrier->display.print(ring.elements[i].content);
+
+    // Draw content if any; countdowns at the sprite size are blitted
+    RadialElement& element = ring.elements[i];
+    if (element.content.length() > 0) {
+      const char* text = element.content.c_str();
+      int textWidth = glyphTextWidth(text, ring.textSize);
+      uint16_t textColor = blendColors(ring.borderColor, element.color, element.textFade);
+
+      // Sliding text shows through the rows inside the circle that are
+      // wide enough for all of it
+      if (element.textOffset != 0) {
+        int halfRows = isqrt(max(circleSize * circleSize - textWidth * textWidth / 4, 0)) - 1;
+        target.setClip(x - circleSize, y - halfRows, 2 * circleSize + 1, 2 * halfRows + 1);
+      }
+      drawGlyphText(target, x - textWidth/2, y - GLYPH_HEIGHT * ring.textSize/2 + element.textOffset,
+                    text, ring.textSize, textColor);
+      target.clearClip();
     }
   }
 }
 
 void RadialDisplay::drawArcRing(int centerX, int centerY, RadialRing& ring) {
-  // Simplified arc drawing - draw as thick lines
+  // Each element is a band from the ring radius outward, centered on its angle
+  int outer = ring.radius + max(ring.thickness, 1) - 1;
+
   for (int i = 0; i < ring.elementCount; i++) {
     if (!ring.elements[i].isVisible) continue;
-    
-    float startAngle = ring.elements[i].angle - ring.elements[i].size/2;
-    float endAngle = ring.elements[i].angle + ring.elements[i].size/2;
-    
-    // Draw arc as series of points
-    for (float a = startAngle; a <= endAngle; a += 2) {
-      int x, y;
-      calculatePosition(centerX, centerY, ring.radius, a, x, y);
-      carrier->display.drawPixel(x, y, ring.elements[i].color);
-      
-      // Make thicker
-      if (ring.thickness > 1) {
-        for (int t = 1; t < ring.thickness; t++) {
-          int x2, y2;
-          calculatePosition(centerX, centerY, ring.radius + t, a, x2, y2);
-          carrier->display.drawPixel(x2, y2, ring.elements[i].color);
-        }
-      }
-    }
+
+    int halfSpan = ring.elements[i].size/2;
+    BinaryAngle startAngle = angleFromDegrees(ring.elements[i].angle + ring.rotation - halfSpan);
+    uint32_t sweep = ((uint32_t)max(halfSpan, 0) * 2 * 65536) / 360;
+    fillAnnularSector(centerX, centerY, ring.radius, outer, startAngle, sweep, ring.elements[i].color);
   }
 }
 
 void RadialDisplay::drawDotRing(int centerX, int centerY, RadialRing& ring) {
   for (int i = 0; i < ring.elementCount; i++) {
     if (!ring.elements[i].isVisible) continue;
-    
-    float angle;
-    if (ring.autoSpacing) {
-      float angleRange = ring.endAngle - ring.startAngle;
-      if (angleRange <= 0) angleRange = 360;
-      angle = ring.startAngle + (i * angleRange / ring.elementCount);
-    } else {
-      angle = ring.elements[i].angle;
-    }
-    
+
     int x, y;
-    calculatePosition(centerX, centerY, ring.radius, angle, x, y);
-    
+    calculatePosition(centerX, centerY, ring.radius, elementAngle(ring, i), x, y);
+
     int dotSize = ring.elements[i].size > 0 ? ring.elements[i].size : 3;
-    carrier->display.fillCircle(x, y, dotSize, ring.elements[i].color);
+    target.fillCircle(x, y, dotSize, ring.elements[i].color);
+  }
+}
+
+void RadialDisplay::sparklineBar(RadialRing& ring, int index, int& inner, int& outer,
+                                 float& startAngle, float& endAngle) {
+  // Bars fill the band drawn by drawRingBackground(), with a gap between
+  float angleRange = ring.endAngle - ring.startAngle;
+  if (angleRange <= 0) angleRange = 360;
+  float span = angleRange / ring.sampleCount;
+  startAngle = ring.startAngle + ring.rotation + index * span + span / 10;
+  endAngle = startAngle + span * 4 / 5;
+  inner = ring.radius > ring.thickness/2 ? ring.radius - ring.thickness/2 + 1 : 0;
+  outer = ring.radius + ring.thickness/2;
+}
+
+void RadialDisplay::drawSparklineRing(int centerX, int centerY, RadialRing& ring) {
+  for (int i = 0; i < ring.sampleCount; i++) {
+    if (ring.samples[i] == 0) continue;
+
+    int inner, outer;
+    float startAngle, endAngle;
+    sparklineBar(ring, i, inner, outer, startAngle, endAngle);
+    int top = inner + ((outer - inner) * ring.samples[i] + 127) / 255;
+    uint32_t sweep = (uint32_t)((endAngle - startAngle) * 65536 / 360);
+    fillAnnularSector(centerX, centerY, inner, top, angleFromDegrees(startAngle), sweep, ring.borderColor);
   }
 }
 
-void RadialDisplay::drawCenterElement(int centerX, int centerY, int radius, String text, 
+void RadialDisplay::drawCenterElement(int centerX, int centerY, int radius, const char* text,
                                     uint16_t bgColor, uint16_t textColor, int textSize) {
   // Draw circle background
-  carrier->display.fillCircle(centerX, centerY, radius, bgColor);
-  carrier->display.drawCircle(centerX, centerY, radius, textColor);
-  
+  target.fillCircle(centerX, centerY, radius, bgColor);
+  target.drawCircle(centerX, centerY, radius, textColor);
+
   // Draw text in center
-  carrier->display.setTextColor(textColor);
-  carrier->display.setTextSize(textSize);
-  
-  int textWidth = text.length() * 6 * textSize;
-  int textHeight = 8 * textSize;
-  
-  carrier->display.setCursor(centerX - textWidth/2, centerY - textHeight/2);
-  carrier->display.print(text);
+  int textWidth = glyphTextWidth(text, textSize);
+  int textHeight = GLYPH_HEIGHT * textSize;
+  drawGlyphText(target, centerX - textWidth/2, centerY - textHeight/2, text, textSize, textColor);
+
+  screenOwner = nullptr;
 }
 
-void RadialDisplay::drawSimpleRing(int centerX, int centerY, int radius, RadialElement* elements, 
+void RadialDisplay::drawSimpleRing(int centerX, int centerY, int radius, RadialElement* elements,
                                   int count, RadialRing::RingType type) {
   RadialRing ring = {0};
   ring.radius = radius;
@@ -207,12 +746,13 @@ void RadialDisplay::drawSimpleRing(int centerX, int centerY, int radius, RadialE
   ring.startAngle = 0;
   ring.endAngle = 360;
   ring.textSize = 1;
-  
+  ring.isVisible = true;
+
   drawRing(centerX, centerY, ring);
 }
 
 // Utility functions
-RadialElement RadialDisplay::createTextElement(float angle, String text, uint16_t color) {
+RadialElement RadialDisplay::createTextElement(float angle, const char* text, uint16_t color) {
   RadialElement element = {0};
   element.angle = angle;
   element.content = text;
@@ -222,7 +762,7 @@ RadialElement RadialDisplay::createTextElement(float angle, String text, uint16_
   return element;
 }
 
-RadialElement RadialDisplay::createCircleElement(float angle, String content, uint16_t color, int size) {
+RadialElement RadialDisplay::createCircleElement(float angle, const char* content, uint16_t color, int size) {
   RadialElement element = {0};
   element.angle = angle;
   element.content = content;
@@ -240,6 +780,7 @@ RadialRing RadialDisplay::createTextRing(int radius, int textSize, uint16_t colo
   ring.autoSpacing = true;
   ring.startAngle = 0;
   ring.endAngle = 360;
+  ring.isVisible = true;
   return ring;
 }
 
@@ -253,5 +794,35 @@ RadialRing RadialDisplay::createCircleRing(int radius, int circleSize, uint16_t
   ring.autoSpacing = true;
   ring.startAngle = 0;
   ring.endAngle = 360;
+  ring.isVisible = true;
   return ring;
-}
\ No newline at end of file
+}
+
+RadialRing RadialDisplay::createCenterRing(int textSize, uint16_t textColor) {
+  // Retained equivalent of drawCenterElement(): one circle element at the
+  // center, outlined and labelled in textColor
+  RadialRing ring = {0};
+  ring.radius = 0;
+  ring.type = RadialRing::RING_CIRCLES;
+  ring.borderColor = textColor;
+  ring.borderWidth = 1;
+  ring.textSize = textSize;
+  ring.autoSpacing = false;
+  ring.isVisible = true;
+  return ring;
+}
+
+RadialRing RadialDisplay::createSparklineRing(int radius, int thickness, const uint8_t* samples,
+                                             uint8_t* drawnSamples, int sampleCount) {
+  RadialRing ring = {0};
+  ring.radius = radius;
+  ring.thickness = thickness;
+  ring.type = RadialRing::RING_SPARKLINE;
+  ring.samples = samples;
+  ring.drawnSamples = drawnSamples;
+  ring.sampleCount = sampleCount;
+  ring.startAngle = 0;
+  ring.endAngle = 360;
+  ring.isVisible = true;
+  return ring;
+}
@@ -1,6 +1,12 @@
 /*
  * Generic Radial Display Library for Arduino Opla
  * Flexible library for creating customizable circular/radial UI layouts
+ *
+ * A RadialDisplayConfig is a retained scene: modes keep one alive, update
+ * element content in place and hand it to drawRadialLayout(). Each element
+ * remembers the bounds and signature it was last drawn with, so only the
+ * regions whose elements changed are repainted, each composited off-screen
+ * in strips and sent to the panel in bursts.
  */
 
 #ifndef RADIALDISPLAY_H
@@ -8,14 +14,37 @@
 
 #include <Arduino.h>
 #include <Arduino_MKRIoTCarrier.h>
+#include "StripCompositor.h"
+#include "FixedTrig.h"
+#include "FixedString.h"
+#include "GlyphAtlas.h"
+
+// Opla round display resolution
+const int RADIAL_SCREEN_WIDTH = 240;
+const int RADIAL_SCREEN_HEIGHT = 240;
+
+// Screen-space rectangle used for element bounds and dirty regions
+struct RadialRect {
+  int16_t x, y, w, h;   // w == 0 means empty
+};
 
 // Generic radial element that can hold any type of content
 struct RadialElement {
   float angle;          // Position angle in degrees (0° = top, clockwise)
-  String content;       // Text content to display
+  FixedString<23> content;  // Text content to display
   uint16_t color;       // Element color
   bool isVisible;       // Whether to show this element
   int size;            // Size parameter (context-dependent)
+
+  // Countdown transitions in RING_CIRCLES, 0 when at rest: the text drawn
+  // this many pixels lower, clipped to the circle, and blended this far
+  // (of 255) into the circle's fill
+  int8_t textOffset;
+  uint8_t textFade;
+
+  // Retained state, maintained by RadialDisplay
+  RadialRect lastBounds;    // Area covered when last drawn
+  uint32_t lastSignature;   // Hash of everything that affected that draw
 };
 
 // Configuration for a radial ring
@@ -28,20 +57,36 @@ struct RadialRing {
   int textSize;         // Text size for elements in this ring
   int elementCount;     // Number of elements in this ring
   RadialElement* elements; // Array of elements
-  
+
+  // RING_SPARKLINE: one bar per sample, clockwise from startAngle, growing
+  // outward across the band from 0 (none) to 255 (full thickness), drawn
+  // in borderColor. drawnSamples is the copy on screen, so only bars that
+  // changed are repainted.
+  const uint8_t* samples;
+  uint8_t* drawnSamples;
+  int sampleCount;
+
   // Ring type and layout
   enum RingType {
     RING_TEXT_CIRCULAR,   // Text arranged in a circle
+    RING_TEXT_ARC,        // Text following the ring's curve
     RING_CIRCLES,         // Individual circles with content
     RING_ARCS,           // Arc segments
     RING_DOTS,           // Small dots/indicators
-    RING_BACKGROUND      // Just a background ring
+    RING_BACKGROUND,     // Just a background ring
+    RING_SPARKLINE       // Radial bars, one per sample
   } type;
-  
+
   // Layout options
+  float rotation;       // Turns every element clockwise by this many degrees
   float startAngle;     // Starting angle for first element
   float endAngle;       // Ending angle for last element (for partial rings)
   bool autoSpacing;     // Auto-calculate spacing between elements
+  bool isVisible;       // Whether to show this ring at all
+
+  // Retained state, maintained by RadialDisplay
+  RadialRect lastBounds;
+  uint32_t lastSignature;
 };
 
 // Main radial display configuration
@@ -49,40 +94,100 @@ struct RadialDisplayConfig {
   int centerX, centerY; // Center point
   uint16_t backgroundColor; // Screen background
   int ringCount;        // Number of rings
-  RadialRing* rings;    // Array of ring configurations
+  RadialRing* rings;    // Array of ring configurations, painted last to first
+
+  // Retained state, maintained by RadialDisplay
+  uint32_t lastSignature;
+};
+
+// RGB565 color amount/255 of the way from one color to another
+uint16_t blendColors(uint16_t from, uint16_t to, uint8_t amount);
+
+// Counters for judging how much repainting the diffing saves
+struct RadialRenderStats {
+  uint32_t fullRedraws;      // Frames drawn from a cleared screen
+  uint32_t partialRedraws;   // Frames that repainted dirty regions only
+  uint32_t unchangedFrames;  // Frames where nothing needed drawing
+  uint32_t repaintedPixels;  // Area of all regions cleared and redrawn
 };
 
 class RadialDisplay {
 private:
   MKRIoTCarrier* carrier;
-  
+  StripCompositor target;     // All drawing goes through here
+  bool needsFullRedraw;
+  RadialRenderStats stats;
+
+  // Dirty regions collected while diffing a frame
+  static const int MAX_DIRTY_RECTS = 6;
+  RadialRect dirtyRects[MAX_DIRTY_RECTS];
+  int dirtyCount;
+
+  // The display whose scene is currently on screen
+  static RadialDisplay* screenOwner;
+
   // Helper functions
   void calculatePosition(int centerX, int centerY, int radius, float angle, int& x, int& y);
+  float elementAngle(RadialRing& ring, int index);
+  void drawRingContent(int centerX, int centerY, RadialRing& ring);
   void drawRingBackground(int centerX, int centerY, RadialRing& ring);
   void drawTextRing(int centerX, int centerY, RadialRing& ring);
+  void drawArcTextRing(int centerX, int centerY, RadialRing& ring);
   void drawCircleRing(int centerX, int centerY, RadialRing& ring);
   void drawArcRing(int centerX, int centerY, RadialRing& ring);
   void drawDotRing(int centerX, int centerY, RadialRing& ring);
+  void drawSparklineRing(int centerX, int centerY, RadialRing& ring);
+  void sparklineBar(RadialRing& ring, int index, int& inner, int& outer,
+                    float& startAngle, float& endAngle);
+
+  // Retained-mode diffing
+  RadialRect textBounds(int x, int y, const char* text, int textSize);
+  RadialRect arcTextBounds(int centerX, int centerY, RadialRing& ring, int index);
+  RadialRect sectorBounds(int centerX, int centerY, int innerRadius, int outerRadius,
+                          float startAngle, float endAngle);
+  RadialRect elementBounds(int centerX, int centerY, RadialRing& ring, int index);
+  RadialRect ringBounds(int centerX, int centerY, RadialRing& ring);
+  uint32_t elementSignature(RadialRing& ring, int index);
+  uint32_t ringSignature(RadialRing& ring);
+  uint32_t configSignature(RadialDisplayConfig& config);
+  void addDirtyRect(RadialRect rect);
+  void collectDirtyRects(RadialDisplayConfig& config);
+  void repaintRegion(RadialDisplayConfig& config, RadialRect region);
+  void commitFrame(RadialDisplayConfig& config);
 
 public:
   RadialDisplay(MKRIoTCarrier* carrierPtr);
-  
+
   // Core functions
   void clear(uint16_t backgroundColor = 0x0000);
   void drawRadialLayout(RadialDisplayConfig& config);
   void drawRing(int centerX, int centerY, RadialRing& ring);
-  
+  void invalidate();  // Force the next drawRadialLayout() to redraw everything
+  bool isOnScreen();  // Whether the last scene drawn is still what the screen shows
+  const RadialRenderStats& getStats() { return stats; }
+  const CompositorStats& getCompositorStats() { return StripCompositor::getStats(); }
+
+  // Scanline rasterizer for rings and arcs: one span per run of pixels
+  // between innerRadius and outerRadius (inclusive) within the sweep,
+  // clockwise from startAngle. Outside drawRadialLayout() it draws straight
+  // to the screen; invalidate() any scene it draws over.
+  void fillAnnularSector(int centerX, int centerY, int innerRadius, int outerRadius,
+                         BinaryAngle startAngle, uint32_t sweep, uint16_t color);
+
   // Convenience functions for common patterns
-  void drawCenterElement(int centerX, int centerY, int radius, String text, 
+  void drawCenterElement(int centerX, int centerY, int radius, const char* text,
                         uint16_t bgColor, uint16_t textColor, int textSize);
-  void drawSimpleRing(int centerX, int centerY, int radius, RadialElement* elements, 
+  void drawSimpleRing(int centerX, int centerY, int radius, RadialElement* elements,
                      int count, RadialRing::RingType type);
-  
+
   // Utility functions
-  RadialElement createTextElement(float angle, String text, uint16_t color);
-  RadialElement createCircleElement(float angle, String content, uint16_t color, int size);
+  RadialElement createTextElement(float angle, const char* text, uint16_t color);
+  RadialElement createCircleElement(float angle, const char* content, uint16_t color, int size);
   RadialRing createTextRing(int radius, int textSize, uint16_t color);
   RadialRing createCircleRing(int radius, int circleSize, uint16_t fillColor, uint16_t borderColor);
+  RadialRing createCenterRing(int textSize, uint16_t textColor);
+  RadialRing createSparklineRing(int radius, int thickness, const uint8_t* samples,
+                                 uint8_t* drawnSamples, int sampleCount);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,23 @@
+#include "RouteId.h"
+
+// Slot 0 stays empty and stands for no route
+FixedString<ROUTE_ID_LENGTH> RouteId::table[ROUTE_TABLE_SIZE];
+uint8_t RouteId::tableCount = 1;
+
+uint8_t RouteId::intern(const char* route) {
+  if (!route || !*route) return 0;
+
+  // Compare against the ID as it would be stored, so long IDs intern once
+  FixedString<ROUTE_ID_LENGTH> id(route);
+  for (uint8_t i = 1; i < tableCount; i++) {
+    if (table[i] == id) return i;
+  }
+
+  if (tableCount >= ROUTE_TABLE_SIZE) {
+    Serial.print("Route table full, dropping ");
+    Serial.println(id.c_str());
+    return 0;
+  }
+  table[tableCount] = id.c_str();
+  return tableCount++;
+}
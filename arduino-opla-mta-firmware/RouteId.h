@@ -0,0 +1,46 @@
+/*
+ * Interned route IDs for Arduino Opla MTA Firmware
+ * Each distinct route ID ("F", "6X", ...) is stored once in a small table
+ * and referred to by a one-byte index, so arrivals copy and compare routes
+ * without strings or heap allocation.
+ */
+
+#ifndef ROUTEID_H
+#define ROUTEID_H
+
+#include <Arduino.h>
+#include "FixedString.h"
+
+const int ROUTE_ID_LENGTH = 7;     // Longest route ID kept, e.g. "6X"
+const int ROUTE_TABLE_SIZE = 32;   // Distinct routes, enough for the subway
+
+class RouteId {
+private:
+  uint8_t index;   // 0 is no route
+
+  static FixedString<ROUTE_ID_LENGTH> table[ROUTE_TABLE_SIZE];
+  static uint8_t tableCount;
+
+  static uint8_t intern(const char* route);
+
+public:
+  RouteId() : index(0) {}
+  RouteId(const char* route) : index(intern(route)) {}
+
+  RouteId& operator=(const char* route) {
+    index = intern(route);
+    return *this;
+  }
+
+  const char* c_str() const { return table[index].c_str(); }
+  bool isEmpty() const { return index == 0; }
+
+  bool operator==(const RouteId& other) const { return index == other.index; }
+  bool operator!=(const RouteId& other) const { return index != other.index; }
+  bool operator==(const char* route) const { return table[index] == route; }
+  bool operator!=(const char* route) const { return !(*this == route); }
+
+  static int count() { return tableCount; }
+};
+
+#endif
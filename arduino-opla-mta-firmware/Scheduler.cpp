@@ -0,0 +1,176 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler() {
+  heapSize = 0;
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    tasks[i].inUse = false;
+    tasks[i].scheduled = false;
+    heapPosition[i] = -1;
+  }
+}
+
+void Scheduler::heapSwap(int i, int j) {
+  int8_t id = heap[i];
+  heap[i] = heap[j];
+  heap[j] = id;
+  heapPosition[heap[i]] = i;
+  heapPosition[heap[j]] = j;
+}
+
+void Scheduler::siftUp(int i) {
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!heapLess(i, parent)) break;
+    heapSwap(i, parent);
+    i = parent;
+  }
+}
+
+void Scheduler::siftDown(int i) {
+  while (true) {
+    int smallest = i;
+    int left = 2 * i + 1;
+    int right = left + 1;
+    if (left < heapSize && heapLess(left, smallest)) smallest = left;
+    if (right < heapSize && heapLess(right, smallest)) smallest = right;
+    if (smallest == i) break;
+    heapSwap(i, smallest);
+    i = smallest;
+  }
+}
+
+void Scheduler::heapPush(int id) {
+  heap[heapSize] = id;
+  heapPosition[id] = heapSize;
+  heapSize++;
+  siftUp(heapSize - 1);
+  tasks[id].scheduled = true;
+}
+
+void Scheduler::heapRemove(int id) {
+  int i = heapPosition[id];
+  if (i < 0) return;
+  heapSize--;
+  if (i != heapSize) {
+    heapSwap(i, heapSize);
+    siftDown(i);
+    siftUp(i);
+  }
+  heapPosition[id] = -1;
+  tasks[id].scheduled = false;
+}
+
+int Scheduler::addTask(TaskCallback callback, void* context, const char* name, uint32_t delayMs, uint32_t period) {
+  for (int id = 0; id < SCHEDULER_MAX_TASKS; id++) {
+    if (tasks[id].inUse) continue;
+
+    Task& task = tasks[id];
+    task.callback = callback;
+    task.context = context;
+    task.name = name;
+    task.deadline = millis() + delayMs;
+    task.period = period;
+    task.inUse = true;
+    memset(&task.stats, 0, sizeof(task.stats));
+    heapPush(id);
+    return id;
+  }
+  Serial.print("Scheduler full, dropping task ");
+  Serial.println(name);
+  return -1;
+}
+
+int Scheduler::every(uint32_t periodMs, TaskCallback callback, void* context, const char* name, uint32_t firstDelayMs) {
+  return addTask(callback, context, name, firstDelayMs, periodMs > 0 ? periodMs : 1);
+}
+
+int Scheduler::after(uint32_t delayMs, TaskCallback callback, void* context, const char* name) {
+  return addTask(callback, context, name, delayMs, 0);
+}
+
+void Scheduler::runIn(int id, uint32_t delayMs) {
+  if (id < 0 || !tasks[id].inUse) return;
+  if (tasks[id].scheduled) heapRemove(id);
+  tasks[id].deadline = millis() + delayMs;
+  heapPush(id);
+}
+
+void Scheduler::setPeriod(int id, uint32_t periodMs) {
+  if (id < 0 || !tasks[id].inUse || tasks[id].period == 0 || periodMs == 0) return;
+  if (tasks[id].period == periodMs) return;
+
+  // Pull the next run in if it is further off than the new period
+  uint32_t now = millis();
+  tasks[id].period = periodMs;
+  if (tasks[id].scheduled && before(now + periodMs, tasks[id].deadline)) {
+    runIn(id, periodMs);
+  }
+}
+
+void Scheduler::cancel(int id) {
+  if (id < 0 || !tasks[id].inUse) return;
+  if (tasks[id].scheduled) heapRemove(id);
+  tasks[id].inUse = false;
+}
+
+uint32_t Scheduler::runDue() {
+  // Only the tasks due on entry. One that blocks long enough to fall due
+  // again, or to bring others due, leaves them to the next call, so loop()
+  // checks the touch pads in between.
+  uint32_t entered = millis();
+  while (heapSize > 0) {
+    int id = heap[0];
+    Task& task = tasks[id];
+    if (before(entered, task.deadline)) break;
+    uint32_t now = millis();
+
+    // Reschedule before running, so the callback may move or cancel it
+    uint32_t late = now - task.deadline;
+    heapRemove(id);
+    if (task.period > 0) {
+      // Fixed rate; runs missed while late are skipped, not bunched up
+      task.deadline += task.period;
+      if (!before(now, task.deadline)) task.deadline = now + task.period;
+      heapPush(id);
+    }
+
+    uint32_t start = micros();
+    task.callback(task.context);
+    uint32_t elapsed = micros() - start;
+
+    task.stats.runs++;
+    task.stats.totalMicros += elapsed;
+    if (elapsed > task.stats.maxMicros) task.stats.maxMicros = elapsed;
+    task.stats.totalLateMs += late;
+    if (late > task.stats.maxLateMs) task.stats.maxLateMs = late;
+  }
+  return msUntilNext();
+}
+
+uint32_t Scheduler::msUntilNext() {
+  if (heapSize == 0) return 1000;
+  uint32_t now = millis();
+  uint32_t deadline = tasks[heap[0]].deadline;
+  return before(now, deadline) ? deadline - now : 0;
+}
+
+int Scheduler::getTaskCount() {
+  int count = 0;
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    if (tasks[i].inUse) count++;
+  }
+  return count;
+}
+
+void Scheduler::printStats(Print& out) {
+  out.println("Tasks: runs, avg/max run us, avg/max late ms");
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    if (!tasks[i].inUse) continue;
+    const TaskStats& s = tasks[i].stats;
+    FixedString<63> line;
+    line.format("  %-8s %6lu  %6lu/%-7lu  %4lu/%lu", tasks[i].name, (unsigned long)s.runs,
+                (unsigned long)(s.runs ? s.totalMicros / s.runs : 0), (unsigned long)s.maxMicros,
+                (unsigned long)(s.runs ? s.totalLateMs / s.runs : 0), (unsigned long)s.maxLateMs);
+    out.println(line.c_str());
+  }
+}
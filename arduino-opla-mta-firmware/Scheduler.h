@@ -0,0 +1,80 @@
+/*
+ * Cooperative scheduler for Arduino Opla MTA Firmware
+ * Tasks are kept in a min-heap ordered by deadline, so loop() runs only the
+ * tasks that are due and knows how long it can idle until the next one.
+ * Deadlines are compared by signed difference and stay correct across the
+ * millis() rollover. Each task keeps run-time and lateness figures.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "FixedString.h"
+
+const int SCHEDULER_MAX_TASKS = 12;
+
+struct TaskStats {
+  uint32_t runs;
+  uint32_t totalMicros;     // Time spent in the callback
+  uint32_t maxMicros;
+  uint32_t totalLateMs;     // Start time past the deadline
+  uint32_t maxLateMs;
+};
+
+class Scheduler {
+public:
+  typedef void (*TaskCallback)(void* context);
+
+private:
+  struct Task {
+    TaskCallback callback;
+    void* context;
+    const char* name;
+    uint32_t deadline;
+    uint32_t period;        // 0 for a one-shot
+    bool scheduled;         // In the heap
+    bool inUse;
+    TaskStats stats;
+  };
+
+  Task tasks[SCHEDULER_MAX_TASKS];
+  int8_t heap[SCHEDULER_MAX_TASKS];   // Task IDs, earliest deadline first
+  int8_t heapPosition[SCHEDULER_MAX_TASKS];
+  int heapSize;
+
+  static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+  bool heapLess(int i, int j) { return before(tasks[heap[i]].deadline, tasks[heap[j]].deadline); }
+  void heapSwap(int i, int j);
+  void siftUp(int i);
+  void siftDown(int i);
+  void heapPush(int id);
+  void heapRemove(int id);
+  int addTask(TaskCallback callback, void* context, const char* name, uint32_t delayMs, uint32_t period);
+
+public:
+  Scheduler();
+
+  // Both return a task ID, or -1 if the table is full. A periodic task
+  // first runs after firstDelayMs, then every periodMs.
+  int every(uint32_t periodMs, TaskCallback callback, void* context, const char* name,
+            uint32_t firstDelayMs = 0);
+  int after(uint32_t delayMs, TaskCallback callback, void* context, const char* name);
+
+  // Moves a task's next run; a stopped one-shot is scheduled again
+  void runIn(int id, uint32_t delayMs);
+  void setPeriod(int id, uint32_t periodMs);
+  void cancel(int id);
+
+  // Runs every task that is due, once, and returns the milliseconds until
+  // the next deadline, 0 if one has come while they ran
+  uint32_t runDue();
+  uint32_t msUntilNext();
+
+  int getTaskCount();
+  const char* getTaskName(int id) { return tasks[id].name; }
+  const TaskStats& getTaskStats(int id) { return tasks[id].stats; }
+  void printStats(Print& out);
+};
+
+#endif
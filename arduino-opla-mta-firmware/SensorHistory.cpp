@@ -0,0 +1,224 @@
+#include "SensorHistory.h"
+
+static const uint16_t CHANNEL_NIBBLES = HISTORY_CHANNEL_BYTES * 2;
+
+// A zigzagged 16-bit difference needs at most 17 bits, 3 per group
+static const int MAX_DELTA_NIBBLES = 6;
+
+// Channel units per sensor unit
+static const float UNITS_PER_READING[HISTORY_CHANNEL_COUNT] = {10.0f, 10.0f, 100.0f, 1.0f};
+
+SensorHistory::SensorHistory() {
+  clear();
+}
+
+void SensorHistory::clear() {
+  memset(channels, 0, sizeof(channels));
+  memset(hourCounts, 0, sizeof(hourCounts));
+  oldestHour = 0;
+  hourCount = 0;
+  version = 0;
+}
+
+void SensorHistory::append(const int16_t values[HISTORY_CHANNEL_COUNT]) {
+  if (hourCount == 0 || hourCounts[hourSlot(0)] >= HISTORY_SAMPLES_PER_HOUR) {
+    startHour();
+  }
+  while (!hasRoom() && hourCount > 1) {
+    dropOldestHour();
+  }
+  if (!hasRoom()) return;
+
+  int slot = hourSlot(0);
+  bool keyframe = hourCounts[slot] == 0;
+  for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+    Channel& channel = channels[i];
+    HourSummary& hour = channel.hours[slot];
+    int16_t value = values[i];
+
+    if (keyframe) {
+      hour.first = value;
+      hour.min = value;
+      hour.max = value;
+      hour.nibbles = 0;
+    } else {
+      uint16_t before = channel.used;
+      writeDelta(channel, (int32_t)value - channel.last);
+      hour.nibbles += channel.used - before;
+      if (value < hour.min) hour.min = value;
+      if (value > hour.max) hour.max = value;
+    }
+    channel.last = value;
+  }
+  hourCounts[slot]++;
+  version++;
+}
+
+void SensorHistory::startHour() {
+  if (hourCount == HISTORY_HOUR_SLOTS) {
+    dropOldestHour();
+  }
+  hourCount++;
+  hourCounts[hourSlot(0)] = 0;
+}
+
+void SensorHistory::dropOldestHour() {
+  for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+    Channel& channel = channels[i];
+    uint16_t nibbles = channel.hours[oldestHour].nibbles;
+    channel.tail = (channel.tail + nibbles) % CHANNEL_NIBBLES;
+    channel.used -= nibbles;
+  }
+  hourCounts[oldestHour] = 0;
+  oldestHour = (oldestHour + 1) % HISTORY_HOUR_SLOTS;
+  hourCount--;
+}
+
+bool SensorHistory::hasRoom() const {
+  for (int i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+    if (channels[i].used + MAX_DELTA_NIBBLES > CHANNEL_NIBBLES) return false;
+  }
+  return true;
+}
+
+void SensorHistory::writeNibble(Channel& channel, uint8_t nibble) {
+  uint16_t index = (channel.tail + channel.used) % CHANNEL_NIBBLES;
+  uint8_t& byte = channel.deltas[index / 2];
+  if (index & 1) {
+    byte = (byte & 0x0F) | (nibble << 4);
+  } else {
+    byte = (byte & 0xF0) | nibble;
+  }
+  channel.used++;
+}
+
+void SensorHistory::writeDelta(Channel& channel, int32_t delta) {
+  // Zigzag, then 3 bits per group with the top bit marking a continuation
+  uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+  while (zigzag >= 8) {
+    writeNibble(channel, (zigzag & 7) | 8);
+    zigzag >>= 3;
+  }
+  writeNibble(channel, zigzag);
+}
+
+// Reads one delta starting at index, advancing it past the delta
+static int32_t readDelta(const uint8_t* deltas, uint16_t& index) {
+  uint32_t zigzag = 0;
+  int shift = 0;
+  uint8_t nibble;
+  do {
+    uint16_t wrapped = index % CHANNEL_NIBBLES;
+    uint8_t byte = deltas[wrapped / 2];
+    nibble = (wrapped & 1) ? byte >> 4 : byte & 0x0F;
+    zigzag |= (uint32_t)(nibble & 7) << shift;
+    shift += 3;
+    index++;
+  } while (nibble & 8);
+  return (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+}
+
+uint16_t SensorHistory::hourStart(const Channel& channel, int slot) const {
+  uint16_t index = channel.tail;
+  for (int s = oldestHour; s != slot; s = (s + 1) % HISTORY_HOUR_SLOTS) {
+    index += channel.hours[s].nibbles;
+  }
+  return index;
+}
+
+int SensorHistory::getSampleCount() const {
+  int count = 0;
+  for (int age = 0; age < hourCount; age++) {
+    count += hourCounts[hourSlot(age)];
+  }
+  return count;
+}
+
+int16_t SensorHistory::minimum(HistoryChannel channel) const {
+  if (hourCount == 0) return 0;
+  int16_t value = channels[channel].hours[hourSlot(0)].min;
+  for (int age = 1; age < hourCount; age++) {
+    value = min(value, channels[channel].hours[hourSlot(age)].min);
+  }
+  return value;
+}
+
+int16_t SensorHistory::maximum(HistoryChannel channel) const {
+  if (hourCount == 0) return 0;
+  int16_t value = channels[channel].hours[hourSlot(0)].max;
+  for (int age = 1; age < hourCount; age++) {
+    value = max(value, channels[channel].hours[hourSlot(age)].max);
+  }
+  return value;
+}
+
+bool SensorHistory::valueAt(HistoryChannel channel, int minutesAgo, int16_t& value) const {
+  if (minutesAgo < 0) return false;
+
+  // Find the hour holding the reading, newest first
+  for (int age = 0; age < hourCount; age++) {
+    int slot = hourSlot(age);
+    int count = hourCounts[slot];
+    if (minutesAgo >= count) {
+      minutesAgo -= count;
+      continue;
+    }
+
+    const Channel& c = channels[channel];
+    int32_t decoded = c.hours[slot].first;
+    uint16_t index = hourStart(c, slot);
+    for (int i = count - 1 - minutesAgo; i > 0; i--) {
+      decoded += readDelta(c.deltas, index);
+    }
+    value = (int16_t)decoded;
+    return true;
+  }
+  return false;
+}
+
+int16_t SensorHistory::trend(HistoryChannel channel, int minutes) const {
+  int count = getSampleCount();
+  if (count == 0) return 0;
+
+  int16_t past;
+  valueAt(channel, min(minutes, count - 1), past);
+  return channels[channel].last - past;
+}
+
+void SensorHistory::sparkline(HistoryChannel channel, uint8_t out[HISTORY_HOURS]) const {
+  memset(out, 0, HISTORY_HOURS);
+  if (hourCount == 0) return;
+
+  const Channel& c = channels[channel];
+  int32_t low = minimum(channel);
+  int32_t range = maximum(channel) - low;
+
+  // Decode the hours in storage order, one pass over the deltas
+  uint16_t index = c.tail;
+  for (int age = hourCount - 1; age >= 0; age--) {
+    int slot = hourSlot(age);
+    int count = hourCounts[slot];
+    int32_t value = c.hours[slot].first;
+    int32_t sum = value;
+    for (int i = 1; i < count; i++) {
+      value += readDelta(c.deltas, index);
+      sum += value;
+    }
+
+    int bar = HISTORY_HOURS - 1 - age;
+    if (bar < 0 || count == 0) continue;
+    int32_t mean = sum / count;
+    out[bar] = range > 0 ? 1 + (mean - low) * 254 / range : 128;
+  }
+}
+
+int16_t SensorHistory::toUnits(HistoryChannel channel, float reading) {
+  float units = reading * UNITS_PER_READING[channel];
+  if (units > 32767.0f) return 32767;
+  if (units < -32768.0f) return -32768;
+  return (int16_t)(units < 0 ? units - 0.5f : units + 0.5f);
+}
+
+float SensorHistory::fromUnits(HistoryChannel channel, int32_t units) {
+  return units / UNITS_PER_READING[channel];
+}
@@ -0,0 +1,101 @@
+/*
+ * Ambient history for Arduino Opla MTA Firmware
+ * Keeps 24 hours of one-minute readings per channel in fixed memory. Each
+ * hour starts from an absolute keyframe kept in a small summary (first,
+ * min, max); the rest of the hour is stored as zigzag deltas, varint
+ * coded in 4-bit groups, in a per-channel ring. Slow indoor readings mostly
+ * change by a step or two a minute, so a minute costs half a byte.
+ * Appending and dropping the oldest hour are O(1), min/max come from the
+ * hour summaries, and only point lookups decode (at most one hour).
+ */
+
+#ifndef SENSORHISTORY_H
+#define SENSORHISTORY_H
+
+#include <Arduino.h>
+
+enum HistoryChannel {
+  HISTORY_TEMPERATURE,    // 0.1 °C
+  HISTORY_HUMIDITY,       // 0.1 %RH
+  HISTORY_PRESSURE,       // 0.01 kPa
+  HISTORY_LIGHT,          // APDS9960 clear count
+  HISTORY_CHANNEL_COUNT
+};
+
+const uint32_t HISTORY_INTERVAL_MS = 60000;
+const int HISTORY_HOURS = 24;
+const int HISTORY_SAMPLES_PER_HOUR = 60;
+
+// Complete hours plus the one being filled
+const int HISTORY_HOUR_SLOTS = HISTORY_HOURS + 1;
+
+// Delta storage per channel. An hour that would overflow it pushes out the
+// oldest hour early, so noisy channels keep a shorter history.
+const int HISTORY_CHANNEL_BYTES = 1024;
+
+class SensorHistory {
+private:
+  struct HourSummary {
+    int16_t first;          // Keyframe: the hour's first reading
+    int16_t min;
+    int16_t max;
+    uint16_t nibbles;       // Delta storage used by the rest of the hour
+  };
+
+  struct Channel {
+    uint8_t deltas[HISTORY_CHANNEL_BYTES];  // Two 4-bit groups per byte
+    uint16_t tail;          // Nibble index of the oldest hour's deltas
+    uint16_t used;          // Nibbles in use
+    int16_t last;
+    HourSummary hours[HISTORY_HOUR_SLOTS];
+  };
+
+  Channel channels[HISTORY_CHANNEL_COUNT];
+  uint8_t hourCounts[HISTORY_HOUR_SLOTS];   // Readings per hour slot
+  uint8_t oldestHour;
+  uint8_t hourCount;
+  uint32_t version;
+
+  int hourSlot(int age) const { return (oldestHour + hourCount - 1 - age) % HISTORY_HOUR_SLOTS; }
+  void startHour();
+  void dropOldestHour();
+  bool hasRoom() const;
+  void writeNibble(Channel& channel, uint8_t nibble);
+  void writeDelta(Channel& channel, int32_t delta);
+  uint16_t hourStart(const Channel& channel, int slot) const;
+
+public:
+  SensorHistory();
+  void clear();
+
+  // Adds one reading per channel, in channel units
+  void append(const int16_t values[HISTORY_CHANNEL_COUNT]);
+
+  // Readings held per channel, and a counter bumped on every append
+  int getSampleCount() const;
+  uint32_t getVersion() const { return version; }
+  int getDeltaBytes(HistoryChannel channel) const { return (channels[channel].used + 1) / 2; }
+
+  int16_t latest(HistoryChannel channel) const { return channels[channel].last; }
+  int16_t minimum(HistoryChannel channel) const;
+  int16_t maximum(HistoryChannel channel) const;
+
+  // Reading from minutesAgo minutes back (0 is the latest); false if the
+  // history does not reach that far
+  bool valueAt(HistoryChannel channel, int minutesAgo, int16_t& value) const;
+
+  // Latest reading minus the one minutes back, or the oldest if the
+  // history is shorter
+  int16_t trend(HistoryChannel channel, int minutes) const;
+
+  // One value per hour, oldest first, ending with the current hour: the
+  // hour's mean scaled over the whole history's range to 1..255, or 0 for
+  // hours not yet recorded
+  void sparkline(HistoryChannel channel, uint8_t out[HISTORY_HOURS]) const;
+
+  // Conversion between sensor readings and channel units
+  static int16_t toUnits(HistoryChannel channel, float reading);
+  static float fromUnits(HistoryChannel channel, int32_t units);
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "SensorService.h"
+
+// Longest begin() waits for the first light integration
+static const unsigned long FIRST_LIGHT_TIMEOUT_MS = 250;
+
+SensorService::SensorService(MKRIoTCarrier* carrierPtr) {
+  carrier = carrierPtr;
+  memset(&sample, 0, sizeof(sample));
+  smoothedLight = 0;
+  nextClimate = 0;
+  nextPressure = 0;
+  nextHistory = 0;
+}
+
+void SensorService::begin() {
+  unsigned long start = millis();
+  while (!readLight(true) && (uint32_t)(millis() - start) < FIRST_LIGHT_TIMEOUT_MS) {
+    delay(5);
+  }
+  readClimate(true);
+  readPressure(true);
+  nextHistory = millis();
+  Serial.println("Sensor Service initialized");
+}
+
+void SensorService::update() {
+  readLight(false);
+
+  // One blocking one-shot read per call keeps each run short
+  uint32_t now = millis();
+  if ((int32_t)(now - nextClimate) >= 0) {
+    readClimate(false);
+  } else if ((int32_t)(now - nextPressure) >= 0) {
+    readPressure(false);
+  }
+
+  if ((int32_t)(now - nextHistory) >= 0) {
+    recordHistory();
+    nextHistory += HISTORY_INTERVAL_MS;
+  }
+}
+
+bool SensorService::readLight(bool seed) {
+  if (!carrier->Light.colorAvailable()) return false;
+
+  int none;
+  int clear;
+  carrier->Light.readColor(none, none, none, clear);
+  if (seed) {
+    smoothedLight = clear;
+  } else {
+    smooth(smoothedLight, clear);
+  }
+  sample.light = (int)(smoothedLight + 0.5f);
+  publish();
+  return true;
+}
+
+void SensorService::readClimate(bool seed) {
+  float temperature = carrier->Env.readTemperature();
+  float humidity = carrier->Env.readHumidity();
+  if (seed) {
+    sample.temperature = temperature;
+    sample.humidity = humidity;
+  } else {
+    smooth(sample.temperature, temperature);
+    smooth(sample.humidity, humidity);
+  }
+  nextClimate = millis() + SENSOR_CLIMATE_PERIOD_MS;
+  publish();
+}
+
+void SensorService::readPressure(bool seed) {
+  float pressure = carrier->Pressure.readPressure();
+  if (seed) {
+    sample.pressure = pressure;
+  } else {
+    smooth(sample.pressure, pressure);
+  }
+  nextPressure = millis() + SENSOR_PRESSURE_PERIOD_MS;
+  publish();
+}
+
+void SensorService::recordHistory() {
+  int16_t values[HISTORY_CHANNEL_COUNT];
+  values[HISTORY_TEMPERATURE] = SensorHistory::toUnits(HISTORY_TEMPERATURE, sample.temperature);
+  values[HISTORY_HUMIDITY] = SensorHistory::toUnits(HISTORY_HUMIDITY, sample.humidity);
+  values[HISTORY_PRESSURE] = SensorHistory::toUnits(HISTORY_PRESSURE, sample.pressure);
+  values[HISTORY_LIGHT] = SensorHistory::toUnits(HISTORY_LIGHT, sample.light);
+  history.append(values);
+}
+
+void SensorService::publish() {
+  sample.timestamp = millis();
+  sample.version++;
+}
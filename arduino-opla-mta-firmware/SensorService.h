@@ -0,0 +1,63 @@
+/*
+ * Sensor service for Arduino Opla MTA Firmware
+ * Owns the carrier's environmental sensors and publishes one smoothed,
+ * timestamped sample set. update() runs from a scheduler task and never
+ * waits on a sensor: the APDS9960 integrates continuously and is read only
+ * once a result is ready, and at most one HTS221/LPS22HB one-shot read is
+ * made per call. Modes read getSample() and never touch the hardware.
+ * Once a minute the sample is also added to the ambient history.
+ */
+
+#ifndef SENSORSERVICE_H
+#define SENSORSERVICE_H
+
+#include <Arduino.h>
+#include <Arduino_MKRIoTCarrier.h>
+#include "SensorHistory.h"
+
+const uint32_t SENSOR_POLL_MS = 500;               // Light sensor and due checks
+const uint32_t SENSOR_CLIMATE_PERIOD_MS = 2000;    // HTS221 temperature + humidity
+const uint32_t SENSOR_PRESSURE_PERIOD_MS = 10000;  // LPS22HB pressure
+
+// Weight of each new reading in the exponential moving average
+const float SENSOR_SMOOTHING = 0.3f;
+
+struct SensorSample {
+  float temperature;      // °C
+  float humidity;         // %RH
+  float pressure;         // kPa
+  int light;              // APDS9960 clear channel
+  unsigned long timestamp;  // millis() of the newest reading
+  uint32_t version;       // Bumped on every new reading
+};
+
+class SensorService {
+private:
+  MKRIoTCarrier* carrier;
+  SensorSample sample;
+  float smoothedLight;
+  uint32_t nextClimate;
+  uint32_t nextPressure;
+  uint32_t nextHistory;
+  SensorHistory history;
+
+  static void smooth(float& value, float reading) { value += SENSOR_SMOOTHING * (reading - value); }
+  bool readLight(bool seed);
+  void readClimate(bool seed);
+  void readPressure(bool seed);
+  void publish();
+  void recordHistory();
+
+public:
+  SensorService(MKRIoTCarrier* carrierPtr);
+
+  // Takes a first reading of every sensor to seed the averages; call after
+  // carrier.begin(). This is the only call that waits for the light sensor.
+  void begin();
+  void update();
+
+  const SensorSample& getSample() const { return sample; }
+  const SensorHistory& getHistory() const { return history; }
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Binary station summary for Arduino Opla MTA Firmware
+ * A fixed-layout alternative to the proxy's JSON response, decoded by
+ * MTAManager straight into StationData without a parser or document
+ * memory. All integers are little-endian.
+ *
+ *   Header, STATION_SUMMARY_HEADER_BYTES:
+ *     0   2  magic "MS"
+ *     2   1  format version (STATION_SUMMARY_VERSION)
+ *     3   1  flags, 0
+ *     4   8  station ID, NUL padded
+ *     12  4  feed timestamp, Unix seconds
+ *     16  1  uptown records
+ *     17  1  downtown records
+ *     18  1  strings
+ *     19  1  reserved, 0
+ *     20  4  CRC-32 of every other byte of the summary
+ *   Records, uptown then downtown, soonest first, 6 bytes each:
+ *     0   1  route: string index
+ *     1   1  destination: string index
+ *     2   4  arrival, Unix seconds on the feed's clock
+ *   Strings, each a length byte and that many bytes, no terminator
+ *
+ * Strings come last so a decoder can keep just the indices of the records
+ * it wants and fill in the text as it streams past.
+ */
+
+#ifndef STATIONSUMMARY_H
+#define STATIONSUMMARY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Sent in Accept by clients that can decode it, and as the Content-Type
+const char* const STATION_SUMMARY_CONTENT_TYPE = "application/x-mta-summary";
+
+const uint8_t STATION_SUMMARY_MAGIC[2] = {'M', 'S'};
+const uint8_t STATION_SUMMARY_VERSION = 1;
+
+const int STATION_SUMMARY_HEADER_BYTES = 24;
+const int STATION_SUMMARY_RECORD_BYTES = 6;
+const int STATION_SUMMARY_ID_BYTES = 8;
+
+const int STATION_SUMMARY_ID_OFFSET = 4;
+const int STATION_SUMMARY_TIMESTAMP_OFFSET = 12;
+const int STATION_SUMMARY_COUNTS_OFFSET = 16;
+const int STATION_SUMMARY_CRC_OFFSET = 20;
+
+inline uint32_t stationSummaryRead32(const uint8_t* bytes) {
+  return bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// CRC-32 (IEEE, as zlib) four bits at a time: a 64-byte table instead of
+// the usual 1 KB. Start from 0; each call continues the last.
+inline uint32_t stationSummaryCrc(uint32_t crc, const uint8_t* bytes, size_t length) {
+  static const uint32_t NIBBLE_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= bytes[i];
+    crc = (crc >> 4) ^ NIBBLE_TABLE[crc & 0x0F];
+    crc = (crc >> 4) ^ NIBBLE_TABLE[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+#endif
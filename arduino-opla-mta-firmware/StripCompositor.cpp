@@ -0,0 +1,228 @@
+#include "StripCompositor.h"
+
+uint16_t StripCompositor::stripBuffer[STRIP_BUFFER_PIXELS];
+CompositorStats StripCompositor::stats = {0, 0, 0};
+
+StripCompositor::StripCompositor(Adafruit_SPITFT* target, int16_t w, int16_t h) : Adafruit_GFX(w, h) {
+  display = target;
+  compositing = false;
+  stripHeight = 0;
+  clearClip();
+}
+
+void StripCompositor::beginRegion(int16_t x, int16_t y, int16_t w, int16_t h) {
+  // Clip the region to the screen
+  int16_t x1 = min((int16_t)(x + w), _width);
+  int16_t y1 = min((int16_t)(y + h), _height);
+  regionX = max(x, (int16_t)0);
+  regionY = max(y, (int16_t)0);
+  regionW = x1 - regionX;
+  regionH = y1 - regionY;
+
+  // Narrow regions get taller strips from the same buffer
+  compositing = regionW > 0 && regionH > 0;
+  rowsPerStrip = compositing ? min((int)regionH, STRIP_BUFFER_PIXELS / regionW) : 0;
+  stripY = regionY;
+  stripHeight = 0;
+}
+
+bool StripCompositor::nextStrip() {
+  if (!compositing) return false;
+
+  // Send the strip just drawn, then move down to the next one
+  if (stripHeight > 0) {
+    flushStrip();
+    stripY += stripHeight;
+  }
+
+  int16_t remaining = regionY + regionH - stripY;
+  if (remaining <= 0) {
+    compositing = false;
+    stripHeight = 0;
+    return false;
+  }
+
+  stripHeight = min(rowsPerStrip, remaining);
+  return true;
+}
+
+bool StripCompositor::stripIntersects(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (!compositing) return true;
+  return x < regionX + regionW && regionX < x + w &&
+         y < stripY + stripHeight && stripY < y + h;
+}
+
+void StripCompositor::visibleRows(int16_t& top, int16_t& bottom) {
+  top = max(compositing ? stripY : (int16_t)0, clipY0);
+  bottom = min(compositing ? (int16_t)(stripY + stripHeight - 1) : (int16_t)(_height - 1), clipY1);
+}
+
+void StripCompositor::setClip(int16_t x, int16_t y, int16_t w, int16_t h) {
+  clipX0 = x;
+  clipY0 = y;
+  clipX1 = x + w - 1;
+  clipY1 = y + h - 1;
+}
+
+void StripCompositor::clearClip() {
+  clipX0 = 0;
+  clipY0 = 0;
+  clipX1 = _width - 1;
+  clipY1 = _height - 1;
+}
+
+void StripCompositor::flushStrip() {
+  display->startWrite();
+  display->setAddrWindow(regionX, stripY, regionW, stripHeight);
+  display->writePixels(stripBuffer, (uint32_t)regionW * stripHeight);
+  display->endWrite();
+
+  stats.strips++;
+  stats.transactions++;
+  stats.pixelsSent += (uint32_t)regionW * stripHeight;
+}
+
+bool StripCompositor::clipSpan(int16_t& x, int16_t& y, int16_t& w, int16_t& h) {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+
+  // Clip to the current strip while compositing, otherwise to the screen,
+  // and to any clip rectangle
+  int16_t left = max(compositing ? regionX : (int16_t)0, clipX0);
+  int16_t top = max(compositing ? stripY : (int16_t)0, clipY0);
+  int16_t right = min(compositing ? (int16_t)(regionX + regionW - 1) : (int16_t)(_width - 1), clipX1);
+  int16_t bottom = min(compositing ? (int16_t)(stripY + stripHeight - 1) : (int16_t)(_height - 1), clipY1);
+
+  int16_t x1 = x + w - 1;
+  int16_t y1 = y + h - 1;
+  if (x < left) x = left;
+  if (y < top) y = top;
+  if (x1 > right) x1 = right;
+  if (y1 > bottom) y1 = bottom;
+  w = x1 - x + 1;
+  h = y1 - y + 1;
+  return w > 0 && h > 0;
+}
+
+void StripCompositor::fillStrip(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  uint16_t* row = stripBuffer + (y - stripY) * regionW + (x - regionX);
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      row[i] = color;
+    }
+    row += regionW;
+  }
+}
+
+void StripCompositor::drawMask(int16_t x, int16_t y, const uint8_t* mask, int16_t w, int16_t h,
+                               int16_t stride, uint16_t color) {
+  int16_t clipX = x, clipY = y, clipW = w, clipH = h;
+  if (!clipSpan(clipX, clipY, clipW, clipH)) return;
+  int16_t first = clipX - x, end = first + clipW;   // Mask columns in view
+
+  startWrite();
+  for (int16_t j = clipY; j < clipY + clipH; j++) {
+    const uint8_t* bits = mask + (j - y) * stride;
+    uint16_t* row = compositing ? stripBuffer + (j - stripY) * regionW : nullptr;
+
+    // A byte at a time, stopping as soon as no bits are left in it
+    for (int16_t column = first & ~7; column < end; column += 8) {
+      uint8_t byte = bits[column >> 3];
+      for (int16_t i = column; byte; i++, byte <<= 1) {
+        if (!(byte & 0x80) || i < first || i >= end) continue;
+        if (compositing) {
+          row[x - regionX + i] = color;
+        } else {
+          display->writePixel(x + i, j, color);
+          stats.pixelsSent++;
+        }
+      }
+    }
+  }
+  endWrite();
+}
+
+void StripCompositor::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (compositing) {
+    writePixel(x, y, color);
+    return;
+  }
+  if (x >= 0 && x < _width && y >= 0 && y < _height) {
+    display->drawPixel(x, y, color);
+    stats.transactions++;
+    stats.pixelsSent++;
+  }
+}
+
+void StripCompositor::startWrite() {
+  if (!compositing) {
+    display->startWrite();
+    stats.transactions++;
+  }
+}
+
+void StripCompositor::endWrite() {
+  if (!compositing) {
+    display->endWrite();
+  }
+}
+
+void StripCompositor::writePixel(int16_t x, int16_t y, uint16_t color) {
+  int16_t w = 1;
+  int16_t h = 1;
+  if (!clipSpan(x, y, w, h)) return;
+
+  if (compositing) {
+    stripBuffer[(y - stripY) * regionW + (x - regionX)] = color;
+  } else {
+    display->writePixel(x, y, color);
+    stats.pixelsSent++;
+  }
+}
+
+void StripCompositor::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!clipSpan(x, y, w, h)) return;
+
+  if (compositing) {
+    fillStrip(x, y, w, h, color);
+  } else {
+    display->writeFillRect(x, y, w, h, color);
+    stats.pixelsSent += (uint32_t)w * h;
+  }
+}
+
+void StripCompositor::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  writeFillRect(x, y, 1, h, color);
+}
+
+void StripCompositor::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  writeFillRect(x, y, w, 1, color);
+}
+
+void StripCompositor::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+void StripCompositor::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  startWrite();
+  writeFillRect(x, y, 1, h, color);
+  endWrite();
+}
+
+void StripCompositor::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  startWrite();
+  writeFillRect(x, y, w, 1, color);
+  endWrite();
+}
+
+void StripCompositor::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
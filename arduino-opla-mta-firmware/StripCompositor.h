@@ -0,0 +1,83 @@
+/*
+ * Strip compositor for Arduino Opla MTA Firmware
+ * Adafruit_GFX target that renders a screen region into a small off-screen
+ * RGB565 strip and sends each finished strip to the panel as one SPI burst,
+ * so overlapping layers cost RAM writes instead of bus transactions.
+ * Outside a region, drawing passes straight through to the panel.
+ */
+
+#ifndef STRIPCOMPOSITOR_H
+#define STRIPCOMPOSITOR_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SPITFT.h>
+
+// 240 x 16 RGB565 pixels = 7.5 KB, shared by every compositor since they
+// all feed the same panel (SAMD21 has 32 KB of RAM in total)
+const int STRIP_BUFFER_PIXELS = 240 * 16;
+
+// What actually went out over SPI, for measuring the compositor's effect
+struct CompositorStats {
+  uint32_t strips;        // Strips flushed from the buffer
+  uint32_t transactions;  // SPI transactions started, strips included
+  uint32_t pixelsSent;    // Pixels written to the panel, strips included
+};
+
+class StripCompositor : public Adafruit_GFX {
+private:
+  Adafruit_SPITFT* display;
+
+  // Region being composited; stripHeight == 0 before the first strip
+  bool compositing;
+  int16_t regionX, regionY, regionW, regionH;
+  int16_t rowsPerStrip;
+  int16_t stripY, stripHeight;
+
+  // Further clip on top of the region's, the whole screen when not set
+  int16_t clipX0, clipY0, clipX1, clipY1;
+
+  static uint16_t stripBuffer[STRIP_BUFFER_PIXELS];
+  static CompositorStats stats;
+
+  bool clipSpan(int16_t& x, int16_t& y, int16_t& w, int16_t& h);
+  void fillStrip(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void flushStrip();
+
+public:
+  StripCompositor(Adafruit_SPITFT* target, int16_t w, int16_t h);
+
+  // Composite a region strip by strip. Draw the whole region, background
+  // first, once per nextStrip() that returns true:
+  //   for (c.beginRegion(x, y, w, h); c.nextStrip(); ) { ...draw... }
+  void beginRegion(int16_t x, int16_t y, int16_t w, int16_t h);
+  bool nextStrip();
+  bool stripIntersects(int16_t x, int16_t y, int16_t w, int16_t h);
+  void visibleRows(int16_t& top, int16_t& bottom);  // Inclusive; whole screen outside a region
+
+  // Confines drawing to a rectangle until clearClip()
+  void setClip(int16_t x, int16_t y, int16_t w, int16_t h);
+  void clearClip();
+
+  // Sets the pixels under the set bits of a 1-bit mask (rows stride bytes
+  // apart, most significant bit leftmost); while compositing they are
+  // written straight into the strip
+  void drawMask(int16_t x, int16_t y, const uint8_t* mask, int16_t w, int16_t h, int16_t stride,
+                uint16_t color);
+
+  static const CompositorStats& getStats() { return stats; }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void startWrite() override;
+  void endWrite() override;
+  void writePixel(int16_t x, int16_t y, uint16_t color) override;
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+};
+
+#endif
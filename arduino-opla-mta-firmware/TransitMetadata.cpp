@@ -0,0 +1,59 @@
+#include "TransitMetadata.h"
+
+static const char* transitString(uint16_t offset) {
+  return TRANSIT_STRINGS + offset;
+}
+
+// Entry for a stop ID, or null. Unknown IDs hash onto some slot too, so
+// the ID stored there has to match.
+static const TransitStopEntry* probeStop(const char* id, size_t length) {
+  if (length == 0 || length > (size_t)TRANSIT_STOP_ID_BYTES || TRANSIT_STOP_COUNT == 0) return nullptr;
+  uint32_t bucket = transitStopHash(id, length, 0) % TRANSIT_STOP_BUCKETS;
+  uint16_t displacement = TRANSIT_STOP_DISPLACEMENTS[bucket];
+  const TransitStopEntry* entry = &TRANSIT_STOPS[transitStopHash(id, length, displacement + 1u) % TRANSIT_STOP_COUNT];
+
+  if (strncmp(entry->id, id, length) != 0) return nullptr;
+  return length == (size_t)TRANSIT_STOP_ID_BYTES || entry->id[length] == 0 ? entry : nullptr;
+}
+
+bool findTransitStation(const char* stopId, TransitStation& station) {
+  size_t length = strlen(stopId);
+  const TransitStopEntry* entry = probeStop(stopId, length);
+
+  // Platforms are the parent ID plus N or S
+  char last = length > 1 ? stopId[length - 1] : 0;
+  if (!entry && (last == 'N' || last == 'S')) entry = probeStop(stopId, length - 1);
+  if (!entry) return false;
+
+  station.name = transitString(entry->name);
+  station.northLabel = transitString(entry->northLabel);
+  station.southLabel = transitString(entry->southLabel);
+  return true;
+}
+
+bool findTransitRoute(const char* routeId, TransitRoute& route) {
+  // A couple of dozen routes: a binary search is as quick as hashing
+  int low = 0, high = TRANSIT_ROUTE_COUNT - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    const TransitRouteEntry* entry = &TRANSIT_ROUTES[middle];
+    int order = strncmp(routeId, entry->id, TRANSIT_ROUTE_ID_BYTES);
+    if (order == 0 && strlen(routeId) <= (size_t)TRANSIT_ROUTE_ID_BYTES) {
+      route.name = transitString(entry->name);
+      route.color = entry->color;
+      route.textColor = entry->textColor;
+      return true;
+    }
+    if (order < 0) {
+      high = middle - 1;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return false;
+}
+
+uint16_t transitRouteColor(const char* routeId) {
+  TransitRoute route;
+  return findTransitRoute(routeId, route) ? route.color : TRANSIT_DEFAULT_COLOR;
+}
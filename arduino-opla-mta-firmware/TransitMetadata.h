@@ -0,0 +1,83 @@
+/*
+ * Station and route metadata for Arduino Opla MTA Firmware
+ * Names, direction labels and line colors for any stop or route, from
+ * tables generated out of GTFS static data (TransitTables.cpp, written by
+ * sim/tools/transit_tables.cpp). The tables are const, so the SAMD21
+ * links them into flash and reads them in place; a stop lookup is one
+ * minimal perfect hash probe, nothing is copied into RAM and no file is
+ * read at runtime.
+ *
+ * The stop hash is hash-and-displace: a first hash picks a bucket, and
+ * the bucket's displacement seeds a second hash that lands each of its
+ * stops on a slot no other stop uses.
+ */
+
+#ifndef TRANSITMETADATA_H
+#define TRANSITMETADATA_H
+
+#include <Arduino.h>
+
+const int TRANSIT_STOP_ID_BYTES = 4;    // Parent stop IDs are "A27", "635", ...
+const int TRANSIT_ROUTE_ID_BYTES = 4;   // "6X", "GS", "SI"
+
+// Colors used when a route is not in the tables
+const uint16_t TRANSIT_DEFAULT_COLOR = 0xA555;       // MTA gray
+const uint16_t TRANSIT_DEFAULT_TEXT_COLOR = 0xFFFF;
+
+// Generated table rows; strings are offsets into TRANSIT_STRINGS
+struct TransitStopEntry {
+  char id[TRANSIT_STOP_ID_BYTES];       // NUL padded, not always terminated
+  uint16_t name;
+  uint16_t northLabel;
+  uint16_t southLabel;
+};
+
+struct TransitRouteEntry {
+  char id[TRANSIT_ROUTE_ID_BYTES];
+  uint16_t color;                       // RGB565
+  uint16_t textColor;
+  uint16_t name;
+};
+
+extern const char TRANSIT_STRINGS[];
+extern const TransitStopEntry TRANSIT_STOPS[];            // By hash slot
+extern const uint16_t TRANSIT_STOP_COUNT;
+extern const uint16_t TRANSIT_STOP_DISPLACEMENTS[];       // Per bucket
+extern const uint16_t TRANSIT_STOP_BUCKETS;
+extern const TransitRouteEntry TRANSIT_ROUTES[];          // Sorted by ID
+extern const uint16_t TRANSIT_ROUTE_COUNT;
+
+// Shared by the generator and the lookup: FNV-1a with a seeded basis,
+// then murmur3's finalizer so the low bits are usable modulo any size
+inline uint32_t transitStopHash(const char* id, size_t length, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+  for (size_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)id[i]) * 16777619u;
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35u;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+struct TransitStation {
+  const char* name;                     // All point into flash
+  const char* northLabel;               // "Uptown & The Bronx", ...
+  const char* southLabel;
+};
+
+struct TransitRoute {
+  const char* name;                     // "Lexington Avenue Express", ...
+  uint16_t color;
+  uint16_t textColor;
+};
+
+// A parent station ("635") or either of its platforms ("635N")
+bool findTransitStation(const char* stopId, TransitStation& station);
+
+bool findTransitRoute(const char* routeId, TransitRoute& route);
+
+// The route's bullet color, TRANSIT_DEFAULT_COLOR if it is unknown
+uint16_t transitRouteColor(const char* routeId);
+
+#endif
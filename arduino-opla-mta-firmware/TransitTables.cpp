@@ -0,0 +1,83 @@
+/*
+ * Transit metadata tables for Arduino Opla MTA Firmware
+ * Generated by sim/tools/transit_tables.cpp from sim/gtfs; do not edit.
+ * 3 stations, 29 routes.
+ */
+
+#include "TransitMetadata.h"
+
+const char TRANSIT_STRINGS[] =
+  "14 St - Union Sq\000"
+  "UPTOWN\000"
+  "DOWNTOWN\000"
+  "Astor Pl\000"
+  "Union Sq - 14 St\000"
+  "Broadway - 7 Avenue Local\000"
+  "7 Avenue Express\000"
+  "Lexington Avenue Express\000"
+  "Lexington Avenue Local\000"
+  "Pelham Bay Park Express\000"
+  "Flushing Local\000"
+  "Flushing Express\000"
+  "8 Avenue Express\000"
+  "6 Avenue Express\000"
+  "8 Avenue Local\000"
+  "Queens Blvd Express/6 Av Local\000"
+  "Franklin Avenue Shuttle\000"
+  "Brooklyn F Express\000"
+  "Brooklyn-Queens Crosstown\000"
+  "42 St Shuttle\000"
+  "Rockaway Park Shuttle\000"
+  "Nassau St Local\000"
+  "14 St-Canarsie Local\000"
+  "Queens Blvd Local/6 Av Local\000"
+  "Broadway Express\000"
+  "Broadway Local\000"
+  "Staten Island Railway\000"
+  "Nassau St Express\000"
+  ;
+
+const uint16_t TRANSIT_STOP_COUNT = 3;
+const TransitStopEntry TRANSIT_STOPS[] = {
+  {{'L', '0', '8'}, 0, 17, 24},
+  {{'6', '2', '6'}, 33, 17, 24},
+  {{'4', '0', '1'}, 42, 17, 24},
+};
+
+const uint16_t TRANSIT_STOP_BUCKETS = 1;
+const uint16_t TRANSIT_STOP_DISPLACEMENTS[] = {
+  10
+};
+
+const uint16_t TRANSIT_ROUTE_COUNT = 29;
+const TransitRouteEntry TRANSIT_ROUTES[] = {
+  {{'1'}, 0xE9A5, 0xFFFF, 59},
+  {{'2'}, 0xE9A5, 0xFFFF, 85},
+  {{'3'}, 0xE9A5, 0xFFFF, 85},
+  {{'4'}, 0x0487, 0xFFFF, 102},
+  {{'5'}, 0x0487, 0xFFFF, 102},
+  {{'6'}, 0x0487, 0xFFFF, 127},
+  {{'6', 'X'}, 0x052B, 0xFFFF, 150},
+  {{'7'}, 0xB995, 0xFFFF, 174},
+  {{'7', 'X'}, 0xB995, 0xFFFF, 189},
+  {{'A'}, 0x01D4, 0xFFFF, 206},
+  {{'B'}, 0xFB03, 0xFFFF, 223},
+  {{'C'}, 0x01D4, 0xFFFF, 240},
+  {{'D'}, 0xFB03, 0xFFFF, 223},
+  {{'E'}, 0x01D4, 0xFFFF, 240},
+  {{'F'}, 0xFB03, 0xFFFF, 255},
+  {{'F', 'S'}, 0x6B6E, 0xFFFF, 286},
+  {{'F', 'X'}, 0xFB03, 0xFFFF, 310},
+  {{'G'}, 0x6DE8, 0xFFFF, 329},
+  {{'G', 'S'}, 0x6B6E, 0xFFFF, 355},
+  {{'H'}, 0x6B6E, 0xFFFF, 369},
+  {{'J'}, 0x9B26, 0xFFFF, 391},
+  {{'L'}, 0xA555, 0xFFFF, 407},
+  {{'M'}, 0xFB03, 0xFFFF, 428},
+  {{'N'}, 0xFE61, 0x0000, 457},
+  {{'Q'}, 0xFE61, 0x0000, 457},
+  {{'R'}, 0xFE61, 0x0000, 474},
+  {{'S', 'I'}, 0x01D4, 0xFFFF, 489},
+  {{'W'}, 0xFE61, 0x0000, 474},
+  {{'Z'}, 0x9B26, 0xFFFF, 511},
+};
@@ -0,0 +1,46 @@
+#include "WallClock.h"
+
+WallClock::WallClock() {
+  baseTime = 0;
+  baseMillis = 0;
+  lastAttempt = 0;
+  attempted = false;
+  synced = false;
+}
+
+uint32_t WallClock::now() const {
+  return baseTime + (uint32_t)(millis() - baseMillis) / 1000;
+}
+
+uint32_t WallClock::msUntil(uint32_t time) const {
+  int64_t ms = (int64_t)(int32_t)(time - baseTime) * 1000 - (uint32_t)(millis() - baseMillis);
+  return ms > 0 ? (uint32_t)ms : 0;
+}
+
+int32_t WallClock::sync() {
+  uint32_t ms = millis();
+
+  // Fold whole seconds into the base so the millis() difference never wraps
+  uint32_t seconds = (uint32_t)(ms - baseMillis) / 1000;
+  baseTime += seconds;
+  baseMillis += seconds * 1000;
+
+  uint32_t interval = synced ? WALL_CLOCK_RESYNC_MS : WALL_CLOCK_RETRY_MS;
+  if (attempted && (uint32_t)(ms - lastAttempt) < interval) return 0;
+  if (WiFi.status() != WL_CONNECTED) return 0;
+
+  attempted = true;
+  lastAttempt = ms;
+  uint32_t epoch = WiFi.getTime();
+  if (epoch < WALL_CLOCK_MIN_EPOCH) return 0;
+
+  int32_t moved = (int32_t)(epoch - now());
+  baseTime = epoch;
+  baseMillis = ms;
+  if (!synced) {
+    Serial.print("Clock set from network: ");
+    Serial.println(epoch);
+  }
+  synced = true;
+  return moved;
+}
@@ -0,0 +1,43 @@
+/*
+ * Wall clock for Arduino Opla MTA Firmware
+ * Keeps Unix time in seconds, set from WiFi.getTime() (the NINA module's
+ * NTP time) and carried forward on millis() between syncs. Until the first
+ * sync it counts seconds since boot, so countdowns still run; sync()
+ * reports how far the clock moved so callers can shift stored times.
+ */
+
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+const uint32_t WALL_CLOCK_RESYNC_MS = 3600000UL;   // Once synced
+const uint32_t WALL_CLOCK_RETRY_MS = 10000;        // Until the first sync
+
+// WiFi.getTime() returns 0 until the module has reached an NTP server
+const uint32_t WALL_CLOCK_MIN_EPOCH = 1577836800UL;  // 2020-01-01
+
+class WallClock {
+private:
+  uint32_t baseTime;          // now() at baseMillis
+  uint32_t baseMillis;
+  uint32_t lastAttempt;
+  bool attempted;
+  bool synced;
+
+public:
+  WallClock();
+
+  // Reads the network time when a sync is due. Returns the seconds the
+  // clock moved, or 0 if it was not synced this call. Call periodically.
+  int32_t sync();
+
+  bool isSynced() const { return synced; }
+  uint32_t now() const;
+
+  // Milliseconds until now() reaches time, 0 if it has
+  uint32_t msUntil(uint32_t time) const;
+};
+
+#endif
@@ -8,6 +8,13 @@
 #include "LEDManager.h"
 #include "ModeManager.h"
 #include "MTAManager.h"
+#include "SensorService.h"
+#include "StripCompositor.h"
+#include "RadialAnimator.h"
+#include "Profiler.h"
+#include "MemoryMonitor.h"
+#include "Scheduler.h"
+#include "IdleSleep.h"
 #include <Arduino_MKRIoTCarrier.h>
 
 // Define API keys
@@ -18,9 +25,169 @@ WiFiManager wifiManager;
 LEDManager ledManager;
 MKRIoTCarrier carrier;
 MTAManager mtaManager;
-ModeManager modeManager(&carrier, &mtaManager);
+SensorService sensorService(&carrier);
+ModeManager modeManager(&carrier, &mtaManager, &sensorService);
+Scheduler scheduler;
+IdleSleep idleSleep;
+
+// Task periods (milliseconds)
+const uint32_t WIFI_POLL_MS = 250;
+const uint32_t MTA_FETCH_POLL_MS = 10;     // While a fetch is in flight
+const uint32_t MTA_IDLE_POLL_MS = 1000;    // Checking for stale stations
+const uint32_t MODE_UPDATE_MS = 5000;
+const uint32_t STATUS_REPORT_MS = 10000;
+const uint32_t TASK_REPORT_MS = 30000;
+const uint32_t SERIAL_POLL_MS = 250;       // Profiler commands
+
+// Time since the last touch after which the network may block the loop
+const uint32_t UI_QUIET_MS = 3000;
+
+int mtaTask = -1;
+int frameTask = -1;         // One-shot, rescheduled while a mode animates
+bool framesRunning = false;
+uint32_t lastTouchMs = 0;
+
+// Starts animation frames after anything that may have started a tween
+void startFrames() {
+  if (!framesRunning && modeManager.isAnimating()) {
+    framesRunning = true;
+    scheduler.runIn(frameTask, 0);
+  }
+}
+
+// Wake check for idle sleep: senses the touch pads and handles presses
+bool pollButtons(void*) {
+  MEMORY_SCOPE(MEMORY_MODES);
+  carrier.Buttons.update();
+  
+  // Check for button presses
+  bool pressed = false;
+  static const touchButtons pads[] = {TOUCH0, TOUCH1, TOUCH2, TOUCH3, TOUCH4};
+  for (int i = 0; i < 5; i++) {
+    if (carrier.Buttons.onTouchDown(pads[i])) {
+      modeManager.handleButtonPress(i);
+      pressed = true;
+    }
+  }
+  if (pressed) {
+    lastTouchMs = millis();
+    startFrames();
+  }
+  return pressed;
+}
+
+// Quiet check for MTA fetches: no touch for a while and nothing animating
+bool uiQuiet(void*) {
+  return !framesRunning && millis() - lastTouchMs >= UI_QUIET_MS;
+}
+
+void updateConnectivity(void*) {
+  MEMORY_SCOPE(MEMORY_WIFI);
+  wifiManager.update();
+  
+  // Update LED status based on WiFi state
+  if (wifiManager.isConnected()) {
+    ledManager.setWiFiStatus(WIFI_CONNECTED);
+  } else if (wifiManager.isConnecting()) {
+    ledManager.setWiFiStatus(WIFI_CONNECTING);
+  } else {
+    ledManager.setWiFiStatus(WIFI_DISCONNECTED);
+  }
+  ledManager.update();
+}
+
+void updateTransitData(void*) {
+  // Keep the MTA station cache warm; poll quickly only while fetching
+  MEMORY_SCOPE(MEMORY_TRANSIT);
+  mtaManager.update();
+  scheduler.setPeriod(mtaTask, mtaManager.isFetching() ? MTA_FETCH_POLL_MS : MTA_IDLE_POLL_MS);
+}
+
+void sampleSensors(void*) {
+  MEMORY_SCOPE(MEMORY_SENSORS);
+  sensorService.update();
+}
+
+void updateMode(void*) {
+  MEMORY_SCOPE(MEMORY_MODES);
+  modeManager.update();
+  startFrames();
+}
+
+void renderFrame(void*) {
+  MEMORY_SCOPE(MEMORY_MODES);
+  uint32_t nextMs = modeManager.renderFrame();
+  framesRunning = nextMs > 0;
+  if (framesRunning) scheduler.runIn(frameTask, nextMs);
+}
+
+void printStatus(void*) {
+  Serial.print("Status: WiFi=");
+  if (wifiManager.isConnected()) {
+    Serial.print("CONNECTED");
+  } else if (wifiManager.isConnecting()) {
+    Serial.print("CONNECTING");
+  } else {
+    Serial.print("DISCONNECTED");
+  }
+  Serial.print(", Mode=");
+  Serial.print(modeManager.getCurrentModeName());
+  Serial.print(", Uptime=");
+  Serial.print(millis() / 1000);
+  Serial.print("s, Display=");
+  Serial.print(StripCompositor::getStats().pixelsSent);
+  Serial.print("px/");
+  Serial.print(StripCompositor::getStats().transactions);
+  Serial.print(" txn, CPU=");
+  uint16_t duty = idleSleep.getDutyCyclePermille();
+  Serial.print(duty / 10);
+  Serial.print(".");
+  Serial.print(duty % 10);
+  Serial.print("%, Anim=");
+  const AnimatorStats& anim = RadialAnimator::getStats();
+  uint32_t fps = anim.animatingMs ? (uint64_t)anim.frames * 10000 / anim.animatingMs : 0;
+  Serial.print(fps / 10);
+  Serial.print(".");
+  Serial.print(fps % 10);
+  Serial.print("fps/");
+  Serial.print(anim.droppedFrames);
+  Serial.print(" dropped, Heap=");
+  const MemoryStats& memory = MemoryMonitor::sample();
+  Serial.print(memory.freeBytes);
+  Serial.print("B free/");
+  Serial.print(memory.largestFreeBlock);
+  Serial.print("B block, Stack=");
+  Serial.print(memory.stackBytes);
+  Serial.print("B peak, Allocs=");
+  Serial.println(MemoryMonitor::getTotalAllocations());
+  idleSleep.resetStats();
+}
+
+#if PROFILER_ENABLED
+// 'P' dumps the probes as a binary record (sim/tools/profile_decode.cpp
+// reads it back out of a capture), 'R' starts them over
+void pollSerial(void*) {
+  while (Serial.available() > 0) {
+    int command = Serial.read();
+    if (command == PROFILE_DUMP_COMMAND) {
+      Profiler::dump(Serial);
+      Serial.flush();
+    } else if (command == PROFILE_RESET_COMMAND) {
+      Profiler::reset();
+    }
+  }
+}
+#endif
+
+void printTaskStats(void*) {
+  scheduler.printStats(Serial);
+  mtaManager.printStats(Serial);
+  MemoryMonitor::printStats(Serial);
+}
 
 void setup() {
+  // Before anything else runs, so the stack paint covers all of it
+  MemoryMonitor::begin();
   Serial.begin(115200);
   // Wait for serial port to connect with timeout (for standalone operation)
   unsigned long serialTimeout = millis();
@@ -46,82 +213,59 @@ void setup() {
   
   // Initialize WiFi first (needed for MTA manager)
   Serial.println("Starting WiFi Manager...");
-  wifiManager.begin();
+  {
+    MEMORY_SCOPE(MEMORY_WIFI);
+    wifiManager.begin();
+  }
   
   // Initialize MTA Manager
   Serial.println("Starting MTA Manager...");
-  mtaManager.begin();
+  {
+    MEMORY_SCOPE(MEMORY_TRANSIT);
+    mtaManager.begin();
+  }
+  
+  // Initialize sensor sampling (modes read its samples)
+  Serial.println("Starting Sensor Service...");
+  {
+    MEMORY_SCOPE(MEMORY_SENSORS);
+    sensorService.begin();
+  }
   
   // Initialize Mode Manager
   Serial.println("Starting Mode Manager...");
-  modeManager.begin();
+  {
+    MEMORY_SCOPE(MEMORY_MODES);
+    modeManager.begin();
+  }
+  
+  // Register periodic work; loop() only runs what is due. Touch pads are
+  // sensed while idle, so they need no task.
+  idleSleep.setWakeCheck(pollButtons, nullptr);
+  mtaManager.setQuietCheck(uiQuiet, nullptr);
+  scheduler.every(WIFI_POLL_MS, updateConnectivity, nullptr, "wifi");
+  scheduler.every(SENSOR_POLL_MS, sampleSensors, nullptr, "sensors");
+  mtaTask = scheduler.every(MTA_IDLE_POLL_MS, updateTransitData, nullptr, "mta");
+  scheduler.every(MODE_UPDATE_MS, updateMode, nullptr, "mode", MODE_UPDATE_MS);
+  scheduler.every(STATUS_REPORT_MS, printStatus, nullptr, "status", STATUS_REPORT_MS);
+  scheduler.every(TASK_REPORT_MS, printTaskStats, nullptr, "tasks", TASK_REPORT_MS);
+  frameTask = scheduler.after(0, renderFrame, nullptr, "frame");
+#if PROFILER_ENABLED
+  Profiler::begin();
+  scheduler.every(SERIAL_POLL_MS, pollSerial, nullptr, "serial");
+#endif
+  idleSleep.resetStats();
   
   Serial.println("=== Setup complete ===");
   Serial.println("Touch button 0 to enter Temperature/Humidity mode");
 }
 
 void loop() {
-  static unsigned long lastDebug = 0;
-  static unsigned long lastModeUpdate = 0;
-  
-  // Update WiFi connection status
-  wifiManager.update();
-  
-  // Update LED status based on WiFi state
-  if (wifiManager.isConnected()) {
-    ledManager.setWiFiStatus(WIFI_CONNECTED);
-  } else if (wifiManager.isConnecting()) {
-    ledManager.setWiFiStatus(WIFI_CONNECTING);
-  } else {
-    ledManager.setWiFiStatus(WIFI_DISCONNECTED);
-  }
-  
-  // Update LED animations
-  ledManager.update();
-  
-  // Update button states
-  carrier.Buttons.update();
-  
-  // Check for button presses
-  if (carrier.Buttons.onTouchDown(TOUCH0)) {
-    modeManager.handleButtonPress(0);
-  }
-  if (carrier.Buttons.onTouchDown(TOUCH1)) {
-    modeManager.handleButtonPress(1);
+  // Run due tasks, then sleep until the next deadline or a touch
+  uint32_t idleMs;
+  {
+    PROFILE_SCOPE(PROBE_LOOP);
+    idleMs = scheduler.runDue();
   }
-  if (carrier.Buttons.onTouchDown(TOUCH2)) {
-    modeManager.handleButtonPress(2);
-  }
-  if (carrier.Buttons.onTouchDown(TOUCH3)) {
-    modeManager.handleButtonPress(3);
-  }
-  if (carrier.Buttons.onTouchDown(TOUCH4)) {
-    modeManager.handleButtonPress(4);
-  }
-  
-  // Update mode display every 5 seconds (less frequent updates)
-  if (millis() - lastModeUpdate > 5000) {
-    modeManager.update();
-    lastModeUpdate = millis();
-  }
-  
-  // Debug output every 10 seconds
-  if (millis() - lastDebug > 10000) {
-    Serial.print("Status: WiFi=");
-    if (wifiManager.isConnected()) {
-      Serial.print("CONNECTED");
-    } else if (wifiManager.isConnecting()) {
-      Serial.print("CONNECTING");
-    } else {
-      Serial.print("DISCONNECTED");
-    }
-    Serial.print(", Mode=");
-    Serial.print(modeManager.getCurrentModeName());
-    Serial.print(", Uptime=");
-    Serial.print(millis() / 1000);
-    Serial.println("s");
-    lastDebug = millis();
-  }
-  
-  delay(50);
-}
\ No newline at end of file
+  idleSleep.sleep(idleMs);
+}
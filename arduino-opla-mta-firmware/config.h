@@ -33,6 +33,34 @@ const MTAConfig MTA_CONFIGS[3] = {
   {"L", "L08N", "14 St - Union Sq"},     // Button 2  
   {"6", "626N", "Astor Pl"}              // Button 3
 };
+const int MTA_STATION_COUNT = sizeof(MTA_CONFIGS) / sizeof(MTA_CONFIGS[0]);
+
+// Arrivals kept per direction for a station
+const int TRAINS_PER_DIRECTION = 3;
+
+// Serve built-in sample arrivals instead of querying MTA_PROXY_HOST.
+// The host simulator builds with this set to 0 and serves proxy fixtures.
+#ifndef MTA_USE_SIMULATED_DATA
+#define MTA_USE_SIMULATED_DATA 1
+#endif
+
+// Decode the MTA's GTFS-realtime feeds directly instead of querying
+// MTA_PROXY_HOST. Only applies when MTA_USE_SIMULATED_DATA is 0.
+#ifndef MTA_USE_GTFS_FEED
+#define MTA_USE_GTFS_FEED 0
+#endif
+
+// Timing probes on the hot paths (Profiler.h), dumped over Serial on
+// request. The host simulator builds with this set to 1.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+
+// Count allocations per subsystem (MemoryMonitor.h). Needs the link to wrap
+// malloc, free, realloc and calloc, which make compile sets up.
+#ifndef MEMORY_WRAP_MALLOC
+#define MEMORY_WRAP_MALLOC 0
+#endif
 
 // Weather Configuration
 const float WEATHER_LATITUDE = 40.7589;   // NYC coordinates
@@ -44,6 +72,17 @@ extern const char* WEATHER_API_KEY;
 
 // Refresh Intervals (in seconds)
 const int MTA_REFRESH_INTERVAL = 120;     // 2 minutes
+const int MTA_RETRY_INTERVAL = 15;        // After a failed MTA fetch
+const int MTA_DEPARTED_GRACE = 30;        // Train stays listed past its arrival
+
+// Adaptive MTA refresh (seconds). A station refreshes at half the time to
+// its nearest train, stretched up to double while its arrivals hold steady,
+// within these bounds; stations not on screen refresh less often.
+// MTA_REFRESH_INTERVAL applies when no trains are listed.
+const int MTA_REFRESH_MIN = 30;
+const int MTA_REFRESH_MAX = 300;
+const int MTA_BACKGROUND_REFRESH_FACTOR = 4;
+const int MTA_MOVED_SECONDS = 60;         // Prediction change that counts as volatile
 const int WEATHER_REFRESH_INTERVAL = 600; // 10 minutes
 const int RAIN_REFRESH_INTERVAL = 900;    // 15 minutes
 
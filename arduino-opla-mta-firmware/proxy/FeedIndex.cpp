@@ -0,0 +1,288 @@
+#include "FeedIndex.h"
+#include <algorithm>
+#include <string.h>
+
+// Protobuf wire types
+static const int WIRE_VARINT = 0;
+static const int WIRE_FIXED64 = 1;
+static const int WIRE_LENGTH = 2;
+static const int WIRE_FIXED32 = 5;
+
+// gtfs-realtime.proto field numbers
+static const uint32_t FEED_MESSAGE_HEADER = 1;
+static const uint32_t FEED_MESSAGE_ENTITY = 2;
+static const uint32_t FEED_HEADER_TIMESTAMP = 3;
+static const uint32_t FEED_ENTITY_TRIP_UPDATE = 3;
+static const uint32_t TRIP_UPDATE_TRIP = 1;
+static const uint32_t TRIP_UPDATE_STOP_TIME_UPDATE = 2;
+static const uint32_t TRIP_DESCRIPTOR_ROUTE_ID = 5;
+static const uint32_t STOP_TIME_UPDATE_ARRIVAL = 2;
+static const uint32_t STOP_TIME_UPDATE_DEPARTURE = 3;
+static const uint32_t STOP_TIME_UPDATE_STOP_ID = 4;
+static const uint32_t STOP_TIME_EVENT_TIME = 2;
+
+// Walks one message's fields; nested messages get a reader of their own
+class ProtoReader {
+private:
+  const uint8_t* position;
+  const uint8_t* end;
+
+public:
+  ProtoReader(const uint8_t* data, const uint8_t* dataEnd) : position(data), end(dataEnd) {}
+
+  bool atEnd() const { return position == end; }
+
+  bool readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && position < end; shift += 7) {
+      uint8_t byte = *position++;
+      value |= (uint64_t)(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) return true;
+    }
+    return false;
+  }
+
+  bool readTag(uint32_t& field, int& wireType) {
+    uint64_t tag;
+    if (!readVarint(tag)) return false;
+    field = tag >> 3;
+    wireType = tag & 7;
+    return true;
+  }
+
+  // A length-delimited field's bytes
+  bool readBytes(const uint8_t*& data, const uint8_t*& dataEnd) {
+    uint64_t length;
+    if (!readVarint(length) || length > (uint64_t)(end - position)) return false;
+    data = position;
+    dataEnd = position + length;
+    position = dataEnd;
+    return true;
+  }
+
+  bool readString(std::string& out) {
+    const uint8_t *data, *dataEnd;
+    if (!readBytes(data, dataEnd)) return false;
+    out.assign((const char*)data, dataEnd - data);
+    return true;
+  }
+
+  bool skip(int wireType) {
+    uint64_t value;
+    const uint8_t *data, *dataEnd;
+    switch (wireType) {
+      case WIRE_VARINT: return readVarint(value);
+      case WIRE_LENGTH: return readBytes(data, dataEnd);
+      case WIRE_FIXED64: return advance(8);
+      case WIRE_FIXED32: return advance(4);
+      default: return false;   // Groups are not used by GTFS-realtime
+    }
+  }
+
+  bool advance(size_t count) {
+    if (count > (size_t)(end - position)) return false;
+    position += count;
+    return true;
+  }
+};
+
+// Time from a StopTimeEvent, 0 if it has none
+static bool decodeStopTimeEvent(const uint8_t* data, const uint8_t* end, uint32_t& time) {
+  ProtoReader reader(data, end);
+  while (!reader.atEnd()) {
+    uint32_t field;
+    int wireType;
+    if (!reader.readTag(field, wireType)) return false;
+    if (field == STOP_TIME_EVENT_TIME && wireType == WIRE_VARINT) {
+      uint64_t value;
+      if (!reader.readVarint(value)) return false;
+      time = (uint32_t)value;
+    } else if (!reader.skip(wireType)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FeedIndex::FeedIndex() {
+  clear();
+}
+
+void FeedIndex::clear() {
+  stations.clear();
+  timestamp = 0;
+  memset(&stats, 0, sizeof(stats));
+}
+
+std::string FeedIndex::parentStop(const std::string& stopId, int* direction) {
+  char suffix = stopId.empty() ? 0 : stopId.back();
+  bool platform = stopId.size() > 1 && (suffix == 'N' || suffix == 'S');
+  if (direction) *direction = !platform ? -1 : suffix == 'N' ? 0 : 1;
+  return platform ? stopId.substr(0, stopId.size() - 1) : stopId;
+}
+
+typedef std::pair<const uint8_t*, const uint8_t*> ByteRange;
+
+// Finds the feed's timestamp and its trip updates. The header may come
+// after the entities, and arrivals are filtered on its timestamp, so trip
+// updates are only located here and decoded afterwards.
+static bool scanFeed(const std::string& feed, uint32_t& feedTime, std::vector<ByteRange>& tripUpdates) {
+  const uint8_t* data = (const uint8_t*)feed.data();
+  ProtoReader reader(data, data + feed.size());
+  while (!reader.atEnd()) {
+    uint32_t field;
+    int wireType;
+    const uint8_t *message, *messageEnd;
+    if (!reader.readTag(field, wireType)) return false;
+
+    if (field == FEED_MESSAGE_HEADER && wireType == WIRE_LENGTH) {
+      if (!reader.readBytes(message, messageEnd)) return false;
+      ProtoReader header(message, messageEnd);
+      while (!header.atEnd()) {
+        uint32_t headerField;
+        int headerWire;
+        if (!header.readTag(headerField, headerWire)) return false;
+        if (headerField == FEED_HEADER_TIMESTAMP && headerWire == WIRE_VARINT) {
+          uint64_t value;
+          if (!header.readVarint(value)) return false;
+          feedTime = (uint32_t)value;
+        } else if (!header.skip(headerWire)) {
+          return false;
+        }
+      }
+    } else if (field == FEED_MESSAGE_ENTITY && wireType == WIRE_LENGTH) {
+      if (!reader.readBytes(message, messageEnd)) return false;
+      ProtoReader entity(message, messageEnd);
+      while (!entity.atEnd()) {
+        uint32_t entityField;
+        int entityWire;
+        const uint8_t *update, *updateEnd;
+        if (!entity.readTag(entityField, entityWire)) return false;
+        if (entityField == FEED_ENTITY_TRIP_UPDATE && entityWire == WIRE_LENGTH) {
+          if (!entity.readBytes(update, updateEnd)) return false;
+          tripUpdates.push_back(ByteRange(update, updateEnd));
+        } else if (!entity.skip(entityWire)) {
+          return false;
+        }
+      }
+    } else if (!reader.skip(wireType)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FeedIndex::addFeed(const std::string& feed, std::string* error) {
+  uint32_t feedTime = 0;
+  std::vector<ByteRange> tripUpdates;
+  bool ok = scanFeed(feed, feedTime, tripUpdates);
+
+  // Decoded into an index of its own, so a bad feed leaves this one as it was
+  FeedIndex added;
+  for (size_t i = 0; ok && i < tripUpdates.size(); i++) {
+    ok = added.decodeTripUpdate(tripUpdates[i].first, tripUpdates[i].second, feedTime);
+  }
+  if (!ok) {
+    if (error) *error = "malformed GTFS-realtime feed";
+    return false;
+  }
+
+  for (auto& entry : added.stations) {
+    IndexedStation& station = stations[entry.first];
+    for (IndexedArrival& arrival : entry.second.uptown) station.uptown.push_back(std::move(arrival));
+    for (IndexedArrival& arrival : entry.second.downtown) station.downtown.push_back(std::move(arrival));
+  }
+  stats.feeds++;
+  stats.tripUpdates += added.stats.tripUpdates;
+  stats.stopTimeUpdates += added.stats.stopTimeUpdates;
+  stats.arrivals += added.stats.arrivals;
+  timestamp = std::max(timestamp, feedTime);
+  return true;
+}
+
+bool FeedIndex::decodeTripUpdate(const uint8_t* data, const uint8_t* end, uint32_t feedTime) {
+  stats.tripUpdates++;
+  std::string route;
+  struct StopTime {
+    std::string stopId;
+    uint32_t time;
+  };
+  std::vector<StopTime> stopTimes;
+
+  ProtoReader reader(data, end);
+  while (!reader.atEnd()) {
+    uint32_t field;
+    int wireType;
+    const uint8_t *message, *messageEnd;
+    if (!reader.readTag(field, wireType)) return false;
+
+    if (field == TRIP_UPDATE_TRIP && wireType == WIRE_LENGTH) {
+      if (!reader.readBytes(message, messageEnd)) return false;
+      ProtoReader trip(message, messageEnd);
+      while (!trip.atEnd()) {
+        uint32_t tripField;
+        int tripWire;
+        if (!trip.readTag(tripField, tripWire)) return false;
+        if (tripField == TRIP_DESCRIPTOR_ROUTE_ID && tripWire == WIRE_LENGTH) {
+          if (!trip.readString(route)) return false;
+        } else if (!trip.skip(tripWire)) {
+          return false;
+        }
+      }
+    } else if (field == TRIP_UPDATE_STOP_TIME_UPDATE && wireType == WIRE_LENGTH) {
+      if (!reader.readBytes(message, messageEnd)) return false;
+      stats.stopTimeUpdates++;
+      StopTime stopTime = {"", 0};
+      uint32_t arrival = 0, departure = 0;
+      ProtoReader update(message, messageEnd);
+      while (!update.atEnd()) {
+        uint32_t updateField;
+        int updateWire;
+        const uint8_t *event, *eventEnd;
+        if (!update.readTag(updateField, updateWire)) return false;
+        if (updateField == STOP_TIME_UPDATE_STOP_ID && updateWire == WIRE_LENGTH) {
+          if (!update.readString(stopTime.stopId)) return false;
+        } else if (updateField == STOP_TIME_UPDATE_ARRIVAL && updateWire == WIRE_LENGTH) {
+          if (!update.readBytes(event, eventEnd) || !decodeStopTimeEvent(event, eventEnd, arrival)) return false;
+        } else if (updateField == STOP_TIME_UPDATE_DEPARTURE && updateWire == WIRE_LENGTH) {
+          if (!update.readBytes(event, eventEnd) || !decodeStopTimeEvent(event, eventEnd, departure)) return false;
+        } else if (!update.skip(updateWire)) {
+          return false;
+        }
+      }
+      // Same rule as the device: the arrival, else the departure
+      stopTime.time = arrival ? arrival : departure;
+      stopTimes.push_back(stopTime);
+    } else if (!reader.skip(wireType)) {
+      return false;
+    }
+  }
+
+  // The route and the terminal are only known once the whole trip is read
+  if (stopTimes.empty()) return true;
+  const std::string& terminal = stopTimes.back().stopId;
+  for (const StopTime& stopTime : stopTimes) {
+    int direction;
+    std::string parent = parentStop(stopTime.stopId, &direction);
+    if (direction < 0 || stopTime.time == 0) continue;
+    if (feedTime && stopTime.time < feedTime) continue;   // Already left
+
+    IndexedStation& station = stations[parent];
+    (direction == 0 ? station.uptown : station.downtown).push_back({stopTime.time, route, terminal});
+    stats.arrivals++;
+  }
+  return true;
+}
+
+void FeedIndex::finish() {
+  auto sooner = [](const IndexedArrival& a, const IndexedArrival& b) { return a.time < b.time; };
+  for (auto& entry : stations) {
+    std::stable_sort(entry.second.uptown.begin(), entry.second.uptown.end(), sooner);
+    std::stable_sort(entry.second.downtown.begin(), entry.second.downtown.end(), sooner);
+  }
+}
+
+const IndexedStation* FeedIndex::find(const std::string& stopId) const {
+  auto found = stations.find(parentStop(stopId));
+  return found == stations.end() ? nullptr : &found->second;
+}
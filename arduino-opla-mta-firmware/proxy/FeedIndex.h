@@ -0,0 +1,68 @@
+/*
+ * Arrival index for the MTA transit proxy
+ * Decodes whole GTFS-realtime feeds (the MTA's, or recorded ones) and
+ * indexes every stop time update by parent station: per direction, the
+ * upcoming arrivals sorted by time, with the route and the trip's last
+ * stop. Rebuilt from scratch on every feed update; lookups are a hash
+ * probe. Stop IDs ending in N are uptown, S downtown, as on the device.
+ */
+
+#ifndef FEEDINDEX_H
+#define FEEDINDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct IndexedArrival {
+  uint32_t time;              // POSIX seconds
+  std::string route;
+  std::string terminal;       // Stop ID of the trip's last stop time update
+};
+
+struct IndexedStation {
+  std::vector<IndexedArrival> uptown;
+  std::vector<IndexedArrival> downtown;
+};
+
+struct FeedIndexStats {
+  uint32_t feeds;
+  uint32_t tripUpdates;
+  uint32_t stopTimeUpdates;
+  uint32_t arrivals;          // Indexed: not yet departed at the feed's time
+};
+
+class FeedIndex {
+private:
+  std::unordered_map<std::string, IndexedStation> stations;
+  uint32_t timestamp;
+  FeedIndexStats stats;
+
+  bool decodeTripUpdate(const uint8_t* data, const uint8_t* end, uint32_t feedTime);
+
+public:
+  FeedIndex();
+  void clear();
+
+  // Adds one FeedMessage. Arrivals before the feed's own timestamp have
+  // left and are dropped. Returns false, with the reason in error, if the
+  // feed is malformed; nothing from it is kept then.
+  bool addFeed(const std::string& feed, std::string* error = nullptr);
+
+  // Sorts every station's arrivals; call once all feeds are added
+  void finish();
+
+  // Parent station ("401"), or either platform ("401N"); null if unknown
+  const IndexedStation* find(const std::string& stopId) const;
+  const std::unordered_map<std::string, IndexedStation>& getStations() const { return stations; }
+
+  // Newest feed timestamp seen
+  uint32_t getTimestamp() const { return timestamp; }
+  const FeedIndexStats& getStats() const { return stats; }
+
+  // Parent station of a platform stop ID, and which direction it serves
+  static std::string parentStop(const std::string& stopId, int* direction = nullptr);
+};
+
+#endif
@@ -0,0 +1,380 @@
+#include "HttpServer.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+
+static const int MAX_EVENTS = 64;
+
+// How often connections are checked for timeouts
+static const uint32_t SWEEP_MS = 250;
+
+// Sent when a request cannot be parsed; the connection is closed after it
+static const HttpResponse BAD_REQUEST = {
+  "HTTP/1.1 400 Bad Request\r\nContent-Type: text/plain\r\nContent-Length: 12\r\n", "Bad request\n"};
+
+// Sent when a request head outgrows HTTP_SERVER_MAX_REQUEST, before closing
+static const HttpResponse HEAD_TOO_LARGE = {
+  "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Type: text/plain\r\nContent-Length: 26\r\n",
+  "Request head is too large\n"};
+
+HttpServer::HttpServer() {
+  listenFd = -1;
+  epollFd = -1;
+  handler = nullptr;
+  handlerContext = nullptr;
+  tick = nullptr;
+  tickContext = nullptr;
+  tickMs = 1000;
+  memset(&stats, 0, sizeof(stats));
+  setKeepAlive(5000);
+}
+
+HttpServer::~HttpServer() {
+  while (!connections.empty()) closeConnection(connections.begin()->first);
+  if (listenFd >= 0) close(listenFd);
+  if (epollFd >= 0) close(epollFd);
+}
+
+uint64_t HttpServer::nowMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+bool HttpServer::listen(const char* address, uint16_t port, std::string* error) {
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+    if (error) *error = std::string("bad address ") + address;
+    return false;
+  }
+
+  listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listenFd < 0) {
+    if (error) *error = strerror(errno);
+    return false;
+  }
+  int on = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 512) != 0) {
+    if (error) *error = strerror(errno);
+    return false;
+  }
+
+  epollFd = epoll_create1(EPOLL_CLOEXEC);
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.fd = listenFd;
+  if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) != 0) {
+    if (error) *error = strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+void HttpServer::setHandler(RequestHandler requestHandler, void* context) {
+  handler = requestHandler;
+  handlerContext = context;
+}
+
+void HttpServer::setTick(uint32_t periodMs, TickHandler tickHandler, void* context) {
+  tickMs = periodMs;
+  tick = tickHandler;
+  tickContext = context;
+}
+
+void HttpServer::setKeepAlive(uint32_t ms) {
+  keepAliveMs = ms;
+  keepAliveLines = "Connection: keep-alive\r\nKeep-Alive: timeout=" + std::to_string((ms + 999) / 1000) + "\r\n\r\n";
+}
+
+void HttpServer::run(volatile sig_atomic_t& stop) {
+  struct epoll_event events[MAX_EVENTS];
+  uint64_t nextTick = nowMs() + tickMs;
+  uint64_t nextSweep = nowMs() + SWEEP_MS;
+
+  while (!stop) {
+    uint64_t now = nowMs();
+    uint64_t wake = std::min(nextTick, nextSweep);
+    int timeout = wake > now ? (int)(wake - now) : 0;
+    int count = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+    if (count < 0 && errno != EINTR) break;
+
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+      if (fd == listenFd) {
+        acceptConnections();
+        continue;
+      }
+      auto found = connections.find(fd);
+      if (found == connections.end()) continue;
+
+      if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+        closeConnection(fd);
+        continue;
+      }
+      if (events[i].events & EPOLLOUT) flush(fd, found->second);
+      if (connections.count(fd) && (events[i].events & EPOLLIN)) readRequests(fd, found->second);
+    }
+
+    now = nowMs();
+    if (now >= nextTick) {
+      if (tick) tick(tickContext);
+      nextTick = now + tickMs;
+    }
+    if (now >= nextSweep) {
+      closeIdle(now);
+      nextSweep = now + SWEEP_MS;
+    }
+  }
+}
+
+void HttpServer::acceptConnections() {
+  while (true) {
+    int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;   // EAGAIN once the backlog is empty
+
+    // Responses go out in one write; don't hold them for Nagle
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+      close(fd);
+      continue;
+    }
+    Connection& connection = connections[fd];
+    connection.lastActive = nowMs();
+    connection.byActivity = activity.insert(activity.end(), fd);
+    connection.byHeadStart = heads.end();
+    connection.closing = false;
+    connection.peerClosed = false;
+    stats.connections++;
+    stats.openConnections++;
+    stats.peakConnections = std::max(stats.peakConnections, stats.openConnections);
+  }
+}
+
+void HttpServer::readRequests(int fd, Connection& connection) {
+  // Never more than a request head's worth past the last complete request,
+  // so a client sending without end cannot grow the buffer
+  char buffer[HTTP_SERVER_MAX_REQUEST + 1];
+  uint64_t requests = stats.requests;
+  while (true) {
+    if (!handleRequests(fd, connection)) return;
+
+    // Backpressure: while a response waits for the socket, further
+    // requests stay unread, in the buffer or the kernel's
+    if (connection.closing || connection.peerClosed || !connection.output.empty()) break;
+    if (connection.input.size() > HTTP_SERVER_MAX_REQUEST) {
+      connection.closing = true;
+      send(fd, connection, HEAD_TOO_LARGE, false);
+      return;
+    }
+
+    ssize_t n = read(fd, buffer, sizeof(buffer) - connection.input.size());
+    if (n > 0) {
+      connection.input.append(buffer, n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      closeConnection(fd);
+      return;
+    }
+    if (n == 0) connection.peerClosed = true;
+    break;
+  }
+  uint64_t now = nowMs();
+  touch(fd, connection, now);
+  trackHead(fd, connection, stats.requests != requests, now);
+
+  // A client that shut down its side after its requests still gets every
+  // response; the connection closes once the last has gone out
+  if ((connection.closing || connection.peerClosed) && connection.output.empty()) closeConnection(fd);
+}
+
+bool HttpServer::handleRequests(int fd, Connection& connection) {
+  // Complete requests in order, each once the response before it has gone
+  // out; a closing connection takes no more
+  size_t headEnd;
+  while (!connection.closing && connection.output.empty() && (headEnd = connection.input.find("\r\n\r\n")) != std::string::npos) {
+    std::string head = connection.input.substr(0, headEnd);
+    connection.input.erase(0, headEnd + 4);
+    stats.requests++;
+
+    HttpRequest request;
+    if (!parseRequest(head, request) || !handler) {
+      connection.closing = true;
+      send(fd, connection, BAD_REQUEST, false);
+    } else {
+      const HttpResponse& response = handler(request, handlerContext);
+      if (!request.keepAlive) connection.closing = true;
+      send(fd, connection, response, request.keepAlive);
+    }
+    if (!connections.count(fd)) return false;
+  }
+  return true;
+}
+
+// Value of a header in a head whose names were lowercased
+static std::string headerValue(const std::string& lowerHead, const std::string& head, const char* name) {
+  std::string key = std::string("\r\n") + name + ":";
+  size_t start = lowerHead.find(key);
+  if (start == std::string::npos) return "";
+  start += key.size();
+  size_t end = head.find("\r\n", start);
+  if (end == std::string::npos) end = head.size();
+  while (start < end && (head[start] == ' ' || head[start] == '\t')) start++;
+  while (end > start && (head[end - 1] == ' ' || head[end - 1] == '\t')) end--;
+  return head.substr(start, end - start);
+}
+
+bool HttpServer::parseRequest(const std::string& head, HttpRequest& request) {
+  size_t methodEnd = head.find(' ');
+  size_t pathEnd = methodEnd == std::string::npos ? std::string::npos : head.find(' ', methodEnd + 1);
+  size_t lineEnd = head.find("\r\n");
+  if (lineEnd == std::string::npos) lineEnd = head.size();
+  if (pathEnd == std::string::npos || pathEnd > lineEnd) return false;
+
+  request.method = head.substr(0, methodEnd);
+  request.path = head.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+  request.path = request.path.substr(0, request.path.find('?'));
+  std::string version = head.substr(pathEnd + 1, lineEnd - pathEnd - 1);
+  if (version.compare(0, 5, "HTTP/") != 0) return false;
+
+  std::string lowerHead = head;
+  for (char& c : lowerHead) c = tolower((unsigned char)c);
+  std::string connectionHeader = headerValue(lowerHead, lowerHead, "connection");
+  if (version == "HTTP/1.0") {
+    request.keepAlive = connectionHeader.find("keep-alive") != std::string::npos;
+  } else {
+    request.keepAlive = connectionHeader.find("close") == std::string::npos;
+  }
+  request.accept = headerValue(lowerHead, head, "accept");
+  request.acceptEncoding = headerValue(lowerHead, lowerHead, "accept-encoding");
+  request.ifNoneMatch = headerValue(lowerHead, head, "if-none-match");
+  request.ifModifiedSince = headerValue(lowerHead, head, "if-modified-since");
+  return true;
+}
+
+// Only called with no output pending, so responses go out in order
+void HttpServer::send(int fd, Connection& connection, const HttpResponse& response, bool keepAlive) {
+  static const std::string CLOSE_LINES = "Connection: close\r\n\r\n";
+  const std::string& connectionLines = keepAlive ? keepAliveLines : CLOSE_LINES;
+  size_t total = response.head.size() + connectionLines.size() + response.body.size();
+  stats.bytesSent += total;
+
+  struct iovec parts[3] = {
+    {(void*)response.head.data(), response.head.size()},
+    {(void*)connectionLines.data(), connectionLines.size()},
+    {(void*)response.body.data(), response.body.size()},
+  };
+  ssize_t written = writev(fd, parts, 3);
+  if (written < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      closeConnection(fd);
+      return;
+    }
+    written = 0;
+  }
+  if ((size_t)written == total) {
+    if (connection.closing) closeConnection(fd);
+    return;
+  }
+
+  // The socket buffer is full; keep the rest until it drains
+  for (const struct iovec& part : parts) {
+    size_t skip = std::min((size_t)written, part.iov_len);
+    connection.output.append((const char*)part.iov_base + skip, part.iov_len - skip);
+    written -= skip;
+  }
+  watchOutput(fd, connection, true);
+}
+
+void HttpServer::flush(int fd, Connection& connection) {
+  while (!connection.output.empty()) {
+    ssize_t written = write(fd, connection.output.data(), connection.output.size());
+    if (written < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+      if (errno == EINTR) continue;
+      closeConnection(fd);
+      return;
+    }
+    connection.output.erase(0, written);
+    touch(fd, connection, nowMs());
+  }
+  watchOutput(fd, connection, false);
+  if (connection.closing) {
+    closeConnection(fd);
+    return;
+  }
+
+  // Requests held back while the output drained
+  readRequests(fd, connection);
+}
+
+void HttpServer::watchOutput(int fd, Connection& connection, bool watch) {
+  struct epoll_event event;
+  // Reading waits while output is pending
+  event.events = watch ? (uint32_t)EPOLLOUT : connection.peerClosed ? 0 : (uint32_t)(EPOLLIN | EPOLLRDHUP);
+  event.data.fd = fd;
+  epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void HttpServer::closeConnection(int fd) {
+  auto found = connections.find(fd);
+  if (found != connections.end()) {
+    activity.erase(found->second.byActivity);
+    if (found->second.byHeadStart != heads.end()) heads.erase(found->second.byHeadStart);
+    connections.erase(found);
+  }
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  stats.openConnections--;
+}
+
+void HttpServer::touch(int fd, Connection& connection, uint64_t now) {
+  connection.lastActive = now;
+  activity.splice(activity.end(), activity, connection.byActivity);
+}
+
+// Starts the head timeout when a partial request head is first waiting
+// for the client, restarting it if a request completed meanwhile, and
+// stops it when there is none
+void HttpServer::trackHead(int fd, Connection& connection, bool restart, uint64_t now) {
+  bool waiting = !connection.input.empty() && connection.output.empty() && !connection.peerClosed;
+  bool tracked = connection.byHeadStart != heads.end();
+  if (tracked && (!waiting || restart)) {
+    heads.erase(connection.byHeadStart);
+    connection.byHeadStart = heads.end();
+    tracked = false;
+  }
+  if (waiting && !tracked) {
+    connection.headStart = now;
+    connection.byHeadStart = heads.insert(heads.end(), fd);
+  }
+}
+
+// Idle connections, those whose client has not taken any output for the
+// keep-alive timeout, and those with a request head overdue
+void HttpServer::closeIdle(uint64_t now) {
+  while (!activity.empty() && now - connections[activity.front()].lastActive >= keepAliveMs) {
+    closeConnection(activity.front());
+  }
+  while (!heads.empty() && now - connections[heads.front()].headStart >= HTTP_SERVER_HEAD_TIMEOUT) {
+    closeConnection(heads.front());
+  }
+}
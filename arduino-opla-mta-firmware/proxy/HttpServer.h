@@ -0,0 +1,124 @@
+/*
+ * Event-driven HTTP/1.1 server for the MTA transit proxy
+ * One thread, one epoll set: non-blocking sockets, requests parsed as
+ * their bytes arrive (pipelined ones in order), kept-alive connections
+ * closed after an idle timeout. Responses come ready-made from the
+ * handler; the server only adds the Connection header and writes them
+ * with one writev(), buffering whatever the socket does not take. Until
+ * that buffer has drained the connection is not read from, so a client
+ * that pipelines requests without reading the responses holds at most
+ * one of them. Connections are closed once idle for the keep-alive
+ * timeout, when the client has taken no output for as long, or when a
+ * request head takes over HTTP_SERVER_HEAD_TIMEOUT to arrive.
+ */
+
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <signal.h>
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Request head larger than this is answered with 431 and the connection
+// closed
+const size_t HTTP_SERVER_MAX_REQUEST = 8192;
+
+// Time a request head has to arrive in full, however steadily its bytes
+// trickle in, before the connection is closed
+const uint32_t HTTP_SERVER_HEAD_TIMEOUT = 10000;
+
+struct HttpRequest {
+  std::string method;
+  std::string path;             // Without the query string
+  bool keepAlive;               // HTTP/1.1 without "Connection: close"
+  std::string accept;           // Header values, empty if absent
+  std::string acceptEncoding;
+  std::string ifNoneMatch;
+  std::string ifModifiedSince;
+};
+
+struct HttpResponse {
+  std::string head;             // Status line and headers, without Connection or the blank line
+  std::string body;
+};
+
+struct HttpServerStats {
+  uint64_t connections;         // Accepted
+  uint64_t requests;
+  uint64_t bytesSent;
+  uint32_t openConnections;
+  uint32_t peakConnections;
+};
+
+class HttpServer {
+public:
+  // Returns the response to send; it must stay valid until the next call
+  typedef const HttpResponse& (*RequestHandler)(const HttpRequest& request, void* context);
+  typedef void (*TickHandler)(void* context);
+
+private:
+  struct Connection {
+    std::string input;
+    std::string output;         // Response bytes the socket has not taken yet
+    uint64_t lastActive;        // Last bytes read, or written from output
+    uint64_t headStart;         // First bytes of the partial request head in input
+    std::list<int>::iterator byActivity;
+    std::list<int>::iterator byHeadStart;   // heads.end() without a partial head
+    bool closing;               // Close once the output is written
+    bool peerClosed;            // The client shut down its side; read no more
+  };
+
+  int listenFd;
+  int epollFd;
+  std::unordered_map<int, Connection> connections;
+
+  // Connections oldest first, by lastActive and by headStart, so timeouts
+  // only look at the front
+  std::list<int> activity;
+  std::list<int> heads;
+  uint32_t keepAliveMs;
+  std::string keepAliveLines;   // Connection and Keep-Alive headers plus the blank line
+
+  RequestHandler handler;
+  void* handlerContext;
+  TickHandler tick;
+  void* tickContext;
+  uint32_t tickMs;
+
+  HttpServerStats stats;
+
+  static uint64_t nowMs();
+  void acceptConnections();
+  void readRequests(int fd, Connection& connection);
+  bool handleRequests(int fd, Connection& connection);
+  bool parseRequest(const std::string& head, HttpRequest& request);
+  void send(int fd, Connection& connection, const HttpResponse& response, bool keepAlive);
+  void flush(int fd, Connection& connection);
+  void watchOutput(int fd, Connection& connection, bool watch);
+  void closeConnection(int fd);
+  void touch(int fd, Connection& connection, uint64_t now);
+  void trackHead(int fd, Connection& connection, bool restart, uint64_t now);
+  void closeIdle(uint64_t now);
+
+public:
+  HttpServer();
+  ~HttpServer();
+
+  // Binds and listens; false with the reason in error on failure
+  bool listen(const char* address, uint16_t port, std::string* error);
+
+  void setHandler(RequestHandler requestHandler, void* context);
+  void setTick(uint32_t periodMs, TickHandler tickHandler, void* context);
+
+  // Idle time a kept connection is held open, advertised as Keep-Alive
+  void setKeepAlive(uint32_t ms);
+
+  // Serves until stop becomes non-zero, e.g. from a signal handler
+  void run(volatile sig_atomic_t& stop);
+
+  const HttpServerStats& getStats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,267 @@
+#include "ResponseCache.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+#include <algorithm>
+#include <vector>
+#include <StationSummaryWriter.h>
+#include "StationSummary.h"
+
+static const char* VARY_LINE = "Vary: Accept, Accept-Encoding\r\n";
+
+// Strong ETag from the body's FNV-1a hash, as the simulated server makes them
+static std::string etagFor(const std::string& body) {
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : body) hash = (hash ^ c) * 16777619u;
+  char tag[16];
+  snprintf(tag, sizeof(tag), "\"%08x\"", hash);
+  return tag;
+}
+
+static std::string httpDate(time_t t) {
+  char text[32];
+  struct tm parts;
+  gmtime_r(&t, &parts);
+  strftime(text, sizeof(text), "%a, %d %b %Y %H:%M:%S GMT", &parts);
+  return text;
+}
+
+// zlib or gzip stream compressed for a window of 2^windowBits bytes
+static bool compress(const std::string& in, std::string& out, int windowBits, bool gzip) {
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits + (gzip ? 16 : 0), 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  out.resize(deflateBound(&stream, in.size()) + 32);
+  stream.next_in = (Bytef*)in.data();
+  stream.avail_in = in.size();
+  stream.next_out = (Bytef*)&out[0];
+  stream.avail_out = out.size();
+  bool ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return ok;
+}
+
+static void appendJsonString(std::string& out, const std::string& text) {
+  out += '"';
+  for (unsigned char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += (char)c;
+    } else if (c < 0x20) {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      out += escape;
+    } else {
+      out += (char)c;
+    }
+  }
+  out += '"';
+}
+
+// Splits one CSV line, honouring quoted fields with doubled quotes
+static std::vector<std::string> splitCsv(const std::string& line) {
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); i++) {
+    char c = line[i];
+    if (quoted) {
+      if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        fields.back() += '"';
+        i++;
+      } else if (c == '"') {
+        quoted = false;
+      } else {
+        fields.back() += c;
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      fields.emplace_back();
+    } else if (c != '\r' && c != '\n') {
+      fields.back() += c;
+    }
+  }
+  return fields;
+}
+
+ResponseCache::ResponseCache() {
+  arrivalsPerDirection = 6;
+  memset(&stats, 0, sizeof(stats));
+  notFound.body = "{\"error\":\"not found\"}";
+  notFound.head = "HTTP/1.1 404 Not Found\r\nContent-Type: application/json\r\nContent-Length: " +
+                  std::to_string(notFound.body.size()) + "\r\n";
+  notAllowed.head = "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\nContent-Length: 0\r\n";
+}
+
+bool ResponseCache::loadStopNames(const char* path, std::string* error) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    if (error) *error = std::string("cannot open ") + path;
+    return false;
+  }
+
+  int idColumn = -1, nameColumn = -1;
+  bool header = true;
+  char buffer[4096];
+  while (fgets(buffer, sizeof(buffer), f)) {
+    std::vector<std::string> fields = splitCsv(buffer);
+    if (header) {
+      if (fields[0].compare(0, 3, "\xEF\xBB\xBF") == 0) fields[0].erase(0, 3);   // UTF-8 BOM
+      for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i] == "stop_id") idColumn = i;
+        if (fields[i] == "stop_name") nameColumn = i;
+      }
+      header = false;
+      if (idColumn < 0 || nameColumn < 0) break;
+      continue;
+    }
+    if ((int)fields.size() > std::max(idColumn, nameColumn)) stopNames[fields[idColumn]] = fields[nameColumn];
+  }
+  fclose(f);
+
+  if (idColumn < 0 || nameColumn < 0) {
+    if (error) *error = std::string(path) + " has no stop_id and stop_name columns";
+    return false;
+  }
+  return true;
+}
+
+void ResponseCache::setArrivalsPerDirection(int count) {
+  arrivalsPerDirection = std::min(std::max(count, 1), 255);
+}
+
+std::string ResponseCache::stopName(const std::string& stopId) const {
+  auto found = stopNames.find(stopId);
+  if (found == stopNames.end()) found = stopNames.find(FeedIndex::parentStop(stopId));
+  return found == stopNames.end() ? stopId : found->second;
+}
+
+void ResponseCache::build(const FeedIndex& index) {
+  stations.clear();
+  stats.stationIds = 0;
+  stats.bodyBytes = 0;
+
+  // Devices ask by platform ("401N") and expect both directions, with
+  // the ID they asked for echoed back
+  for (const auto& entry : index.getStations()) {
+    const std::string& parent = entry.first;
+    addStation(parent, parent, entry.second, index.getTimestamp());
+    addStation(parent + "N", parent, entry.second, index.getTimestamp());
+    addStation(parent + "S", parent, entry.second, index.getTimestamp());
+  }
+}
+
+void ResponseCache::addStation(const std::string& stationId, const std::string& parent,
+                               const IndexedStation& arrivals, uint32_t timestamp) {
+  CachedStation& cached = stations[stationId];
+  cached.lastModified = httpDate(timestamp);
+  stats.stationIds++;
+
+  const std::vector<IndexedArrival>* directions[2] = {&arrivals.uptown, &arrivals.downtown};
+  static const char* DIRECTION_KEYS[2] = {"uptown", "downtown"};
+
+  // JSON, compact, in the shape MTAManager::parseTrainData reads
+  std::string json = "{\"station\":";
+  appendJsonString(json, stationId);
+  json += ",\"name\":";
+  appendJsonString(json, stopName(parent));
+  json += ",\"timestamp\":" + std::to_string(timestamp);
+  for (int d = 0; d < 2; d++) {
+    json += std::string(",\"") + DIRECTION_KEYS[d] + "\":[";
+    size_t count = std::min(directions[d]->size(), (size_t)arrivalsPerDirection);
+    for (size_t i = 0; i < count; i++) {
+      const IndexedArrival& arrival = (*directions[d])[i];
+      json += i ? ",{\"route\":" : "{\"route\":";
+      appendJsonString(json, arrival.route);
+      json += ",\"destination\":";
+      appendJsonString(json, stopName(arrival.terminal));
+      json += ",\"minutes\":" + std::to_string((arrival.time - timestamp + 30) / 60);
+      json += ",\"arrival\":" + std::to_string(arrival.time) + "}";
+    }
+    json += "]";
+  }
+  json += "}";
+  addVariants(cached, FORMAT_JSON, "application/json", json);
+
+  // Binary summary, of the same arrivals
+
+  StationSummaryWriter writer;
+  for (int d = 0; d < 2; d++) {
+    size_t count = std::min(directions[d]->size(), (size_t)arrivalsPerDirection);
+    for (size_t i = 0; i < count; i++) {
+      const IndexedArrival& arrival = (*directions[d])[i];
+      writer.add(d, arrival.route, stopName(arrival.terminal), arrival.time);
+    }
+  }
+  std::string summary;
+  cached.hasSummary = writer.finish(stationId, timestamp, summary);
+  if (cached.hasSummary) addVariants(cached, FORMAT_SUMMARY, STATION_SUMMARY_CONTENT_TYPE, summary);
+}
+
+void ResponseCache::addVariants(CachedStation& cached, ResponseFormat format, const std::string& contentType,
+                                const std::string& body) {
+  std::string& etag = cached.etag[format];
+  etag = etagFor(body);
+  std::string validators = "ETag: " + etag + "\r\nLast-Modified: " + cached.lastModified + "\r\n" + VARY_LINE;
+  cached.notModified[format].head = "HTTP/1.1 304 Not Modified\r\n" + validators;
+
+  static const char* ENCODING_NAMES[ENCODING_COUNT] = {nullptr, "deflate", "gzip"};
+  for (int e = 0; e < ENCODING_COUNT; e++) {
+    HttpResponse& response = cached.full[format][e];
+    response.body = body;
+    const char* encoding = ENCODING_NAMES[e];
+
+    // A compressed variant is only kept when it is smaller
+    std::string compressed;
+    if (encoding && compress(body, compressed, PROXY_DEFLATE_WINDOW_BITS, e == ENCODING_GZIP) &&
+        compressed.size() < body.size()) {
+      response.body.swap(compressed);
+    } else {
+      encoding = nullptr;
+    }
+    response.head = "HTTP/1.1 200 OK\r\nContent-Type: " + contentType + "\r\nContent-Length: " +
+                    std::to_string(response.body.size()) + "\r\n" + validators;
+    if (encoding) response.head += std::string("Content-Encoding: ") + encoding + "\r\n";
+    stats.bodyBytes += response.body.size();
+  }
+}
+
+const HttpResponse& ResponseCache::respond(const HttpRequest& request) {
+  if (request.method != "GET") return notAllowed;
+
+  size_t prefixLength = strlen(STATION_PATH_PREFIX);
+  auto found = request.path.compare(0, prefixLength, STATION_PATH_PREFIX) == 0
+                   ? stations.find(request.path.substr(prefixLength))
+                   : stations.end();
+  if (found == stations.end()) {
+    stats.notFound++;
+    return notFound;
+  }
+  CachedStation& cached = found->second;
+
+  // Same negotiation as the simulated server: a summary to clients that
+  // list it, deflate before gzip
+  ResponseFormat format = cached.hasSummary && request.accept.find(STATION_SUMMARY_CONTENT_TYPE) != std::string::npos
+                              ? FORMAT_SUMMARY
+                              : FORMAT_JSON;
+  ResponseEncoding encoding = request.acceptEncoding.find("deflate") != std::string::npos ? ENCODING_DEFLATE
+                              : request.acceptEncoding.find("gzip") != std::string::npos  ? ENCODING_GZIP
+                                                                                          : ENCODING_IDENTITY;
+  stats.served[format]++;
+
+  // If-None-Match takes precedence over If-Modified-Since (RFC 9110)
+  bool unchanged = !request.ifNoneMatch.empty() ? request.ifNoneMatch == cached.etag[format]
+                                                : request.ifModifiedSince == cached.lastModified;
+  if (unchanged) {
+    stats.notModified++;
+    return cached.notModified[format];
+  }
+
+  const HttpResponse& response = cached.full[format][encoding];
+  if (response.head.find("Content-Encoding:") != std::string::npos) stats.compressed++;
+  return response;
+}
@@ -0,0 +1,79 @@
+/*
+ * Pre-serialized station responses for the MTA transit proxy
+ * Built from a FeedIndex once per feed update: for every station and both
+ * of its platform IDs, the JSON body the firmware parses and the binary
+ * station summary, each also deflated and gzipped for the device's 2 KB
+ * inflate window, with the matching 304. Answering a request is choosing
+ * one of those; nothing is formatted or compressed per request.
+ */
+
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include "FeedIndex.h"
+#include "HttpServer.h"
+
+// Path prefix the firmware requests, followed by the station ID
+const char* const STATION_PATH_PREFIX = "/api/mta/station/";
+
+// Matches INFLATE_WINDOW_BITS: the device cannot inflate larger windows
+const int PROXY_DEFLATE_WINDOW_BITS = 11;
+
+enum ResponseFormat { FORMAT_JSON, FORMAT_SUMMARY, FORMAT_COUNT };
+enum ResponseEncoding { ENCODING_IDENTITY, ENCODING_DEFLATE, ENCODING_GZIP, ENCODING_COUNT };
+
+struct ResponseCacheStats {
+  uint32_t stationIds;            // Requestable IDs: stations and platforms
+  uint64_t bodyBytes;             // Every cached variant's body
+  uint64_t served[FORMAT_COUNT];
+  uint64_t compressed;            // Served deflated or gzipped
+  uint64_t notModified;
+  uint64_t notFound;
+};
+
+class ResponseCache {
+private:
+  struct CachedStation {
+    HttpResponse full[FORMAT_COUNT][ENCODING_COUNT];
+    HttpResponse notModified[FORMAT_COUNT];
+    std::string etag[FORMAT_COUNT];
+    std::string lastModified;
+    bool hasSummary;              // The ID and arrivals fit in a summary
+  };
+
+  std::unordered_map<std::string, CachedStation> stations;
+  std::unordered_map<std::string, std::string> stopNames;
+  int arrivalsPerDirection;
+  HttpResponse notFound;
+  HttpResponse notAllowed;
+  ResponseCacheStats stats;
+
+  std::string stopName(const std::string& stopId) const;
+  void addStation(const std::string& stationId, const std::string& parent, const IndexedStation& arrivals,
+                  uint32_t timestamp);
+  void addVariants(CachedStation& cached, ResponseFormat format, const std::string& contentType,
+                   const std::string& body);
+
+public:
+  ResponseCache();
+
+  // Names from a GTFS static stops.txt, for station names and destinations;
+  // without them, stop IDs are shown
+  bool loadStopNames(const char* path, std::string* error);
+
+  // Arrivals kept per direction, soonest first (1 to 255)
+  void setArrivalsPerDirection(int count);
+
+  // Replaces every cached response with ones built from the index
+  void build(const FeedIndex& index);
+
+  // The response for a request; valid until the next build()
+  const HttpResponse& respond(const HttpRequest& request);
+
+  const ResponseCacheStats& getStats() const { return stats; }
+};
+
+#endif
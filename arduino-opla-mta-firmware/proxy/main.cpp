@@ -0,0 +1,217 @@
+/*
+ * MTA transit proxy
+ * Serves /api/mta/station/{stationId} the way the firmware expects, from
+ * GTFS-realtime feed files: the MTA's own, recorded ones, or the synthetic
+ * feed bench-gtfs writes. Feeds are indexed and every station's responses
+ * built whenever a source file changes, so requests are answered from
+ * memory by one epoll loop, however many devices poll it.
+ */
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "FeedIndex.h"
+#include "HttpServer.h"
+#include "ResponseCache.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+  stopRequested = 1;
+}
+
+struct Proxy {
+  std::vector<std::string> sources;       // Feed files and directories of them
+  std::string signature;                  // Paths, sizes and mtimes last loaded
+  FeedIndex index;
+  ResponseCache cache;
+  uint32_t rebuilds;
+};
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool readFile(const std::string& path, std::string& contents) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  contents.clear();
+  char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) contents.append(buffer, n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+// Feed files named by the sources, directories expanded to the regular
+// files in them, sorted so arrivals tie-break the same way every load
+static std::vector<std::string> listFeeds(const std::vector<std::string>& sources, std::string& signature) {
+  std::vector<std::string> feeds;
+  for (const std::string& source : sources) {
+    DIR* dir = opendir(source.c_str());
+    if (!dir) {
+      feeds.push_back(source);
+      continue;
+    }
+    std::vector<std::string> entries;
+    while (struct dirent* entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') entries.push_back(source + "/" + entry->d_name);
+    }
+    closedir(dir);
+    std::sort(entries.begin(), entries.end());
+    for (const std::string& path : entries) {
+      struct stat st;
+      if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) feeds.push_back(path);
+    }
+  }
+
+  signature.clear();
+  for (const std::string& path : feeds) {
+    struct stat st;
+    bool exists = stat(path.c_str(), &st) == 0;
+    signature += path + ":" + std::to_string(exists ? st.st_size : -1) + ":" +
+                 std::to_string(exists ? st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec : 0) + "\n";
+  }
+  return feeds;
+}
+
+// Reindexes every feed and rebuilds the responses; a feed that cannot be
+// read or decoded is reported and left out
+static void reload(Proxy& proxy, const std::vector<std::string>& feeds) {
+  double start = nowSeconds();
+  size_t bytes = 0;
+  proxy.index.clear();
+  for (const std::string& path : feeds) {
+    std::string feed, error;
+    if (!readFile(path, feed)) {
+      fprintf(stderr, "%s: cannot read\n", path.c_str());
+    } else if (!proxy.index.addFeed(feed, &error)) {
+      fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+    } else {
+      bytes += feed.size();
+    }
+  }
+  proxy.index.finish();
+  double indexed = nowSeconds();
+  proxy.cache.build(proxy.index);
+  double built = nowSeconds();
+  proxy.rebuilds++;
+
+  const FeedIndexStats& feedStats = proxy.index.getStats();
+  const ResponseCacheStats& cacheStats = proxy.cache.getStats();
+  printf("Loaded %u of %zu feeds, %zu bytes: %u trip updates, %u arrivals at %zu stations (%.1f ms)\n",
+         feedStats.feeds, feeds.size(), bytes, feedStats.tripUpdates, feedStats.arrivals,
+         proxy.index.getStations().size(), (indexed - start) * 1000);
+  printf("Built responses for %u station IDs, %.1f KB of bodies (%.1f ms)\n", cacheStats.stationIds,
+         cacheStats.bodyBytes / 1024.0, (built - indexed) * 1000);
+  fflush(stdout);
+}
+
+static const HttpResponse& handleRequest(const HttpRequest& request, void* context) {
+  return ((Proxy*)context)->cache.respond(request);
+}
+
+static void pollSources(void* context) {
+  Proxy& proxy = *(Proxy*)context;
+  std::string signature;
+  std::vector<std::string> feeds = listFeeds(proxy.sources, signature);
+  if (signature != proxy.signature) {
+    proxy.signature = signature;
+    reload(proxy, feeds);
+  }
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [options] FEED|DIR...\n"
+          "  --port N           Port to listen on (default 8080)\n"
+          "  --bind ADDR        Address to listen on (default 127.0.0.1)\n"
+          "  --stops FILE       GTFS static stops.txt for station and destination names\n"
+          "  --arrivals N       Arrivals per direction in each response (default 6)\n"
+          "  --keep-alive MS    Idle timeout for kept connections (default 5000)\n"
+          "  --poll SECONDS     Interval to check the feeds for changes (default 5)\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  static Proxy proxy;
+  const char* bindAddress = "127.0.0.1";
+  int port = 8080;
+  uint32_t keepAliveMs = 5000;
+  double pollSeconds = 5;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--port" && hasValue) {
+      port = atoi(argv[++i]);
+    } else if (arg == "--bind" && hasValue) {
+      bindAddress = argv[++i];
+    } else if (arg == "--stops" && hasValue) {
+      std::string error;
+      if (!proxy.cache.loadStopNames(argv[++i], &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+      }
+    } else if (arg == "--arrivals" && hasValue) {
+      proxy.cache.setArrivalsPerDirection(atoi(argv[++i]));
+    } else if (arg == "--keep-alive" && hasValue) {
+      keepAliveMs = strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--poll" && hasValue) {
+      pollSeconds = atof(argv[++i]);
+    } else if (arg[0] == '-') {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 2;
+    } else {
+      proxy.sources.push_back(arg);
+    }
+  }
+  if (proxy.sources.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  reload(proxy, listFeeds(proxy.sources, proxy.signature));
+
+  HttpServer server;
+  std::string error;
+  if (!server.listen(bindAddress, port, &error)) {
+    fprintf(stderr, "Cannot listen on %s:%d: %s\n", bindAddress, port, error.c_str());
+    return 1;
+  }
+  server.setKeepAlive(keepAliveMs);
+  server.setHandler(handleRequest, &proxy);
+  server.setTick(std::max(pollSeconds, 0.1) * 1000, pollSources, &proxy);
+
+  struct sigaction action = {};
+  action.sa_handler = onSignal;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  signal(SIGPIPE, SIG_IGN);   // A device vanishing mid-response is not fatal
+
+  printf("Serving http://%s:%d%s{stationId}\n", bindAddress, port, STATION_PATH_PREFIX);
+  fflush(stdout);
+  server.run(stopRequested);
+
+  const HttpServerStats& serverStats = server.getStats();
+  const ResponseCacheStats& cacheStats = proxy.cache.getStats();
+  printf("\n%llu connections (peak %u open), %llu requests, %llu bytes sent\n",
+         (unsigned long long)serverStats.connections, serverStats.peakConnections,
+         (unsigned long long)serverStats.requests, (unsigned long long)serverStats.bytesSent);
+  printf("Station responses: %llu JSON, %llu summary, %llu compressed, %llu not modified, %llu not found; "
+         "%u rebuilds\n",
+         (unsigned long long)cacheStats.served[FORMAT_JSON], (unsigned long long)cacheStats.served[FORMAT_SUMMARY],
+         (unsigned long long)cacheStats.compressed, (unsigned long long)cacheStats.notModified,
+         (unsigned long long)cacheStats.notFound, proxy.rebuilds);
+  return 0;
+}
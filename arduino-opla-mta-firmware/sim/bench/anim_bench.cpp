@@ -0,0 +1,165 @@
+/*
+ * Animation benchmark
+ * Runs RadialAnimator on the virtual clock against a countdown ring like
+ * transit mode's. Sliding and fading countdowns must never touch a pixel
+ * outside their circles, and every transition, the ring swinging round
+ * included, must end on exactly the pixels a fresh draw of the final scene
+ * gives. Then tweens the background color, which repaints the whole screen
+ * every frame, to show the frame rate backing off instead of frames piling
+ * up. Exits non-zero on any failure.
+ */
+
+#include <Arduino.h>
+#include <SimClock.h>
+#include <math.h>
+#include "RadialAnimator.h"
+
+static const int PIXELS = RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT;
+static const int CIRCLE_SIZE = 20;
+
+struct Bench {
+  MKRIoTCarrier carrier;
+  RadialDisplay display;
+  RadialAnimator animator;
+  RadialDisplayConfig scene;
+  RadialRing ring;
+  RadialElement elements[3];
+
+  Bench() : display(&carrier), animator(&display) {
+    for (int i = 0; i < 3; i++) {
+      elements[i] = display.createCircleElement(90 + i * 120, "", ST77XX_WHITE, CIRCLE_SIZE);
+    }
+    ring = display.createCircleRing(95, CIRCLE_SIZE, ST77XX_WHITE, ST77XX_BLACK);
+    ring.elementCount = 3;
+    ring.elements = elements;
+    ring.autoSpacing = false;
+    ring.textSize = 2;
+    scene = {120, 120, 0x0560, 1, &ring, 0};
+    animator.setScene(&scene);
+  }
+
+  const uint16_t* pixels() { return carrier.display.getFramebuffer(); }
+};
+
+// Frames until the animator is done; calls check after each
+template <typename F> static int runFrames(Bench& bench, F check) {
+  int frames = 0;
+  for (uint32_t nextMs = bench.animator.renderFrame(); nextMs > 0; nextMs = bench.animator.renderFrame()) {
+    frames++;
+    check();
+    SimClock::advanceMicros(nextMs * 1000ULL);
+  }
+  return frames;
+}
+
+// The screen matches the scene drawn from scratch
+static bool matchesFreshDraw(Bench& bench) {
+  static uint16_t animated[PIXELS];
+  memcpy(animated, bench.pixels(), sizeof(animated));
+  bench.display.invalidate();
+  bench.display.drawRadialLayout(bench.scene);
+  return memcmp(animated, bench.pixels(), sizeof(animated)) == 0;
+}
+
+static void setTexts(Bench& bench, const char* const texts[3], TextTransition transition) {
+  for (int i = 0; i < 3; i++) {
+    bench.animator.changeText(bench.ring, i, texts[i], transition, 400);
+  }
+}
+
+static bool checkText(Bench& bench, const char* name, TextTransition transition) {
+  static const char* const BEFORE[] = {"2m", "11m", "16m"};
+  static const char* const AFTER[] = {"1m", "10m", "9m"};
+  static uint16_t start[PIXELS];
+  static bool inCircle[PIXELS];
+
+  setTexts(bench, BEFORE, TEXT_CUT);
+  bench.display.invalidate();
+  bench.display.drawRadialLayout(bench.scene);
+  memcpy(start, bench.pixels(), sizeof(start));
+  memset(inCircle, 0, sizeof(inCircle));
+  for (int i = 0; i < 3; i++) {
+    float angle = bench.elements[i].angle * M_PI / 180;
+    int x = 120 + lroundf(95 * sinf(angle)), y = 120 - lroundf(95 * cosf(angle));
+    for (int py = y - CIRCLE_SIZE; py <= y + CIRCLE_SIZE; py++) {
+      for (int px = x - CIRCLE_SIZE; px <= x + CIRCLE_SIZE; px++) {
+        int dx = px - x, dy = py - y;
+        if (dx * dx + dy * dy <= CIRCLE_SIZE * CIRCLE_SIZE) inCircle[py * RADIAL_SCREEN_WIDTH + px] = true;
+      }
+    }
+  }
+
+  setTexts(bench, AFTER, transition);
+  int strays = 0;
+  bool moved = false;
+  int frames = runFrames(bench, [&]() {
+    for (int p = 0; p < PIXELS; p++) {
+      if (bench.pixels()[p] == start[p]) continue;
+      moved = true;
+      if (!inCircle[p]) strays++;
+    }
+  });
+  bool settled = matchesFreshDraw(bench);
+  bool ok = strays == 0 && moved && settled && bench.elements[1].content == "10m";
+  printf("%-28s %2d frames, %d pixels outside the circles, %s at rest: %s\n", name, frames, strays,
+         settled ? "matches" : "differs", ok ? "ok" : "WRONG");
+  return ok;
+}
+
+// Retargeting a transition that has not reached its new text yet
+static bool checkRetarget(Bench& bench) {
+  static const char* const FIRST[] = {"5m", "6m", "7m"};
+  static const char* const SECOND[] = {"4m", "5m", "6m"};
+  setTexts(bench, FIRST, TEXT_SLIDE);
+  bench.animator.renderFrame();
+  SimClock::advanceMicros(100000);
+  setTexts(bench, SECOND, TEXT_SLIDE);
+  runFrames(bench, []() {});
+  bool ok = bench.elements[0].content == "4m" && bench.elements[2].content == "6m" &&
+            bench.elements[0].textOffset == 0 && matchesFreshDraw(bench);
+  printf("%-28s %s\n", "Retargeted mid-slide", ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static bool checkSwing(Bench& bench) {
+  bench.ring.rotation = -120;
+  bench.display.drawRadialLayout(bench.scene);
+  bench.animator.animate(bench.ring.rotation, 0, 450);
+  uint32_t startMs = millis();
+  int frames = runFrames(bench, []() {});
+  uint32_t elapsedMs = millis() - startMs;
+  bool ok = bench.ring.rotation == 0 && matchesFreshDraw(bench) && frames >= 10;
+  printf("%-28s %2d frames in %u ms (%.1f fps), at rest: %s\n", "Ring swing, 450 ms", frames, elapsedMs,
+         frames * 1000.0 / elapsedMs, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static bool checkBackoff(Bench& bench) {
+  AnimatorStats before = RadialAnimator::getStats();
+  bench.animator.animateColor(bench.scene.backgroundColor, ST77XX_BLACK, 1000);
+  uint32_t startMs = millis();
+  int frames = runFrames(bench, []() {});
+  uint32_t elapsedMs = millis() - startMs;
+  const AnimatorStats& after = RadialAnimator::getStats();
+  uint32_t overruns = after.overruns - before.overruns;
+  bool ok = bench.scene.backgroundColor == ST77XX_BLACK && overruns > 0 &&
+            bench.animator.getFrameMs() > ANIMATION_FRAME_MS && matchesFreshDraw(bench);
+  printf("%-28s %2d frames in %u ms, %u overruns, %u dropped, interval now %u ms: %s\n",
+         "Full-screen color, 1 s", frames, elapsedMs, overruns, after.droppedFrames - before.droppedFrames,
+         bench.animator.getFrameMs(), ok ? "ok" : "WRONG");
+  return ok;
+}
+
+int main() {
+  static Bench bench;
+  bool ok = checkText(bench, "Countdowns slide, 400 ms", TEXT_SLIDE);
+  ok = checkText(bench, "Countdowns fade, 400 ms", TEXT_FADE) && ok;
+  ok = checkRetarget(bench) && ok;
+  ok = checkSwing(bench) && ok;
+  ok = checkBackoff(bench) && ok;
+
+  const AnimatorStats& stats = RadialAnimator::getStats();
+  printf("\nTotal: %u frames, %u dropped, %u overruns, slowest %.1f ms\n", stats.frames, stats.droppedFrames,
+         stats.overruns, stats.maxFrameMicros / 1000.0);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*
+ * Dirty-region benchmark
+ * Keeps a scene like transit mode's, with a history sparkline round the
+ * edge, and changes one thing at a time: a countdown, all of them, a
+ * sparkline bar, the whole history, the station name, a color, the ring's
+ * rotation, the background. Each frame drawRadialLayout() repaints only the
+ * regions it finds dirty, and the result must match the same scene drawn
+ * from a cleared screen, pixel for pixel. Reports what each kind of change
+ * repaints and sends, and its modelled bus and host time against a full
+ * redraw. Exits non-zero on any failure.
+ */
+
+#include <Arduino.h>
+#include <time.h>
+#include "RadialDisplay.h"
+
+static const int PIXELS = RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT;
+static const int FRAMES = 40;
+static const int HISTORY_SAMPLES = 48;
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Bench {
+  MKRIoTCarrier carrier;
+  RadialDisplay display;
+  RadialDisplayConfig scene;
+  RadialRing rings[5];
+  RadialElement countdowns[3];
+  RadialElement station[1];
+  RadialElement direction[1];
+  RadialElement center[1];
+  uint8_t samples[HISTORY_SAMPLES];
+  uint8_t drawnSamples[HISTORY_SAMPLES];
+
+  Bench() : display(&carrier) {
+    for (int i = 0; i < 3; i++) {
+      countdowns[i] = display.createCircleElement(90 + i * 120, "", ST77XX_WHITE, 20);
+    }
+    countdowns[0].content = "2m";
+    countdowns[1].content = "11m";
+    countdowns[2].content = "16m";
+    rings[0] = display.createCircleRing(90, 20, ST77XX_WHITE, ST77XX_BLACK);
+    rings[0].elementCount = 3;
+    rings[0].elements = countdowns;
+    rings[0].autoSpacing = false;
+    rings[0].textSize = 2;
+
+    direction[0] = display.createTextElement(0, "UPTOWN", ST77XX_BLACK);
+    rings[1] = display.createTextRing(66, 2, ST77XX_BLACK);
+    rings[1].type = RadialRing::RING_TEXT_ARC;
+    rings[1].elementCount = 1;
+    rings[1].elements = direction;
+
+    station[0] = display.createTextElement(0, "Union Sq - 14 St", ST77XX_BLACK);
+    rings[2] = display.createTextRing(48, 1, ST77XX_BLACK);
+    rings[2].type = RadialRing::RING_TEXT_ARC;
+    rings[2].elementCount = 1;
+    rings[2].elements = station;
+
+    center[0] = display.createCircleElement(0, "L", ST77XX_BLACK, 30);
+    rings[3] = display.createCenterRing(4, ST77XX_WHITE);
+    rings[3].elementCount = 1;
+    rings[3].elements = center;
+
+    for (int i = 0; i < HISTORY_SAMPLES; i++) samples[i] = (i * 37) % 256;
+    rings[4] = display.createSparklineRing(113, 12, samples, drawnSamples, HISTORY_SAMPLES);
+    rings[4].bgColor = 0x2104;
+    rings[4].borderColor = ST77XX_WHITE;
+
+    scene = {120, 120, 0x8410, 5, rings, 0};
+  }
+
+  const uint16_t* pixels() { return carrier.display.getFramebuffer(); }
+};
+
+struct Change {
+  const char* name;
+  void (*apply)(Bench& bench, int frame);
+};
+
+static const Change CHANGES[] = {
+  {"nothing", [](Bench&, int) {}},
+  {"one countdown", [](Bench& b, int frame) { b.countdowns[0].content = frame % 2 ? "1m" : "2m"; }},
+  {"three countdowns", [](Bench& b, int frame) {
+    static const char* const TEXTS[2][3] = {{"2m", "11m", "16m"}, {"1m", "10m", "15m"}};
+    for (int i = 0; i < 3; i++) b.countdowns[i].content = TEXTS[frame % 2][i];
+  }},
+  {"one history bar", [](Bench& b, int frame) { b.samples[7] = frame % 2 ? 250 : 40; }},
+  {"whole history", [](Bench& b, int) {
+    uint8_t first = b.samples[0];
+    memmove(b.samples, b.samples + 1, HISTORY_SAMPLES - 1);
+    b.samples[HISTORY_SAMPLES - 1] = first;
+  }},
+  {"station name", [](Bench& b, int frame) { b.station[0].content = frame % 2 ? "Bedford Av" : "Union Sq - 14 St"; }},
+  {"countdown color", [](Bench& b, int frame) { b.countdowns[1].color = frame % 2 ? ST77XX_YELLOW : ST77XX_WHITE; }},
+  {"ring rotation", [](Bench& b, int frame) { b.rings[0].rotation = frame % 2 ? 4 : 0; }},
+  {"background", [](Bench& b, int frame) { b.scene.backgroundColor = frame % 2 ? 0x0560 : 0x8410; }},
+};
+
+struct Cost {
+  double hostUs;
+  double busUs;
+  uint32_t pixelsSent;
+};
+
+static Cost drawFrame(Bench& bench) {
+  bench.carrier.display.resetBusStats();
+  double start = nowSeconds();
+  bench.display.drawRadialLayout(bench.scene);
+  Cost cost;
+  cost.hostUs = (nowSeconds() - start) * 1e6;
+  cost.busUs = bench.carrier.display.getBusStats().busNanos / 1e3;
+  cost.pixelsSent = bench.carrier.display.getBusStats().pixels;
+  return cost;
+}
+
+int main() {
+  static Bench bench;
+  static uint16_t partial[PIXELS];
+  bool ok = true;
+
+  bench.display.drawRadialLayout(bench.scene);
+  printf("%-17s %9s %9s %9s %9s %9s %9s %9s\n", "Per frame", "repainted", "sent", "bus us", "full us",
+         "host us", "full us", "mismatch");
+
+  for (const Change& change : CHANGES) {
+    RadialRenderStats before = bench.display.getStats();
+    Cost dirty = {0, 0, 0}, full = {0, 0, 0};
+    int mismatched = 0;
+
+    for (int frame = 1; frame <= FRAMES; frame++) {
+      change.apply(bench, frame);
+      Cost cost = drawFrame(bench);
+      dirty.hostUs += cost.hostUs;
+      dirty.busUs += cost.busUs;
+      dirty.pixelsSent += cost.pixelsSent;
+      memcpy(partial, bench.pixels(), sizeof(partial));
+
+      // The same scene from scratch; it leaves the display as it found it
+      bench.display.invalidate();
+      cost = drawFrame(bench);
+      full.hostUs += cost.hostUs;
+      full.busUs += cost.busUs;
+      mismatched += memcmp(partial, bench.pixels(), sizeof(partial)) != 0;
+    }
+
+    // Less the full redraws
+    uint32_t repainted = bench.display.getStats().repaintedPixels - before.repaintedPixels - FRAMES * PIXELS;
+    printf("%-17s %9u %9u %9.0f %9.0f %9.1f %9.1f %9d%s\n", change.name, repainted / FRAMES,
+           dirty.pixelsSent / FRAMES, dirty.busUs / FRAMES, full.busUs / FRAMES, dirty.hostUs / FRAMES,
+           full.hostUs / FRAMES, mismatched, mismatched ? "  WRONG" : "");
+    ok = ok && mismatched == 0;
+  }
+
+  // Frames with nothing changed must not have drawn anything
+  const RadialRenderStats& stats = bench.display.getStats();
+  printf("\n%u full, %u partial and %u unchanged frames\n", stats.fullRedraws, stats.partialRedraws,
+         stats.unchangedFrames);
+  ok = ok && stats.unchangedFrames == FRAMES;
+  return ok ? 0 : 1;
+}
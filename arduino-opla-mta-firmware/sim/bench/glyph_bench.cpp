@@ -0,0 +1,194 @@
+/*
+ * Glyph atlas benchmark
+ * Checks the generated atlas against the 5x7 GFX font it came from (every
+ * glyph keeps all its ink at every size), the countdown sprites against
+ * the glyphs they were rasterized from, and UTF-8 decoding. Then draws
+ * text along rings of several radii at angles all the way round, and
+ * straight text around a ring, through RadialDisplay: once the text is
+ * cleared, not a pixel of it may be left, or its bounds were too small.
+ * Last, times countdown strings through GFX print() and the atlas. Exits
+ * non-zero on any failure.
+ */
+
+#include <Arduino.h>
+#include <time.h>
+#include "GlyphAtlas.h"
+#include "RadialDisplay.h"
+
+static const uint16_t INK = 0xFFFF;
+static const int TIMING_ITERATIONS = 20000;
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t countInk(const Adafruit_SPITFT& display) {
+  const uint16_t* pixels = display.getFramebuffer();
+  uint32_t count = 0;
+  for (int i = 0; i < RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT; i++) count += pixels[i] != 0;
+  return count;
+}
+
+// Same pixels as GFX drawChar() at sizes 1 to 4, trimmed columns aside
+static bool checkInk(MKRIoTCarrier& carrier, StripCompositor& target) {
+  int wrong = 0;
+  for (int c = ' '; c <= '~'; c++) {
+    char text[2] = {(char)c, 0};
+    for (int size = 1; size <= 4; size++) {
+      carrier.display.fillScreen(0);
+      carrier.display.drawChar(10, 10, c, INK, INK, size);
+      uint32_t expected = countInk(carrier.display);
+      carrier.display.fillScreen(0);
+      drawGlyphText(target, 10, 10, text, size, INK);
+      uint32_t drawn = countInk(carrier.display);
+      if (drawn != expected && wrong++ < 5) {
+        printf("  '%c' at size %d: %u pixels, font has %u\n", c, size, drawn, expected);
+      }
+    }
+  }
+  printf("Atlas ink vs GFX font, 95 glyphs at sizes 1-4: %s\n", wrong ? "WRONG" : "ok");
+  return wrong == 0;
+}
+
+// Sprites match the same glyph drawn unrotated through drawRotatedGlyph()
+static bool checkSprites(MKRIoTCarrier& carrier, StripCompositor& target) {
+  static uint16_t sprite[RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT];
+  int wrong = 0;
+  for (int i = 0; i < GLYPH_SPRITE_COUNT; i++) {
+    char text[2] = {GLYPH_SPRITE_CHARACTERS[i], 0};
+    const GlyphEntry* glyph = findGlyph(text[0]);
+    carrier.display.fillScreen(0);
+    drawGlyphText(target, 30, 40, text, GLYPH_SPRITE_SIZE, INK);
+    memcpy(sprite, carrier.display.getFramebuffer(), sizeof(sprite));
+
+    // Pixel centers are whole coordinates, so the glyph's center is half a
+    // pixel short of its top-left corner plus half its size
+    int width = glyph->width * GLYPH_SPRITE_SIZE;
+    carrier.display.fillScreen(0);
+    drawRotatedGlyph(target, (2 * 30 + width - 1) << 15, (2 * 40 + GLYPH_SPRITE_ROWS - 1) << 15,
+                     Q15_ONE, 0, glyph, GLYPH_SPRITE_SIZE, INK);
+    bool same = memcmp(sprite, carrier.display.getFramebuffer(), sizeof(sprite)) == 0;
+    if (!same || glyph->sprite != i || countInk(carrier.display) == 0) {
+      printf("  sprite '%s' does not match its glyph\n", text);
+      wrong++;
+    }
+  }
+  printf("Sprites vs glyphs, %d at size %d: %s\n", GLYPH_SPRITE_COUNT, GLYPH_SPRITE_SIZE, wrong ? "WRONG" : "ok");
+  return wrong == 0;
+}
+
+static bool checkDecoding() {
+  struct Case {
+    const char* text;
+    uint16_t expected[4];
+  };
+  static const Case CASES[] = {
+    {"m", {'m', 0}},
+    {"\xE2\x98\x80", {GLYPH_SUN, 0}},
+    {"\xE2\x98\xBD!", {GLYPH_MOON, '!', 0}},
+    {"\xC3\xA9", {0xE9, 0}},
+    {"\xE2\x98" "A", {GLYPH_REPLACEMENT, 'A', 0}},     // Truncated sequence
+    {"\xF0\x9F\x9A\x87", {GLYPH_REPLACEMENT, GLYPH_REPLACEMENT, GLYPH_REPLACEMENT, GLYPH_REPLACEMENT}},
+  };
+  bool ok = true;
+  for (const Case& c : CASES) {
+    const char* text = c.text;
+    for (int i = 0; i < 4 && (*text || c.expected[i]); i++) {
+      ok = ok && nextCodepoint(text) == c.expected[i];
+    }
+    ok = ok && *text == 0;
+  }
+  ok = ok && findGlyph(0xE9) == findGlyph(GLYPH_REPLACEMENT) && findGlyph(GLYPH_SUN)->codepoint == GLYPH_SUN;
+  printf("UTF-8 decoding and lookup: %s\n", ok ? "ok" : "WRONG");
+  return ok;
+}
+
+// Draws each text around rings of each type, clears it, and looks for leftovers
+static bool checkBounds(MKRIoTCarrier& carrier, RadialDisplay& display) {
+  static const char* TEXTS[] = {"UPTOWN", "Union Sq - 14 St", "HUMID", "\xE2\x98\x80 12m", "W"};
+  static const int RADII[] = {30, 50, 70, 95, 110};
+  static const RadialRing::RingType TYPES[] = {RadialRing::RING_TEXT_ARC, RadialRing::RING_TEXT_CIRCULAR};
+  int draws = 0, leftovers = 0;
+  uint32_t inked = 0;
+
+  for (RadialRing::RingType type : TYPES) {
+    for (int radius : RADII) {
+      for (int size = 1; size <= 2; size++) {
+        for (const char* text : TEXTS) {
+          for (int angle = 0; angle < 360; angle += 15) {
+            RadialElement element = display.createTextElement(angle + 0.5f, text, INK);
+            RadialRing ring = display.createTextRing(radius, size, INK);
+            ring.type = type;
+            ring.autoSpacing = false;
+            ring.elementCount = 1;
+            ring.elements = &element;
+            RadialDisplayConfig scene = {120, 120, 0, 1, &ring, 0};
+
+            display.invalidate();
+            display.drawRadialLayout(scene);
+            inked += countInk(carrier.display);
+            element.content = "";
+            display.drawRadialLayout(scene);
+            draws++;
+            if (countInk(carrier.display) != 0 && leftovers++ < 5) {
+              printf("  %s text \"%s\" at %d degrees, radius %d, size %d outlives its bounds\n",
+                     type == RadialRing::RING_TEXT_ARC ? "Arc" : "Straight", text, angle, radius, size);
+            }
+          }
+        }
+      }
+    }
+  }
+  printf("Text bounds, %d texts drawn and cleared (%.0f pixels each): %s\n", draws, (double)inked / draws,
+         leftovers || inked == 0 ? "WRONG" : "ok");
+  return leftovers == 0 && inked > 0;
+}
+
+template <typename F> static double timeDraws(StripCompositor& target, F draw) {
+  double start = nowSeconds();
+  for (int i = 0; i < TIMING_ITERATIONS; i++) {
+    target.beginRegion(0, 0, RADIAL_SCREEN_WIDTH, 16 * 4);
+    target.nextStrip();
+    draw(i);
+  }
+  return (nowSeconds() - start) * 1e9 / TIMING_ITERATIONS;
+}
+
+static void timeCountdowns(StripCompositor& target) {
+  static const char* COUNTDOWNS[] = {"2m", "11m", "16m", "9m"};
+  printf("\n%-30s %10s %10s %8s\n", "Countdown, per string", "print() ns", "atlas ns", "speedup");
+  for (int size = 1; size <= 4; size++) {
+    double print = timeDraws(target, [&](int i) {
+      target.setTextSize(size);
+      target.setTextColor(INK);
+      target.setCursor(20, 8);
+      target.print(COUNTDOWNS[i % 4]);
+    });
+    double atlas = timeDraws(target, [&](int i) {
+      drawGlyphText(target, 20, 8, COUNTDOWNS[i % 4], size, INK);
+    });
+    char label[40];
+    snprintf(label, sizeof(label), "size %d%s", size, size == GLYPH_SPRITE_SIZE ? " (sprites)" : "");
+    printf("%-30s %10.0f %10.0f %7.1fx\n", label, print, atlas, print / atlas);
+  }
+  target.nextStrip();
+}
+
+int main() {
+  static MKRIoTCarrier carrier;
+  static StripCompositor target(&carrier.display, RADIAL_SCREEN_WIDTH, RADIAL_SCREEN_HEIGHT);
+  static RadialDisplay display(&carrier);
+  target.setTextWrap(false);
+
+  printf("Glyph atlas: %u glyphs, %u column bytes, %u sprite bytes in flash\n", GLYPH_COUNT,
+         GLYPHS[GLYPH_COUNT - 1].offset + GLYPHS[GLYPH_COUNT - 1].width,
+         (unsigned)(GLYPH_SPRITE_COUNT * GLYPH_SPRITE_BYTES));
+  bool ok = checkInk(carrier, target);
+  ok = checkSprites(carrier, target) && ok;
+  ok = checkDecoding() && ok;
+  ok = checkBounds(carrier, display) && ok;
+  timeCountdowns(target);
+  return ok ? 0 : 1;
+}
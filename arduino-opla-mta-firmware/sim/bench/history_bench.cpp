@@ -0,0 +1,100 @@
+/*
+ * Ambient history benchmark
+ * Feeds SensorHistory 30 hours of synthetic one-minute readings (a daily
+ * temperature swing, humidity following it, a pressure front, light
+ * switching between night, lamps and daylight) and checks every retained
+ * reading, the min/max and the trend against a plain array. Then repeats
+ * with a light channel that jumps every minute, to show the history
+ * shortening instead of overflowing. Exits non-zero on any mismatch.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <vector>
+#include "SensorHistory.h"
+
+static bool check(const SensorHistory& history, const std::vector<std::vector<int16_t>>& reference) {
+  int count = history.getSampleCount();
+  size_t total = reference[0].size();
+  bool ok = count > 0 && (size_t)count <= total;
+
+  for (int c = 0; c < HISTORY_CHANNEL_COUNT && ok; c++) {
+    HistoryChannel channel = (HistoryChannel)c;
+    const std::vector<int16_t>& values = reference[c];
+    int16_t low = 32767, high = -32768;
+    for (int age = 0; age < count; age++) {
+      int16_t value;
+      int16_t expected = values[total - 1 - age];
+      if (!history.valueAt(channel, age, value) || value != expected) {
+        printf("  channel %d, %d minutes ago: got %d, expected %d\n", c, age, value, expected);
+        return false;
+      }
+      low = std::min(low, expected);
+      high = std::max(high, expected);
+    }
+    int16_t unused;
+    ok = !history.valueAt(channel, count, unused) && history.minimum(channel) == low &&
+         history.maximum(channel) == high && history.latest(channel) == values[total - 1] &&
+         history.trend(channel, 180) == values[total - 1] - values[total - 1 - std::min(180, count - 1)];
+  }
+  return ok;
+}
+
+static bool run(const char* name, bool noisyLight) {
+  static SensorHistory history;
+  history.clear();
+  std::vector<std::vector<int16_t>> reference(HISTORY_CHANNEL_COUNT);
+  bool ok = true;
+  srand(7);
+
+  const int MINUTES = 30 * 60;
+  for (int minute = 0; minute < MINUTES; minute++) {
+    double day = minute / 1440.0 * 2 * M_PI;
+    float temperature = 21.5f + 2.5f * sin(day) + (rand() % 3 - 1) * 0.05f;
+    float humidity = 45.0f - 6.0f * sin(day) + (rand() % 3 - 1) * 0.1f;
+    float pressure = 101.3f - 0.8f / (1 + exp(-(minute - 900) / 120.0));  // Front at 15 h
+    int hour = (minute / 60) % 24;
+    float light = hour < 7 ? 3 : hour < 9 || hour >= 19 ? 180 : 420 + 60 * sin(minute / 37.0);
+    if (noisyLight) light = rand() % 4000;
+
+    int16_t values[HISTORY_CHANNEL_COUNT] = {
+      SensorHistory::toUnits(HISTORY_TEMPERATURE, temperature),
+      SensorHistory::toUnits(HISTORY_HUMIDITY, humidity),
+      SensorHistory::toUnits(HISTORY_PRESSURE, pressure),
+      SensorHistory::toUnits(HISTORY_LIGHT, light),
+    };
+    history.append(values);
+    for (int c = 0; c < HISTORY_CHANNEL_COUNT; c++) reference[c].push_back(values[c]);
+
+    // Check as the window fills, at each hour boundary and once it slides
+    if (minute % 59 == 0 || minute == MINUTES - 1) ok = ok && check(history, reference);
+  }
+
+  int count = history.getSampleCount();
+  printf("%s: %s, %d readings kept (%.1f h)\n", name, ok ? "ok" : "WRONG", count, count / 60.0);
+  static const char* NAMES[] = {"temperature", "humidity", "pressure", "light"};
+  for (int c = 0; c < HISTORY_CHANNEL_COUNT; c++) {
+    HistoryChannel channel = (HistoryChannel)c;
+    printf("  %-11s %4d bytes, %.2f bytes/reading, range %.2f..%.2f, 3 h trend %+.2f\n", NAMES[c],
+           history.getDeltaBytes(channel), (double)history.getDeltaBytes(channel) / count,
+           SensorHistory::fromUnits(channel, history.minimum(channel)),
+           SensorHistory::fromUnits(channel, history.maximum(channel)),
+           SensorHistory::fromUnits(channel, history.trend(channel, 180)));
+  }
+
+  uint8_t bars[HISTORY_HOURS];
+  history.sparkline(HISTORY_PRESSURE, bars);
+  printf("  pressure sparkline:");
+  for (int i = 0; i < HISTORY_HOURS; i++) printf(" %d", bars[i]);
+  printf("\n");
+  return ok;
+}
+
+int main() {
+  printf("SensorHistory: %u bytes for %d channels, %d h at 1 min (raw int16: %u bytes)\n",
+         (unsigned)sizeof(SensorHistory), HISTORY_CHANNEL_COUNT, HISTORY_HOURS,
+         (unsigned)(HISTORY_CHANNEL_COUNT * HISTORY_HOURS * HISTORY_SAMPLES_PER_HOUR * sizeof(int16_t)));
+  bool ok = run("Indoor day", false);
+  ok = run("Noisy light", true) && ok;
+  return ok ? 0 : 1;
+}
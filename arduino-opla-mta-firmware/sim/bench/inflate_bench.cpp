@@ -0,0 +1,153 @@
+/*
+ * Streaming inflater benchmark
+ * Compresses test bodies with the host zlib in every format InflateStream
+ * reads (zlib, gzip, raw) and every window from 512 bytes to 32 KB, then
+ * inflates them through InflateStream a byte at a time. Streams compressed
+ * for the 2 KB window or less must come back byte for byte; zlib streams
+ * for larger windows must be refused at the header, and gzip/raw ones must
+ * either decode exactly or fail, never return wrong bytes. Prints the 2 KB
+ * and 32 KB rows at full compression plus anything unexpected, and exits
+ * non-zero if any stream breaks those rules.
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "InflateStream.h"
+
+// Serves a buffer as a Stream, like the body of an HTTP response
+class MemoryStream : public Stream {
+private:
+  const std::string& data;
+  size_t position;
+
+public:
+  MemoryStream(const std::string& source) : data(source), position(0) {}
+  int available() override { return data.size() - position; }
+  int read() override { return position < data.size() ? (uint8_t)data[position++] : -1; }
+  int peek() override { return position < data.size() ? (uint8_t)data[position] : -1; }
+  size_t write(uint8_t) override { return 0; }
+};
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// A proxy response much like the simulator fixtures
+static std::string stationResponse(int entries) {
+  static const char* ROUTES[] = {"1", "2", "3", "A", "C", "E", "N", "Q", "R", "W"};
+  static const char* DESTINATIONS[] = {"Van Cortlandt Park - 242 St", "South Ferry", "Wakefield - 241 St",
+                                       "Far Rockaway - Mott Av", "Astoria - Ditmars Blvd", "Coney Island - Stillwell Av"};
+  std::string body = "{\"timestamp\": 1759276800, \"arrivals\": [";
+  char entry[160];
+  for (int i = 0; i < entries; i++) {
+    snprintf(entry, sizeof(entry), "%s{\"route\": \"%s\", \"destination\": \"%s\", \"minutes\": %d, \"arrival\": %d}",
+             i ? ", " : "", ROUTES[i * 7 % 10], DESTINATIONS[i * 5 % 6], i, 1759276800 + i * 60 + i * 13 % 50);
+    body += entry;
+  }
+  return body + "]}";
+}
+
+// Random bytes, repeated: every match in the copies is a whole block back
+static std::string repeatedBlock(size_t blockSize, int copies) {
+  std::string block;
+  srand(11);
+  for (size_t i = 0; i < blockSize; i++) block += (char)(rand() & 0xFF);
+  std::string body;
+  for (int i = 0; i < copies; i++) body += block;
+  return body;
+}
+
+static std::string compress(const std::string& input, InflateFormat format, int windowBits, int level) {
+  // deflateInit2 refuses 8 for zlib streams; 9 is the smallest it writes
+  int bits = windowBits;
+  if (format == INFLATE_GZIP) bits += 16;
+  if (format == INFLATE_RAW) bits = -bits;
+
+  z_stream z = {};
+  deflateInit2(&z, level, Z_DEFLATED, bits, 8, Z_DEFAULT_STRATEGY);
+  std::string output(deflateBound(&z, input.size()) + 32, '\0');
+  z.next_in = (Bytef*)input.data();
+  z.avail_in = input.size();
+  z.next_out = (Bytef*)&output[0];
+  z.avail_out = output.size();
+  deflate(&z, Z_FINISH);
+  output.resize(z.total_out);
+  deflateEnd(&z);
+  return output;
+}
+
+enum Outcome { INFLATED, REFUSED, WRONG };
+
+static Outcome inflate(const std::string& compressed, InflateFormat format, const std::string& expected,
+                       double& seconds) {
+  static InflateStream inflater;
+  MemoryStream source(compressed);
+  std::string output;
+
+  double start = nowSeconds();
+  inflater.begin(source, format);
+  int c;
+  while ((c = inflater.read()) >= 0) output += (char)c;
+  seconds = nowSeconds() - start;
+
+  if (inflater.hasFailed()) return REFUSED;
+  return inflater.isDone() && output == expected && inflater.getOutputBytes() == expected.size() ? INFLATED : WRONG;
+}
+
+int main() {
+  struct Body {
+    const char* name;
+    std::string data;
+  };
+  std::vector<Body> bodies = {
+    {"station, 6 entries", stationResponse(6)},
+    {"station, 400 entries", stationResponse(400)},
+    {"1 KB random x 8", repeatedBlock(1024, 8)},
+    {"4 KB random x 4", repeatedBlock(4096, 4)},
+  };
+  static const char* FORMATS[] = {"zlib", "gzip", "raw"};
+
+  printf("InflateStream: %u bytes (window %u)\n\n", (unsigned)sizeof(InflateStream), INFLATE_WINDOW_SIZE);
+  printf("%-22s %-5s %6s %8s %8s %7s %9s\n", "body", "fmt", "window", "bytes", "wire", "ratio", "MB/s");
+
+  bool ok = true;
+  for (const Body& body : bodies) {
+    for (int f = 0; f < 3; f++) {
+      InflateFormat format = (InflateFormat)f;
+      for (int windowBits = 9; windowBits <= 15; windowBits++) {
+        for (int level = 0; level <= 9; level += 9) {
+          std::string compressed = compress(body.data, format, windowBits, level);
+          double seconds;
+          Outcome outcome = inflate(compressed, format, body.data, seconds);
+
+          // zlib headers state the window, even over stored blocks; without
+          // one, stored blocks never reach back and decode for any window
+          bool fits = windowBits <= INFLATE_WINDOW_BITS || (level == 0 && format != INFLATE_ZLIB);
+          bool pass = outcome == INFLATED ? fits || format != INFLATE_ZLIB
+                                          : outcome == REFUSED && !fits;
+          ok = ok && pass;
+
+          if (level == 0 && pass) continue;
+          if (windowBits != INFLATE_WINDOW_BITS && windowBits != 15 && pass) continue;
+          printf("%-22s %-5s %5dK %8zu %8zu %6.1f%% ", body.name, FORMATS[f], (1 << windowBits) / 1024,
+                 body.data.size(), compressed.size(), 100.0 * compressed.size() / body.data.size());
+          if (outcome == INFLATED) {
+            printf("%9.1f", body.data.size() / seconds / 1e6);
+          } else {
+            printf("%9s", outcome == REFUSED ? "refused" : "WRONG");
+          }
+          printf("%s\n", pass ? "" : "  <- unexpected");
+        }
+      }
+    }
+  }
+
+  printf("\n%s\n", ok ? "All streams inflated or refused as expected" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * Streaming MTA response benchmark
+ * Serves generated proxy responses from 2 KB to 100 KB through the
+ * simulated network, as the first MTA_CONFIGS station, and checks that
+ * MTAManager picks out the first arrivals
+ * in each direction, while ArduinoJson memory stays fixed. Entries carry
+ * fields the parser must filter out, other top-level values it must read
+ * past, and "downtown" comes before "uptown". Arrival epochs are from a
+ * server clock years off the device's, and must still count down from the
+ * minutes the server reported. A last fetch of an unchanged response must
+ * be answered 304 and leave the data in place. For comparison, each body is
+ * also handed to the old whole-body DynamicJsonDocument(2048) parse.
+ * Exits non-zero if any response is parsed wrong.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFiNINA.h>
+#include <SimClock.h>
+#include <SimNetwork.h>
+#include <sys/stat.h>
+#include "MTAManager.h"
+
+static const char* FIXTURE_ROOT = "build-sim/json-fixtures";
+static const char* STATION_DIR = "build-sim/json-fixtures/api.example.com/api/mta/station";
+
+static std::string arrivalEntry(const char* route, const char* destination, int minutes, int index) {
+  char entry[512];
+  snprintf(entry, sizeof(entry),
+           "{\"trip_id\": \"%06d_%s..N03R\", \"route\": \"%s\", \"destination\": \"%s\", "
+           "\"minutes\": %d, \"arrival\": %d, \"track\": null, \"assigned\": true, \"delay\": -1.5e1, "
+           "\"note\": \"Stops at \\\"all\\\" {local} stations [weekends]\", "
+           "\"stops\": [{\"id\": \"B06N\", \"t\": 1700000000}, {\"id\": \"B04N\", \"t\": 1700000120}]}",
+           index, route, route, destination, minutes, 1700000000 + minutes * 60);
+  return entry;
+}
+
+static std::string buildResponse(size_t targetBytes) {
+  std::string body = "{\n  \"station\": \"B06\", \"generated\": 1700000000, \"stale\": false,\n";
+  body += "  \"timestamp\": 1700000000,\n";
+  body += "  \"alerts\": [{\"text\": \"Planned work: \\u2014 no trains\", \"routes\": [\"F\", \"M\"]}],\n";
+
+  // Downtown first, then uptown, each padded out with later arrivals
+  int perDirection = 1;
+  while (true) {
+    std::string downtown, uptown;
+    for (int i = 0; i < perDirection; i++) {
+      if (i) {
+        downtown += ", ";
+        uptown += ", ";
+      }
+      downtown += arrivalEntry("F", "Coney Island", 4 + 7 * i, i);
+      uptown += arrivalEntry(i % 2 ? "M" : "F", "179 St", 2 + 6 * i, i);
+    }
+    std::string candidate = body + "  \"downtown\": [" + downtown + "],\n  \"uptown\": [" + uptown +
+                            "],\n  \"meta\": {\"source\": \"gtfs-rt\", \"feeds\": [1, 2, 3], \"ok\": true}\n}\n";
+    if (candidate.size() >= targetBytes || perDirection > 10000) return candidate;
+    perDirection++;
+  }
+}
+
+static bool writeFixture(const char* name, const std::string& body) {
+  mkdir("build-sim", 0755);
+  mkdir(FIXTURE_ROOT, 0755);
+  mkdir((std::string(FIXTURE_ROOT) + "/api.example.com").c_str(), 0755);
+  mkdir((std::string(FIXTURE_ROOT) + "/api.example.com/api").c_str(), 0755);
+  mkdir((std::string(FIXTURE_ROOT) + "/api.example.com/api/mta").c_str(), 0755);
+  mkdir(STATION_DIR, 0755);
+  std::string path = std::string(STATION_DIR) + "/" + name + ".json";
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  fwrite(body.data(), 1, body.size(), f);
+  fclose(f);
+  return true;
+}
+
+static bool arrivalMatches(MTAManager& mta, const TrainArrival& arrival, const char* route,
+                           const char* destination, int minutes) {
+  return arrival.isValid && arrival.route == route && arrival.destination == destination &&
+         arrival.minutesAway == minutes && mta.minutesUntil(arrival) == minutes;
+}
+
+// Fetches one station, running the manager until it is done; true if the
+// station's data changed
+static bool refresh(MTAManager& mta, int index) {
+  uint32_t version = mta.getDataVersion(index);
+  if (!mta.startRefresh(index)) return false;
+  while (mta.isFetching()) {
+    mta.update();
+    delay(1);
+  }
+  return mta.getDataVersion(index) != version;
+}
+
+int main() {
+  SimNetwork::config().fixtureRoot = FIXTURE_ROOT;
+  SimNetwork::config().stationSummaries = false;   // JSON even though the client would take a summary
+  WiFi.begin("bench", "bench");
+
+  MTAManager mta;
+  mta.begin();
+
+  static const size_t SIZES[] = {2 * 1024, 20 * 1024, 100 * 1024};
+  bool allOk = true;
+
+  printf("ArduinoJson memory while parsing: %u bytes (entry) + %u bytes (filter), any response size\n",
+         (unsigned)MTA_ARRIVAL_JSON_SIZE, (unsigned)MTA_FILTER_JSON_SIZE);
+  for (size_t size : SIZES) {
+    const char* name = MTA_CONFIGS[0].stationId;
+    std::string body = buildResponse(size);
+    if (!writeFixture(name, body)) {
+      fprintf(stderr, "Could not write fixture %s\n", name);
+      return 2;
+    }
+
+    uint64_t start = SimClock::nowMicros();
+    bool updated = refresh(mta, 0);
+    uint64_t elapsed = SimClock::nowMicros() - start;
+    const StationData& data = mta.getStationData(0);
+
+    bool ok = updated && data.hasData &&
+              arrivalMatches(mta, data.uptown[0], "F", "179 St", 2) &&
+              arrivalMatches(mta, data.uptown[1], "M", "179 St", 8) &&
+              arrivalMatches(mta, data.uptown[2], "F", "179 St", 14) &&
+              arrivalMatches(mta, data.downtown[0], "F", "Coney Island", 4) &&
+              arrivalMatches(mta, data.downtown[1], "F", "Coney Island", 11) &&
+              arrivalMatches(mta, data.downtown[2], "F", "Coney Island", 18);
+    allOk = allOk && ok;
+
+    DynamicJsonDocument wholeBody(2048);
+    DeserializationError oldResult = deserializeJson(wholeBody, body.c_str(), body.size());
+
+    printf("%7u-byte response: %s in %.1f ms virtual; whole-body parse: %s\n",
+           (unsigned)body.size(), ok ? "parsed" : "WRONG", elapsed / 1000.0, oldResult.c_str());
+  }
+
+  // Unchanged since the last fetch: the request is conditional
+  uint32_t notModified = mta.getFetchStats().notModified;
+  bool updated = refresh(mta, 0);
+  bool revalidated = !updated && mta.getFetchStats().notModified == notModified + 1 &&
+                     arrivalMatches(mta, mta.getStationData(0).uptown[0], "F", "179 St", 2);
+  printf("  unchanged response: %s\n", revalidated ? "not modified" : "WRONG");
+  allOk = allOk && revalidated;
+
+  return allOk ? 0 : 1;
+}
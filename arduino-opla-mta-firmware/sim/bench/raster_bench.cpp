@@ -0,0 +1,215 @@
+/*
+ * Ring rasterizer benchmark
+ * Fills annular sectors with RadialDisplay::fillAnnularSector(), one
+ * scanline span at a time, and compares every pixel with a per-pixel fill
+ * of the same sector: each pixel of the bounding square tested against the
+ * band's radii and the sweep's two edges. Covers start angles all the way
+ * round, sweeps from 2 degrees to the full circle, sweeps that wrap past 0
+ * degrees, pies and 1-pixel rings; any difference fails. The edge test
+ * itself is checked against float geometry: a pixel may only disagree with
+ * atan2() within a pixel of an edge. Then times both fills, on the host and
+ * on the modelled SPI bus. Exits non-zero on any failure.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <time.h>
+#include "RadialDisplay.h"
+
+static const uint16_t INK = 0xFFFF;
+static const int CENTER = 120;
+static const int PIXELS = RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT;
+static const int TIMING_ITERATIONS = 200;
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Sector {
+  int inner, outer;
+  BinaryAngle start;
+  uint32_t sweep;
+};
+
+static Sector makeSector(int inner, int outer, float startDegrees, float sweepDegrees) {
+  Sector sector = {inner, outer, angleFromDegrees(startDegrees), (uint32_t)(sweepDegrees * 65536 / 360)};
+  return sector;
+}
+
+static bool inBand(const Sector& sector, int32_t dx, int32_t dy) {
+  int32_t distanceSq = dx * dx + dy * dy;
+  return distanceSq <= (int32_t)sector.outer * sector.outer + sector.outer &&
+         (sector.inner <= 0 || distanceSq > (int32_t)sector.inner * sector.inner - sector.inner);
+}
+
+// A pixel's center within half a pixel of the band, clockwise of the start
+// edge and not of the end edge. Sweeps over 180 degrees are everything
+// outside the gap from the end round to the start.
+static bool insideSector(const Sector& sector, int32_t dx, int32_t dy) {
+  if (!inBand(sector, dx, dy)) return false;
+  if (sector.sweep >= 65536) return true;
+
+  BinaryAngle end = sector.start + sector.sweep;
+  int32_t fromStart = fixedCos(sector.start) * dx + fixedSin(sector.start) * dy;
+  int32_t fromEnd = fixedCos(end) * dx + fixedSin(end) * dy;
+  if (sector.sweep > 32768) return !(fromStart < 0 && fromEnd > 0);
+  return fromStart >= 0 && fromEnd <= 0;
+}
+
+static void fillPerPixel(Adafruit_SPITFT& display, const Sector& sector, uint16_t color) {
+  display.startWrite();
+  for (int dy = -sector.outer; dy <= sector.outer; dy++) {
+    for (int dx = -sector.outer; dx <= sector.outer; dx++) {
+      if (insideSector(sector, dx, dy)) display.writePixel(CENTER + dx, CENTER + dy, color);
+    }
+  }
+  display.endWrite();
+}
+
+static void fillSpans(RadialDisplay& display, const Sector& sector, uint16_t color) {
+  display.fillAnnularSector(CENTER, CENTER, sector.inner, sector.outer, sector.start, sector.sweep, color);
+}
+
+// Distance from a pixel center to the line through an edge, in pixels
+static double edgeDistance(BinaryAngle edge, int dx, int dy) {
+  return fabs((double)(fixedCos(edge) * dx + fixedSin(edge) * dy)) / Q15_ONE;
+}
+
+// Pixels in the band where the sector disagrees with atan2() more than a
+// pixel from either edge
+static int geometryErrors(const Sector& sector) {
+  if (sector.sweep >= 65536) return 0;
+  double start = sector.start * 360.0 / 65536;
+  double sweep = sector.sweep * 360.0 / 65536;
+  BinaryAngle end = sector.start + sector.sweep;
+  int errors = 0;
+  for (int dy = -sector.outer; dy <= sector.outer; dy++) {
+    for (int dx = -sector.outer; dx <= sector.outer; dx++) {
+      if (!inBand(sector, dx, dy)) continue;
+
+      // Degrees clockwise from the top, y growing downward
+      double angle = atan2((double)dx, (double)-dy) * 180 / M_PI;
+      bool expected = fmod(angle - start + 720, 360) < sweep;
+      if (expected != insideSector(sector, dx, dy) &&
+          edgeDistance(sector.start, dx, dy) >= 1 && edgeDistance(end, dx, dy) >= 1) {
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+static bool checkShapes(MKRIoTCarrier& carrier, RadialDisplay& display) {
+  struct Shape {
+    const char* name;
+    int inner, outer;
+  };
+  static const Shape SHAPES[] = {
+    {"pie", 0, 40},
+    {"band", 60, 79},
+    {"wide band", 25, 115},
+    {"thin ring", 100, 100},
+    {"thin ring at the edge", 119, 119},
+    {"2-pixel ring", 30, 31},
+    {"1-pixel disc", 0, 0},
+  };
+  static const float SWEEPS[] = {0.5f, 2, 10, 90, 179.5f, 180, 180.5f, 270, 350, 359.5f, 360};
+  static uint16_t spans[PIXELS];
+  bool ok = true;
+  printf("%-24s %8s %10s %10s\n", "Spans vs per-pixel", "sectors", "pixels", "mismatched");
+
+  for (const Shape& shape : SHAPES) {
+    int sectors = 0, mismatched = 0, geometry = 0;
+    uint32_t pixels = 0;
+
+    // Start angles all the way round, the axes included, where pixels lie
+    // exactly on an edge; the sweeps from the later ones wrap past 0 degrees
+    for (float start = 0; start < 360; start += 3.75f) {
+      for (float sweep : SWEEPS) {
+        Sector sector = makeSector(shape.inner, shape.outer, start, sweep);
+        carrier.display.fillScreen(0);
+        fillSpans(display, sector, INK);
+        memcpy(spans, carrier.display.getFramebuffer(), sizeof(spans));
+        carrier.display.fillScreen(0);
+        fillPerPixel(carrier.display, sector, INK);
+
+        const uint16_t* expected = carrier.display.getFramebuffer();
+        int wrong = 0;
+        for (int i = 0; i < PIXELS; i++) {
+          wrong += spans[i] != expected[i];
+          pixels += expected[i] != 0;
+        }
+        if (wrong && mismatched == 0) {
+          printf("  %s, %.1f degrees from %.2f: %d pixels differ\n", shape.name, sweep, start, wrong);
+        }
+        mismatched += wrong;
+        geometry += geometryErrors(sector);
+        sectors++;
+      }
+    }
+
+    printf("%-24s %8d %10u %10d%s\n", shape.name, sectors, pixels, mismatched, mismatched ? "  WRONG" : "");
+    if (geometry) printf("  %s: %d pixels on the wrong side of the sweep\n", shape.name, geometry);
+    ok = ok && mismatched == 0 && geometry == 0 && pixels > 0;
+  }
+  return ok;
+}
+
+struct Cost {
+  double hostNs;
+  double busUs;
+  uint32_t windows;
+};
+
+template <typename F> static Cost timeFill(Adafruit_SPITFT& panel, F fill) {
+  panel.resetBusStats();
+  double start = nowSeconds();
+  for (int i = 0; i < TIMING_ITERATIONS; i++) fill();
+  Cost cost;
+  cost.hostNs = (nowSeconds() - start) * 1e9 / TIMING_ITERATIONS;
+  cost.busUs = panel.getBusStats().busNanos / 1e3 / TIMING_ITERATIONS;
+  cost.windows = panel.getBusStats().addrWindows / TIMING_ITERATIONS;
+  return cost;
+}
+
+static void timeShapes(MKRIoTCarrier& carrier, RadialDisplay& display) {
+  struct Case {
+    const char* name;
+    int inner, outer;
+    float start, sweep;
+  };
+  static const Case CASES[] = {
+    {"ring background", 100, 119, 0, 360},
+    {"quarter arc", 90, 97, 300, 90},
+    {"thin ring", 110, 110, 0, 360},
+    {"sparkline bar", 104, 115, 40, 12},
+    {"pie, 300 degrees", 0, 60, 200, 300},
+  };
+
+  printf("\n%-18s %7s %9s %9s %7s %9s %9s %12s\n", "Per fill", "pixels", "spans ns", "pixel ns", "speedup",
+         "spans us", "pixel us", "windows");
+  for (const Case& c : CASES) {
+    Sector sector = makeSector(c.inner, c.outer, c.start, c.sweep);
+    carrier.display.fillScreen(0);
+    fillPerPixel(carrier.display, sector, INK);
+    uint32_t pixels = 0;
+    for (int i = 0; i < PIXELS; i++) pixels += carrier.display.getFramebuffer()[i] != 0;
+
+    Cost spans = timeFill(carrier.display, [&]() { fillSpans(display, sector, INK); });
+    Cost perPixel = timeFill(carrier.display, [&]() { fillPerPixel(carrier.display, sector, INK); });
+    char windows[24];
+    snprintf(windows, sizeof(windows), "%u / %u", spans.windows, perPixel.windows);
+    printf("%-18s %7u %9.0f %9.0f %6.1fx %9.0f %9.0f %12s\n", c.name, pixels, spans.hostNs, perPixel.hostNs,
+           perPixel.hostNs / spans.hostNs, spans.busUs, perPixel.busUs, windows);
+  }
+}
+
+int main() {
+  static MKRIoTCarrier carrier;
+  static RadialDisplay display(&carrier);
+  bool ok = checkShapes(carrier, display);
+  timeShapes(carrier, display);
+  return ok ? 0 : 1;
+}
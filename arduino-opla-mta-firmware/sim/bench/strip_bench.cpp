@@ -0,0 +1,211 @@
+/*
+ * Strip compositor benchmark
+ * Draws the same layers (fills, circles, lines, GFX and atlas text, a
+ * mask) into regions of every shape, a strip's height and one row more,
+ * narrow ones that get taller strips, regions partly off the screen, a
+ * single pixel: once composited strip by strip, once straight to the panel
+ * clipped to the region. Both must leave the same pixels, and compositing
+ * must send each pixel of the region exactly once. Then draws a layered
+ * scene like transit mode's through drawRadialLayout() and ring by ring
+ * straight to the panel, and compares what went over the modelled SPI bus.
+ * Exits non-zero on any failure.
+ */
+
+#include <Arduino.h>
+#include <time.h>
+#include "RadialDisplay.h"
+
+static const int PIXELS = RADIAL_SCREEN_WIDTH * RADIAL_SCREEN_HEIGHT;
+static const uint16_t UNDERNEATH = 0x1234;
+static const int TIMING_ITERATIONS = 50;
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Cost {
+  double hostUs;
+  double busUs;
+  uint32_t transactions;
+  uint32_t windows;
+  uint32_t pixels;
+};
+
+template <typename F> static Cost measure(Adafruit_SPITFT& panel, int iterations, F draw) {
+  panel.resetBusStats();
+  double start = nowSeconds();
+  for (int i = 0; i < iterations; i++) draw();
+  Cost cost;
+  cost.hostUs = (nowSeconds() - start) * 1e6 / iterations;
+  const SimBusStats& bus = panel.getBusStats();
+  cost.busUs = bus.busNanos / 1e3 / iterations;
+  cost.transactions = bus.transactions / iterations;
+  cost.windows = bus.addrWindows / iterations;
+  cost.pixels = bus.pixels / iterations;
+  return cost;
+}
+
+// Layers overlapping all over the screen, background first
+static void drawLayers(StripCompositor& target) {
+  static const uint8_t MASK[] = {0x3C, 0x00, 0x7E, 0x80, 0xFF, 0xC0, 0xE7, 0x40, 0xFF, 0xC0, 0x7E, 0x80, 0x3C, 0x00};
+  target.fillRect(0, 0, RADIAL_SCREEN_WIDTH, RADIAL_SCREEN_HEIGHT, 0x8410);
+  target.fillCircle(120, 120, 100, 0x07E0);
+  target.drawCircle(120, 120, 104, ST77XX_WHITE);
+  target.fillCircle(120, 30, 25, ST77XX_BLUE);
+  target.fillTriangle(10, 200, 230, 180, 120, 239, ST77XX_RED);
+  target.drawLine(0, 0, 239, 239, ST77XX_BLACK);
+  target.drawLine(239, 3, 2, 236, ST77XX_YELLOW);
+  target.setTextSize(3);
+  target.setTextColor(ST77XX_BLACK);
+  target.setCursor(60, 110);
+  target.print("16m");
+  drawGlyphText(target, 40, 60, "Union Sq - 14 St", 1, ST77XX_WHITE);
+  for (int x = 0; x < RADIAL_SCREEN_WIDTH; x += 23) {
+    target.drawMask(x, x * 7 % 230, MASK, 10, 7, 2, ST77XX_MAGENTA);
+  }
+}
+
+static bool checkRegions(MKRIoTCarrier& carrier, StripCompositor& target) {
+  struct Region {
+    const char* name;
+    int16_t x, y, w, h;
+  };
+  static const Region REGIONS[] = {
+    {"whole screen", 0, 0, 240, 240},
+    {"one strip", 0, 100, 240, 16},
+    {"a strip and a row", 0, 100, 240, 17},
+    {"narrow column", 100, 0, 16, 240},
+    {"odd rectangle", 101, 7, 37, 53},
+    {"countdown circle", 18, 98, 43, 43},
+    {"off the top left", -10, -20, 60, 70},
+    {"off the bottom right", 200, 210, 80, 80},
+    {"one pixel", 120, 120, 1, 1},
+  };
+  static uint16_t direct[PIXELS];
+  bool ok = true;
+
+  printf("%-22s %7s %8s %8s %8s %8s %8s %8s\n", "Region", "strips", "windows", "direct", "pixels", "direct",
+         "bus us", "direct");
+  for (const Region& r : REGIONS) {
+    carrier.display.fillScreen(UNDERNEATH);
+    target.setClip(r.x, r.y, r.w, r.h);
+    Cost straight = measure(carrier.display, 1, [&]() { drawLayers(target); });
+    target.clearClip();
+    memcpy(direct, carrier.display.getFramebuffer(), sizeof(direct));
+
+    carrier.display.fillScreen(UNDERNEATH);
+    uint32_t strips = StripCompositor::getStats().strips;
+    uint32_t sent = StripCompositor::getStats().pixelsSent;
+    Cost composited = measure(carrier.display, 1, [&]() {
+      for (target.beginRegion(r.x, r.y, r.w, r.h); target.nextStrip(); ) drawLayers(target);
+    });
+    strips = StripCompositor::getStats().strips - strips;
+    sent = StripCompositor::getStats().pixelsSent - sent;
+
+    // The region clipped to the screen
+    int area = (min(r.x + r.w, 240) - max((int)r.x, 0)) * (min(r.y + r.h, 240) - max((int)r.y, 0));
+    bool same = memcmp(direct, carrier.display.getFramebuffer(), sizeof(direct)) == 0;
+    bool once = sent == (uint32_t)area && composited.pixels == (uint32_t)area;
+    printf("%-22s %7u %8u %8u %8u %8u %8.0f %8.0f%s\n", r.name, strips, composited.windows, straight.windows,
+           composited.pixels, straight.pixels, composited.busUs, straight.busUs,
+           !same ? "  WRONG" : !once ? "  NOT ONCE" : "");
+    ok = ok && same && once;
+  }
+  return ok;
+}
+
+struct Scene {
+  RadialDisplayConfig config;
+  RadialRing rings[5];
+  RadialElement countdowns[3];
+  RadialElement station[1];
+  RadialElement center[1];
+  RadialElement arcs[4];
+
+  Scene(RadialDisplay& display) {
+    static const char* const TEXTS[] = {"2m", "11m", "16m"};
+    for (int i = 0; i < 3; i++) {
+      countdowns[i] = display.createCircleElement(90 + i * 120, TEXTS[i], ST77XX_WHITE, 20);
+    }
+    rings[0] = display.createCircleRing(90, 20, ST77XX_WHITE, ST77XX_BLACK);
+    rings[0].elementCount = 3;
+    rings[0].elements = countdowns;
+    rings[0].autoSpacing = false;
+    rings[0].textSize = 2;
+
+    station[0] = display.createTextElement(0, "Union Sq - 14 St", ST77XX_BLACK);
+    rings[1] = display.createTextRing(52, 1, ST77XX_BLACK);
+    rings[1].type = RadialRing::RING_TEXT_ARC;
+    rings[1].elementCount = 1;
+    rings[1].elements = station;
+    rings[1].thickness = 16;
+    rings[1].bgColor = 0xC618;
+
+    center[0] = display.createCircleElement(0, "L", ST77XX_BLACK, 30);
+    rings[2] = display.createCenterRing(4, ST77XX_WHITE);
+    rings[2].elementCount = 1;
+    rings[2].elements = center;
+
+    // A band under the countdowns with arcs over it
+    for (int i = 0; i < 4; i++) {
+      arcs[i] = display.createCircleElement(45 + i * 90, "", i % 2 ? ST77XX_RED : ST77XX_BLUE, 60);
+    }
+    rings[3] = display.createTextRing(100, 1, 0);
+    rings[3].type = RadialRing::RING_ARCS;
+    rings[3].thickness = 18;
+    rings[3].bgColor = 0x39E7;
+    rings[3].elementCount = 4;
+    rings[3].elements = arcs;
+    rings[3].autoSpacing = false;
+
+    rings[4] = display.createTextRing(118, 1, 0);
+    rings[4].type = RadialRing::RING_BACKGROUND;
+    rings[4].thickness = 6;
+    rings[4].bgColor = ST77XX_WHITE;
+
+    config = {120, 120, 0x8410, 5, rings, 0};
+  }
+};
+
+static bool compareScene(MKRIoTCarrier& carrier, RadialDisplay& display) {
+  static uint16_t direct[PIXELS];
+  static Scene scene(display);
+
+  // Ring by ring, outermost first, as drawRadialLayout() layers them
+  Cost straight = measure(carrier.display, TIMING_ITERATIONS, [&]() {
+    display.clear(scene.config.backgroundColor);
+    for (int i = scene.config.ringCount - 1; i >= 0; i--) {
+      display.drawRing(scene.config.centerX, scene.config.centerY, scene.rings[i]);
+    }
+  });
+  memcpy(direct, carrier.display.getFramebuffer(), sizeof(direct));
+
+  carrier.display.fillScreen(UNDERNEATH);
+  Cost composited = measure(carrier.display, TIMING_ITERATIONS, [&]() {
+    display.invalidate();
+    display.drawRadialLayout(scene.config);
+  });
+  bool same = memcmp(direct, carrier.display.getFramebuffer(), sizeof(direct)) == 0;
+
+  printf("\n%-22s %12s %8s %8s %9s %9s\n", "Full scene", "transactions", "windows", "pixels", "bus us",
+         "host us");
+  printf("%-22s %12u %8u %8u %9.0f %9.0f\n", "ring by ring", straight.transactions, straight.windows,
+         straight.pixels, straight.busUs, straight.hostUs);
+  printf("%-22s %12u %8u %8u %9.0f %9.0f\n", "composited", composited.transactions, composited.windows,
+         composited.pixels, composited.busUs, composited.hostUs);
+  printf("Same pixels: %s, %.1fx less bus time\n", same ? "ok" : "WRONG", straight.busUs / composited.busUs);
+  return same && composited.pixels == (uint32_t)PIXELS;
+}
+
+int main() {
+  static MKRIoTCarrier carrier;
+  static StripCompositor target(&carrier.display, RADIAL_SCREEN_WIDTH, RADIAL_SCREEN_HEIGHT);
+  static RadialDisplay display(&carrier);
+  target.setTextWrap(false);
+
+  bool ok = checkRegions(carrier, target);
+  ok = compareScene(carrier, display) && ok;
+  return ok ? 0 : 1;
+}
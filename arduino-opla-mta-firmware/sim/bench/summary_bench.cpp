@@ -0,0 +1,217 @@
+/*
+ * Station summary benchmark
+ * Builds proxy responses from 3 to 200 arrivals per direction, encodes
+ * each as a binary station summary with the host encoder, and decodes both
+ * forms with MTAManager from memory. Reports bytes on the wire (plain and
+ * deflated for the 2 KB window), host time per parse and the peak stack
+ * the parse used; on the device the JSON path also holds its ArduinoJson
+ * documents on the stack, which the simulator keeps on the heap. Both
+ * decoders must agree on every kept arrival, and the summary decoder must
+ * reject a corrupted, truncated or misaddressed summary. Exits non-zero if
+ * any check fails.
+ */
+
+#include <Arduino.h>
+#include <StationSummaryEncoder.h>
+#include <stdio.h>
+#include <time.h>
+#include <string>
+#include <zlib.h>
+#include "MTAManager.h"
+
+// Serves a buffer as a Stream, like the body of an HTTP response
+class MemoryStream : public Stream {
+private:
+  const std::string& data;
+  size_t position;
+
+public:
+  MemoryStream(const std::string& source) : data(source), position(0) { setTimeout(10); }
+  int available() override { return data.size() - position; }
+  int read() override { return position < data.size() ? (uint8_t)data[position++] : -1; }
+  int peek() override { return position < data.size() ? (uint8_t)data[position] : -1; }
+  size_t write(uint8_t) override { return 0; }
+};
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Stack use of a call, by painting the stack below the caller first and
+// seeing how much of the paint the call overwrote
+static const size_t PAINT_BYTES = 32 * 1024;
+static const uint8_t PAINT = 0xA5;
+
+__attribute__((noinline)) static void paintStack() {
+  uint8_t area[PAINT_BYTES];
+  memset(area, PAINT, sizeof(area));
+  __asm__ volatile("" : : "r"(area) : "memory");   // Keep the stores
+}
+
+__attribute__((noinline)) static size_t paintUsed() {
+  uint8_t area[PAINT_BYTES];
+  __asm__ volatile("" : "+m"(area));   // Whatever the stack holds now
+  size_t untouched = 0;
+  while (untouched < PAINT_BYTES && area[untouched] == PAINT) untouched++;
+  return PAINT_BYTES - untouched;
+}
+
+static const uint32_t FEED_TIME = 1759276800;
+
+// A proxy response shaped like the simulator fixtures
+static std::string buildResponse(const char* station, int perDirection) {
+  static const char* ROUTES[] = {"4", "5", "6", "6X"};
+  static const char* UPTOWN[] = {"Woodlawn", "Eastchester - Dyre Av", "Pelham Bay Park"};
+  static const char* DOWNTOWN[] = {"Flatbush Av", "Crown Hts - Utica Av", "Brooklyn Bridge - City Hall"};
+  std::string body = std::string("{\n  \"station\": \"") + station + "\",\n  \"name\": \"Union Sq - 14 St\",\n";
+  body += "  \"timestamp\": " + std::to_string(FEED_TIME) + ",\n";
+  for (int d = 0; d < 2; d++) {
+    body += d ? "  \"downtown\": [\n" : "  \"uptown\": [\n";
+    for (int i = 0; i < perDirection; i++) {
+      int seconds = 90 + i * 170 + d * 45 + (i * 37) % 50;
+      char entry[200];
+      snprintf(entry, sizeof(entry),
+               "    {\"route\": \"%s\", \"destination\": \"%s\", \"minutes\": %d, \"arrival\": %u}%s\n",
+               ROUTES[(i + d) % 4], (d ? DOWNTOWN : UPTOWN)[i % 3], (seconds + 30) / 60,
+               (unsigned)(FEED_TIME + seconds), i + 1 < perDirection ? "," : "");
+      body += entry;
+    }
+    body += d ? "  ]\n" : "  ],\n";
+  }
+  return body + "}\n";
+}
+
+static size_t deflatedSize(const std::string& body) {
+  z_stream z = {};
+  deflateInit2(&z, Z_BEST_COMPRESSION, Z_DEFLATED, INFLATE_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&z, body.size()) + 32, '\0');
+  z.next_in = (Bytef*)body.data();
+  z.avail_in = body.size();
+  z.next_out = (Bytef*)&out[0];
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  size_t size = z.total_out;
+  deflateEnd(&z);
+  return size;
+}
+
+struct ParseResult {
+  bool ok;
+  uint32_t serverTime;
+  double microseconds;
+  size_t stackBytes;
+};
+
+template <typename F> static ParseResult measure(const std::string& body, StationData& data, F parse) {
+  ParseResult result;
+  {
+    // Once before measuring, so lazy symbol binding is not counted
+    MemoryStream warmUp(body);
+    parse(warmUp, data, result.serverTime);
+
+    MemoryStream stream(body);
+    paintStack();
+    result.ok = parse(stream, data, result.serverTime);
+    result.stackBytes = paintUsed();
+  }
+
+  int iterations = 0;
+  double start = nowSeconds();
+  double elapsed;
+  do {
+    MemoryStream stream(body);
+    uint32_t serverTime;
+    parse(stream, data, serverTime);
+    iterations++;
+  } while ((elapsed = nowSeconds() - start) < 0.05);
+  result.microseconds = elapsed * 1e6 / iterations;
+  return result;
+}
+
+static bool sameArrivals(const StationData& a, const StationData& b) {
+  const TrainArrival* left[2] = {a.uptown, a.downtown};
+  const TrainArrival* right[2] = {b.uptown, b.downtown};
+  for (int d = 0; d < 2; d++) {
+    for (int i = 0; i < TRAINS_PER_DIRECTION; i++) {
+      const TrainArrival& x = left[d][i];
+      const TrainArrival& y = right[d][i];
+      if (x.isValid != y.isValid) return false;
+      if (x.isValid && (x.route != y.route || x.destination != y.destination || x.arrivalTime != y.arrivalTime ||
+                        x.minutesAway != y.minutesAway)) {
+        return false;
+      }
+    }
+  }
+  return a.hasData && b.hasData;
+}
+
+int main() {
+  static MTAManager mta;
+  static StationData fromJson, fromSummary;
+  const char* station = MTA_CONFIGS[0].stationId;
+  bool allOk = true;
+
+  auto parseJson = [](Stream& body, StationData& data, uint32_t& serverTime) {
+    return mta.parseTrainData(body, data, serverTime);
+  };
+  auto parseSummary = [station](Stream& body, StationData& data, uint32_t& serverTime) {
+    return mta.parseSummary(body, station, data, serverTime);
+  };
+
+  printf("ArduinoJson documents on the device stack while parsing JSON: %u bytes; summary: none\n\n",
+         (unsigned)(MTA_ARRIVAL_JSON_SIZE + MTA_FILTER_JSON_SIZE));
+  printf("%-9s %-7s %8s %9s %10s %11s\n", "arrivals", "format", "bytes", "deflated", "parse us", "host stack");
+
+  static const int PER_DIRECTION[] = {3, 10, 40, 200};
+  for (int count : PER_DIRECTION) {
+    std::string json = buildResponse(station, count);
+    std::string summary, error;
+    if (!encodeStationSummary(json, summary, &error)) {
+      printf("%d per direction: could not encode: %s\n", count, error.c_str());
+      return 1;
+    }
+
+    ParseResult j = measure(json, fromJson, parseJson);
+    ParseResult s = measure(summary, fromSummary, parseSummary);
+    bool ok = j.ok && s.ok && j.serverTime == FEED_TIME && s.serverTime == FEED_TIME &&
+              sameArrivals(fromJson, fromSummary);
+    allOk = allOk && ok;
+
+    char label[16];
+    snprintf(label, sizeof(label), "2 x %d", count);
+    printf("%-9s %-7s %8zu %9zu %10.2f %11zu\n", label, "json", json.size(), deflatedSize(json), j.microseconds,
+           j.stackBytes);
+    printf("%-9s %-7s %8zu %9zu %10.2f %11zu%s\n", "", "summary", summary.size(), deflatedSize(summary),
+           s.microseconds, s.stackBytes, ok ? "" : "  <- decoders disagree");
+  }
+
+  // The CRC is zlib's, and damage anywhere must be caught
+  std::string summary;
+  encodeStationSummary(buildResponse(station, 3), summary);
+  uint32_t expected = stationSummaryRead32((const uint8_t*)summary.data() + STATION_SUMMARY_CRC_OFFSET);
+  std::string covered = summary.substr(0, STATION_SUMMARY_CRC_OFFSET) + summary.substr(STATION_SUMMARY_HEADER_BYTES);
+  bool crcOk = crc32(0, (const Bytef*)covered.data(), covered.size()) == expected;
+
+  bool rejected = true;
+  uint32_t serverTime;
+  for (size_t i = 0; i < summary.size(); i++) {
+    std::string damaged = summary;
+    damaged[i] ^= 0x10;
+    MemoryStream stream(damaged);
+    rejected = rejected && !mta.parseSummary(stream, station, fromSummary, serverTime);
+  }
+  for (size_t length = 0; length < summary.size(); length++) {
+    std::string truncated = summary.substr(0, length);
+    MemoryStream stream(truncated);
+    rejected = rejected && !mta.parseSummary(stream, station, fromSummary, serverTime);
+  }
+  MemoryStream stream(summary);
+  rejected = rejected && !mta.parseSummary(stream, MTA_CONFIGS[1].stationId, fromSummary, serverTime);
+
+  printf("\nCRC matches zlib: %s; damaged, truncated and misaddressed summaries: %s\n", crcOk ? "yes" : "NO",
+         rejected ? "rejected" : "ACCEPTED");
+  allOk = allOk && crcOk && rejected;
+  return allOk ? 0 : 1;
+}
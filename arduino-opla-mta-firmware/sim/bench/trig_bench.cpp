@@ -0,0 +1,113 @@
+/*
+ * Fixed-point vs float trigonometry benchmark
+ * Compares FixedTrig's polarToCartesian() with the float sin()/cos() path
+ * RadialDisplay used before, for pixel accuracy over every radius the
+ * 240x240 display can use, and for time per call on the host. The host has
+ * an FPU, so the speedup on the SAMD21 (soft-float) is far larger than
+ * reported here. Exits non-zero if any position is off by more than a pixel.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include "FixedTrig.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t readCycles() { return __rdtsc(); }
+#else
+static uint64_t readCycles() { return 0; }
+#endif
+
+static const int CENTER = 120;
+static const int MAX_RADIUS = 170;   // Corner of the screen from the center
+static const int ITERATIONS = 2000000;
+
+// The float path RadialDisplay::calculatePosition() used to take
+static void floatPosition(int centerX, int centerY, int radius, float angle, int& x, int& y) {
+  float radians = (angle - 90) * M_PI / 180.0;
+  x = centerX + (radius * cos(radians));
+  y = centerY + (radius * sin(radians));
+}
+
+// Nearest pixel, the reference both paths are judged against
+static void exactPosition(int centerX, int centerY, int radius, double angle, int& x, int& y) {
+  double radians = angle * M_PI / 180.0;
+  x = centerX + (int)lround(radius * sin(radians));
+  y = centerY - (int)lround(radius * cos(radians));
+}
+
+static double nowSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Timing {
+  double nsPerCall;
+  double cyclesPerCall;
+};
+
+template <typename F> static Timing timeCalls(F position) {
+  volatile int sink = 0;
+  double start = nowSeconds();
+  uint64_t cycles = readCycles();
+  for (int i = 0; i < ITERATIONS; i++) {
+    int x, y;
+    position(i % MAX_RADIUS, i, x, y);
+    sink = sink + x + y;
+  }
+  Timing t;
+  t.cyclesPerCall = (double)(readCycles() - cycles) / ITERATIONS;
+  t.nsPerCall = (nowSeconds() - start) * 1e9 / ITERATIONS;
+  return t;
+}
+
+int main() {
+  // Raw sine accuracy over the whole circle
+  double maxSinError = 0;
+  for (uint32_t a = 0; a < 65536; a++) {
+    double exact = sin(a * 2 * M_PI / 65536) * 32768.0;
+    double error = fabs(fixedSin((BinaryAngle)a) - exact);
+    if (error > maxSinError) maxSinError = error;
+  }
+
+  // Position accuracy at every radius, in tenth-degree steps
+  int fixedOff = 0, floatOff = 0, fixedWorst = 0, floatWorst = 0, samples = 0;
+  for (int radius = 0; radius <= MAX_RADIUS; radius++) {
+    for (int tenth = 0; tenth < 3600; tenth++) {
+      float angle = tenth / 10.0f;
+      int ex, ey, fx, fy, gx, gy;
+      exactPosition(CENTER, CENTER, radius, angle, ex, ey);
+      polarToCartesian(CENTER, CENTER, radius, angleFromDegrees(angle), fx, fy);
+      floatPosition(CENTER, CENTER, radius, angle, gx, gy);
+
+      int fixedError = std::max(abs(fx - ex), abs(fy - ey));
+      int floatError = std::max(abs(gx - ex), abs(gy - ey));
+      if (fixedError) fixedOff++;
+      if (floatError) floatOff++;
+      if (fixedError > fixedWorst) fixedWorst = fixedError;
+      if (floatError > floatWorst) floatWorst = floatError;
+      samples++;
+    }
+  }
+
+  Timing fixedTime = timeCalls([](int radius, int i, int& x, int& y) {
+    polarToCartesian(CENTER, CENTER, radius, angleFromDegrees((float)(i % 360)), x, y);
+  });
+  Timing floatTime = timeCalls([](int radius, int i, int& x, int& y) {
+    floatPosition(CENTER, CENTER, radius, (float)(i % 360), x, y);
+  });
+
+  printf("Sine table:     %d entries, %u bytes, max error %.2f Q15 LSB\n",
+         SINE_TABLE_STEPS + 1, (unsigned)sizeof(QuarterSineTable::values), maxSinError);
+  printf("Positions:      %d samples, radius 0..%d, 0.1 degree steps\n", samples, MAX_RADIUS);
+  printf("  fixed-point:  %d off the nearest pixel, worst %d px\n", fixedOff, fixedWorst);
+  printf("  float:        %d off the nearest pixel, worst %d px\n", floatOff, floatWorst);
+  printf("Time per call:  fixed %.1f ns / %.0f cycles, float %.1f ns / %.0f cycles (host FPU)\n",
+         fixedTime.nsPerCall, fixedTime.cyclesPerCall, floatTime.nsPerCall, floatTime.cyclesPerCall);
+
+  return fixedWorst <= 1 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/*
+ * Host simulator stand-in for Adafruit_SPITFT
+ * Draws into an in-memory RGB565 framebuffer and models the SPI bus cost of
+ * every address window, pixel and transaction
+ */
+
+#ifndef ADAFRUIT_SPITFT_H
+#define ADAFRUIT_SPITFT_H
+
+#include <Adafruit_GFX.h>
+
+struct SimBusStats {
+  uint32_t transactions;  // CS-low periods (startWrite/endWrite pairs)
+  uint32_t addrWindows;   // CASET/RASET/RAMWR command sequences
+  uint64_t pixels;        // 16-bit pixels clocked out
+  uint64_t busNanos;      // Modelled time spent on the bus
+};
+
+class Adafruit_SPITFT : public Adafruit_GFX {
+private:
+  uint16_t* framebuffer;
+  int16_t winX0, winY0, winX1, winY1;
+  int16_t winCurX, winCurY;
+  uint8_t writeDepth;
+  SimBusStats stats;
+
+  void chargeBus(uint64_t bits);
+  void pushPixel(uint16_t color);
+
+public:
+  // Bus model: 12 MHz SERCOM SPI, 11 command/data bytes per address window
+  static const uint32_t SPI_CLOCK_HZ = 12000000;
+  static const uint32_t ADDR_WINDOW_BITS = 11 * 8;
+  static const uint32_t TRANSACTION_OVERHEAD_NS = 1500;
+
+  Adafruit_SPITFT(uint16_t w, uint16_t h);
+  ~Adafruit_SPITFT();
+
+  void startWrite() override;
+  void endWrite() override;
+  virtual void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+  void writePixels(uint16_t* colors, uint32_t len, bool block = true, bool bigEndian = false);
+  void writeColor(uint16_t color, uint32_t len);
+  void pushColor(uint16_t color);
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void writePixel(int16_t x, int16_t y, uint16_t color) override;
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) override;
+
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  }
+
+  // Simulator access
+  const uint16_t* getFramebuffer() const { return framebuffer; }
+  uint16_t getPixel(int16_t x, int16_t y) const;
+  const SimBusStats& getBusStats() const { return stats; }
+  void resetBusStats();
+  bool writePPM(const char* path) const;
+};
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * Host simulator stand-in for Adafruit_ST7789
+ */
+
+#ifndef ADAFRUIT_ST7789_H
+#define ADAFRUIT_ST7789_H
+
+#include <Adafruit_ST77xx.h>
+
+class Adafruit_ST7789 : public Adafruit_ST77xx {
+public:
+  Adafruit_ST7789() : Adafruit_ST77xx(240, 240) {}
+  void init(uint16_t width, uint16_t height) { (void)width; (void)height; }
+};
+
+#endif
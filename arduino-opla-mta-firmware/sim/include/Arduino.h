@@ -0,0 +1,115 @@
+/*
+ * Host simulator stand-in for the Arduino core
+ * Provides the subset of the SAMD Arduino API used by the firmware,
+ * driven by the simulator's virtual clock
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+using std::abs;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+
+template <class T, class L> auto min(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+
+template <class T, class L> auto max(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+
+template <typename T> constexpr T constrain(T v, T lo, T hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Time. millis()/micros() wrap at 32 bits like the SAMD core, but note that
+// unsigned long is 64 bits on the host, so rollover-sensitive code must do
+// its arithmetic in uint32_t.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// CMSIS wait-for-interrupt, as the SAMD core provides it
+void __WFI();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+long random(long maxValue);
+long random(long minValue, long maxValue);
+void randomSeed(unsigned long seed);
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+
+class SimSerial : public Stream {
+private:
+  // Bytes sent to the board, from the scenario's serial command
+  char input[64];
+  size_t inputStart = 0;
+  size_t inputEnd = 0;
+
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  operator bool() { return true; }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  int available() override { return (int)(inputEnd - inputStart); }
+  int read() override { return inputStart < inputEnd ? (uint8_t)input[inputStart++] : -1; }
+  int peek() override { return inputStart < inputEnd ? (uint8_t)input[inputStart] : -1; }
+  void flush() override;
+
+  // Queues bytes for the sketch to read; what does not fit is dropped
+  void simReceive(const char* text);
+};
+
+extern SimSerial Serial;
+
+#endif
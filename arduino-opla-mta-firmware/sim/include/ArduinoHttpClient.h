@@ -0,0 +1,107 @@
+/*
+ * Host simulator stand-in for ArduinoHttpClient
+ * Implements the HttpClient request/response API over any Client, with the
+ * same blocking waits as the real library (on the virtual clock)
+ */
+
+#ifndef ARDUINOHTTPCLIENT_H
+#define ARDUINOHTTPCLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+static const int HTTP_SUCCESS = 0;
+static const int HTTP_ERROR_CONNECTION_FAILED = -1;
+static const int HTTP_ERROR_API = -2;
+static const int HTTP_ERROR_TIMED_OUT = -3;
+static const int HTTP_ERROR_INVALID_RESPONSE = -4;
+
+#define HTTP_METHOD_GET "GET"
+#define HTTP_METHOD_POST "POST"
+
+class HttpClient : public Client {
+private:
+  enum State {
+    eIdle,
+    eRequestStarted,
+    eRequestSent,
+    eReadingStatusCode,
+    eStatusCodeRead,
+    eReadingHeaders,
+    eSkipToEndOfHeader,
+    eLineStartingCRFound,
+    eReadingBody
+  };
+
+  Client* iClient;
+  String iServerName;
+  uint16_t iServerPort;
+  State iState;
+  int iStatusCode;
+  long iContentLength;
+  long iBodyLengthConsumed;
+  bool iConnectionClose;
+  bool iSendDefaultRequestHeaders;
+  uint32_t iHttpResponseTimeout;
+  uint32_t iHttpWaitForDataDelay;
+  String iHeaderLine;
+
+  void resetState();
+  int sendInitialHeaders(const char* aURLPath, const char* aHttpMethod);
+  void finishHeaders();
+  bool readHeaderLine(String& line);
+
+public:
+  HttpClient(Client& aClient, const char* aServerName, uint16_t aServerPort = 80);
+  HttpClient(Client& aClient, const String& aServerName, uint16_t aServerPort = 80);
+
+  void beginRequest();
+  void endRequest();
+  void beginBody();
+
+  int get(const char* aURLPath) { return startRequest(aURLPath, HTTP_METHOD_GET); }
+  int get(const String& aURLPath) { return get(aURLPath.c_str()); }
+  int startRequest(const char* aURLPath, const char* aHttpMethod);
+
+  void sendHeader(const char* aHeader);
+  void sendHeader(const String& aHeader) { sendHeader(aHeader.c_str()); }
+  void sendHeader(const char* aHeaderName, const char* aHeaderValue);
+  void sendHeader(const String& aHeaderName, const String& aHeaderValue) {
+    sendHeader(aHeaderName.c_str(), aHeaderValue.c_str());
+  }
+  void sendHeader(const char* aHeaderName, const int aHeaderValue);
+
+  void connectionKeepAlive() { iConnectionClose = false; }
+  void noDefaultRequestHeaders() { iSendDefaultRequestHeaders = false; }
+
+  int responseStatusCode();
+  bool headerAvailable();
+  String readHeaderName();
+  String readHeaderValue();
+  int skipResponseHeaders();
+  bool endOfHeadersReached() { return iState == eReadingBody; }
+  bool endOfBodyReached();
+  bool completed() { return endOfBodyReached(); }
+  long contentLength() { return iContentLength; }
+  String responseBody();
+
+  void setHttpResponseTimeout(uint32_t timeout) { iHttpResponseTimeout = timeout; }
+  void setHttpWaitForDataDelay(uint32_t delay) { iHttpWaitForDataDelay = delay; }
+
+  // Client interface, forwarding to the wrapped client
+  size_t write(uint8_t b) override { return iClient->write(b); }
+  size_t write(const uint8_t* buf, size_t size) override { return iClient->write(buf, size); }
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override { return iClient->peek(); }
+  void flush() override { iClient->flush(); }
+  int connect(IPAddress ip, uint16_t port) override { return iClient->connect(ip, port); }
+  int connect(const char* host, uint16_t port) override { return iClient->connect(host, port); }
+  void stop() override;
+  uint8_t connected() override { return iClient->connected(); }
+  operator bool() override { return bool(*iClient); }
+};
+
+#endif
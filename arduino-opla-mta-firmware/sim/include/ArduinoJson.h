@@ -0,0 +1,155 @@
+/*
+ * Host simulator stand-in for the ArduinoJson 6 DOM API
+ * Covers JsonDocument and its Dynamic/Static variants, deserializeJson
+ * from a buffer or a Stream with an optional DeserializationOption::Filter,
+ * and read-only variant access.
+ * Memory use is accounted the way ArduinoJson 6 does (16 bytes per slot
+ * plus copied strings), so an undersized document fails with NoMemory
+ * exactly where the device would.
+ */
+
+#ifndef ARDUINOJSON_H
+#define ARDUINOJSON_H
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+struct JsonNode {
+  enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+  bool boolean = false;
+  double number = 0;
+  std::string text;
+  std::vector<std::shared_ptr<JsonNode>> items;
+  std::vector<std::pair<std::string, std::shared_ptr<JsonNode>>> members;
+};
+
+class JsonArray;
+
+class JsonVariant {
+private:
+  std::shared_ptr<JsonNode> node;
+
+public:
+  JsonVariant() {}
+  JsonVariant(std::shared_ptr<JsonNode> n) : node(n) {}
+
+  bool isNull() const { return !node || node->type == JsonNode::Null; }
+  size_t size() const;
+  JsonVariant operator[](const char* key) const;
+  JsonVariant operator[](size_t index) const;
+  JsonVariant operator[](int index) const { return (*this)[(size_t)index]; }
+  operator JsonArray() const;
+
+  template <typename T> T as() const;
+};
+
+class JsonArray {
+private:
+  std::shared_ptr<JsonNode> node;
+
+public:
+  JsonArray() {}
+  JsonArray(std::shared_ptr<JsonNode> n) : node(n && n->type == JsonNode::Array ? n : nullptr) {}
+
+  bool isNull() const { return !node; }
+  size_t size() const { return node ? node->items.size() : 0; }
+  JsonVariant operator[](size_t index) const {
+    return index < size() ? JsonVariant(node->items[index]) : JsonVariant();
+  }
+  JsonVariant operator[](int index) const { return (*this)[(size_t)index]; }
+};
+
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+  DeserializationError(Code c = Ok) : code(c) {}
+  explicit operator bool() const { return code != Ok; }
+  bool operator==(Code c) const { return code == c; }
+  const char* c_str() const;
+
+private:
+  Code code;
+};
+
+namespace DeserializationOption {
+class Filter;
+}
+
+class JsonDocument {
+private:
+  size_t capacity;
+  size_t used;
+  std::shared_ptr<JsonNode> root;
+
+  friend class DeserializationOption::Filter;
+  friend DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length,
+                                              DeserializationOption::Filter filter);
+
+public:
+  explicit JsonDocument(size_t cap) : capacity(cap), used(0) {}
+  virtual ~JsonDocument() {}
+
+  void clear() { root.reset(); used = 0; }
+  size_t memoryUsage() const { return used; }
+  size_t size() const { return JsonVariant(root).size(); }
+  JsonVariant operator[](const char* key) const { return JsonVariant(root)[key]; }
+  JsonVariant operator[](size_t index) const { return JsonVariant(root)[index]; }
+};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+  explicit DynamicJsonDocument(size_t cap) : JsonDocument(cap) {}
+};
+
+template <size_t N> class StaticJsonDocument : public JsonDocument {
+public:
+  StaticJsonDocument() : JsonDocument(N) {}
+};
+
+namespace DeserializationOption {
+
+// Keeps only the parts of the input that are true in the filter document;
+// everything else is read past without using document memory
+class Filter {
+private:
+  std::shared_ptr<JsonNode> root;
+
+public:
+  Filter();
+  explicit Filter(const JsonDocument& doc) : root(doc.root) {}
+  const JsonNode* node() const { return root.get(); }
+};
+
+}  // namespace DeserializationOption
+
+template <> String JsonVariant::as<String>() const;
+template <> const char* JsonVariant::as<const char*>() const;
+template <> int JsonVariant::as<int>() const;
+template <> long JsonVariant::as<long>() const;
+template <> unsigned long JsonVariant::as<unsigned long>() const;
+template <> float JsonVariant::as<float>() const;
+template <> bool JsonVariant::as<bool>() const;
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length,
+                                     DeserializationOption::Filter filter = DeserializationOption::Filter());
+
+// Reads exactly one value from the stream, like ArduinoJson: objects,
+// arrays and strings end at their closing character, while a bare number
+// or literal also consumes the character that terminates it
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input,
+                                     DeserializationOption::Filter filter = DeserializationOption::Filter());
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter()) {
+  return deserializeJson(doc, input.c_str(), input.length(), filter);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter()) {
+  return deserializeJson(doc, input, strlen(input), filter);
+}
+
+#endif
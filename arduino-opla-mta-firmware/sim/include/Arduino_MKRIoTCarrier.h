@@ -0,0 +1,91 @@
+/*
+ * Host simulator stand-in for the Arduino_MKRIoTCarrier library
+ * Display goes to the simulated framebuffer; sensors and touch pads are
+ * driven by the scenario player through SimHardware
+ */
+
+#ifndef ARDUINO_MKRIOTCARRIER_H
+#define ARDUINO_MKRIOTCARRIER_H
+
+#include <Arduino.h>
+#include <Adafruit_ST7789.h>
+#include "SimHardware.h"
+
+extern bool CARRIER_CASE;
+
+enum touchButtons {
+  TOUCH0 = 0,
+  TOUCH1,
+  TOUCH2,
+  TOUCH3,
+  TOUCH4,
+  TOUCH_ALL
+};
+
+#define CELSIUS 0
+#define FAHRENHEIT 1
+#define KILOPASCAL 0
+#define MILLIBAR 1
+#define PSI 2
+
+class MKRIoTCarrierQtouch {
+private:
+  bool touched[TOUCH_ALL];
+  bool previous[TOUCH_ALL];
+
+public:
+  MKRIoTCarrierQtouch();
+  bool begin() { return true; }
+  bool update();
+  bool getTouch(touchButtons button);
+  bool onTouchDown(touchButtons button);
+  bool onTouchUp(touchButtons button);
+  bool onTouchChange(touchButtons button);
+};
+
+// HTS221 humidity/temperature sensor (one-shot conversions)
+class HTS221Class {
+public:
+  // One-shot conversion time as configured by Arduino_HTS221
+  static const uint32_t CONVERSION_US = 4500;
+
+  float readTemperature(int units = CELSIUS);
+  float readHumidity();
+};
+
+// LPS22HB barometric sensor (one-shot conversions)
+class LPS22HBClass {
+public:
+  static const uint32_t CONVERSION_US = 10000;
+
+  float readPressure(int units = KILOPASCAL);
+  float readTemperature();
+};
+
+// APDS9960 gesture/colour sensor (free-running ALS integration)
+class APDS9960 {
+private:
+  uint64_t lastReadMicros;
+
+public:
+  // ATIME as configured by Arduino_APDS9960: ~103 ms per integration
+  static const uint32_t INTEGRATION_US = 103000;
+
+  APDS9960() : lastReadMicros(0) {}
+  int colorAvailable();
+  bool readColor(int& r, int& g, int& b);
+  bool readColor(int& r, int& g, int& b, int& c);
+};
+
+class MKRIoTCarrier {
+public:
+  Adafruit_ST7789 display;
+  MKRIoTCarrierQtouch Buttons;
+  APDS9960 Light;
+  LPS22HBClass Pressure;
+  HTS221Class Env;
+
+  int begin();
+};
+
+#endif
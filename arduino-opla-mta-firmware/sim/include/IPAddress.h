@@ -0,0 +1,28 @@
+/*
+ * Host simulator stand-in for the Arduino IPAddress class
+ */
+
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+#include "Printable.h"
+
+class IPAddress : public Printable {
+private:
+  uint8_t octets[4];
+
+public:
+  IPAddress() : octets{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+
+  uint8_t operator[](int index) const { return octets[index]; }
+  bool operator==(const IPAddress& rhs) const {
+    return octets[0] == rhs.octets[0] && octets[1] == rhs.octets[1] &&
+           octets[2] == rhs.octets[2] && octets[3] == rhs.octets[3];
+  }
+
+  size_t printTo(Print& p) const override;
+};
+
+#endif
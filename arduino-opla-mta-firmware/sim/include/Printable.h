@@ -0,0 +1,18 @@
+/*
+ * Host simulator stand-in for the Arduino Printable interface
+ */
+
+#ifndef PRINTABLE_H
+#define PRINTABLE_H
+
+#include <stddef.h>
+
+class Print;
+
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Virtual clock for the host simulator
+ * millis()/micros()/delay() run on this clock instead of wall time, so runs
+ * are deterministic and modelled bus/sensor costs show up as elapsed time
+ */
+
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <stdint.h>
+
+class SimClock {
+public:
+  static uint64_t nowMicros();
+  static void advanceMicros(uint64_t us);
+  static void advanceNanos(uint64_t ns);
+
+  // Offsets millis()/micros() so rollover can be exercised quickly
+  static void setStartMillis(uint32_t ms);
+
+  // __WFI(): the only modelled interrupt is the 1 ms SysTick, so waiting
+  // idles the clock to the next millisecond and then runs the hook, which
+  // is where the scenario player changes touch and sensor state
+  static void waitForInterrupt();
+  static void setInterruptHook(void (*hook)());
+  static uint64_t idleMicros();
+};
+
+#endif
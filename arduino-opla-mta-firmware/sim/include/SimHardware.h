@@ -0,0 +1,52 @@
+/*
+ * Scripted hardware state for the host simulator
+ * The scenario player writes sensor values and touch state here; the
+ * MKRIoTCarrier stand-in reads them back and models the I2C cost
+ */
+
+#ifndef SIMHARDWARE_H
+#define SIMHARDWARE_H
+
+#include <stdint.h>
+
+struct SimSensorValues {
+  float temperature;   // °C
+  float humidity;      // %RH
+  float pressure;      // kPa
+  int red, green, blue;
+  int ambient;         // APDS9960 clear channel
+};
+
+// Press to first onTouchDown() report, per press
+struct SimTouchStats {
+  uint32_t presses;
+  uint32_t reported;
+  uint64_t totalLatencyMicros;
+  uint64_t maxLatencyMicros;
+};
+
+struct SimI2CStats {
+  uint32_t transactions;
+  uint32_t bytes;
+  uint64_t busNanos;
+};
+
+class SimHardware {
+public:
+  // I2C bus model: 100 kHz standard mode, address + register byte per transaction
+  static const uint32_t I2C_CLOCK_HZ = 100000;
+
+  static SimSensorValues& sensors();
+  static void setTouch(int pad, bool touched, uint64_t atMicros);
+  static bool isTouched(int pad);
+  static void reportTouchDown(int pad);
+  static const SimTouchStats& getTouchStats();
+
+  static void chargeI2C(uint32_t payloadBytes);
+  static const SimI2CStats& getI2CStats();
+
+  static uint8_t getLEDLevel(uint8_t pin);
+  static void setLEDLevel(uint8_t pin, uint8_t level);
+};
+
+#endif
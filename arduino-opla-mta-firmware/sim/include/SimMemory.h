@@ -0,0 +1,61 @@
+/*
+ * Simulated RAM for the host simulator
+ * The sketch runs on a stack of its own, which MemoryMonitor can paint and
+ * measure like the board's. While it runs, its new/delete are served from
+ * a fixed arena managed the way newlib-nano's malloc manages the board's
+ * heap: first fit from an address-ordered free list, neighbours merged,
+ * and a break that only moves up. Free space and fragmentation therefore
+ * behave like the board's, in host-sized objects.
+ *
+ * Code the sketch calls into that stands in for the world outside the
+ * board (the simulated server, the scenario player) allocates from the
+ * host heap instead, under a HostScope.
+ */
+
+#ifndef SIMMEMORY_H
+#define SIMMEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t SIM_DEFAULT_HEAP_BYTES = 16384;
+const size_t SIM_SKETCH_STACK_BYTES = 256 * 1024;
+
+struct SimHeapStats {
+  size_t arenaBytes;
+  size_t usedBytes;          // In allocated chunks, headers included
+  size_t peakUsedBytes;
+  size_t freeBytes;          // Free chunks plus the arena above the break
+  size_t largestFreeBlock;   // Largest allocation that would succeed now
+  uint32_t blocks;
+  uint32_t overflows;        // Allocations the arena had no room for
+};
+
+class SimMemory {
+public:
+  // Called for each allocation the arena serves or refuses, and each free,
+  // with the bytes asked for (0 for a free)
+  enum AllocationEvent { ALLOCATED, FREED, REFUSED };
+  typedef void (*AllocationHook)(AllocationEvent event, size_t bytes);
+
+  // Arena size; takes effect when the sketch starts
+  static void setHeapBytes(size_t bytes);
+  static SimHeapStats heapStats();
+  static void setAllocationHook(AllocationHook hook);
+
+  // Runs body on the sketch stack with the arena serving new/delete
+  static void runSketch(void (*body)());
+
+  // The sketch stack, or null outside runSketch()
+  static char* stackBottom();
+  static char* stackTop();
+
+  // Allocations in its lifetime come from the host heap
+  class HostScope {
+  public:
+    HostScope();
+    ~HostScope();
+  };
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Fixture-backed network for the host simulator
+ * Each host maps to a directory under the fixture root; HTTP requests are
+ * answered with the file at the request path, with an ETag and
+ * Last-Modified so conditional requests for unchanged files get a 304.
+ * JSON station responses are sent as binary station summaries to clients
+ * that accept them, and bodies are compressed with zlib for clients that
+ * accept it, and chunked when chunking is configured. Idle kept-alive connections are dropped the way a server
+ * would: silently, so the client only finds out when its next request
+ * goes unanswered.
+ * Latency and bandwidth are applied on the virtual clock.
+ * With a server configured, connections go to it over real TCP instead,
+ * for end-to-end runs against the transit proxy; only the connection
+ * setup is then charged to the virtual clock.
+ */
+
+#ifndef SIMNETWORK_H
+#define SIMNETWORK_H
+
+#include <stdint.h>
+#include <string>
+#include <IPAddress.h>
+
+struct SimNetworkStats {
+  uint32_t lookups;         // Host names resolved
+  uint32_t connections;
+  uint32_t requests;
+  uint32_t notModified;     // Answered 304
+  uint64_t bytesSent;
+  uint64_t bytesReceived;
+};
+
+struct SimNetworkConfig {
+  std::string fixtureRoot;
+  uint32_t lookupMs;        // DNS lookup through the NINA co-processor
+  uint32_t connectMs;       // TCP setup through the NINA co-processor
+  uint32_t latencyMs;       // Request to first response byte
+  uint32_t bytesPerMs;      // Downstream throughput
+  bool linkUp;
+  uint32_t keepAliveMs;     // Server's idle timeout for kept connections
+  int deflateWindowBits;    // For Accept-Encoding clients; 0 sends identity
+  bool stationSummaries;    // Encode JSON fixtures for StationSummary clients
+  uint32_t chunkBytes;      // Send bodies chunked, this much a chunk; 0 sends a Content-Length
+  std::string server;       // "HOST:PORT" to connect to instead; empty for fixtures
+};
+
+class SimConnection {
+private:
+  std::string host;
+  std::string request;
+  std::string response;
+  size_t readOffset;
+  uint64_t responseStartMicros;
+  uint64_t responseEndMicros;   // Last byte of the newest response arrives
+  bool closeAfterResponse;
+  bool open;
+  bool live;                    // Connected to a real server
+  int socketFd;                 // Until the server closes it, else -1
+  std::string liveHead;         // Head of the live response being received
+  size_t liveBodyLeft;          // Body bytes of that response still to come
+
+  void handleRequest();
+  void receive(int waitMs);
+  void scanLiveResponses(const char* data, size_t size);
+
+public:
+  SimConnection(const std::string& hostName, int fd = -1);
+  ~SimConnection();
+
+  size_t write(const uint8_t* data, size_t size);
+  int available();
+  int read();
+  int peek();
+  bool isOpen();
+  void close();
+};
+
+class SimNetwork {
+public:
+  static SimNetworkConfig& config();
+  static SimNetworkStats& stats();
+
+  // Gives each host with fixtures, or any host with a configured server,
+  // an address 10.0.0.N that connect() takes back to the host. False when
+  // the link is down or the host has no fixtures.
+  static bool resolve(const char* host, IPAddress& address);
+
+  // Returns nullptr when the link is down, the host has no fixtures or
+  // the configured server refuses the connection. Connecting by name
+  // resolves the host first, as WiFiNINA's connect() does.
+  static SimConnection* connect(const char* host, uint16_t port);
+  static SimConnection* connect(const IPAddress& address, uint16_t port);
+};
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * Host-side encoder for binary station summaries
+ * Turns a proxy JSON response into the StationSummary.h format, the way a
+ * proxy serving it would, with the StationSummaryWriter the proxy uses. Used by
+ * the simulated server for clients that accept it, by the summary-encode
+ * tool and by the benchmarks.
+ */
+
+#ifndef STATIONSUMMARYENCODER_H
+#define STATIONSUMMARYENCODER_H
+
+#include <string>
+
+// Encodes a response with "station", "timestamp" and "uptown"/"downtown"
+// arrival lists. Entries without an "arrival" epoch are placed "minutes"
+// after the timestamp. Returns false, with the reason in error, if the
+// response cannot be represented.
+bool encodeStationSummary(const std::string& json, std::string& summary, std::string* error = nullptr);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Binary station summary writer
+ * Assembles the StationSummary.h format: header, arrival records, the
+ * string table and the CRC. The one place host code writes summaries; the
+ * transit proxy builds them from its feed index, StationSummaryEncoder from
+ * JSON responses.
+ */
+
+#ifndef STATIONSUMMARYWRITER_H
+#define STATIONSUMMARYWRITER_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class StationSummaryWriter {
+private:
+  std::vector<std::string> strings;             // Routes and destinations, in order of first use
+  std::unordered_map<std::string, int> stringIndex;
+  std::string records;
+  uint32_t counts[2];
+
+  int intern(const std::string& text);
+
+public:
+  StationSummaryWriter();
+
+  // Adds an arrival, uptown (0) ones before downtown (1). Strings over 255
+  // bytes are cut short. Limits are checked by finish().
+  void add(int direction, const std::string& route, const std::string& destination, uint32_t arrival);
+
+  // Writes the summary; false, with the reason in error, if the station ID
+  // is too long or there are over 255 arrivals a direction or strings
+  bool finish(const std::string& stationId, uint32_t timestamp, std::string& summary,
+              std::string* error = nullptr) const;
+};
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Host simulator stand-in for the Arduino Stream class
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+  unsigned long timeout;
+  int timedRead();
+  int timedPeek();
+
+public:
+  Stream() : timeout(1000) {}
+
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  unsigned long getTimeout() { return timeout; }
+
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+  size_t readBytesUntil(char terminator, char* buffer, size_t length);
+  String readString();
+  String readStringUntil(char terminator);
+  bool find(const char* target);
+};
+
+#endif
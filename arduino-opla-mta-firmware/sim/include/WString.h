@@ -0,0 +1,94 @@
+/*
+ * Host simulator stand-in for the Arduino String class
+ * Heap-backed like the real one, so allocation behaviour stays comparable
+ */
+
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stdlib.h>
+#include <string>
+
+class String {
+private:
+  std::string buffer;
+
+public:
+  String() {}
+  String(const char* cstr) : buffer(cstr ? cstr : "") {}
+  String(const char* cstr, unsigned int length) : buffer(cstr, length) {}
+  String(const std::string& str) : buffer(str) {}
+  explicit String(char c) : buffer(1, c) {}
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimalPlaces = 2);
+  explicit String(double value, unsigned char decimalPlaces = 2);
+
+  unsigned int length() const { return buffer.length(); }
+  const char* c_str() const { return buffer.c_str(); }
+  bool reserve(unsigned int size) { buffer.reserve(size); return true; }
+
+  String& operator=(const char* cstr) { buffer = cstr ? cstr : ""; return *this; }
+
+  bool concat(const String& str) { buffer += str.buffer; return true; }
+  bool concat(const char* cstr) { if (cstr) buffer += cstr; return true; }
+  bool concat(char c) { buffer += c; return true; }
+  bool concat(int value) { return concat(String(value)); }
+  bool concat(unsigned int value) { return concat(String(value)); }
+  bool concat(long value) { return concat(String(value)); }
+  bool concat(unsigned long value) { return concat(String(value)); }
+  bool concat(float value) { return concat(String(value)); }
+  bool concat(double value) { return concat(String(value)); }
+
+  template <typename T> String& operator+=(const T& rhs) { concat(rhs); return *this; }
+
+  friend String operator+(const String& lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, const char* rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const char* lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, char rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, int rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, unsigned int rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, long rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, unsigned long rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, float rhs) { String s(lhs); s.concat(rhs); return s; }
+  friend String operator+(const String& lhs, double rhs) { String s(lhs); s.concat(rhs); return s; }
+
+  bool equals(const String& str) const { return buffer == str.buffer; }
+  bool equals(const char* cstr) const { return buffer == (cstr ? cstr : ""); }
+  bool equalsIgnoreCase(const String& str) const;
+  bool operator==(const String& rhs) const { return equals(rhs); }
+  bool operator==(const char* rhs) const { return equals(rhs); }
+  bool operator!=(const String& rhs) const { return !equals(rhs); }
+  bool operator!=(const char* rhs) const { return !equals(rhs); }
+  bool operator<(const String& rhs) const { return buffer < rhs.buffer; }
+  int compareTo(const String& str) const { return buffer.compare(str.buffer); }
+  bool startsWith(const String& prefix) const { return buffer.compare(0, prefix.length(), prefix.buffer) == 0; }
+  bool endsWith(const String& suffix) const;
+
+  char charAt(unsigned int index) const { return index < buffer.length() ? buffer[index] : 0; }
+  void setCharAt(unsigned int index, char c) { if (index < buffer.length()) buffer[index] = c; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return buffer[index]; }
+
+  int indexOf(char c, unsigned int fromIndex = 0) const;
+  int indexOf(const String& str, unsigned int fromIndex = 0) const;
+  int lastIndexOf(char c) const;
+  String substring(unsigned int beginIndex) const;
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(const String& find, const String& replacement);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const { return strtol(buffer.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(buffer.c_str(), nullptr); }
+  double toDouble() const { return strtod(buffer.c_str(), nullptr); }
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Host simulator stand-in for the WiFiNINA library
+ * Association is modelled as a blocking begin() on the virtual clock;
+ * host lookups and WiFiClient connections are served by SimNetwork from
+ * local fixtures
+ */
+
+#ifndef WIFININA_H
+#define WIFININA_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+enum wl_status_t {
+  WL_NO_SHIELD = 255,
+  WL_NO_MODULE = WL_NO_SHIELD,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL,
+  WL_SCAN_COMPLETED,
+  WL_CONNECTED,
+  WL_CONNECT_FAILED,
+  WL_CONNECTION_LOST,
+  WL_DISCONNECTED,
+  WL_AP_LISTENING,
+  WL_AP_CONNECTED,
+  WL_AP_FAILED
+};
+
+class SimConnection;
+
+class WiFiClass {
+private:
+  uint8_t currentStatus;
+  String currentSSID;
+
+public:
+  WiFiClass();
+
+  int begin(const char* ssid, const char* passphrase);
+  int disconnect();
+  uint8_t status();
+  const char* SSID() { return currentSSID.c_str(); }
+  IPAddress localIP();
+  int32_t RSSI();
+  unsigned long getTime();
+  int hostByName(const char* host, IPAddress& result);
+  const char* firmwareVersion() { return "1.5.0-sim"; }
+
+  // Simulator hook: drops or restores the access point
+  void simSetLinkUp(bool up);
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient : public Client {
+private:
+  SimConnection* connection;
+
+public:
+  WiFiClient();
+  ~WiFiClient();
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connection != nullptr; }
+};
+
+// TLS is terminated by the NINA co-processor on the device; the simulator
+// serves fixtures for port 443 like any other
+class WiFiSSLClient : public WiFiClient {
+};
+
+#endif
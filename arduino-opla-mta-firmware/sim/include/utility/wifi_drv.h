@@ -0,0 +1,18 @@
+/*
+ * Host simulator stand-in for WiFiNINA's WiFiDrv pin access
+ * The NINA module's RGB LED state is recorded in SimHardware
+ */
+
+#ifndef WIFI_DRV_H
+#define WIFI_DRV_H
+
+#include <stdint.h>
+
+class WiFiDrv {
+public:
+  static void pinMode(uint8_t pin, uint8_t mode);
+  static void digitalWrite(uint8_t pin, uint8_t value);
+  static void analogWrite(uint8_t pin, uint8_t value);
+};
+
+#endif
@@ -0,0 +1,246 @@
+#include <Adafruit_SPITFT.h>
+#include <SimClock.h>
+
+Adafruit_SPITFT::Adafruit_SPITFT(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  framebuffer = (uint16_t*)calloc((size_t)w * h, sizeof(uint16_t));
+  winX0 = winY0 = winX1 = winY1 = 0;
+  winCurX = winCurY = 0;
+  writeDepth = 0;
+  resetBusStats();
+}
+
+Adafruit_SPITFT::~Adafruit_SPITFT() {
+  free(framebuffer);
+}
+
+void Adafruit_SPITFT::resetBusStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void Adafruit_SPITFT::chargeBus(uint64_t bits) {
+  uint64_t ns = bits * 1000000000ULL / SPI_CLOCK_HZ;
+  stats.busNanos += ns;
+  SimClock::advanceNanos(ns);
+}
+
+void Adafruit_SPITFT::startWrite() {
+  if (writeDepth++ == 0) {
+    stats.transactions++;
+    stats.busNanos += TRANSACTION_OVERHEAD_NS;
+    SimClock::advanceNanos(TRANSACTION_OVERHEAD_NS);
+  }
+}
+
+void Adafruit_SPITFT::endWrite() {
+  if (writeDepth > 0) writeDepth--;
+}
+
+void Adafruit_SPITFT::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  winX0 = x;
+  winY0 = y;
+  winX1 = x + w - 1;
+  winY1 = y + h - 1;
+  winCurX = winX0;
+  winCurY = winY0;
+  stats.addrWindows++;
+  chargeBus(ADDR_WINDOW_BITS);
+}
+
+void Adafruit_SPITFT::pushPixel(uint16_t color) {
+  if (winCurX >= 0 && winCurY >= 0 && winCurX < WIDTH && winCurY < HEIGHT) {
+    framebuffer[winCurY * WIDTH + winCurX] = color;
+  }
+  if (++winCurX > winX1) {
+    winCurX = winX0;
+    if (++winCurY > winY1) winCurY = winY0;
+  }
+}
+
+void Adafruit_SPITFT::writePixels(uint16_t* colors, uint32_t len, bool block, bool bigEndian) {
+  (void)block;
+  for (uint32_t i = 0; i < len; i++) {
+    uint16_t c = colors[i];
+    pushPixel(bigEndian ? (uint16_t)((c >> 8) | (c << 8)) : c);
+  }
+  stats.pixels += len;
+  chargeBus((uint64_t)len * 16);
+}
+
+void Adafruit_SPITFT::writeColor(uint16_t color, uint32_t len) {
+  for (uint32_t i = 0; i < len; i++) {
+    pushPixel(color);
+  }
+  stats.pixels += len;
+  chargeBus((uint64_t)len * 16);
+}
+
+void Adafruit_SPITFT::pushColor(uint16_t color) {
+  startWrite();
+  writeColor(color, 1);
+  endWrite();
+}
+
+void Adafruit_SPITFT::writePixel(int16_t x, int16_t y, uint16_t color) {
+  if ((x >= 0) && (x < _width) && (y >= 0) && (y < _height)) {
+    setAddrWindow(x, y, 1, 1);
+    writeColor(color, 1);
+  }
+}
+
+void Adafruit_SPITFT::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if ((x >= 0) && (x < _width) && (y >= 0) && (y < _height)) {
+    startWrite();
+    setAddrWindow(x, y, 1, 1);
+    writeColor(color, 1);
+    endWrite();
+  }
+}
+
+void Adafruit_SPITFT::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  setAddrWindow(x, y, w, h);
+  writeColor(color, (uint32_t)w * h);
+}
+
+void Adafruit_SPITFT::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w && h) {
+    if (w < 0) {
+      x += w + 1;
+      w = -w;
+    }
+    if (x < _width) {
+      if (h < 0) {
+        y += h + 1;
+        h = -h;
+      }
+      if (y < _height) {
+        int16_t x2 = x + w - 1;
+        if (x2 >= 0) {
+          int16_t y2 = y + h - 1;
+          if (y2 >= 0) {
+            if (x < 0) {
+              x = 0;
+              w = x2 + 1;
+            }
+            if (y < 0) {
+              y = 0;
+              h = y2 + 1;
+            }
+            if (x2 >= _width) w = _width - x;
+            if (y2 >= _height) h = _height - y;
+            writeFillRectPreclipped(x, y, w, h, color);
+          }
+        }
+      }
+    }
+  }
+}
+
+void Adafruit_SPITFT::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if ((y >= 0) && (y < _height) && w) {
+    if (w < 0) {
+      x += w + 1;
+      w = -w;
+    }
+    if (x < _width) {
+      int16_t x2 = x + w - 1;
+      if (x2 >= 0) {
+        if (x < 0) {
+          x = 0;
+          w = x2 + 1;
+        }
+        if (x2 >= _width) w = _width - x;
+        writeFillRectPreclipped(x, y, w, 1, color);
+      }
+    }
+  }
+}
+
+void Adafruit_SPITFT::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if ((x >= 0) && (x < _width) && h) {
+    if (h < 0) {
+      y += h + 1;
+      h = -h;
+    }
+    if (y < _height) {
+      int16_t y2 = y + h - 1;
+      if (y2 >= 0) {
+        if (y < 0) {
+          y = 0;
+          h = y2 + 1;
+        }
+        if (y2 >= _height) h = _height - y;
+        writeFillRectPreclipped(x, y, 1, h, color);
+      }
+    }
+  }
+}
+
+void Adafruit_SPITFT::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+void Adafruit_SPITFT::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  startWrite();
+  writeFastHLine(x, y, w, color);
+  endWrite();
+}
+
+void Adafruit_SPITFT::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  startWrite();
+  writeFastVLine(x, y, h, color);
+  endWrite();
+}
+
+void Adafruit_SPITFT::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) {
+  int16_t x2, y2;
+  if ((x >= _width) || (y >= _height) || ((x2 = (x + w - 1)) < 0) || ((y2 = (y + h - 1)) < 0)) {
+    return;
+  }
+
+  int16_t bx1 = 0, by1 = 0, saveW = w;
+  if (x < 0) {
+    w += x;
+    bx1 = -x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    by1 = -y;
+    y = 0;
+  }
+  if (x2 >= _width) w = _width - x;
+  if (y2 >= _height) h = _height - y;
+
+  const uint16_t* pcolors = bitmap + by1 * saveW + bx1;
+  startWrite();
+  setAddrWindow(x, y, w, h);
+  while (h--) {
+    writePixels((uint16_t*)pcolors, w);
+    pcolors += saveW;
+  }
+  endWrite();
+}
+
+uint16_t Adafruit_SPITFT::getPixel(int16_t x, int16_t y) const {
+  if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return 0;
+  return framebuffer[y * WIDTH + x];
+}
+
+bool Adafruit_SPITFT::writePPM(const char* path) const {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+  for (int32_t i = 0; i < (int32_t)WIDTH * HEIGHT; i++) {
+    uint16_t c = framebuffer[i];
+    uint8_t rgb[3] = {
+      (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+      (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+      (uint8_t)((c & 0x1F) * 255 / 31)
+    };
+    fwrite(rgb, 1, 3, f);
+  }
+  fclose(f);
+  return true;
+}
@@ -0,0 +1,373 @@
+#include <Arduino.h>
+#include <SimClock.h>
+#include <ctype.h>
+
+SimSerial Serial;
+
+// Virtual clock
+
+static uint64_t virtualMicros = 0;
+static uint64_t pendingNanos = 0;
+static uint64_t startOffsetMicros = 0;
+static uint64_t idleTotalMicros = 0;
+static void (*interruptHook)() = nullptr;
+
+uint64_t SimClock::nowMicros() {
+  return virtualMicros;
+}
+
+void SimClock::advanceMicros(uint64_t us) {
+  virtualMicros += us;
+}
+
+void SimClock::advanceNanos(uint64_t ns) {
+  pendingNanos += ns;
+  virtualMicros += pendingNanos / 1000;
+  pendingNanos %= 1000;
+}
+
+void SimClock::setStartMillis(uint32_t ms) {
+  startOffsetMicros = (uint64_t)ms * 1000;
+}
+
+void SimClock::waitForInterrupt() {
+  uint64_t now = virtualMicros + startOffsetMicros;
+  uint64_t idle = 1000 - now % 1000;
+  virtualMicros += idle;
+  idleTotalMicros += idle;
+  if (interruptHook) interruptHook();
+}
+
+void SimClock::setInterruptHook(void (*hook)()) {
+  interruptHook = hook;
+}
+
+uint64_t SimClock::idleMicros() {
+  return idleTotalMicros;
+}
+
+void __WFI() {
+  SimClock::waitForInterrupt();
+}
+
+unsigned long millis() {
+  return (uint32_t)((virtualMicros + startOffsetMicros) / 1000);
+}
+
+unsigned long micros() {
+  return (uint32_t)(virtualMicros + startOffsetMicros);
+}
+
+void delay(unsigned long ms) {
+  SimClock::advanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  SimClock::advanceMicros(us);
+}
+
+void yield() {
+}
+
+// GPIO
+
+static uint8_t pinLevels[64];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < sizeof(pinLevels)) pinLevels[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+// Deterministic PRNG so runs are reproducible
+
+static uint32_t randomState = 1;
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) randomState = (uint32_t)seed;
+}
+
+long random(long maxValue) {
+  if (maxValue <= 0) return 0;
+  randomState = randomState * 1103515245u + 12345u;
+  return (long)((randomState >> 1) % (uint32_t)maxValue);
+}
+
+long random(long minValue, long maxValue) {
+  if (minValue >= maxValue) return minValue;
+  return random(maxValue - minValue) + minValue;
+}
+
+// Serial
+
+size_t SimSerial::write(uint8_t c) {
+  fputc(c, stdout);
+  return 1;
+}
+
+size_t SimSerial::write(const uint8_t* buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void SimSerial::flush() {
+  fflush(stdout);
+}
+
+void SimSerial::simReceive(const char* text) {
+  memmove(input, input + inputStart, inputEnd - inputStart);
+  inputEnd -= inputStart;
+  inputStart = 0;
+  while (*text && inputEnd < sizeof(input)) input[inputEnd++] = *text++;
+}
+
+// String
+
+static std::string numberToString(unsigned long value, unsigned char base) {
+  if (base < 2) base = 10;
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  do {
+    unsigned long m = value;
+    value /= base;
+    char c = m - base * value;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (value);
+  return std::string(str);
+}
+
+String::String(unsigned char value, unsigned char base) : buffer(numberToString(value, base)) {}
+String::String(unsigned int value, unsigned char base) : buffer(numberToString(value, base)) {}
+String::String(unsigned long value, unsigned char base) : buffer(numberToString(value, base)) {}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(long value, unsigned char base) {
+  if (value < 0 && base == 10) {
+    buffer = "-" + numberToString((unsigned long)(-value), base);
+  } else {
+    buffer = numberToString((unsigned long)value, base);
+  }
+}
+
+String::String(float value, unsigned char decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned char decimalPlaces) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  buffer = buf;
+}
+
+bool String::equalsIgnoreCase(const String& str) const {
+  if (buffer.length() != str.buffer.length()) return false;
+  for (size_t i = 0; i < buffer.length(); i++) {
+    if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)str.buffer[i])) return false;
+  }
+  return true;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.length() > buffer.length()) return false;
+  return buffer.compare(buffer.length() - suffix.length(), suffix.length(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const {
+  size_t pos = buffer.find(c, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  size_t pos = buffer.find(str.buffer, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t pos = buffer.rfind(c);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, buffer.length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    unsigned int t = beginIndex;
+    beginIndex = endIndex;
+    endIndex = t;
+  }
+  if (beginIndex >= buffer.length()) return String();
+  if (endIndex > buffer.length()) endIndex = buffer.length();
+  return String(buffer.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(const String& find, const String& replacement) {
+  if (find.length() == 0) return;
+  size_t pos = 0;
+  while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+    buffer.replace(pos, find.length(), replacement.buffer);
+    pos += replacement.length();
+  }
+}
+
+void String::remove(unsigned int index) {
+  if (index < buffer.length()) buffer.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < buffer.length()) buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (auto& c : buffer) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (auto& c : buffer) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t begin = buffer.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    buffer.clear();
+    return;
+  }
+  size_t end = buffer.find_last_not_of(" \t\r\n");
+  buffer = buffer.substr(begin, end - begin + 1);
+}
+
+// Print
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++)) n++;
+    else break;
+  }
+  return n;
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 0) return write((uint8_t)n);
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return t + printNumber((unsigned long)(-n), 10);
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  if (base == 0) return write((uint8_t)n);
+  return printNumber(n, base);
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  std::string s = numberToString(n, base);
+  return write(s.c_str(), s.length());
+}
+
+size_t Print::printFloat(double number, uint8_t digits) {
+  if (std::isnan(number)) return print("nan");
+  if (std::isinf(number)) return print("inf");
+  char buf[64];
+  int len = snprintf(buf, sizeof(buf), "%.*f", digits, number);
+  return write(buf, len);
+}
+
+// Stream
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - start < timeout);
+  return -1;
+}
+
+int Stream::timedPeek() {
+  unsigned long start = millis();
+  do {
+    int c = peek();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - start < timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t index = 0;
+  while (index < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) break;
+    *buffer++ = (char)c;
+    index++;
+  }
+  return index;
+}
+
+String Stream::readString() {
+  std::string ret;
+  int c = timedRead();
+  while (c >= 0) {
+    ret += (char)c;
+    c = timedRead();
+  }
+  return String(ret);
+}
+
+String Stream::readStringUntil(char terminator) {
+  std::string ret;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    ret += (char)c;
+    c = timedRead();
+  }
+  return String(ret);
+}
+
+bool Stream::find(const char* target) {
+  size_t len = strlen(target);
+  size_t index = 0;
+  if (len == 0) return true;
+  int c;
+  while ((c = timedRead()) > 0) {
+    if (c == target[index]) {
+      if (++index >= len) return true;
+    } else {
+      index = (c == target[0]) ? 1 : 0;
+    }
+  }
+  return false;
+}
+
+// IPAddress
+
+size_t IPAddress::printTo(Print& p) const {
+  size_t n = 0;
+  for (int i = 0; i < 3; i++) {
+    n += p.print(octets[i], DEC);
+    n += p.print('.');
+  }
+  n += p.print(octets[3], DEC);
+  return n;
+}
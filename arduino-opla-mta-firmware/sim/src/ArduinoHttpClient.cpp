@@ -0,0 +1,254 @@
+#include <ArduinoHttpClient.h>
+
+static const uint32_t DEFAULT_RESPONSE_TIMEOUT = 30000;
+static const uint32_t DEFAULT_WAIT_FOR_DATA_DELAY = 1000;
+
+HttpClient::HttpClient(Client& aClient, const char* aServerName, uint16_t aServerPort)
+  : iClient(&aClient), iServerName(aServerName), iServerPort(aServerPort) {
+  iConnectionClose = true;
+  iSendDefaultRequestHeaders = true;
+  iHttpResponseTimeout = DEFAULT_RESPONSE_TIMEOUT;
+  iHttpWaitForDataDelay = DEFAULT_WAIT_FOR_DATA_DELAY;
+  resetState();
+}
+
+HttpClient::HttpClient(Client& aClient, const String& aServerName, uint16_t aServerPort)
+  : HttpClient(aClient, aServerName.c_str(), aServerPort) {
+}
+
+void HttpClient::resetState() {
+  iState = eIdle;
+  iStatusCode = 0;
+  iContentLength = -1;
+  iBodyLengthConsumed = 0;
+  iHeaderLine = "";
+}
+
+void HttpClient::stop() {
+  iClient->stop();
+  iState = eIdle;
+}
+
+void HttpClient::beginRequest() {
+  iState = eRequestStarted;
+}
+
+int HttpClient::startRequest(const char* aURLPath, const char* aHttpMethod) {
+  bool inBeginRequest = (iState == eRequestStarted);
+  if (!inBeginRequest && iState != eIdle) {
+    return HTTP_ERROR_API;
+  }
+
+  if (iConnectionClose || !iClient->connected()) {
+    if (!iClient->connect(iServerName.c_str(), iServerPort)) {
+      return HTTP_ERROR_CONNECTION_FAILED;
+    }
+  }
+
+  int ret = sendInitialHeaders(aURLPath, aHttpMethod);
+  if (ret == HTTP_SUCCESS && !inBeginRequest) {
+    endRequest();
+  }
+  return ret;
+}
+
+int HttpClient::sendInitialHeaders(const char* aURLPath, const char* aHttpMethod) {
+  iClient->print(aHttpMethod);
+  iClient->print(" ");
+  iClient->print(aURLPath);
+  iClient->println(" HTTP/1.1");
+  if (iSendDefaultRequestHeaders) {
+    iClient->print("Host: ");
+    iClient->print(iServerName);
+    if (iServerPort != 80) {
+      iClient->print(":");
+      iClient->print(iServerPort);
+    }
+    iClient->println();
+    iClient->println("User-Agent: Arduino/2.2.0");
+  }
+  if (iConnectionClose) {
+    iClient->println("Connection: close");
+  }
+  iState = eRequestStarted;
+  return HTTP_SUCCESS;
+}
+
+void HttpClient::sendHeader(const char* aHeader) {
+  iClient->println(aHeader);
+}
+
+void HttpClient::sendHeader(const char* aHeaderName, const char* aHeaderValue) {
+  iClient->print(aHeaderName);
+  iClient->print(": ");
+  iClient->println(aHeaderValue);
+}
+
+void HttpClient::sendHeader(const char* aHeaderName, const int aHeaderValue) {
+  iClient->print(aHeaderName);
+  iClient->print(": ");
+  iClient->println(aHeaderValue);
+}
+
+void HttpClient::finishHeaders() {
+  iClient->println();
+  iState = eRequestSent;
+}
+
+void HttpClient::beginBody() {
+  if (iState < eRequestSent) finishHeaders();
+}
+
+void HttpClient::endRequest() {
+  beginBody();
+}
+
+bool HttpClient::readHeaderLine(String& line) {
+  line = "";
+  unsigned long start = millis();
+  while (millis() - start < iHttpResponseTimeout) {
+    if (iClient->available()) {
+      int c = iClient->read();
+      if (c == '\n') {
+        return true;
+      }
+      if (c != '\r') {
+        line += (char)c;
+      }
+      start = millis();
+    } else if (!iClient->connected()) {
+      return false;
+    } else {
+      delay(iHttpWaitForDataDelay > 0 ? 1 : 0);
+    }
+  }
+  return false;
+}
+
+int HttpClient::responseStatusCode() {
+  if (iState < eRequestSent) {
+    return HTTP_ERROR_API;
+  }
+
+  // Skip any 1xx informational responses, as the real client does
+  do {
+    String line;
+    if (!readHeaderLine(line)) {
+      return HTTP_ERROR_TIMED_OUT;
+    }
+    if (!line.startsWith("HTTP/") || line.length() < 12) {
+      return HTTP_ERROR_INVALID_RESPONSE;
+    }
+    iStatusCode = line.substring(9, 12).toInt();
+    iContentLength = -1;
+    iState = eStatusCodeRead;
+    if (iStatusCode >= 100 && iStatusCode < 200) {
+      while (readHeaderLine(line) && line.length() > 0) {
+      }
+    }
+  } while (iStatusCode >= 100 && iStatusCode < 200);
+
+  iState = eReadingHeaders;
+  return iStatusCode;
+}
+
+bool HttpClient::headerAvailable() {
+  if (iState == eStatusCodeRead || iState == eRequestSent) {
+    responseStatusCode();
+  }
+  if (iState != eReadingHeaders) {
+    return false;
+  }
+  if (!readHeaderLine(iHeaderLine) || iHeaderLine.length() == 0) {
+    iState = eReadingBody;
+    iBodyLengthConsumed = 0;
+    return false;
+  }
+  int colon = iHeaderLine.indexOf(':');
+  if (colon > 0) {
+    String name = iHeaderLine.substring(0, colon);
+    if (name.equalsIgnoreCase("Content-Length")) {
+      String value = iHeaderLine.substring(colon + 1);
+      value.trim();
+      iContentLength = value.toInt();
+    }
+  }
+  return true;
+}
+
+String HttpClient::readHeaderName() {
+  int colon = iHeaderLine.indexOf(':');
+  return colon > 0 ? iHeaderLine.substring(0, colon) : String();
+}
+
+String HttpClient::readHeaderValue() {
+  int colon = iHeaderLine.indexOf(':');
+  if (colon < 0) return String();
+  String value = iHeaderLine.substring(colon + 1);
+  value.trim();
+  return value;
+}
+
+int HttpClient::skipResponseHeaders() {
+  while (headerAvailable()) {
+  }
+  return iState == eReadingBody ? HTTP_SUCCESS : HTTP_ERROR_TIMED_OUT;
+}
+
+bool HttpClient::endOfBodyReached() {
+  if (iState != eReadingBody) return false;
+  if (iContentLength >= 0) return iBodyLengthConsumed >= iContentLength;
+  return !iClient->connected() && !iClient->available();
+}
+
+String HttpClient::responseBody() {
+  int status = skipResponseHeaders();
+  if (status != HTTP_SUCCESS) {
+    return String();
+  }
+
+  std::string body;
+  if (iContentLength > 0) body.reserve(iContentLength);
+
+  unsigned long start = millis();
+  while (!endOfBodyReached() && millis() - start < iHttpResponseTimeout) {
+    int c = read();
+    if (c >= 0) {
+      body += (char)c;
+      start = millis();
+    } else {
+      delay(1);
+    }
+  }
+  return String(body);
+}
+
+int HttpClient::available() {
+  if (iState == eReadingBody && iContentLength >= 0) {
+    int remaining = (int)(iContentLength - iBodyLengthConsumed);
+    int ready = iClient->available();
+    return ready < remaining ? ready : remaining;
+  }
+  return iClient->available();
+}
+
+int HttpClient::read() {
+  if (iState == eReadingBody && iContentLength >= 0 && iBodyLengthConsumed >= iContentLength) {
+    return -1;
+  }
+  int c = iClient->read();
+  if (c >= 0 && iState == eReadingBody) {
+    iBodyLengthConsumed++;
+  }
+  return c;
+}
+
+int HttpClient::read(uint8_t* buf, size_t size) {
+  size_t n = 0;
+  while (n < size) {
+    int c = read();
+    if (c < 0) break;
+    buf[n++] = (uint8_t)c;
+  }
+  return (int)n;
+}
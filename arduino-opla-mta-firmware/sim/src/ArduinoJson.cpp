@@ -0,0 +1,382 @@
+#include <ArduinoJson.h>
+#include <SimMemory.h>
+
+// ArduinoJson 6 on a 32-bit target: one 16-byte slot per value or member,
+// plus a copy of every string when the input is not zero-copy. The slots
+// live in the document's own pool on the board, so the nodes standing in
+// for them come from the host heap, not the sketch's.
+static const size_t SLOT_SIZE = 16;
+
+namespace {
+
+// A filter of true keeps a value whole; an object or array filter keeps
+// only the matching members or elements; anything else drops the value
+bool filterKeepsAll(const JsonNode* filter) {
+  return filter && filter->type == JsonNode::Bool && filter->boolean;
+}
+
+const JsonNode* memberFilter(const JsonNode* filter, const std::string& key) {
+  if (filterKeepsAll(filter)) return filter;
+  if (!filter || filter->type != JsonNode::Object) return nullptr;
+  const JsonNode* wildcard = nullptr;
+  for (auto& member : filter->members) {
+    if (member.first == key) return member.second.get();
+    if (member.first == "*") wildcard = member.second.get();
+  }
+  return wildcard;
+}
+
+const JsonNode* elementFilter(const JsonNode* filter) {
+  if (filterKeepsAll(filter)) return filter;
+  if (!filter || filter->type != JsonNode::Array || filter->items.empty()) return nullptr;
+  return filter->items[0].get();
+}
+
+class Parser {
+private:
+  const char* p;
+  const char* end;
+  size_t& used;
+  size_t capacity;
+  int depth;
+  int skipping;   // Inside a value the filter drops: parse it, store nothing
+
+public:
+  DeserializationError::Code error;
+
+  Parser(const char* input, size_t length, size_t& usedBytes, size_t cap)
+    : p(input), end(input + length), used(usedBytes), capacity(cap), depth(0), skipping(0),
+      error(DeserializationError::Ok) {}
+
+  bool atEnd() {
+    skipSpace();
+    return p >= end;
+  }
+
+  void skipSpace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+  }
+
+  bool allocate(size_t bytes) {
+    if (skipping) return true;
+    if (used + bytes > capacity) {
+      error = DeserializationError::NoMemory;
+      return false;
+    }
+    used += bytes;
+    return true;
+  }
+
+  bool matchLiteral(const char* literal) {
+    size_t len = strlen(literal);
+    if ((size_t)(end - p) < len || strncmp(p, literal, len) != 0) return false;
+    p += len;
+    return true;
+  }
+
+  bool parseString(std::string& out) {
+    p++;  // opening quote
+    while (p < end && *p != '"') {
+      if (*p == '\\' && p + 1 < end) {
+        p++;
+        switch (*p) {
+          case 'n': out += '\n'; break;
+          case 't': out += '\t'; break;
+          case 'r': out += '\r'; break;
+          case 'b': out += '\b'; break;
+          case 'f': out += '\f'; break;
+          case 'u':
+            // Non-ASCII escapes are not needed by the firmware's payloads
+            out += '?';
+            p += 4;
+            break;
+          default: out += *p; break;
+        }
+      } else {
+        out += *p;
+      }
+      p++;
+    }
+    if (p >= end) {
+      error = DeserializationError::IncompleteInput;
+      return false;
+    }
+    p++;  // closing quote
+    return allocate(out.size() + 1);
+  }
+
+  // Parses one value. Returns nullptr on error; sets kept to false when the
+  // filter drops the value, in which case the node is a placeholder.
+  std::shared_ptr<JsonNode> parseValue(const JsonNode* filter, bool& kept) {
+    skipSpace();
+    if (p >= end) {
+      error = DeserializationError::IncompleteInput;
+      return nullptr;
+    }
+
+    kept = filterKeepsAll(filter) ||
+           (*p == '{' && filter && filter->type == JsonNode::Object) ||
+           (*p == '[' && filter && filter->type == JsonNode::Array);
+    if (!kept) {
+      static const JsonNode keepAll = makeKeepAll();
+      bool ignored;
+      skipping++;
+      auto node = parseValue(&keepAll, ignored);
+      skipping--;
+      return node;
+    }
+
+    if (++depth > 10) {
+      error = DeserializationError::TooDeep;
+      return nullptr;
+    }
+    auto node = std::make_shared<JsonNode>();
+    if (!allocate(SLOT_SIZE)) return nullptr;
+
+    if (*p == '{') {
+      node->type = JsonNode::Object;
+      p++;
+      skipSpace();
+      if (p < end && *p == '}') {
+        p++;
+      } else {
+        while (true) {
+          skipSpace();
+          if (p >= end || *p != '"') {
+            error = p >= end ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+            return nullptr;
+          }
+          // Keys are only stored for members the filter keeps
+          std::string key;
+          skipping++;
+          bool keyParsed = parseString(key);
+          skipping--;
+          if (!keyParsed) return nullptr;
+          if (memberFilter(filter, key) && !allocate(key.size() + 1)) return nullptr;
+          skipSpace();
+          if (p >= end || *p != ':') {
+            error = DeserializationError::InvalidInput;
+            return nullptr;
+          }
+          p++;
+          bool valueKept;
+          auto value = parseValue(memberFilter(filter, key), valueKept);
+          if (!value) return nullptr;
+          if (valueKept) node->members.push_back(std::make_pair(key, value));
+          skipSpace();
+          if (p < end && *p == ',') {
+            p++;
+            continue;
+          }
+          if (p < end && *p == '}') {
+            p++;
+            break;
+          }
+          error = p >= end ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+          return nullptr;
+        }
+      }
+    } else if (*p == '[') {
+      node->type = JsonNode::Array;
+      p++;
+      skipSpace();
+      if (p < end && *p == ']') {
+        p++;
+      } else {
+        while (true) {
+          bool valueKept;
+          auto value = parseValue(elementFilter(filter), valueKept);
+          if (!value) return nullptr;
+          if (valueKept) node->items.push_back(value);
+          skipSpace();
+          if (p < end && *p == ',') {
+            p++;
+            continue;
+          }
+          if (p < end && *p == ']') {
+            p++;
+            break;
+          }
+          error = p >= end ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+          return nullptr;
+        }
+      }
+    } else if (*p == '"') {
+      node->type = JsonNode::String;
+      if (!parseString(node->text)) return nullptr;
+    } else if (matchLiteral("true")) {
+      node->type = JsonNode::Bool;
+      node->boolean = true;
+    } else if (matchLiteral("false")) {
+      node->type = JsonNode::Bool;
+    } else if (matchLiteral("null")) {
+      // Null is the default node type
+    } else {
+      char* numberEnd = nullptr;
+      std::string number(p, (end - p) < 32 ? (end - p) : 32);
+      node->number = strtod(number.c_str(), &numberEnd);
+      if (numberEnd == number.c_str()) {
+        error = DeserializationError::InvalidInput;
+        return nullptr;
+      }
+      node->type = JsonNode::Number;
+      p += numberEnd - number.c_str();
+    }
+    depth--;
+    return node;
+  }
+
+  static JsonNode makeKeepAll() {
+    JsonNode node;
+    node.type = JsonNode::Bool;
+    node.boolean = true;
+    return node;
+  }
+};
+
+}  // namespace
+
+DeserializationOption::Filter::Filter() {
+  SimMemory::HostScope offBoard;
+  root = std::make_shared<JsonNode>();
+  root->type = JsonNode::Bool;
+  root->boolean = true;
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length,
+                                     DeserializationOption::Filter filter) {
+  SimMemory::HostScope offBoard;
+  doc.clear();
+  Parser parser(input, length, doc.used, doc.capacity);
+  if (parser.atEnd()) {
+    return DeserializationError::EmptyInput;
+  }
+  bool kept;
+  auto root = parser.parseValue(filter.node(), kept);
+  if (!root) {
+    // A failed parse leaves the document empty, so lookups read as null
+    doc.clear();
+    return parser.error;
+  }
+  if (kept) doc.root = root;
+  return DeserializationError::Ok;
+}
+
+// Reads the text of one JSON value, leaving the stream just past it
+static void readStreamValue(Stream& input, std::string& text) {
+  char c;
+  do {
+    if (input.readBytes(&c, 1) != 1) return;
+  } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+
+  text += c;
+  if (c == '{' || c == '[' || c == '"') {
+    int depth = c == '"' ? 0 : 1;
+    bool inString = c == '"';
+    bool escaped = false;
+    while (input.readBytes(&c, 1) == 1) {
+      text += c;
+      if (inString) {
+        if (escaped) escaped = false;
+        else if (c == '\\') escaped = true;
+        else if (c == '"') inString = false;
+      } else if (c == '"') {
+        inString = true;
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        depth--;
+      }
+      if (depth == 0 && !inString) return;
+    }
+    return;
+  }
+
+  // Numbers and literals end at the first character that is not part of
+  // them, which is consumed too
+  while (input.readBytes(&c, 1) == 1) {
+    if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') return;
+    text += c;
+  }
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input,
+                                     DeserializationOption::Filter filter) {
+  SimMemory::HostScope offBoard;
+  std::string text;
+  readStreamValue(input, text);
+  return deserializeJson(doc, text.c_str(), text.size(), filter);
+}
+
+const char* DeserializationError::c_str() const {
+  switch (code) {
+    case Ok: return "Ok";
+    case EmptyInput: return "EmptyInput";
+    case IncompleteInput: return "IncompleteInput";
+    case InvalidInput: return "InvalidInput";
+    case NoMemory: return "NoMemory";
+    case TooDeep: return "TooDeep";
+  }
+  return "Unknown";
+}
+
+size_t JsonVariant::size() const {
+  if (!node) return 0;
+  if (node->type == JsonNode::Array) return node->items.size();
+  if (node->type == JsonNode::Object) return node->members.size();
+  return 0;
+}
+
+JsonVariant JsonVariant::operator[](const char* key) const {
+  if (!node || node->type != JsonNode::Object) return JsonVariant();
+  for (auto& member : node->members) {
+    if (member.first == key) return JsonVariant(member.second);
+  }
+  return JsonVariant();
+}
+
+JsonVariant JsonVariant::operator[](size_t index) const {
+  if (!node || node->type != JsonNode::Array || index >= node->items.size()) return JsonVariant();
+  return JsonVariant(node->items[index]);
+}
+
+JsonVariant::operator JsonArray() const {
+  return JsonArray(node);
+}
+
+template <> String JsonVariant::as<String>() const {
+  if (!node) return String("null");
+  switch (node->type) {
+    case JsonNode::String: return String(node->text);
+    case JsonNode::Number: return String(node->number, 0);
+    case JsonNode::Bool: return String(node->boolean ? "true" : "false");
+    default: return String("null");
+  }
+}
+
+template <> const char* JsonVariant::as<const char*>() const {
+  return node && node->type == JsonNode::String ? node->text.c_str() : nullptr;
+}
+
+template <> int JsonVariant::as<int>() const {
+  if (!node) return 0;
+  if (node->type == JsonNode::Number) return (int)node->number;
+  if (node->type == JsonNode::Bool) return node->boolean ? 1 : 0;
+  return 0;
+}
+
+template <> long JsonVariant::as<long>() const {
+  return node && node->type == JsonNode::Number ? (long)node->number : 0;
+}
+
+template <> unsigned long JsonVariant::as<unsigned long>() const {
+  return node && node->type == JsonNode::Number ? (unsigned long)node->number : 0;
+}
+
+template <> float JsonVariant::as<float>() const {
+  return node && node->type == JsonNode::Number ? (float)node->number : 0.0f;
+}
+
+template <> bool JsonVariant::as<bool>() const {
+  return node && node->type == JsonNode::Bool && node->boolean;
+}
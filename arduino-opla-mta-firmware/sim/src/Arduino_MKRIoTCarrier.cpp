@@ -0,0 +1,186 @@
+#include <Arduino_MKRIoTCarrier.h>
+#include <SimClock.h>
+#include <utility/wifi_drv.h>
+
+bool CARRIER_CASE = false;
+
+// Scripted hardware state
+
+static SimSensorValues sensorValues = {21.0f, 45.0f, 101.3f, 120, 110, 90, 400};
+static bool touchState[TOUCH_ALL];
+static uint64_t pressMicros[TOUCH_ALL];
+static bool pressReported[TOUCH_ALL];
+static SimTouchStats touchStats;
+static SimI2CStats i2cStats;
+static uint8_t ledLevels[32];
+
+SimSensorValues& SimHardware::sensors() {
+  return sensorValues;
+}
+
+void SimHardware::setTouch(int pad, bool touched, uint64_t atMicros) {
+  if (pad < 0 || pad >= TOUCH_ALL) return;
+  if (touched && !touchState[pad]) {
+    pressMicros[pad] = atMicros;
+    pressReported[pad] = false;
+    touchStats.presses++;
+  }
+  touchState[pad] = touched;
+}
+
+bool SimHardware::isTouched(int pad) {
+  return pad >= 0 && pad < TOUCH_ALL && touchState[pad];
+}
+
+void SimHardware::reportTouchDown(int pad) {
+  if (pressReported[pad]) return;
+  uint64_t latency = SimClock::nowMicros() - pressMicros[pad];
+  pressReported[pad] = true;
+  touchStats.reported++;
+  touchStats.totalLatencyMicros += latency;
+  if (latency > touchStats.maxLatencyMicros) touchStats.maxLatencyMicros = latency;
+}
+
+const SimTouchStats& SimHardware::getTouchStats() {
+  return touchStats;
+}
+
+void SimHardware::chargeI2C(uint32_t payloadBytes) {
+  // START + address + register, repeated START + address, payload, STOP;
+  // 9 clocks per byte including ACK
+  uint32_t bytes = 3 + payloadBytes;
+  uint64_t ns = (uint64_t)bytes * 9 * 1000000000ULL / I2C_CLOCK_HZ;
+  i2cStats.transactions++;
+  i2cStats.bytes += bytes;
+  i2cStats.busNanos += ns;
+  SimClock::advanceNanos(ns);
+}
+
+const SimI2CStats& SimHardware::getI2CStats() {
+  return i2cStats;
+}
+
+uint8_t SimHardware::getLEDLevel(uint8_t pin) {
+  return pin < sizeof(ledLevels) ? ledLevels[pin] : 0;
+}
+
+void SimHardware::setLEDLevel(uint8_t pin, uint8_t level) {
+  if (pin < sizeof(ledLevels)) ledLevels[pin] = level;
+}
+
+// NINA RGB LED
+
+void WiFiDrv::pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void WiFiDrv::digitalWrite(uint8_t pin, uint8_t value) {
+  SimHardware::setLEDLevel(pin, value ? 255 : 0);
+}
+
+void WiFiDrv::analogWrite(uint8_t pin, uint8_t value) {
+  SimHardware::setLEDLevel(pin, value);
+}
+
+// Carrier
+
+int MKRIoTCarrier::begin() {
+  display.init(240, 240);
+  Buttons.begin();
+  return 1;
+}
+
+MKRIoTCarrierQtouch::MKRIoTCarrierQtouch() {
+  for (int i = 0; i < TOUCH_ALL; i++) {
+    touched[i] = false;
+    previous[i] = false;
+  }
+}
+
+bool MKRIoTCarrierQtouch::update() {
+  bool changed = false;
+  for (int i = 0; i < TOUCH_ALL; i++) {
+    previous[i] = touched[i];
+    touched[i] = SimHardware::isTouched(i);
+    changed = changed || (previous[i] != touched[i]);
+  }
+  return changed;
+}
+
+bool MKRIoTCarrierQtouch::getTouch(touchButtons button) {
+  if (button == TOUCH_ALL) {
+    for (int i = 0; i < TOUCH_ALL; i++) {
+      if (touched[i]) return true;
+    }
+    return false;
+  }
+  return touched[button];
+}
+
+bool MKRIoTCarrierQtouch::onTouchDown(touchButtons button) {
+  bool down = button < TOUCH_ALL && touched[button] && !previous[button];
+  if (down) SimHardware::reportTouchDown(button);
+  return down;
+}
+
+bool MKRIoTCarrierQtouch::onTouchUp(touchButtons button) {
+  return button < TOUCH_ALL && !touched[button] && previous[button];
+}
+
+bool MKRIoTCarrierQtouch::onTouchChange(touchButtons button) {
+  return button < TOUCH_ALL && touched[button] != previous[button];
+}
+
+// Sensors
+
+float HTS221Class::readTemperature(int units) {
+  SimHardware::chargeI2C(1);  // Trigger one-shot
+  SimClock::advanceMicros(CONVERSION_US);
+  SimHardware::chargeI2C(2);  // TEMP_OUT_L/H
+  float celsius = SimHardware::sensors().temperature;
+  return units == FAHRENHEIT ? celsius * 9.0f / 5.0f + 32.0f : celsius;
+}
+
+float HTS221Class::readHumidity() {
+  SimHardware::chargeI2C(1);
+  SimClock::advanceMicros(CONVERSION_US);
+  SimHardware::chargeI2C(2);  // HUMIDITY_OUT_L/H
+  return SimHardware::sensors().humidity;
+}
+
+float LPS22HBClass::readPressure(int units) {
+  SimHardware::chargeI2C(1);
+  SimClock::advanceMicros(CONVERSION_US);
+  SimHardware::chargeI2C(3);  // PRESS_OUT_XL/L/H
+  float kpa = SimHardware::sensors().pressure;
+  if (units == MILLIBAR) return kpa * 10.0f;
+  if (units == PSI) return kpa * 0.145038f;
+  return kpa;
+}
+
+float LPS22HBClass::readTemperature() {
+  SimHardware::chargeI2C(2);
+  return SimHardware::sensors().temperature;
+}
+
+int APDS9960::colorAvailable() {
+  SimHardware::chargeI2C(1);  // STATUS register
+  return SimClock::nowMicros() - lastReadMicros >= INTEGRATION_US ? 1 : 0;
+}
+
+bool APDS9960::readColor(int& r, int& g, int& b) {
+  int c;
+  return readColor(r, g, b, c);
+}
+
+bool APDS9960::readColor(int& r, int& g, int& b, int& c) {
+  SimHardware::chargeI2C(8);  // CDATAL..BDATAH
+  const SimSensorValues& values = SimHardware::sensors();
+  r = values.red;
+  g = values.green;
+  b = values.blue;
+  c = values.ambient;
+  lastReadMicros = SimClock::nowMicros();
+  return true;
+}
@@ -0,0 +1,182 @@
+#include <SimMemory.h>
+#include <stdlib.h>
+#include <new>
+#include <ucontext.h>
+
+// Chunks carry their size in a header, as newlib-nano's do; 16 bytes keeps
+// payloads at the alignment operator new promises on the host
+static const size_t CHUNK_HEADER = 16;
+static const size_t MIN_CHUNK = 32;
+
+struct Chunk {
+  size_t size;     // Header included
+  Chunk* next;     // Only while free
+};
+
+static uint8_t* arena = nullptr;
+static size_t arenaBytes = SIM_DEFAULT_HEAP_BYTES;
+static size_t arenaBreak = 0;          // Offset of the first byte never handed out
+static Chunk* freeList = nullptr;      // Address order
+static SimHeapStats heap = {0};
+static SimMemory::AllocationHook allocationHook = nullptr;
+
+static bool sketchRunning = false;
+static int hostDepth = 0;
+static char* sketchStack = nullptr;
+static ucontext_t hostContext, sketchContext;
+static void (*sketchBody)() = nullptr;
+
+static bool inArena(const void* p) {
+  return arena && p >= arena && p < arena + arenaBytes;
+}
+
+static void notify(SimMemory::AllocationEvent event, size_t bytes) {
+  if (allocationHook) allocationHook(event, bytes);
+}
+
+static void* claim(Chunk* chunk) {
+  heap.usedBytes += chunk->size;
+  heap.blocks++;
+  if (heap.usedBytes > heap.peakUsedBytes) heap.peakUsedBytes = heap.usedBytes;
+  return (uint8_t*)chunk + CHUNK_HEADER;
+}
+
+static void* arenaAllocate(size_t bytes) {
+  size_t size = (bytes + CHUNK_HEADER + 15) & ~(size_t)15;
+  if (size < MIN_CHUNK) size = MIN_CHUNK;
+
+  // First fit; a chunk with room to spare gives up its tail
+  for (Chunk** link = &freeList; *link; link = &(*link)->next) {
+    Chunk* chunk = *link;
+    if (chunk->size < size) continue;
+    if (chunk->size - size >= MIN_CHUNK) {
+      chunk->size -= size;
+      Chunk* tail = (Chunk*)((uint8_t*)chunk + chunk->size);
+      tail->size = size;
+      return claim(tail);
+    }
+    *link = chunk->next;
+    return claim(chunk);
+  }
+
+  if (arenaBytes - arenaBreak < size) return nullptr;
+  Chunk* chunk = (Chunk*)(arena + arenaBreak);
+  chunk->size = size;
+  arenaBreak += size;
+  return claim(chunk);
+}
+
+static void arenaFree(void* p) {
+  Chunk* chunk = (Chunk*)((uint8_t*)p - CHUNK_HEADER);
+  heap.usedBytes -= chunk->size;
+  heap.blocks--;
+
+  Chunk* before = nullptr;
+  Chunk* after = freeList;
+  while (after && after < chunk) {
+    before = after;
+    after = after->next;
+  }
+  chunk->next = after;
+  if (after && (uint8_t*)chunk + chunk->size == (uint8_t*)after) {
+    chunk->size += after->size;
+    chunk->next = after->next;
+  }
+  if (before && (uint8_t*)before + before->size == (uint8_t*)chunk) {
+    before->size += chunk->size;
+    before->next = chunk->next;
+  } else if (before) {
+    before->next = chunk;
+  } else {
+    freeList = chunk;
+  }
+}
+
+void SimMemory::setHeapBytes(size_t bytes) {
+  arenaBytes = bytes & ~(size_t)15;
+}
+
+SimHeapStats SimMemory::heapStats() {
+  SimHeapStats stats = heap;
+  stats.arenaBytes = arenaBytes;
+  size_t top = arenaBytes - arenaBreak;
+  stats.freeBytes = top;
+  stats.largestFreeBlock = top > CHUNK_HEADER ? top - CHUNK_HEADER : 0;
+  for (Chunk* chunk = freeList; chunk; chunk = chunk->next) {
+    stats.freeBytes += chunk->size;
+    if (chunk->size - CHUNK_HEADER > stats.largestFreeBlock) stats.largestFreeBlock = chunk->size - CHUNK_HEADER;
+  }
+  return stats;
+}
+
+void SimMemory::setAllocationHook(AllocationHook hook) {
+  allocationHook = hook;
+}
+
+static void sketchEntry() {
+  sketchBody();
+}
+
+void SimMemory::runSketch(void (*body)()) {
+  if (!arena) arena = (uint8_t*)aligned_alloc(16, arenaBytes);
+  if (!sketchStack) sketchStack = (char*)malloc(SIM_SKETCH_STACK_BYTES);
+  sketchBody = body;
+
+  getcontext(&sketchContext);
+  sketchContext.uc_stack.ss_sp = sketchStack;
+  sketchContext.uc_stack.ss_size = SIM_SKETCH_STACK_BYTES;
+  sketchContext.uc_link = &hostContext;
+  makecontext(&sketchContext, sketchEntry, 0);
+
+  sketchRunning = true;
+  swapcontext(&hostContext, &sketchContext);
+  sketchRunning = false;
+}
+
+char* SimMemory::stackBottom() {
+  return sketchStack;
+}
+
+char* SimMemory::stackTop() {
+  return sketchStack ? sketchStack + SIM_SKETCH_STACK_BYTES : nullptr;
+}
+
+SimMemory::HostScope::HostScope() {
+  hostDepth++;
+}
+
+SimMemory::HostScope::~HostScope() {
+  hostDepth--;
+}
+
+// The sketch's new and delete. An allocation the arena has no room for
+// would return null on the board; here it is reported, then served from
+// the host heap so the run can go on.
+void* operator new(size_t bytes) {
+  if (sketchRunning && hostDepth == 0 && arena) {
+    void* p = arenaAllocate(bytes);
+    if (p) {
+      notify(SimMemory::ALLOCATED, bytes);
+      return p;
+    }
+    heap.overflows++;
+    notify(SimMemory::REFUSED, bytes);
+  }
+  void* p = malloc(bytes ? bytes : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  if (inArena(p)) {
+    arenaFree(p);
+    notify(SimMemory::FREED, 0);
+  } else {
+    free(p);
+  }
+}
+
+void* operator new[](size_t bytes) { return operator new(bytes); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
@@ -0,0 +1,446 @@
+#include <SimNetwork.h>
+#include <SimClock.h>
+#include <SimMemory.h>
+#include <StationSummaryEncoder.h>
+#include <WiFiNINA.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <vector>
+#include "StationSummary.h"
+
+static SimNetworkConfig networkConfig = {"sim/fixtures", 40, 120, 80, 50, true, 5000, 11, true, 0, ""};
+static SimNetworkStats networkStats;
+
+SimNetworkConfig& SimNetwork::config() {
+  return networkConfig;
+}
+
+SimNetworkStats& SimNetwork::stats() {
+  return networkStats;
+}
+
+static bool isDirectory(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool readFile(const std::string& path, std::string& contents, time_t& modified) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+  modified = st.st_mtime;
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  contents.resize(st.st_size);
+  size_t n = fread(&contents[0], 1, contents.size(), f);
+  fclose(f);
+  contents.resize(n);
+  return true;
+}
+
+static std::string contentTypeFor(const std::string& path) {
+  if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) return "application/json";
+  return "application/octet-stream";
+}
+
+// Strong ETag from the body's FNV-1a hash
+static std::string etagFor(const std::string& body) {
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : body) hash = (hash ^ c) * 16777619u;
+  char tag[16];
+  snprintf(tag, sizeof(tag), "\"%08x\"", hash);
+  return tag;
+}
+
+// Body in chunks of chunkBytes, with a chunk extension and a trailer field
+// as a client must be ready for
+static std::string chunk(const std::string& body, size_t chunkBytes) {
+  std::string out;
+  char size[32];
+  for (size_t offset = 0; offset < body.size(); offset += chunkBytes) {
+    size_t length = std::min(chunkBytes, body.size() - offset);
+    snprintf(size, sizeof(size), "%zx%s\r\n", length, offset == 0 ? ";sim=1" : "");
+    out += size;
+    out.append(body, offset, length);
+    out += "\r\n";
+  }
+  return out + "0\r\nX-Sim-Trailer: 1\r\n\r\n";
+}
+
+static std::string httpDate(time_t t) {
+  char text[32];
+  struct tm parts;
+  gmtime_r(&t, &parts);
+  strftime(text, sizeof(text), "%a, %d %b %Y %H:%M:%S GMT", &parts);
+  return text;
+}
+
+// Value of a header, given the lowercased name; empty if absent
+static std::string requestHeader(const std::string& head, const std::string& lowerHead, const std::string& name) {
+  size_t start = lowerHead.find("\r\n" + name + ":");
+  if (start == std::string::npos) return "";
+  start += name.size() + 3;
+  size_t end = head.find("\r\n", start);
+  std::string value = head.substr(start, end == std::string::npos ? std::string::npos : end - start);
+  size_t first = value.find_first_not_of(" \t");
+  return first == std::string::npos ? "" : value.substr(first);
+}
+
+// zlib or gzip stream compressed for a window of 2^windowBits bytes
+static bool compress(const std::string& in, std::string& out, int windowBits, bool gzip) {
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits + (gzip ? 16 : 0), 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  out.resize(deflateBound(&stream, in.size()) + 32);
+  stream.next_in = (Bytef*)in.data();
+  stream.avail_in = in.size();
+  stream.next_out = (Bytef*)&out[0];
+  stream.avail_out = out.size();
+  bool ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return ok;
+}
+
+// Blocking TCP connection to "HOST:PORT", -1 if it cannot be made
+static int connectServer(const std::string& server) {
+  size_t colon = server.rfind(':');
+  if (colon == std::string::npos) return -1;
+  std::string hostName = server.substr(0, colon);
+  std::string port = server.substr(colon + 1);
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* addresses;
+  if (getaddrinfo(hostName.c_str(), port.c_str(), &hints, &addresses) != 0) return -1;
+  int fd = -1;
+  for (struct addrinfo* a = addresses; a && fd < 0; a = a->ai_next) {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+
+  if (fd >= 0) {
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  }
+  return fd;
+}
+
+// The server side of a connection lives off the board, so its buffers come
+// from the host heap, not the sketch's
+// Hosts in the order they were first resolved; the Nth has address 10.0.0.N
+static std::vector<std::string> resolvedHosts;
+
+bool SimNetwork::resolve(const char* host, IPAddress& address) {
+  SimMemory::HostScope offBoard;
+  if (!networkConfig.linkUp || WiFi.status() != WL_CONNECTED) return false;
+
+  // WiFi.hostByName() blocks until the co-processor has the answer
+  SimClock::advanceMicros((uint64_t)networkConfig.lookupMs * 1000);
+  if (networkConfig.server.empty() && !isDirectory(networkConfig.fixtureRoot + "/" + host)) return false;
+  size_t index = std::find(resolvedHosts.begin(), resolvedHosts.end(), host) - resolvedHosts.begin();
+  if (index == resolvedHosts.size()) {
+    if (index >= 254) return false;
+    resolvedHosts.push_back(host);
+  }
+  address = IPAddress(10, 0, 0, (uint8_t)(index + 1));
+  networkStats.lookups++;
+  return true;
+}
+
+SimConnection* SimNetwork::connect(const char* host, uint16_t port) {
+  IPAddress address;
+  if (!resolve(host, address)) return nullptr;
+  return connect(address, port);
+}
+
+SimConnection* SimNetwork::connect(const IPAddress& address, uint16_t port) {
+  (void)port;
+  SimMemory::HostScope offBoard;
+  if (!networkConfig.linkUp || WiFi.status() != WL_CONNECTED) return nullptr;
+
+  // WiFiNINA's connect() blocks until the co-processor has the socket up
+  SimClock::advanceMicros((uint64_t)networkConfig.connectMs * 1000);
+  if (address[0] != 10 || address[1] != 0 || address[2] != 0 || address[3] == 0 ||
+      address[3] > resolvedHosts.size()) {
+    return nullptr;
+  }
+  const std::string& host = resolvedHosts[address[3] - 1];
+  if (!networkConfig.server.empty()) {
+    int fd = connectServer(networkConfig.server);
+    if (fd < 0) return nullptr;
+    networkStats.connections++;
+    return new SimConnection(host, fd);
+  }
+
+  networkStats.connections++;
+  return new SimConnection(host);
+}
+
+SimConnection::SimConnection(const std::string& hostName, int fd) : host(hostName) {
+  readOffset = 0;
+  responseStartMicros = 0;
+  responseEndMicros = 0;
+  closeAfterResponse = false;
+  open = true;
+  live = fd >= 0;
+  socketFd = fd;
+  liveBodyLeft = 0;
+}
+
+SimConnection::~SimConnection() {
+  close();
+}
+
+void SimConnection::close() {
+  if (socketFd >= 0) ::close(socketFd);
+  socketFd = -1;
+  open = false;
+}
+
+// Takes whatever the live server has sent, waiting up to waitMs of real
+// time for the first bytes; a closed socket ends the connection
+void SimConnection::receive(int waitMs) {
+  if (socketFd < 0) return;
+  SimMemory::HostScope offBoard;
+  struct pollfd ready = {socketFd, POLLIN, 0};
+  if (poll(&ready, 1, waitMs) <= 0) return;
+
+  if (readOffset >= response.size()) {
+    response.clear();
+    readOffset = 0;
+  }
+  char buffer[4096];
+  ssize_t n;
+  while ((n = recv(socketFd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+    response.append(buffer, n);
+    scanLiveResponses(buffer, n);
+  }
+  if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    ::close(socketFd);
+    socketFd = -1;
+  }
+}
+
+// Follows the live server's responses from head to head, skipping bodies by
+// their Content-Length, to count the 304s as the fixture server does
+void SimConnection::scanLiveResponses(const char* data, size_t size) {
+  while (size > 0) {
+    if (liveBodyLeft > 0) {
+      size_t skip = std::min(liveBodyLeft, size);
+      liveBodyLeft -= skip;
+      data += skip;
+      size -= skip;
+      continue;
+    }
+
+    size_t searchFrom = liveHead.size() < 3 ? 0 : liveHead.size() - 3;
+    liveHead.append(data, size);
+    size_t headEnd = liveHead.find("\r\n\r\n", searchFrom);
+    if (headEnd == std::string::npos) return;
+
+    size_t used = size - (liveHead.size() - (headEnd + 4));
+    std::string lowerHead = liveHead.substr(0, headEnd);
+    for (char& c : lowerHead) c = tolower((unsigned char)c);
+    int status = 0;
+    sscanf(lowerHead.c_str(), "http/%*s %d", &status);
+    if (status == 304) networkStats.notModified++;
+    std::string length = requestHeader(lowerHead, lowerHead, "content-length");
+    liveBodyLeft = status == 304 || length.empty() ? 0 : strtoul(length.c_str(), nullptr, 10);
+
+    liveHead.clear();
+    data += used;
+    size -= used;
+  }
+}
+
+size_t SimConnection::write(const uint8_t* data, size_t size) {
+  if (!open) return 0;
+  SimMemory::HostScope offBoard;
+
+  if (live) {
+    if (socketFd < 0) {
+      open = false;
+      return 0;
+    }
+    request.append((const char*)data, size);
+    size_t headerEnd;
+    while ((headerEnd = request.find("\r\n\r\n")) != std::string::npos) {
+      networkStats.requests++;
+      request.erase(0, headerEnd + 4);
+    }
+    for (size_t sent = 0; sent < size;) {
+      ssize_t n = send(socketFd, data + sent, size - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        close();
+        return sent;
+      }
+      sent += n;
+    }
+    networkStats.bytesSent += size;
+    return size;
+  }
+
+  // The server closed this connection after it sat idle; the request is
+  // lost and the client sees the connection close
+  uint32_t keepAliveMs = SimNetwork::config().keepAliveMs;
+  if (responseEndMicros != 0 && SimClock::nowMicros() > responseEndMicros + (uint64_t)keepAliveMs * 1000) {
+    networkStats.bytesSent += size;
+    open = false;
+    return size;
+  }
+
+  request.append((const char*)data, size);
+  networkStats.bytesSent += size;
+  if (request.find("\r\n\r\n") != std::string::npos) {
+    handleRequest();
+  }
+  return size;
+}
+
+void SimConnection::handleRequest() {
+  size_t headerEnd = request.find("\r\n\r\n");
+  std::string head = request.substr(0, headerEnd);
+  request.erase(0, headerEnd + 4);
+  networkStats.requests++;
+
+  std::string path;
+  size_t methodEnd = head.find(' ');
+  size_t pathEnd = head.find(' ', methodEnd + 1);
+  if (methodEnd != std::string::npos && pathEnd != std::string::npos) {
+    path = head.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+  }
+  size_t query = path.find('?');
+  if (query != std::string::npos) path.erase(query);
+
+  std::string lowerHead = head;
+  for (auto& c : lowerHead) c = tolower((unsigned char)c);
+  closeAfterResponse = lowerHead.find("\r\nconnection: close") != std::string::npos ||
+                       lowerHead.find("http/1.0") != std::string::npos;
+
+  std::string base = SimNetwork::config().fixtureRoot + "/" + host + path;
+  std::string body;
+  std::string filePath = base;
+  time_t modified = 0;
+  bool found = !path.empty() && path.find("..") == std::string::npos &&
+               (readFile(filePath, body, modified) || readFile(filePath = base + ".json", body, modified));
+
+  // Station responses go out as binary summaries to clients that ask
+  std::string contentType = found ? contentTypeFor(filePath) : "application/json";
+  std::string summary;
+  if (found && SimNetwork::config().stationSummaries && contentType == "application/json" &&
+      requestHeader(head, lowerHead, "accept").find(STATION_SUMMARY_CONTENT_TYPE) != std::string::npos &&
+      encodeStationSummary(body, summary)) {
+    body.swap(summary);
+    contentType = STATION_SUMMARY_CONTENT_TYPE;
+  }
+
+  std::string statusLine = found ? "HTTP/1.1 200 OK" : "HTTP/1.1 404 Not Found";
+  std::string validators;
+  if (found) {
+    // If-None-Match takes precedence over If-Modified-Since (RFC 9110)
+    std::string etag = etagFor(body);
+    std::string lastModified = httpDate(modified);
+    std::string ifNoneMatch = requestHeader(head, lowerHead, "if-none-match");
+    std::string ifModifiedSince = requestHeader(head, lowerHead, "if-modified-since");
+    bool unchanged = !ifNoneMatch.empty() ? ifNoneMatch == etag
+                                          : !ifModifiedSince.empty() && ifModifiedSince == lastModified;
+    if (unchanged) {
+      statusLine = "HTTP/1.1 304 Not Modified";
+      body.clear();
+      networkStats.notModified++;
+    }
+    validators = "ETag: " + etag + "\r\nLast-Modified: " + lastModified + "\r\n";
+
+    std::string acceptEncoding = requestHeader(head, lowerHead, "accept-encoding");
+    int windowBits = SimNetwork::config().deflateWindowBits;
+    bool deflate = acceptEncoding.find("deflate") != std::string::npos;
+    bool gzip = acceptEncoding.find("gzip") != std::string::npos;
+    std::string compressed;
+    if (!body.empty() && windowBits > 0 && (deflate || gzip) &&
+        compress(body, compressed, windowBits, !deflate) && compressed.size() < body.size()) {
+      body.swap(compressed);
+      validators += std::string("Content-Encoding: ") + (deflate ? "deflate" : "gzip") + "\r\n";
+    }
+  } else {
+    body = "{\"error\":\"not found\"}";
+  }
+  bool hasBody = statusLine.compare(9, 3, "304") != 0;
+
+  // Only the newest response is paced; anything earlier has fully arrived
+  response.erase(0, readOffset);
+  readOffset = 0;
+  response += statusLine + "\r\n";
+  response += validators;
+  uint32_t chunkBytes = SimNetwork::config().chunkBytes;
+  if (hasBody) {
+    response += "Content-Type: " + contentType + "\r\n";
+    if (chunkBytes > 0) {
+      response += "Transfer-Encoding: chunked\r\n";
+      body = chunk(body, chunkBytes);
+    } else {
+      response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+  }
+  response += std::string("Connection: ") + (closeAfterResponse ? "close" : "keep-alive") + "\r\n\r\n";
+  response += body;
+  responseStartMicros = SimClock::nowMicros();
+  const SimNetworkConfig& cfg = SimNetwork::config();
+  responseEndMicros = responseStartMicros + (uint64_t)cfg.latencyMs * 1000 +
+                      (uint64_t)response.size() * 1000 / cfg.bytesPerMs;
+}
+
+int SimConnection::available() {
+  if (live) {
+    // Bytes arrive in real time, paced by the server alone
+    if (readOffset >= response.size()) receive(1);
+    return response.size() - readOffset;
+  }
+  if (responseStartMicros == 0 && response.empty()) return 0;
+  const SimNetworkConfig& cfg = SimNetwork::config();
+  uint64_t firstByte = responseStartMicros + (uint64_t)cfg.latencyMs * 1000;
+  uint64_t now = SimClock::nowMicros();
+  if (now < firstByte) return 0;
+  uint64_t arrived = (now - firstByte) * cfg.bytesPerMs / 1000 + 1;
+  if (arrived > response.size()) arrived = response.size();
+  return arrived > readOffset ? (int)(arrived - readOffset) : 0;
+}
+
+int SimConnection::read() {
+  if (available() <= 0) return -1;
+  networkStats.bytesReceived++;
+  return (uint8_t)response[readOffset++];
+}
+
+int SimConnection::peek() {
+  if (available() <= 0) return -1;
+  return (uint8_t)response[readOffset];
+}
+
+bool SimConnection::isOpen() {
+  if (!open) return false;
+  if (live) {
+    receive(0);
+    open = socketFd >= 0;
+    return open;
+  }
+  if (closeAfterResponse && readOffset >= response.size() && !response.empty()) {
+    open = false;
+  }
+  return open;
+}
@@ -0,0 +1,80 @@
+#include "SimScenario.h"
+#include <Arduino.h>
+#include <Arduino_MKRIoTCarrier.h>
+#include <WiFiNINA.h>
+#include <SimHardware.h>
+#include <SimNetwork.h>
+#include <algorithm>
+#include <sstream>
+
+extern MKRIoTCarrier carrier;
+
+bool SimScenario::load(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    std::string text(line);
+    size_t comment = text.find('#');
+    if (comment != std::string::npos) text.erase(comment);
+
+    std::istringstream in(text);
+    Event event;
+    if (!(in >> event.timeMs >> event.command)) continue;
+    in >> event.arg1 >> event.arg2;
+    events.push_back(event);
+
+    // A touch is a press followed by a release after the hold time
+    if (event.command == "touch") {
+      Event release = event;
+      release.command = "release";
+      release.timeMs += event.arg2.empty() ? 120 : strtoul(event.arg2.c_str(), nullptr, 10);
+      events.push_back(release);
+    }
+  }
+  fclose(f);
+
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event& a, const Event& b) { return a.timeMs < b.timeMs; });
+  return true;
+}
+
+void SimScenario::apply(uint64_t nowMs) {
+  while (nextEvent < events.size() && events[nextEvent].timeMs <= nowMs) {
+    run(events[nextEvent++]);
+  }
+}
+
+void SimScenario::run(const Event& event) {
+  SimSensorValues& sensors = SimHardware::sensors();
+  float value = atof(event.arg1.c_str());
+
+  if (event.command == "touch") {
+    SimHardware::setTouch(atoi(event.arg1.c_str()), true, event.timeMs * 1000);
+  } else if (event.command == "release") {
+    SimHardware::setTouch(atoi(event.arg1.c_str()), false, event.timeMs * 1000);
+  } else if (event.command == "temp") {
+    sensors.temperature = value;
+  } else if (event.command == "humidity") {
+    sensors.humidity = value;
+  } else if (event.command == "pressure") {
+    sensors.pressure = value;
+  } else if (event.command == "light") {
+    sensors.ambient = (int)value;
+  } else if (event.command == "wifi") {
+    WiFi.simSetLinkUp(event.arg1 != "down");
+  } else if (event.command == "latency") {
+    SimNetwork::config().latencyMs = (uint32_t)value;
+  } else if (event.command == "chunked") {
+    SimNetwork::config().chunkBytes = (uint32_t)value;
+  } else if (event.command == "serial") {
+    Serial.simReceive(event.arg1.c_str());
+  } else if (event.command == "screenshot") {
+    if (!carrier.display.writePPM(event.arg1.c_str())) {
+      fprintf(stderr, "[sim] could not write %s\n", event.arg1.c_str());
+    }
+  } else {
+    fprintf(stderr, "[sim] unknown scenario command '%s'\n", event.command.c_str());
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ * Scripted scenario player for the host simulator
+ *
+ * One event per line: <time_ms> <command> [args], '#' starts a comment.
+ *   touch <pad> [hold_ms]    Press a touch pad (default hold 120 ms)
+ *   temp <celsius>           Set the HTS221 temperature
+ *   humidity <percent>       Set the HTS221 humidity
+ *   pressure <kpa>           Set the LPS22HB pressure
+ *   light <clear>            Set the APDS9960 clear channel
+ *   wifi up|down             Restore or drop the access point
+ *   latency <ms>             Change network latency
+ *   chunked <bytes>          Send bodies chunked, in chunks this size; 0 stops
+ *   serial <text>            Send bytes to the sketch's Serial input
+ *   screenshot <file.ppm>    Dump the framebuffer
+ */
+
+#ifndef SIMSCENARIO_H
+#define SIMSCENARIO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class SimScenario {
+private:
+  struct Event {
+    uint64_t timeMs;
+    std::string command;
+    std::string arg1;
+    std::string arg2;
+  };
+
+  std::vector<Event> events;
+  size_t nextEvent;
+
+  void run(const Event& event);
+
+public:
+  SimScenario() : nextEvent(0) {}
+  bool load(const char* path);
+  void apply(uint64_t nowMs);
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include <StationSummaryEncoder.h>
+#include <StationSummaryWriter.h>
+#include <ArduinoJson.h>
+
+static bool fail(std::string* error, const std::string& reason) {
+  if (error) *error = reason;
+  return false;
+}
+
+bool encodeStationSummary(const std::string& json, std::string& summary, std::string* error) {
+  DynamicJsonDocument doc(json.size() * 16 + 1024);
+  DeserializationError parseError = deserializeJson(doc, json.c_str(), json.size());
+  if (parseError) return fail(error, std::string("JSON: ") + parseError.c_str());
+
+  const char* station = doc["station"].as<const char*>();
+  if (!station || !*station) return fail(error, "no \"station\"");
+  uint32_t timestamp = doc["timestamp"].as<unsigned long>();
+  if (timestamp == 0) return fail(error, "no \"timestamp\"");
+
+  StationSummaryWriter writer;
+  static const char* DIRECTIONS[2] = {"uptown", "downtown"};
+  for (int d = 0; d < 2; d++) {
+    JsonArray arrivals = doc[DIRECTIONS[d]];
+    for (size_t i = 0; i < arrivals.size(); i++) {
+      JsonVariant entry = arrivals[i];
+      const char* route = entry["route"].as<const char*>();
+      const char* destination = entry["destination"].as<const char*>();
+      uint32_t arrival = entry["arrival"].as<unsigned long>();
+      if (arrival == 0) arrival = timestamp + entry["minutes"].as<long>() * 60;
+      writer.add(d, route ? route : "", destination ? destination : "", arrival);
+    }
+  }
+  return writer.finish(station, timestamp, summary, error);
+}
@@ -0,0 +1,69 @@
+#include <StationSummaryWriter.h>
+#include <string.h>
+#include "StationSummary.h"
+
+static bool fail(std::string* error, const std::string& reason) {
+  if (error) *error = reason;
+  return false;
+}
+
+static void put32(std::string& out, uint32_t value) {
+  for (int i = 0; i < 4; i++) out += (char)(value >> (8 * i));
+}
+
+StationSummaryWriter::StationSummaryWriter() {
+  counts[0] = counts[1] = 0;
+}
+
+int StationSummaryWriter::intern(const std::string& text) {
+  std::string key = text.size() > 255 ? text.substr(0, 255) : text;
+  auto found = stringIndex.find(key);
+  if (found != stringIndex.end()) return found->second;
+  strings.push_back(key);
+  return stringIndex[key] = strings.size() - 1;
+}
+
+void StationSummaryWriter::add(int direction, const std::string& route, const std::string& destination,
+                               uint32_t arrival) {
+  counts[direction]++;
+  records += (char)intern(route);
+  records += (char)intern(destination);
+  put32(records, arrival);
+}
+
+bool StationSummaryWriter::finish(const std::string& stationId, uint32_t timestamp, std::string& summary,
+                                  std::string* error) const {
+  if (stationId.empty()) return fail(error, "no station ID");
+  if (stationId.size() > (size_t)STATION_SUMMARY_ID_BYTES) return fail(error, "station ID too long");
+  if (counts[0] > 255) return fail(error, "over 255 uptown arrivals");
+  if (counts[1] > 255) return fail(error, "over 255 downtown arrivals");
+  if (strings.size() > 255) return fail(error, "over 255 distinct strings");
+
+  std::string header(STATION_SUMMARY_HEADER_BYTES, '\0');
+  header[0] = STATION_SUMMARY_MAGIC[0];
+  header[1] = STATION_SUMMARY_MAGIC[1];
+  header[2] = STATION_SUMMARY_VERSION;
+  header.replace(STATION_SUMMARY_ID_OFFSET, stationId.size(), stationId);
+  std::string stamp;
+  put32(stamp, timestamp);
+  header.replace(STATION_SUMMARY_TIMESTAMP_OFFSET, 4, stamp);
+  header[STATION_SUMMARY_COUNTS_OFFSET] = counts[0];
+  header[STATION_SUMMARY_COUNTS_OFFSET + 1] = counts[1];
+  header[STATION_SUMMARY_COUNTS_OFFSET + 2] = strings.size();
+
+  std::string tail = records;
+  for (const std::string& text : strings) {
+    tail += (char)text.size();
+    tail += text;
+  }
+
+  // The CRC covers the header up to itself, then everything after it
+  uint32_t crc = stationSummaryCrc(0, (const uint8_t*)header.data(), STATION_SUMMARY_CRC_OFFSET);
+  crc = stationSummaryCrc(crc, (const uint8_t*)tail.data(), tail.size());
+  std::string crcBytes;
+  put32(crcBytes, crc);
+  header.replace(STATION_SUMMARY_CRC_OFFSET, 4, crcBytes);
+
+  summary = header + tail;
+  return true;
+}
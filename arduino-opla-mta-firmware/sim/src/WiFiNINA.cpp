@@ -0,0 +1,123 @@
+#include <WiFiNINA.h>
+#include <SimClock.h>
+#include <SimNetwork.h>
+
+WiFiClass WiFi;
+
+// Association time through the NINA module, and the epoch the virtual
+// clock starts at (2025-10-01 00:00:00 UTC) for WiFi.getTime()
+static const uint32_t ASSOCIATE_MS = 1800;
+static const unsigned long SIM_EPOCH_BASE = 1759276800UL;
+
+WiFiClass::WiFiClass() {
+  currentStatus = WL_IDLE_STATUS;
+}
+
+int WiFiClass::begin(const char* ssid, const char* passphrase) {
+  (void)passphrase;
+  // Like the real library, begin() blocks until association succeeds or
+  // the 10 s module timeout expires
+  if (!SimNetwork::config().linkUp) {
+    SimClock::advanceMicros(10000ULL * 1000);
+    currentStatus = WL_CONNECT_FAILED;
+    return currentStatus;
+  }
+  SimClock::advanceMicros((uint64_t)ASSOCIATE_MS * 1000);
+  currentSSID = ssid;
+  currentStatus = WL_CONNECTED;
+  return currentStatus;
+}
+
+int WiFiClass::disconnect() {
+  currentStatus = WL_DISCONNECTED;
+  return currentStatus;
+}
+
+uint8_t WiFiClass::status() {
+  return currentStatus;
+}
+
+IPAddress WiFiClass::localIP() {
+  return currentStatus == WL_CONNECTED ? IPAddress(192, 168, 1, 42) : IPAddress();
+}
+
+int32_t WiFiClass::RSSI() {
+  return currentStatus == WL_CONNECTED ? -58 : 0;
+}
+
+unsigned long WiFiClass::getTime() {
+  if (currentStatus != WL_CONNECTED) return 0;
+  return SIM_EPOCH_BASE + (unsigned long)(SimClock::nowMicros() / 1000000ULL);
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+  return SimNetwork::resolve(host, result) ? 1 : 0;
+}
+
+void WiFiClass::simSetLinkUp(bool up) {
+  SimNetwork::config().linkUp = up;
+  if (!up && currentStatus == WL_CONNECTED) {
+    currentStatus = WL_CONNECTION_LOST;
+  }
+}
+
+WiFiClient::WiFiClient() {
+  connection = nullptr;
+}
+
+WiFiClient::~WiFiClient() {
+  delete connection;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  stop();
+  connection = SimNetwork::connect(ip, port);
+  return connection != nullptr ? 1 : 0;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  stop();
+  connection = SimNetwork::connect(host, port);
+  return connection != nullptr ? 1 : 0;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  return connection ? connection->write(buffer, size) : 0;
+}
+
+int WiFiClient::available() {
+  return connection ? connection->available() : 0;
+}
+
+int WiFiClient::read() {
+  return connection ? connection->read() : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (!connection) return -1;
+  int n = 0;
+  while ((size_t)n < size) {
+    int c = connection->read();
+    if (c < 0) break;
+    buffer[n++] = (uint8_t)c;
+  }
+  return n;
+}
+
+int WiFiClient::peek() {
+  return connection ? connection->peek() : -1;
+}
+
+void WiFiClient::stop() {
+  delete connection;
+  connection = nullptr;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!connection) return 0;
+  return (connection->isOpen() || connection->available() > 0) ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+/*
+ * Classic 5x7 GFX font used by the simulated display
+ */
+
+#ifndef GLCDFONT_H
+#define GLCDFONT_H
+
+#include <stdint.h>
+
+// Returns the five column bytes for a character. Only printable ASCII is
+// tabled; everything else renders as a box, like a missing glyph would.
+const uint8_t* glcdGlyph(unsigned char c);
+
+#endif
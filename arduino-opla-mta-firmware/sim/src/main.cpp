@@ -0,0 +1,197 @@
+/*
+ * Host simulator entry point
+ * Runs the sketch's setup()/loop() on the virtual clock, replays a scripted
+ * scenario of touches, sensor changes and network events, and reports bus,
+ * sensor, network and memory cost at the end of the run
+ */
+
+#include <Arduino.h>
+#include <Arduino_MKRIoTCarrier.h>
+#include <WiFiNINA.h>
+#include <SimClock.h>
+#include <SimHardware.h>
+#include <SimNetwork.h>
+#include <SimMemory.h>
+#include "SimScenario.h"
+#include "RadialAnimator.h"
+#include "Profiler.h"
+#include "MemoryMonitor.h"
+#include <algorithm>
+
+void setup();
+void loop();
+
+extern MKRIoTCarrier carrier;
+
+static SimScenario scenario;
+static uint64_t endMicros;
+static uint32_t iterations = 0;
+static uint64_t longestLoopMicros = 0;
+
+// Scenario events land on the 1 ms tick, including while the sketch sleeps
+static void applyScenario() {
+  SimMemory::HostScope host;
+  scenario.apply(SimClock::nowMicros() / 1000);
+}
+
+// On the sketch stack, with the sketch's heap in SimMemory's arena
+static void runSketch() {
+  setup();
+  while (SimClock::nowMicros() < endMicros) {
+    applyScenario();
+    uint64_t loopStart = SimClock::nowMicros();
+    uint64_t idleStart = SimClock::idleMicros();
+    loop();
+    iterations++;
+    uint64_t busy = (SimClock::nowMicros() - loopStart) - (SimClock::idleMicros() - idleStart);
+    longestLoopMicros = std::max(longestLoopMicros, busy);
+  }
+}
+
+// Print that writes to a file, for the profiler record
+class FilePrint : public Print {
+private:
+  FILE* file;
+
+public:
+  FilePrint(FILE* f) : file(f) {}
+  size_t write(uint8_t c) override { return fputc(c, file) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, file); }
+};
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --duration SECONDS     Virtual run time (default 60)\n"
+          "  --scenario FILE        Scripted events to replay\n"
+          "  --fixtures DIR         Fixture root served as HTTP hosts (default sim/fixtures)\n"
+          "  --latency MS           Request to first byte latency (default 80)\n"
+          "  --bandwidth BYTES/MS   Downstream throughput (default 50)\n"
+          "  --keep-alive MS        Server idle timeout for kept connections (default 5000)\n"
+          "  --deflate-window BITS  Window for compressed responses, 0 for none (default 11)\n"
+          "  --chunked BYTES        Send response bodies chunked, in chunks of BYTES\n"
+          "  --json                 Answer station requests with JSON, not binary summaries\n"
+          "  --server HOST:PORT     Send HTTP requests to a real server, such as mta-proxy\n"
+          "  --start-millis MS      Initial millis() value, to exercise rollover\n"
+          "  --heap BYTES           Heap arena the sketch allocates from (default 16384)\n"
+          "  --screenshot FILE      Write the final framebuffer as a PPM image\n"
+          "  --profile FILE         Write the profiler record at the end (see profile-decode)\n"
+          "  --quiet                Suppress the sketch's Serial output\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  double durationSeconds = 60;
+  const char* scenarioPath = nullptr;
+  const char* screenshotPath = nullptr;
+  const char* profilePath = nullptr;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    String arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--duration" && hasValue) {
+      durationSeconds = atof(argv[++i]);
+    } else if (arg == "--scenario" && hasValue) {
+      scenarioPath = argv[++i];
+    } else if (arg == "--fixtures" && hasValue) {
+      SimNetwork::config().fixtureRoot = argv[++i];
+    } else if (arg == "--latency" && hasValue) {
+      SimNetwork::config().latencyMs = atoi(argv[++i]);
+    } else if (arg == "--bandwidth" && hasValue) {
+      SimNetwork::config().bytesPerMs = atoi(argv[++i]);
+    } else if (arg == "--keep-alive" && hasValue) {
+      SimNetwork::config().keepAliveMs = strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--deflate-window" && hasValue) {
+      SimNetwork::config().deflateWindowBits = atoi(argv[++i]);
+    } else if (arg == "--chunked" && hasValue) {
+      SimNetwork::config().chunkBytes = strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--json") {
+      SimNetwork::config().stationSummaries = false;
+    } else if (arg == "--server" && hasValue) {
+      SimNetwork::config().server = argv[++i];
+    } else if (arg == "--start-millis" && hasValue) {
+      SimClock::setStartMillis(strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--heap" && hasValue) {
+      SimMemory::setHeapBytes(strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--screenshot" && hasValue) {
+      screenshotPath = argv[++i];
+    } else if (arg == "--profile" && hasValue) {
+      profilePath = argv[++i];
+    } else if (arg == "--quiet") {
+      quiet = true;
+    } else {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 2;
+    }
+  }
+
+  if (scenarioPath && !scenario.load(scenarioPath)) {
+    fprintf(stderr, "Could not load scenario %s\n", scenarioPath);
+    return 2;
+  }
+
+  if (quiet) {
+    freopen("/dev/null", "w", stdout);
+  }
+
+  endMicros = (uint64_t)(durationSeconds * 1000000.0);
+  SimClock::setInterruptHook(applyScenario);
+  SimMemory::runSketch(runSketch);
+  fflush(stdout);
+
+  if (screenshotPath && !carrier.display.writePPM(screenshotPath)) {
+    fprintf(stderr, "Could not write screenshot %s\n", screenshotPath);
+  }
+  if (profilePath) {
+    FILE* f = fopen(profilePath, "wb");
+    if (f) {
+      FilePrint out(f);
+      Profiler::dump(out);
+      fclose(f);
+    } else {
+      fprintf(stderr, "Could not write profile %s\n", profilePath);
+    }
+  }
+
+  const SimBusStats& bus = carrier.display.getBusStats();
+  const SimI2CStats& i2c = SimHardware::getI2CStats();
+  const SimNetworkStats& net = SimNetwork::stats();
+  const SimTouchStats& touch = SimHardware::getTouchStats();
+  const AnimatorStats& anim = RadialAnimator::getStats();
+  const MemoryStats& memory = MemoryMonitor::sample();
+  SimHeapStats heap = SimMemory::heapStats();
+  fprintf(stderr, "=== Simulation summary ===\n");
+  fprintf(stderr, "Virtual time:  %.3f s, %u loop iterations, longest %.1f ms busy\n",
+          SimClock::nowMicros() / 1e6, iterations, longestLoopMicros / 1000.0);
+  fprintf(stderr, "CPU:           %.1f%% busy, %.3f s in __WFI()\n",
+          100.0 * (SimClock::nowMicros() - SimClock::idleMicros()) / SimClock::nowMicros(),
+          SimClock::idleMicros() / 1e6);
+  fprintf(stderr, "Touch:         %u presses, %u seen, latency avg %.1f ms, max %.1f ms\n",
+          touch.presses, touch.reported,
+          touch.reported ? touch.totalLatencyMicros / 1000.0 / touch.reported : 0.0,
+          touch.maxLatencyMicros / 1000.0);
+  fprintf(stderr, "Display SPI:   %u transactions, %u address windows, %llu pixels, %.1f ms bus time\n",
+          bus.transactions, bus.addrWindows, (unsigned long long)bus.pixels, bus.busNanos / 1e6);
+  fprintf(stderr, "Sensor I2C:    %u transactions, %u bytes, %.1f ms bus time\n",
+          i2c.transactions, i2c.bytes, i2c.busNanos / 1e6);
+  fprintf(stderr, "Animation:     %u frames, %.1f fps while animating, %u dropped, %u overruns, "
+          "%u snapped, slowest %.1f ms\n",
+          anim.frames, anim.animatingMs ? anim.frames * 1000.0 / anim.animatingMs : 0.0,
+          anim.droppedFrames, anim.overruns, anim.snapped, anim.maxFrameMicros / 1000.0);
+  fprintf(stderr, "Memory:        heap peak %zu of %zu bytes, %zu free in the end (largest %zu), %u blocks live, "
+          "%u allocations refused; stack peak %u bytes\n",
+          heap.peakUsedBytes, heap.arenaBytes, heap.freeBytes, heap.largestFreeBlock, memory.liveBlocks,
+          memory.failures, memory.stackBytes);
+  fprintf(stderr, "Allocations:  ");
+  for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+    const AllocationStats& counts = MemoryMonitor::getAllocations((MemorySubsystem)i);
+    fprintf(stderr, " %s %u (%u bytes)%s", MemoryMonitor::getName((MemorySubsystem)i), counts.allocations,
+            counts.bytes, i + 1 < MEMORY_SUBSYSTEM_COUNT ? "," : "\n");
+  }
+  fprintf(stderr, "Network:       %u lookups, %u connections, %u requests (%u not modified), %llu bytes sent, "
+          "%llu bytes received\n",
+          net.lookups, net.connections, net.requests, net.notModified, (unsigned long long)net.bytesSent,
+          (unsigned long long)net.bytesReceived);
+  return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Glyph atlas generator
+ * Turns the classic 5x7 GFX font, plus the symbols drawn below, into
+ * GlyphTables.cpp, the flash tables behind GlyphAtlas.h:
+ *
+ *   glyph-tables OUT.cpp
+ *
+ * Blank columns either side of a glyph are trimmed, so every glyph gets
+ * its own advance; digits keep all five columns so numbers that change
+ * in place do not shift. The countdown characters are also rasterized
+ * at GLYPH_SPRITE_SIZE into 1-bit row masks. Exits non-zero if a glyph
+ * does not fit the table layout.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "GlyphAtlas.h"
+#include "../src/glcdfont.h"
+
+// Symbols beyond ASCII, drawn top row first, '#' for ink
+struct Symbol {
+  uint16_t codepoint;
+  const char* name;
+  const char* rows[GLYPH_HEIGHT];
+};
+
+static const Symbol SYMBOLS[] = {
+  {GLYPH_SUN, "sun", {
+    "...#...",
+    ".#...#.",
+    "..###..",
+    "#.###.#",
+    "..###..",
+    ".#...#.",
+    "...#...",
+    "......."}},
+  {GLYPH_MOON, "moon", {
+    ".####..",
+    "...###.",
+    "....###",
+    "....###",
+    "....###",
+    "...###.",
+    ".####..",
+    "......."}},
+};
+
+struct Glyph {
+  uint16_t codepoint;
+  std::string label;
+  std::vector<uint8_t> columns;
+  uint8_t sprite;
+};
+
+static bool isDigit(uint16_t codepoint) {
+  return codepoint >= '0' && codepoint <= '9';
+}
+
+// Drops blank columns from both sides; a blank glyph (space) keeps two
+static void trim(Glyph& glyph) {
+  std::vector<uint8_t>& columns = glyph.columns;
+  size_t first = 0, last = columns.size();
+  while (first < last && columns[first] == 0) first++;
+  while (last > first && columns[last - 1] == 0) last--;
+  if (first == last) {
+    columns.assign(2, 0);
+    return;
+  }
+  columns = std::vector<uint8_t>(columns.begin() + first, columns.begin() + last);
+}
+
+static std::string label(uint16_t codepoint) {
+  char buffer[16];
+  if (codepoint == '\\' || codepoint == '\'') {
+    snprintf(buffer, sizeof(buffer), "'\\%c'", codepoint);
+  } else {
+    snprintf(buffer, sizeof(buffer), "'%c'", codepoint);
+  }
+  return buffer;
+}
+
+// Row mask of a glyph scaled by GLYPH_SPRITE_SIZE, as drawGlyphText()
+// would otherwise draw it column by column
+static std::vector<uint8_t> rasterize(const Glyph& glyph) {
+  std::vector<uint8_t> mask(GLYPH_SPRITE_BYTES, 0);
+  for (int y = 0; y < GLYPH_SPRITE_ROWS; y++) {
+    for (int x = 0; x < (int)glyph.columns.size() * GLYPH_SPRITE_SIZE; x++) {
+      if ((glyph.columns[x / GLYPH_SPRITE_SIZE] >> (y / GLYPH_SPRITE_SIZE)) & 1) {
+        mask[y * GLYPH_SPRITE_STRIDE + x / 8] |= 0x80 >> (x % 8);
+      }
+    }
+  }
+  return mask;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s OUT.cpp\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<Glyph> glyphs;
+  for (uint16_t c = ' '; c <= '~'; c++) {
+    const uint8_t* columns = glcdGlyph((unsigned char)c);
+    Glyph glyph = {c, label(c), std::vector<uint8_t>(columns, columns + 5), GLYPH_NO_SPRITE};
+    if (!isDigit(c)) trim(glyph);
+    glyphs.push_back(glyph);
+  }
+  for (const Symbol& symbol : SYMBOLS) {
+    Glyph glyph = {symbol.codepoint, symbol.name, std::vector<uint8_t>(strlen(symbol.rows[0]), 0),
+                   GLYPH_NO_SPRITE};
+    for (int y = 0; y < GLYPH_HEIGHT; y++) {
+      for (size_t x = 0; x < glyph.columns.size() && symbol.rows[y][x]; x++) {
+        if (symbol.rows[y][x] == '#') glyph.columns[x] |= 1 << y;
+      }
+    }
+    trim(glyph);
+    glyphs.push_back(glyph);
+  }
+
+  std::vector<std::vector<uint8_t>> sprites;
+  for (int i = 0; i < GLYPH_SPRITE_COUNT; i++) {
+    Glyph& glyph = glyphs[GLYPH_SPRITE_CHARACTERS[i] - ' '];
+    if ((int)glyph.columns.size() * GLYPH_SPRITE_SIZE > GLYPH_SPRITE_STRIDE * 8) {
+      fprintf(stderr, "%s is too wide for a sprite\n", glyph.label.c_str());
+      return 1;
+    }
+    glyph.sprite = i;
+    sprites.push_back(rasterize(glyph));
+  }
+
+  std::string columnRows, glyphRows;
+  size_t offset = 0;
+  for (size_t i = 0; i < glyphs.size(); i++) {
+    const Glyph& glyph = glyphs[i];
+    if (i > 0 && glyph.codepoint <= glyphs[i - 1].codepoint) {
+      fprintf(stderr, "%s is out of order\n", glyph.label.c_str());
+      return 1;
+    }
+    if (glyph.columns.size() > 255 || offset > 65535) {
+      fprintf(stderr, "%s does not fit the table\n", glyph.label.c_str());
+      return 1;
+    }
+
+    char row[96];
+    columnRows += " ";
+    for (uint8_t column : glyph.columns) {
+      snprintf(row, sizeof(row), " 0x%02X,", column);
+      columnRows += row;
+    }
+    columnRows += "  // " + glyph.label + "\n";
+    snprintf(row, sizeof(row), "  {0x%04X, %zu, %zu, %u},  // %s\n", glyph.codepoint, offset,
+             glyph.columns.size(), glyph.sprite, glyph.label.c_str());
+    glyphRows += row;
+    offset += glyph.columns.size();
+  }
+
+  FILE* out = fopen(argv[1], "w");
+  if (!out) {
+    fprintf(stderr, "%s: cannot write\n", argv[1]);
+    return 1;
+  }
+  fprintf(out, "/*\n * Glyph atlas tables for Arduino Opla MTA Firmware\n");
+  fprintf(out, " * Generated by sim/tools/glyph_tables.cpp; do not edit.\n");
+  fprintf(out, " * %zu glyphs, %zu columns, %zu sprites at size %d.\n */\n\n#include \"GlyphAtlas.h\"\n\n",
+          glyphs.size(), offset, sprites.size(), GLYPH_SPRITE_SIZE);
+  fprintf(out, "const uint8_t GLYPH_COLUMNS[] = {\n%s};\n\n", columnRows.c_str());
+  fprintf(out, "const uint16_t GLYPH_COUNT = %zu;\n", glyphs.size());
+  fprintf(out, "const GlyphEntry GLYPHS[] = {\n%s};\n\n", glyphRows.c_str());
+  fprintf(out, "const uint8_t GLYPH_SPRITES[][GLYPH_SPRITE_BYTES] = {\n");
+  for (int i = 0; i < GLYPH_SPRITE_COUNT; i++) {
+    fprintf(out, "  {  // '%c'", GLYPH_SPRITE_CHARACTERS[i]);
+    for (int b = 0; b < GLYPH_SPRITE_BYTES; b++) {
+      fprintf(out, "%s0x%02X,", b % GLYPH_SPRITE_STRIDE == 0 ? (b % 8 == 0 ? "\n    " : "  ") : " ",
+              sprites[i][b]);
+    }
+    fprintf(out, "\n  },\n");
+  }
+  fprintf(out, "};\n");
+  fclose(out);
+
+  printf("%zu glyphs, %zu column bytes, %zu sprite bytes\n", glyphs.size(), offset,
+         sprites.size() * GLYPH_SPRITE_BYTES);
+  return 0;
+}
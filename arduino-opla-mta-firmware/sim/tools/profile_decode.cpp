@@ -0,0 +1,206 @@
+/*
+ * Profiler record decoder
+ * Finds the binary records Profiler::dump() writes (Profiler.h) in a
+ * capture of the board's Serial output, or in a simulator --profile file,
+ * and prints each probe's timings and histogram:
+ *
+ *   profile-decode CAPTURE [--histograms]
+ *
+ * Text around the records is skipped, so a plain serial log works. Exits
+ * non-zero if no intact record is found.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "Profiler.h"
+#include "StationSummary.h"
+
+struct DecodedProbe {
+  std::string name;
+  uint32_t count, minTicks, maxTicks;
+  uint64_t totalTicks;
+  uint16_t buckets[PROFILE_BUCKETS];
+};
+
+struct DecodedRecord {
+  uint32_t ticksPerSecond;
+  uint32_t windowMs;
+  uint32_t overheadTicks;
+  std::vector<DecodedProbe> probes;
+};
+
+// Bounds-checked little-endian reads over one record
+class RecordReader {
+private:
+  const uint8_t* bytes;
+  size_t length;
+  size_t position;
+
+public:
+  bool ok;
+
+  RecordReader(const uint8_t* data, size_t size) : bytes(data), length(size), position(0), ok(true) {}
+
+  uint64_t read(int width) {
+    if (position + width > length) {
+      ok = false;
+      return 0;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < width; i++) value |= (uint64_t)bytes[position + i] << (8 * i);
+    position += width;
+    return value;
+  }
+
+  std::string text(size_t size) {
+    if (position + size > length) {
+      ok = false;
+      return "";
+    }
+    std::string value((const char*)bytes + position, size);
+    position += size;
+    return value;
+  }
+
+  size_t offset() { return position; }
+};
+
+static bool readFile(const char* path, std::string& contents) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) contents.append(buffer, n);
+  fclose(f);
+  return true;
+}
+
+static bool decode(const uint8_t* start, size_t available, DecodedRecord& record, size_t& length) {
+  if (available < (size_t)PROFILE_HEADER_BYTES + 4) return false;
+  RecordReader header(start, available);
+  header.read(4);
+  if (header.read(1) != PROFILE_VERSION) return false;
+  int probeCount = header.read(1);
+  length = header.read(2);
+  if (length > available || length < (size_t)PROFILE_HEADER_BYTES + 4) return false;
+  if (stationSummaryCrc(0, start, length - 4) != stationSummaryRead32(start + length - 4)) return false;
+
+  RecordReader reader(start, length - 4);
+  reader.read(8);
+  record.ticksPerSecond = reader.read(4);
+  record.windowMs = reader.read(4);
+  record.overheadTicks = reader.read(4);
+  record.probes.clear();
+  for (int i = 0; i < probeCount && reader.ok; i++) {
+    DecodedProbe probe;
+    probe.name = reader.text(reader.read(1));
+    probe.count = reader.read(4);
+    probe.minTicks = reader.read(4);
+    probe.maxTicks = reader.read(4);
+    probe.totalTicks = reader.read(8);
+    int first = reader.read(1);
+    int count = reader.read(1);
+    memset(probe.buckets, 0, sizeof(probe.buckets));
+    for (int b = first; b < first + count; b++) {
+      uint16_t value = reader.read(2);
+      if (b < PROFILE_BUCKETS) probe.buckets[b] = value;
+    }
+    record.probes.push_back(probe);
+  }
+  return reader.ok && reader.offset() == length - 4 && record.ticksPerSecond > 0;
+}
+
+// Microseconds below which a fraction of the samples fall, at bucket
+// resolution: the top of the bucket the fraction reaches
+static double percentile(const DecodedProbe& probe, double fraction, uint32_t ticksPerSecond) {
+  uint32_t total = 0;
+  for (int b = 0; b < PROFILE_BUCKETS; b++) total += probe.buckets[b];
+  uint32_t seen = 0;
+  for (int b = 0; b < PROFILE_BUCKETS; b++) {
+    seen += probe.buckets[b];
+    if (total > 0 && seen >= fraction * total) {
+      double top = b == PROFILE_BUCKETS - 1 ? probe.maxTicks : (double)(2ULL << b);
+      return std::min(top, (double)probe.maxTicks) * 1e6 / ticksPerSecond;
+    }
+  }
+  return 0;
+}
+
+// Microseconds with about three significant digits
+static std::string micros(double us) {
+  char text[24];
+  snprintf(text, sizeof(text), us < 10 ? "%.2f" : us < 100 ? "%.1f" : "%.0f", us);
+  return text;
+}
+
+static void print(const DecodedRecord& record, bool histograms) {
+  double usPerTick = 1e6 / record.ticksPerSecond;
+  printf("Profile over %.1f s, %u ticks/s, probe overhead %u ticks (%.2f us)\n", record.windowMs / 1000.0,
+         record.ticksPerSecond, record.overheadTicks, record.overheadTicks * usPerTick);
+  printf("%-18s %9s %10s %10s %10s %10s %10s %11s\n", "probe", "count", "mean us", "min us", "p50 us",
+         "p90 us", "max us", "total ms");
+  for (const DecodedProbe& probe : record.probes) {
+    if (probe.count == 0) {
+      printf("%-18s %9u\n", probe.name.c_str(), 0);
+      continue;
+    }
+    printf("%-18s %9u %10.1f %10.1f %10.1f %10.1f %10.1f %11.2f\n", probe.name.c_str(), probe.count,
+           probe.totalTicks * usPerTick / probe.count, probe.minTicks * usPerTick,
+           percentile(probe, 0.5, record.ticksPerSecond), percentile(probe, 0.9, record.ticksPerSecond),
+           probe.maxTicks * usPerTick, probe.totalTicks * usPerTick / 1000);
+  }
+  if (!histograms) return;
+
+  for (const DecodedProbe& probe : record.probes) {
+    if (probe.count == 0) continue;
+    uint16_t most = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) most = std::max(most, probe.buckets[b]);
+    printf("\n%s\n", probe.name.c_str());
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+      if (probe.buckets[b] == 0) continue;
+      int width = (probe.buckets[b] * 40 + most - 1) / most;
+      printf("  %8s - %8s us %6u%s %s\n", micros((double)(1ULL << b) * usPerTick).c_str(),
+             micros((double)(2ULL << b) * usPerTick).c_str(), probe.buckets[b],
+             probe.buckets[b] == 0xFFFF ? "+" : " ", std::string(width, '#').c_str());
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  bool histograms = argc == 3 && strcmp(argv[2], "--histograms") == 0;
+  if (argc < 2 || (argc == 3 && !histograms) || argc > 3) {
+    fprintf(stderr, "Usage: %s CAPTURE [--histograms]\n", argv[0]);
+    return 2;
+  }
+
+  std::string capture;
+  if (!readFile(argv[1], capture)) {
+    fprintf(stderr, "%s: cannot read\n", argv[1]);
+    return 1;
+  }
+
+  const uint8_t* bytes = (const uint8_t*)capture.data();
+  int found = 0, damaged = 0;
+  for (size_t i = 0; i + sizeof(PROFILE_MAGIC) <= capture.size(); i++) {
+    if (memcmp(bytes + i, PROFILE_MAGIC, sizeof(PROFILE_MAGIC)) != 0) continue;
+    DecodedRecord record;
+    size_t length;
+    if (!decode(bytes + i, capture.size() - i, record, length)) {
+      damaged++;
+      continue;
+    }
+    if (found++ > 0) printf("\n");
+    print(record, histograms);
+    i += length - 1;
+  }
+
+  if (damaged > 0) fprintf(stderr, "%d damaged record(s) skipped\n", damaged);
+  if (found == 0) {
+    fprintf(stderr, "%s: no profiler record found\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Station summary encoder
+ * Converts proxy JSON responses into binary station summaries
+ * (StationSummary.h), for serving from a proxy or as fixtures:
+ *
+ *   summary-encode IN.json [OUT.bin]
+ *
+ * Without OUT only the sizes are reported. Exits non-zero if the response
+ * cannot be encoded.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <StationSummaryEncoder.h>
+#include "StationSummary.h"
+
+static bool readFile(const char* path, std::string& contents) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) contents.append(buffer, n);
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s IN.json [OUT.bin]\n", argv[0]);
+    return 2;
+  }
+
+  std::string json;
+  if (!readFile(argv[1], json)) {
+    fprintf(stderr, "%s: cannot read\n", argv[1]);
+    return 1;
+  }
+  std::string summary, error;
+  if (!encodeStationSummary(json, summary, &error)) {
+    fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+    return 1;
+  }
+
+  if (argc == 3) {
+    FILE* f = fopen(argv[2], "wb");
+    if (!f || fwrite(summary.data(), 1, summary.size(), f) != summary.size()) {
+      fprintf(stderr, "%s: cannot write\n", argv[2]);
+      if (f) fclose(f);
+      return 1;
+    }
+    fclose(f);
+  }
+
+  const uint8_t* counts = (const uint8_t*)summary.data() + STATION_SUMMARY_COUNTS_OFFSET;
+  printf("%s: %zu bytes JSON, %zu bytes summary (%d uptown, %d downtown, %d strings)\n", argv[1], json.size(),
+         summary.size(), counts[0], counts[1], counts[2]);
+  return 0;
+}
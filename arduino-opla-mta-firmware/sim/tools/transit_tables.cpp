@@ -0,0 +1,354 @@
+/*
+ * Transit metadata table generator
+ * Turns GTFS static stops.txt and routes.txt into TransitTables.cpp, the
+ * flash tables behind TransitMetadata.h:
+ *
+ *   transit-tables GTFS_DIR OUT.cpp [STATIONS.csv]
+ *
+ * Parent stations are keyed by a minimal perfect hash; routes are sorted
+ * for binary search. Direction labels come from the MTA's Stations.csv
+ * ("GTFS Stop ID", "North Direction Label", "South Direction Label") when
+ * given, else every station gets UPTOWN and DOWNTOWN. Every station is
+ * looked up through the finished hash before anything is written. Exits
+ * non-zero if an input is missing or malformed.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "TransitMetadata.h"
+
+static const char* DEFAULT_NORTH_LABEL = "UPTOWN";
+static const char* DEFAULT_SOUTH_LABEL = "DOWNTOWN";
+
+// Stops per bucket, on average; smaller finds displacements faster and
+// costs two bytes per bucket
+static const double STOPS_PER_BUCKET = 2.0;
+
+struct Station {
+  std::string id;
+  std::string name;
+  std::string northLabel;
+  std::string southLabel;
+};
+
+struct Route {
+  std::string id;
+  std::string name;
+  uint16_t color;
+  uint16_t textColor;
+};
+
+// A CSV file as rows of named columns
+class CsvFile {
+private:
+  std::vector<std::string> columns;
+  std::vector<std::vector<std::string>> rows;
+
+  // Splits one line, honouring quoted fields with doubled quotes
+  static std::vector<std::string> split(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+      char c = line[i];
+      if (quoted) {
+        if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+          fields.back() += '"';
+          i++;
+        } else if (c == '"') {
+          quoted = false;
+        } else {
+          fields.back() += c;
+        }
+      } else if (c == '"') {
+        quoted = true;
+      } else if (c == ',') {
+        fields.emplace_back();
+      } else if (c != '\r' && c != '\n') {
+        fields.back() += c;
+      }
+    }
+    return fields;
+  }
+
+public:
+  bool load(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), f)) {
+      std::vector<std::string> fields = split(buffer);
+      if (columns.empty()) {
+        if (fields[0].compare(0, 3, "\xEF\xBB\xBF") == 0) fields[0].erase(0, 3);   // UTF-8 BOM
+        columns = fields;
+      } else if (fields.size() > 1 || !fields[0].empty()) {
+        rows.push_back(fields);
+      }
+    }
+    fclose(f);
+    return !columns.empty();
+  }
+
+  int column(const char* name) const {
+    auto found = std::find(columns.begin(), columns.end(), name);
+    return found == columns.end() ? -1 : found - columns.begin();
+  }
+
+  size_t size() const { return rows.size(); }
+
+  // Empty when the row is short or the column absent
+  std::string get(size_t row, int column) const {
+    return column >= 0 && (size_t)column < rows[row].size() ? rows[row][column] : "";
+  }
+};
+
+static uint16_t rgb565(const std::string& hex, uint16_t fallback) {
+  if (hex.size() != 6 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) return fallback;
+  uint32_t rgb = strtoul(hex.c_str(), nullptr, 16);
+  return ((rgb >> 19) & 0x1F) << 11 | ((rgb >> 10) & 0x3F) << 5 | ((rgb >> 3) & 0x1F);
+}
+
+static bool fail(const std::string& message) {
+  fprintf(stderr, "%s\n", message.c_str());
+  return false;
+}
+
+static bool loadStations(const std::string& path, std::vector<Station>& stations) {
+  CsvFile stops;
+  if (!stops.load(path)) return fail(path + ": cannot read");
+  int id = stops.column("stop_id"), name = stops.column("stop_name");
+  int type = stops.column("location_type"), parent = stops.column("parent_station");
+  if (id < 0 || name < 0) return fail(path + ": no stop_id and stop_name columns");
+
+  // Parent stations are location_type 1; feeds without them list only
+  // stops with no parent
+  bool typed = false;
+  for (size_t i = 0; i < stops.size(); i++) typed = typed || stops.get(i, type) == "1";
+  for (size_t i = 0; i < stops.size(); i++) {
+    if (typed ? stops.get(i, type) != "1" : !stops.get(i, parent).empty()) continue;
+    Station station = {stops.get(i, id), stops.get(i, name), DEFAULT_NORTH_LABEL, DEFAULT_SOUTH_LABEL};
+    if (station.id.empty() || station.id.size() > (size_t)TRANSIT_STOP_ID_BYTES) {
+      return fail(path + ": stop ID \"" + station.id + "\" does not fit the table");
+    }
+    stations.push_back(station);
+  }
+  if (stations.empty()) return fail(path + ": no stations");
+  return true;
+}
+
+static bool loadLabels(const std::string& path, std::vector<Station>& stations) {
+  CsvFile csv;
+  if (!csv.load(path)) return fail(path + ": cannot read");
+  int id = csv.column("GTFS Stop ID");
+  int north = csv.column("North Direction Label"), south = csv.column("South Direction Label");
+  if (id < 0 || north < 0 || south < 0) return fail(path + ": no GTFS Stop ID and direction label columns");
+
+  std::map<std::string, size_t> byId;
+  for (size_t i = 0; i < stations.size(); i++) byId[stations[i].id] = i;
+  for (size_t i = 0; i < csv.size(); i++) {
+    auto found = byId.find(csv.get(i, id));
+    if (found == byId.end()) continue;
+    // Terminals have no label for the direction they are not served in
+    if (!csv.get(i, north).empty()) stations[found->second].northLabel = csv.get(i, north);
+    if (!csv.get(i, south).empty()) stations[found->second].southLabel = csv.get(i, south);
+  }
+  return true;
+}
+
+static bool loadRoutes(const std::string& path, std::vector<Route>& routes) {
+  CsvFile csv;
+  if (!csv.load(path)) return fail(path + ": cannot read");
+  int id = csv.column("route_id"), longName = csv.column("route_long_name");
+  int color = csv.column("route_color"), textColor = csv.column("route_text_color");
+  if (id < 0) return fail(path + ": no route_id column");
+
+  for (size_t i = 0; i < csv.size(); i++) {
+    // GTFS defaults: white routes, black text
+    Route route = {csv.get(i, id), csv.get(i, longName), rgb565(csv.get(i, color), 0xFFFF),
+                   rgb565(csv.get(i, textColor), 0x0000)};
+    if (route.id.empty() || route.id.size() > (size_t)TRANSIT_ROUTE_ID_BYTES) {
+      return fail(path + ": route ID \"" + route.id + "\" does not fit the table");
+    }
+    routes.push_back(route);
+  }
+  std::sort(routes.begin(), routes.end(), [](const Route& a, const Route& b) {
+    return strncmp(a.id.c_str(), b.id.c_str(), TRANSIT_ROUTE_ID_BYTES) < 0;
+  });
+  return true;
+}
+
+// Hash and displace: buckets are placed largest first, each trying
+// displacements until all of its stations land on free slots
+static bool buildHash(const std::vector<Station>& stations, std::vector<uint16_t>& displacements,
+                      std::vector<int>& slots) {
+  size_t count = stations.size();
+  size_t bucketCount = std::max<size_t>(1, count / STOPS_PER_BUCKET);
+  std::vector<std::vector<int>> buckets(bucketCount);
+  for (size_t i = 0; i < count; i++) {
+    const std::string& id = stations[i].id;
+    buckets[transitStopHash(id.data(), id.size(), 0) % bucketCount].push_back(i);
+  }
+  std::vector<size_t> order(bucketCount);
+  for (size_t b = 0; b < bucketCount; b++) order[b] = b;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+  displacements.assign(bucketCount, 0);
+  slots.assign(count, -1);
+  for (size_t b : order) {
+    bool placed = false;
+    for (uint32_t displacement = 0; displacement <= 0xFFFF && !placed; displacement++) {
+      std::vector<size_t> taken;
+      for (int station : buckets[b]) {
+        const std::string& id = stations[station].id;
+        size_t slot = transitStopHash(id.data(), id.size(), displacement + 1) % count;
+        if (slots[slot] >= 0 || std::find(taken.begin(), taken.end(), slot) != taken.end()) break;
+        taken.push_back(slot);
+      }
+      if (taken.size() != buckets[b].size()) continue;
+      for (size_t i = 0; i < taken.size(); i++) slots[taken[i]] = buckets[b][i];
+      displacements[b] = displacement;
+      placed = true;
+    }
+    if (!placed) return false;
+  }
+  return true;
+}
+
+// Every name and label once, as offsets into one NUL-separated block
+class StringTable {
+private:
+  std::string block;
+  std::map<std::string, uint16_t> offsets;
+
+public:
+  bool add(const std::string& text, uint16_t& offset) {
+    auto found = offsets.find(text);
+    if (found != offsets.end()) {
+      offset = found->second;
+      return true;
+    }
+    if (block.size() + text.size() + 1 > 0xFFFF) return false;
+    offset = offsets[text] = block.size();
+    block += text;
+    block += '\0';
+    return true;
+  }
+
+  const std::string& getBlock() const { return block; }
+};
+
+static std::string cString(const std::string& text) {
+  std::string out = "\"";
+  for (unsigned char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += (char)c;
+    } else if (c < 0x20 || c >= 0x7F) {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\%03o", c);   // Octal: never swallows the next character
+      out += escape;
+    } else {
+      out += (char)c;
+    }
+  }
+  return out + "\"";
+}
+
+static std::string idInitializer(const std::string& id) {
+  std::string out = "{";
+  for (size_t i = 0; i < id.size(); i++) out += std::string(i ? ", " : "") + "'" + id[i] + "'";
+  return out + "}";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4) {
+    fprintf(stderr, "Usage: %s GTFS_DIR OUT.cpp [STATIONS.csv]\n", argv[0]);
+    return 2;
+  }
+  std::string gtfs = argv[1];
+  std::vector<Station> stations;
+  std::vector<Route> routes;
+  if (!loadStations(gtfs + "/stops.txt", stations) || !loadRoutes(gtfs + "/routes.txt", routes) ||
+      (argc == 4 && !loadLabels(argv[3], stations))) {
+    return 1;
+  }
+
+  std::vector<uint16_t> displacements;
+  std::vector<int> slots;
+  if (!buildHash(stations, displacements, slots)) {
+    fprintf(stderr, "No perfect hash found for %zu stations\n", stations.size());
+    return 1;
+  }
+  for (size_t i = 0; i < stations.size(); i++) {
+    const std::string& id = stations[i].id;
+    uint32_t bucket = transitStopHash(id.data(), id.size(), 0) % displacements.size();
+    if (slots[transitStopHash(id.data(), id.size(), displacements[bucket] + 1u) % stations.size()] != (int)i) {
+      fprintf(stderr, "Station %s does not hash to its slot\n", id.c_str());
+      return 1;
+    }
+  }
+
+  StringTable strings;
+  std::string stopRows, routeRows;
+  bool fits = true;
+  for (int station : slots) {
+    const Station& s = stations[station];
+    uint16_t name, north, south;
+    fits = fits && strings.add(s.name, name) && strings.add(s.northLabel, north) && strings.add(s.southLabel, south);
+    char row[96];
+    snprintf(row, sizeof(row), "  {%s, %u, %u, %u},\n", idInitializer(s.id).c_str(), name, north, south);
+    stopRows += row;
+  }
+  for (const Route& r : routes) {
+    uint16_t name;
+    fits = fits && strings.add(r.name, name);
+    char row[96];
+    snprintf(row, sizeof(row), "  {%s, 0x%04X, 0x%04X, %u},\n", idInitializer(r.id).c_str(), r.color, r.textColor,
+             name);
+    routeRows += row;
+  }
+  if (!fits) {
+    fprintf(stderr, "Names exceed 64 KB\n");
+    return 1;
+  }
+
+  FILE* out = fopen(argv[2], "w");
+  if (!out) {
+    fprintf(stderr, "%s: cannot write\n", argv[2]);
+    return 1;
+  }
+  fprintf(out, "/*\n * Transit metadata tables for Arduino Opla MTA Firmware\n");
+  fprintf(out, " * Generated by sim/tools/transit_tables.cpp from %s; do not edit.\n", gtfs.c_str());
+  fprintf(out, " * %zu stations, %zu routes.\n */\n\n#include \"TransitMetadata.h\"\n\n", stations.size(),
+          routes.size());
+
+  fprintf(out, "const char TRANSIT_STRINGS[] =\n");
+  const std::string& block = strings.getBlock();
+  for (size_t start = 0; start < block.size();) {
+    size_t end = block.find('\0', start);
+    fprintf(out, "  %s\n", cString(block.substr(start, end + 1 - start)).c_str());
+    start = end + 1;
+  }
+  fprintf(out, "  ;\n\n");
+
+  fprintf(out, "const uint16_t TRANSIT_STOP_COUNT = %zu;\n", stations.size());
+  fprintf(out, "const TransitStopEntry TRANSIT_STOPS[] = {\n%s};\n\n", stopRows.c_str());
+  fprintf(out, "const uint16_t TRANSIT_STOP_BUCKETS = %zu;\n", displacements.size());
+  fprintf(out, "const uint16_t TRANSIT_STOP_DISPLACEMENTS[] = {");
+  for (size_t b = 0; b < displacements.size(); b++) {
+    fprintf(out, "%s%u%s", b % 16 == 0 ? "\n  " : " ", displacements[b], b + 1 < displacements.size() ? "," : "");
+  }
+  fprintf(out, "\n};\n\n");
+  fprintf(out, "const uint16_t TRANSIT_ROUTE_COUNT = %zu;\n", routes.size());
+  fprintf(out, "const TransitRouteEntry TRANSIT_ROUTES[] = {\n%s};\n", routeRows.c_str());
+  fclose(out);
+
+  size_t flashBytes = block.size() + stations.size() * sizeof(TransitStopEntry) +
+                      displacements.size() * sizeof(uint16_t) + routes.size() * sizeof(TransitRouteEntry);
+  printf("%zu stations in %zu buckets, %zu routes: %zu bytes of flash, none of RAM\n", stations.size(),
+         displacements.size(), routes.size(), flashBytes);
+  return 0;
+}